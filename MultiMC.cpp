@@ -10,6 +10,7 @@
 #include <QMessageBox>
 #include <QStringList>
 #include <QDesktopServices>
+#include <QtConcurrentRun>
 
 #include "gui/dialogs/VersionSelectDialog.h"
 #include "logic/InstanceList.h"
@@ -39,6 +40,9 @@
 #include "logic/tools/MCEditTool.h"
 
 #include "logic/URNResolver.h"
+#include "logic/ModIndex.h"
+#include "logic/Prefetcher.h"
+#include "logic/minecraft/NativesCache.h"
 
 #include "pathutils.h"
 #include "cmdutils.h"
@@ -233,6 +237,8 @@ MultiMC::MultiMC(int &argc, char **argv, bool root_override) : QApplication(argc
 	m_instances->loadList();
 	connect(InstDirSetting.get(), SIGNAL(SettingChanged(const Setting &, QVariant)),
 			m_instances.get(), SLOT(on_InstFolderChanged(const Setting &, QVariant)));
+	// drop the extracted natives nothing uses anymore, in the background
+	QtConcurrent::run(&NativesCache::collectGarbage, m_instances->instDir());
 
 	// and accounts
 	m_accounts.reset(new MojangAccountList(this));
@@ -373,6 +379,11 @@ void MultiMC::initGlobalSettings()
 	// Minecraft Sneaky Updates
 	m_settings->registerSetting("AutoUpdateMinecraftVersions", true);
 
+	// Background downloads. Speed in KiB/s, 0 is unlimited
+	m_settings->registerSetting("PrefetchEnabled", true);
+	m_settings->registerSetting("PrefetchMaxSpeed", 512);
+	m_settings->registerSetting("PrefetchMaxDownloads", 2);
+
 	// Notifications
 	m_settings->registerSetting("ShownNotifications", QString());
 
@@ -541,6 +552,7 @@ void MultiMC::initHttpMetaCache()
 	m_metacache->addBase("minecraftforge", QDir("mods/minecraftforge").absolutePath());
 	m_metacache->addBase("fmllibs", QDir("mods/minecraftforge/libs").absolutePath());
 	m_metacache->addBase("liteloader", QDir("mods/liteloader").absolutePath());
+	m_metacache->addBase("lwjgl", QDir("lwjgl").absolutePath());
 	m_metacache->addBase("skins", QDir("accounts/skins").absolutePath());
 	m_metacache->addBase("root", QDir(root()).absolutePath());
 	m_metacache->addBase("translations", QDir(staticData() + "/translations").absolutePath());
@@ -681,6 +693,25 @@ std::shared_ptr<URNResolver> MultiMC::resolver()
 	return m_resolver;
 }
 
+std::shared_ptr<ModIndex> MultiMC::modindex()
+{
+	if (!m_modindex)
+	{
+		m_modindex.reset(new ModIndex("modindex"));
+		m_modindex->Load();
+	}
+	return m_modindex;
+}
+
+std::shared_ptr<Prefetcher> MultiMC::prefetcher()
+{
+	if (!m_prefetcher)
+	{
+		m_prefetcher.reset(new Prefetcher());
+	}
+	return m_prefetcher;
+}
+
 void MultiMC::installUpdates(const QString updateFilesDir, UpdateFlags flags)
 {
 	// if we are going to update on exit, save the params now
@@ -739,6 +770,7 @@ void MultiMC::installUpdates(const QString updateFilesDir, UpdateFlags flags)
 
 void MultiMC::onExit()
 {
+	INISettingsObject::flushAll();
 	if (m_updateOnExitPath.size())
 	{
 		installUpdates(m_updateOnExitPath, m_updateOnExitFlags);
@@ -24,6 +24,8 @@ class StatusChecker;
 class BaseProfilerFactory;
 class BaseDetachedToolFactory;
 class URNResolver;
+class ModIndex;
+class Prefetcher;
 class TranslationDownloader;
 
 #if defined(MMC)
@@ -124,6 +126,10 @@ public:
 
 	std::shared_ptr<URNResolver> resolver();
 
+	std::shared_ptr<ModIndex> modindex();
+
+	std::shared_ptr<Prefetcher> prefetcher();
+
 	QMap<QString, std::shared_ptr<BaseProfilerFactory>> profilers()
 	{
 		return m_profilers;
@@ -211,6 +217,8 @@ private:
 	std::shared_ptr<MinecraftVersionList> m_minecraftlist;
 	std::shared_ptr<JavaVersionList> m_javalist;
 	std::shared_ptr<URNResolver> m_resolver;
+	std::shared_ptr<ModIndex> m_modindex;
+	std::shared_ptr<Prefetcher> m_prefetcher;
 	std::shared_ptr<TranslationDownloader> m_translationChecker;
 
 	QMap<QString, std::shared_ptr<BaseProfilerFactory>> m_profilers;
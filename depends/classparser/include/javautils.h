@@ -16,6 +16,7 @@
  */
 #pragma once
 #include <QString>
+#include <QByteArray>
 #include "classparser_config.h"
 
 #define MCVer_Unknown "Unknown"
@@ -23,7 +24,29 @@
 namespace javautils
 {
 /**
- * @brief Get the version from a minecraft.jar by parsing its class files. Expensive!
+ * @brief Get the version from a minecraft.jar by parsing its class files.
+ * Needs to inflate Minecraft.class, but the parsing itself is cheap.
  */
-QString GetMinecraftJarVersion(QString jar);
+CLASSPARSER_EXPORT QString GetMinecraftJarVersion(QString jar);
+
+/**
+ * @brief What a Forge mod class says about itself in its @Mod or @NetworkMod annotation
+ */
+struct ModAnnotation
+{
+	/// "Mod" or "NetworkMod". @NetworkMod doesn't carry any of the values below.
+	QString annotation;
+	QString modid;
+	QString name;
+	QString version;
+	QString dependencies;
+	QString acceptedMinecraftVersions;
+};
+
+/**
+ * @brief Look for a @Mod (or @NetworkMod) annotation on a class.
+ * Returns false if the class has neither, or isn't a valid class file.
+ * Classes that can't contain either are rejected without being parsed.
+ */
+CLASSPARSER_EXPORT bool GetModAnnotation(const QByteArray &classfile, ModAnnotation &out);
 }
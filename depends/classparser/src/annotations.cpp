@@ -25,17 +25,25 @@ annotation *annotation::read(util::membuffer &input, constant_pool &pool)
 	input.read_be(type_index);
 	annotation *ann = new annotation(type_index, pool);
 
-	uint16_t num_pairs = 0;
-	input.read_be(num_pairs);
-	while (num_pairs)
+	try
 	{
-		uint16_t name_idx = 0;
-		// read name index
-		input.read_be(name_idx);
-		auto elem = element_value::readElementValue(input, pool);
-		// read value
-		ann->add_pair(name_idx, elem);
-		num_pairs--;
+		uint16_t num_pairs = 0;
+		input.read_be(num_pairs);
+		while (num_pairs)
+		{
+			uint16_t name_idx = 0;
+			// read name index
+			input.read_be(name_idx);
+			auto elem = element_value::readElementValue(input, pool);
+			// read value
+			ann->add_pair(name_idx, elem);
+			num_pairs--;
+		}
+	}
+	catch (java::classfile_exception &)
+	{
+		delete ann;
+		throw;
 	}
 	return ann;
 }
@@ -73,13 +81,24 @@ element_value *element_value::readElementValue(util::membuffer &input,
 		return new element_value_annotation(ANNOTATION, annotation::read(input, pool), pool);
 	case ARRAY: // Array
 		input.read_be(index);
-		for (int i = 0; i < index; i++)
+		try
+		{
+			for (int i = 0; i < index; i++)
+			{
+				vals.push_back(element_value::readElementValue(input, pool));
+			}
+		}
+		catch (java::classfile_exception &)
 		{
-			vals.push_back(element_value::readElementValue(input, pool));
+			for (auto val : vals)
+			{
+				delete val;
+			}
+			throw;
 		}
 		return new element_value_array(ARRAY, vals, pool);
 	default:
-		throw new java::classfile_exception();
+		throw java::classfile_exception();
 	}
 }
 }
\ No newline at end of file
@@ -42,6 +42,7 @@ protected:
 
 public:
 	element_value(element_value_type type, constant_pool &pool) : type(type), pool(pool) {};
+	virtual ~element_value() {};
 
 	element_value_type getElementValueType()
 	{
@@ -98,6 +99,10 @@ public:
 			delete name_val_pairs[i].second;
 		}
 	}
+	uint16_t getTypeIndex()
+	{
+		return type_index;
+	}
 	void add_pair(uint16_t key, element_value *value)
 	{
 		name_val_pairs.push_back(std::make_pair(key, value));
@@ -7,17 +7,21 @@ namespace java
 {
 /**
  * Class representing a Java .class file
+ *
+ * Construction only reads the header, indexes the constant pool and reads the interfaces.
+ * Fields, methods and class attributes are skipped over the first time the class annotations
+ * are asked for. The class file data isn't copied and has to outlive this object.
  */
 class classfile : public util::membuffer
 {
 public:
-	classfile(char *data, std::size_t size) : membuffer(data, size)
+	classfile(const char *data, std::size_t size) : membuffer(data, size)
 	{
 		valid = false;
 		is_synthetic = false;
 		read_be(magic);
 		if (magic != 0xCAFEBABE)
-			throw new classfile_exception();
+			throw classfile_exception();
 		read_be(minor_version);
 		read_be(major_version);
 		constants.load(*this);
@@ -35,11 +39,75 @@ public:
 			interfaces.push_back(iface);
 			iface_count--;
 		}
+		members_offset = offset();
+		valid = true;
+	}
+	classfile(const classfile &) = delete;
+	classfile &operator=(const classfile &) = delete;
+	~classfile()
+	{
+		for (auto annotation : annotations)
+		{
+			delete annotation;
+		}
+	}
+
+	/**
+	 * The RuntimeVisibleAnnotations of the class itself. Read on first use.
+	 */
+	const java::annotation_table &visible_class_annotations()
+	{
+		if (!annotations_read)
+		{
+			// only try once, even if the attributes turn out to be broken
+			annotations_read = true;
+			read_class_attributes();
+		}
+		return annotations;
+	}
+
+	bool valid;
+	bool is_synthetic;
+	uint32_t magic;
+	uint16_t minor_version;
+	uint16_t major_version;
+	constant_pool constants;
+	uint16_t access_flags;
+	uint16_t this_class;
+	uint16_t super_class;
+	// interfaces this class implements ? must be. investigate.
+	std::vector<uint16_t> interfaces;
+
+private:
+	/*
+	 * Skip the attributes of a field or method:
+	 * attribute_info
+	 * {
+	 * 	u2 attribute_name_index;
+	 * 	u4 attribute_length;
+	 * 	u1 info[attribute_length];
+	 * }
+	 */
+	void skip_attributes()
+	{
+		uint16_t attr_count = 0;
+		read_be(attr_count);
+		while (attr_count)
+		{
+			skip(2);
+			uint32_t attr_length = 0;
+			read_be(attr_length);
+			skip(attr_length);
+			attr_count--;
+		}
+	}
+
+	void read_class_attributes()
+	{
+		seek(members_offset);
 
 		// Fields
-		// read fields (and attributes from inside fields) (and possible inner classes. yay for
-		// recursion!)
-		// for now though, we will ignore all attributes
+		// for now, we ignore all attributes from inside fields
 		/*
 		 * field_info
 		 * {
@@ -57,16 +125,7 @@ public:
 			// skip field stuff
 			skip(6);
 			// and skip field attributes
-			uint16_t attr_count = 0;
-			read_be(attr_count);
-			while (attr_count)
-			{
-				skip(2);
-				uint32_t attr_length = 0;
-				read_be(attr_length);
-				skip(attr_length);
-				attr_count--;
-			}
+			skip_attributes();
 			field_count--;
 		}
 
@@ -87,16 +146,7 @@ public:
 		{
 			skip(6);
 			// and skip method attributes
-			uint16_t attr_count = 0;
-			read_be(attr_count);
-			while (attr_count)
-			{
-				skip(2);
-				uint32_t attr_length = 0;
-				read_be(attr_length);
-				skip(attr_length);
-				attr_count--;
-			}
+			skip_attributes();
 			method_count--;
 		}
 
@@ -104,14 +154,6 @@ public:
 		// there are many kinds of attributes. this is just the generic wrapper structure.
 		// type is decided by attribute name. extensions to the standard are *possible*
 		// class annotations are one kind of a attribute (one per class)
-		/*
-		 * attribute_info
-		 * {
-		 * 	u2 attribute_name_index;
-		 * 	u4 attribute_length;
-		 * 	u1 info[attribute_length];
-		 * }
-		 */
 		uint16_t class_attr_count = 0;
 		read_be(class_attr_count);
 		while (class_attr_count)
@@ -121,14 +163,14 @@ public:
 			uint32_t attr_length = 0;
 			read_be(attr_length);
 
-			auto name = constants[name_idx];
-			if (name.str_data == "RuntimeVisibleAnnotations")
+			if (constants.type(name_idx) == constant::j_string_data &&
+				constants.utf8(name_idx) == "RuntimeVisibleAnnotations")
 			{
 				uint16_t num_annotations = 0;
 				read_be(num_annotations);
 				while (num_annotations)
 				{
-					visible_class_annotations.push_back(annotation::read(*this, constants));
+					annotations.push_back(annotation::read(*this, constants));
 					num_annotations--;
 				}
 			}
@@ -136,21 +178,10 @@ public:
 				skip(attr_length);
 			class_attr_count--;
 		}
-		valid = true;
 	}
-	;
-	bool valid;
-	bool is_synthetic;
-	uint32_t magic;
-	uint16_t minor_version;
-	uint16_t major_version;
-	constant_pool constants;
-	uint16_t access_flags;
-	uint16_t this_class;
-	uint16_t super_class;
-	// interfaces this class implements ? must be. investigate.
-	std::vector<uint16_t> interfaces;
-	// FIXME: doesn't free up memory on delete
-	java::annotation_table visible_class_annotations;
+
+	std::size_t members_offset = 0;
+	bool annotations_read = false;
+	java::annotation_table annotations;
 };
-}
\ No newline at end of file
+}
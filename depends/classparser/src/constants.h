@@ -1,6 +1,8 @@
 #pragma once
 #include "errors.h"
+#include "membuffer.h"
 #include <sstream>
+#include <vector>
 
 namespace java
 {
@@ -20,15 +22,18 @@ public:
 		j_fieldref = 9,
 		j_methodref = 10,
 		j_interface_methodref = 11,
-		j_nameandtype = 12
+		j_nameandtype = 12,
+		j_methodhandle = 15,
+		j_methodtype = 16,
+		j_invokedynamic = 18
 	} type;
 
 	constant(util::membuffer &buf)
 	{
 		buf.read(type);
 		// invalid constant type!
-		if (type > j_nameandtype || type == (type_t)0 || type == (type_t)2)
-			throw new classfile_exception();
+		if (!isValidType(type))
+			throw classfile_exception();
 
 		// load data depending on type
 		switch (type)
@@ -51,6 +56,7 @@ public:
 			buf.read_be(ref_type.name_and_type_idx);
 			break;
 		case j_string:
+		case j_methodtype:
 			buf.read_be(index);
 			break;
 		case j_string_data:
@@ -59,18 +65,47 @@ public:
 			// * U+0000 is represented as 0xC0,0x80 invalid character
 			// * any single zero byte ends the string
 			// * characters above U+10000 are encoded like in CESU-8
-			buf.read_jstr(str_data);
+			str_data = buf.read_jview();
 			break;
 		case j_nameandtype:
 			buf.read_be(name_and_type.name_index);
 			buf.read_be(name_and_type.descriptor_index);
 			break;
+		case j_methodhandle:
+			buf.read(method_handle.reference_kind);
+			buf.read_be(method_handle.reference_index);
+			break;
+		case j_invokedynamic:
+			buf.read_be(invoke_dynamic.bootstrap_method_attr_index);
+			buf.read_be(invoke_dynamic.name_and_type_index);
+			break;
+		default:
+			break;
 		}
 	}
 
-	constant(int fake)
+	static bool isValidType(type_t type)
 	{
-		type = j_hole;
+		switch (type)
+		{
+		case j_string_data:
+		case j_int:
+		case j_float:
+		case j_long:
+		case j_double:
+		case j_class:
+		case j_string:
+		case j_fieldref:
+		case j_methodref:
+		case j_interface_methodref:
+		case j_nameandtype:
+		case j_methodhandle:
+		case j_methodtype:
+		case j_invokedynamic:
+			return true;
+		default:
+			return false;
+		}
 	}
 
 	std::string toString()
@@ -115,11 +150,23 @@ public:
 			ss << "NameAndType: " << name_and_type.name_index << " "
 			   << name_and_type.descriptor_index;
 			break;
+		case j_methodhandle:
+			ss << "MethodHandle: " << (int)method_handle.reference_kind << " "
+			   << method_handle.reference_index;
+			break;
+		case j_methodtype:
+			ss << "MethodType: " << index;
+			break;
+		case j_invokedynamic:
+			ss << "InvokeDynamic: " << invoke_dynamic.bootstrap_method_attr_index << " "
+			   << invoke_dynamic.name_and_type_index;
+			break;
 		}
 		return ss.str();
 	}
 
-	std::string str_data; /** String data in 'modified utf-8'.*/
+	/// String data in 'modified utf-8'. Points into the class file buffer.
+	util::string_view str_data;
 	// store everything here.
 	union
 	{
@@ -145,12 +192,26 @@ public:
 			uint16_t name_index;
 			uint16_t descriptor_index;
 		} name_and_type;
+		struct
+		{
+			uint8_t reference_kind;
+			uint16_t reference_index;
+		} method_handle;
+		struct
+		{
+			uint16_t bootstrap_method_attr_index;
+			uint16_t name_and_type_index;
+		} invoke_dynamic;
 	};
 };
 
 /**
  * A helper class that represents the custom container used in Java class file for storage of
  * constants
+ *
+ * Loading only records where each constant starts and what type it is. Constants are decoded
+ * when they are asked for, and strings aren't copied out of the class file, so the buffer the
+ * class was read from has to outlive the pool.
  */
 class constant_pool
 {
@@ -158,63 +219,113 @@ public:
 	/**
 	 * Create a pool of constants
 	 */
-	constant_pool()
+	constant_pool() : buffer(nullptr, 0)
 	{
 	}
 	/**
-	 * Load a java constant pool
+	 * Index a java constant pool
 	 */
 	void load(util::membuffer &buf)
 	{
-		uint16_t length = 0;
-		buf.read_be(length);
-		length--;
-		uint16_t index = 1;
-		const constant *last_constant = nullptr;
-		while (length)
+		uint16_t count = 0;
+		buf.read_be(count);
+		if (count == 0)
+			throw classfile_exception();
+		buffer = buf;
+		// index 0 isn't used, and neither is the one after a long or a double
+		offsets.assign(count, 0);
+		types.assign(count, constant::j_hole);
+		for (uint16_t index = 1; index < count; index++)
 		{
-			const constant &cnst = constant(buf);
-			constants.push_back(cnst);
-			last_constant = &constants[constants.size() - 1];
-			if (last_constant->type == constant::j_double ||
-				last_constant->type == constant::j_long)
+			offsets[index] = buf.offset();
+			constant::type_t type;
+			buf.read(type);
+			types[index] = type;
+			switch (type)
 			{
-				// push in a fake constant to preserve indexing
-				constants.push_back(constant(0));
-				length -= 2;
-				index += 2;
-			}
-			else
+			case constant::j_string_data:
 			{
-				length--;
+				uint16_t length = 0;
+				buf.read_be(length);
+				buf.skip(length);
+				break;
+			}
+			case constant::j_class:
+			case constant::j_string:
+			case constant::j_methodtype:
+				buf.skip(2);
+				break;
+			case constant::j_methodhandle:
+				buf.skip(3);
+				break;
+			case constant::j_int:
+			case constant::j_float:
+			case constant::j_fieldref:
+			case constant::j_methodref:
+			case constant::j_interface_methodref:
+			case constant::j_nameandtype:
+			case constant::j_invokedynamic:
+				buf.skip(4);
+				break;
+			case constant::j_long:
+			case constant::j_double:
+				buf.skip(8);
 				index++;
+				break;
+			default:
+				throw classfile_exception();
 			}
 		}
 	}
-	typedef std::vector<java::constant> container_type;
 	/**
-	 * Access constants based on jar file index numbers (index of the first element is 1)
+	 * Number of constant slots, including the unused slot 0 (same as constant_pool_count)
+	 */
+	std::size_t size() const
+	{
+		return types.size();
+	}
+	/**
+	 * Type of a constant, without decoding it. Unused slots are j_hole.
 	 */
-	java::constant &operator[](std::size_t constant_index)
+	constant::type_t type(std::size_t constant_index) const
 	{
-		if (constant_index == 0 || constant_index > constants.size())
+		if (constant_index == 0 || constant_index >= types.size())
 		{
-			throw new classfile_exception();
+			throw classfile_exception();
 		}
-		return constants[constant_index - 1];
+		return types[constant_index];
 	}
-	;
-	container_type::const_iterator begin() const
+	/**
+	 * Access constants based on jar file index numbers (index of the first element is 1)
+	 */
+	java::constant operator[](std::size_t constant_index) const
 	{
-		return constants.begin();
+		if (type(constant_index) == constant::j_hole)
+		{
+			throw classfile_exception();
+		}
+		util::membuffer reader = buffer;
+		reader.seek(offsets[constant_index]);
+		return constant(reader);
 	}
-	;
-	container_type::const_iterator end() const
+	/**
+	 * Shortcut for getting the string data of an UTF-8 constant
+	 */
+	util::string_view utf8(std::size_t constant_index) const
 	{
-		return constants.end();
+		if (type(constant_index) != constant::j_string_data)
+		{
+			throw classfile_exception();
+		}
+		util::membuffer reader = buffer;
+		// skip the tag
+		reader.seek(offsets[constant_index] + 1);
+		return reader.read_jview();
 	}
 
 private:
-	container_type constants;
+	util::membuffer buffer;
+	std::vector<std::size_t> offsets;
+	std::vector<constant::type_t> types;
 };
 }
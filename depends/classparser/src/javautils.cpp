@@ -44,26 +44,25 @@ QString GetMinecraftJarVersion(QString jarName)
 		return version;
 
 	// read Minecraft.class
-	qint64 size = Minecraft.size();
-	char *classfile = new char[size];
-	Minecraft.read(classfile, size);
+	QByteArray classfile = Minecraft.readAll();
+	Minecraft.close();
+	zip.close();
 
-	// parse Minecraft.class
+	// parse Minecraft.class - only the constant pool index is built, and only UTF-8 constants
+	// are looked at, without copying them
 	try
 	{
-		char *temp = classfile;
-		java::classfile MinecraftClass(temp, size);
-		java::constant_pool constants = MinecraftClass.constants;
-		for (java::constant_pool::container_type::const_iterator iter = constants.begin();
-			 iter != constants.end(); iter++)
+		java::classfile MinecraftClass(classfile.constData(), classfile.size());
+		const java::constant_pool &constants = MinecraftClass.constants;
+		for (std::size_t i = 1; i < constants.size(); i++)
 		{
-			const java::constant &constant = *iter;
-			if (constant.type != java::constant::j_string_data)
+			if (constants.type(i) != java::constant::j_string_data)
 				continue;
-			const std::string &str = constant.str_data;
-			if (str.compare(0, 20, "Minecraft Minecraft ") == 0)
+			util::string_view str = constants.utf8(i);
+			if (str.starts_with("Minecraft Minecraft "))
 			{
-				version = str.substr(20).data();
+				util::string_view ver = str.substr(20);
+				version = QString::fromUtf8(ver.data(), ver.size());
 				break;
 			}
 		}
@@ -72,12 +71,80 @@ QString GetMinecraftJarVersion(QString jarName)
 	{
 	}
 
-	// clean up
-	delete[] classfile;
-	Minecraft.close();
-	zip.close();
-	jar.close();
-
 	return version;
 }
+
+namespace
+{
+// Forge moved from cpw.mods.fml to net.minecraftforge.fml in 1.8
+bool isModDescriptor(const util::string_view &descriptor)
+{
+	return descriptor == "Lcpw/mods/fml/common/Mod;" ||
+		   descriptor == "Lnet/minecraftforge/fml/common/Mod;";
+}
+
+bool isNetworkModDescriptor(const util::string_view &descriptor)
+{
+	return descriptor == "Lcpw/mods/fml/common/network/NetworkMod;";
+}
+
+QString toQString(const util::string_view &str)
+{
+	return QString::fromUtf8(str.data(), str.size());
+}
+}
+
+bool GetModAnnotation(const QByteArray &classfile, ModAnnotation &out)
+{
+	// the descriptor has to be in the constant pool verbatim - most classes are rejected here
+	if (!classfile.contains("/Mod;") && !classfile.contains("/NetworkMod;"))
+		return false;
+
+	bool found = false;
+	try
+	{
+		java::classfile modClass(classfile.constData(), classfile.size());
+		java::constant_pool &constants = modClass.constants;
+		for (auto annotation : modClass.visible_class_annotations())
+		{
+			util::string_view descriptor = constants.utf8(annotation->getTypeIndex());
+			if (isNetworkModDescriptor(descriptor))
+			{
+				// @Mod, if present, has the interesting bits
+				if (!found)
+					out.annotation = "NetworkMod";
+				found = true;
+				continue;
+			}
+			if (!isModDescriptor(descriptor))
+				continue;
+
+			found = true;
+			out.annotation = "Mod";
+			for (auto &pair : *annotation)
+			{
+				if (pair.second->getElementValueType() != java::STRING)
+					continue;
+				auto value = (java::element_value_simple *)pair.second;
+				QString str = toQString(constants.utf8(value->getIndex()));
+				util::string_view key = constants.utf8(pair.first);
+				if (key == "modid")
+					out.modid = str;
+				else if (key == "name")
+					out.name = str;
+				else if (key == "version")
+					out.version = str;
+				else if (key == "dependencies")
+					out.dependencies = str;
+				else if (key == "acceptedMinecraftVersions")
+					out.acceptedMinecraftVersions = str;
+			}
+		}
+	}
+	catch (java::classfile_exception &)
+	{
+		return false;
+	}
+	return found;
+}
 }
@@ -1,31 +1,36 @@
 #pragma once
 #include <stdint.h>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <exception>
 #include "javaendian.h"
+#include "errors.h"
+#include "string_view.h"
 
 namespace util
 {
+/**
+ * Reads from a buffer owned by someone else. Every read is bounds-checked and throws
+ * java::classfile_exception when it would go past the end of the buffer.
+ *
+ * Copying a membuffer is cheap and gives you an independent read position over the same data.
+ */
 class membuffer
 {
 public:
-	membuffer(char *buffer, std::size_t size)
+	membuffer(const char *buffer, std::size_t size)
 	{
 		current = start = buffer;
 		end = start + size;
 	}
-	~membuffer()
-	{
-		// maybe? possibly? left out to avoid confusion. for now.
-		// delete start;
-	}
 	/**
 		* Read some value. That's all ;)
 		*/
 	template <class T> void read(T &val)
 	{
-		val = *(T *)current;
+		check(sizeof(T));
+		std::memcpy(&val, current, sizeof(T));
 		current += sizeof(T);
 	}
 	/**
@@ -34,8 +39,8 @@ public:
 		*/
 	template <class T> void read_be(T &val)
 	{
-		val = util::bigswap(*(T *)current);
-		current += sizeof(T);
+		read(val);
+		val = util::bigswap(val);
 	}
 	/**
 		* Read a string in the format:
@@ -43,21 +48,52 @@ public:
 		* length bytes data
 		*/
 	void read_jstr(std::string &str)
+	{
+		str.append(read_jview().to_string());
+	}
+	/**
+		* Same as read_jstr, without copying the string data
+		*/
+	string_view read_jview()
 	{
 		uint16_t length = 0;
 		read_be(length);
-		str.append(current, length);
+		check(length);
+		string_view view(current, length);
 		current += length;
+		return view;
 	}
 	/**
 		* Skip N bytes
 		*/
 	void skip(std::size_t N)
 	{
+		check(N);
 		current += N;
 	}
+	/**
+		* Current read position, from the start of the buffer
+		*/
+	std::size_t offset() const
+	{
+		return current - start;
+	}
+	/**
+		* Move the read position to 'offset' bytes from the start of the buffer
+		*/
+	void seek(std::size_t offset)
+	{
+		if (offset > std::size_t(end - start))
+			throw java::classfile_exception();
+		current = start + offset;
+	}
 
 private:
-	char *start, *end, *current;
+	void check(std::size_t N) const
+	{
+		if (N > std::size_t(end - current))
+			throw java::classfile_exception();
+	}
+	const char *start, *end, *current;
 };
 }
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstring>
+#include <string>
+#include <ostream>
+
+namespace util
+{
+/**
+ * A non-owning view of a run of bytes inside a class file.
+ *
+ * Valid only as long as the buffer the class file was parsed from.
+ */
+class string_view
+{
+public:
+	string_view() : m_data(nullptr), m_size(0)
+	{
+	}
+	string_view(const char *data, std::size_t size) : m_data(data), m_size(size)
+	{
+	}
+	const char *data() const
+	{
+		return m_data;
+	}
+	std::size_t size() const
+	{
+		return m_size;
+	}
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+	char operator[](std::size_t pos) const
+	{
+		return m_data[pos];
+	}
+	/**
+	 * Everything from 'pos' to the end. Empty if 'pos' is past the end.
+	 */
+	string_view substr(std::size_t pos) const
+	{
+		if (pos >= m_size)
+			return string_view();
+		return string_view(m_data + pos, m_size - pos);
+	}
+	bool starts_with(const char *prefix) const
+	{
+		std::size_t length = std::strlen(prefix);
+		return length <= m_size && std::memcmp(m_data, prefix, length) == 0;
+	}
+	bool operator==(const char *other) const
+	{
+		return std::strlen(other) == m_size && std::memcmp(m_data, other, m_size) == 0;
+	}
+	bool operator!=(const char *other) const
+	{
+		return !(*this == other);
+	}
+	std::string to_string() const
+	{
+		return std::string(m_data, m_size);
+	}
+
+private:
+	const char *m_data;
+	std::size_t m_size;
+};
+
+inline std::ostream &operator<<(std::ostream &out, const string_view &str)
+{
+	return out.write(str.data(), str.size());
+}
+}
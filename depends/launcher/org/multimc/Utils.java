@@ -23,14 +23,9 @@ import java.lang.reflect.Method;
 import java.lang.reflect.Modifier;
 import java.net.URL;
 import java.net.URLClassLoader;
-import java.nio.file.Files;
-import java.nio.file.Path;
 import java.util.*;
 import java.util.Arrays;
-import java.util.Enumeration;
 import java.util.List;
-import java.util.zip.ZipEntry;
-import java.util.zip.ZipFile;
 
 public class Utils
 {
@@ -186,114 +181,4 @@ public class Utils
 	{
 		System.out.println();
 	}
-
-	/**
-	 * Pushes bytes from in to out. Closes both streams no matter what.
-	 * @param in the input stream
-	 * @param out the output stream
-	 * @throws IOException
-	 */
-	private static void copyStream(InputStream in, OutputStream out) throws IOException
-	{
-		try
-		{
-		byte[] buffer = new byte[4096];
-		int len;
-
-		while((len = in.read(buffer)) >= 0)
-			out.write(buffer, 0, len);
-		} finally
-		{
-			in.close();
-			out.close();
-		}
-	}
-
-	/**
-	 * Replace a 'target' string 'suffix' with 'replacement' 
-	 */
-	public static String replaceSuffix (String target, String suffix, String replacement)
-	{
-		if (!target.endsWith(suffix))
-		{
-			return target;
-		}
-		String prefix = target.substring(0, target.length() - suffix.length());
-		return prefix + replacement;
-	}
-
-	/**
-	 * Unzip zip file with natives 'source' into the folder 'targetFolder'
-	 *
-	 * Contains a hack for OSX. Yay.
-	 * @param source
-	 * @param targetFolder
-	 * @throws IOException
-	 */
-	public static void unzipNatives(File source, File targetFolder) throws IOException
-	{
-		ZipFile zip = new ZipFile(source);
-		Set <String> toProcess = new HashSet<String>();
-		try
-		{
-			Enumeration entries = zip.entries();
-
-			while (entries.hasMoreElements())
-			{
-				ZipEntry entry = (ZipEntry) entries.nextElement();
-
-				String entryName = entry.getName();
-				File targetFile = new File(targetFolder, entryName);
-				if (targetFile.getParentFile() != null)
-				{
-					targetFile.getParentFile().mkdirs();
-				}
-
-				if (entry.isDirectory())
-					continue;
-
-				copyStream(zip.getInputStream(entry), new BufferedOutputStream(new FileOutputStream(targetFile)));
-				toProcess.add(entryName);
-			}
-		} finally
-		{
-			zip.close();
-		}
-		for (String entryName : toProcess)
-		{
-			// check if we need a symlink
-			String suffixFrom = null;
-			String suffixTo = null;
-			if(entryName.endsWith(".dylib"))
-			{
-				suffixFrom = ".dylib";
-				suffixTo = ".jnilib";
-			}
-			else if(entryName.endsWith(".jnilib"))
-			{
-				suffixFrom = ".jnilib";
-				suffixTo = ".dylib";
-			}
-			else
-			{
-				continue;
-			}
-
-			String linkName = replaceSuffix(entryName, suffixFrom, suffixTo);
-			File targetFile = new File(targetFolder, entryName);
-			File symlinkFile = new File(targetFolder, linkName);
-
-			// if the link file exists already for whatever reason, do not create symlinks
-			if(symlinkFile.exists())
-			{
-				continue;
-			}
-
-			// create a symlink. This means we always have .jnilib and .dylib variants of the same libs.
-			Path linkLink = symlinkFile.toPath();
-			Path linkTarget = targetFile.toPath();
-			Files.createSymbolicLink(linkLink, linkTarget);
-		}
-	}
 }
-
@@ -20,7 +20,6 @@ import org.multimc.*;
 import java.applet.Applet;
 import java.io.File;
 import java.awt.*;
-import java.io.IOException;
 import java.lang.reflect.Field;
 import java.lang.reflect.Method;
 import java.util.ArrayList;
@@ -30,7 +29,6 @@ public class OneSixLauncher implements Launcher
 {
 	// parameters, separated from ParamBucket
 	private List<String> libraries;
-	private List<String> extlibs;
 	private List<String> mcparams;
 	private List<String> mods;
 	private List<String> traits;
@@ -52,7 +50,6 @@ public class OneSixLauncher implements Launcher
 	private void processParams(ParamBucket params) throws NotFoundException
 	{
 		libraries = params.all("cp");
-		extlibs = params.all("ext");
 		mcparams = params.allSafe("param", new ArrayList<String>() );
 		mainClass = params.firstSafe("mainClass", "net.minecraft.client.Minecraft");
 		appletClass = params.firstSafe("appletClass", "net.minecraft.client.MinecraftApplet");
@@ -60,6 +57,11 @@ public class OneSixLauncher implements Launcher
 		traits = params.allSafe("traits", new ArrayList<String>());
 		natives = params.first("natives");
 
+		// natives are already extracted, into one folder per architecture if they depend on it
+		String property = System.getProperty("os.arch");
+		boolean is_64 = property.equalsIgnoreCase("x86_64") || property.equalsIgnoreCase("amd64");
+		natives = natives.replace("${arch}", is_64 ? "64" : "32");
+
 		userName = params.first("userName");
 		sessionId = params.first("sessionId");
 		windowTitle = params.firstSafe("windowTitle", "Minecraft");
@@ -323,27 +325,6 @@ public class OneSixLauncher implements Launcher
 		// print the pretty things
 		printStats();
 
-		// extract native libs (depending on platform here... java!)
-		Utils.log("Preparing native libraries...");
-		String property = System.getProperty("os.arch");
-		boolean is_64 = property.equalsIgnoreCase("x86_64") || property.equalsIgnoreCase("amd64");
-		for(String extlib: extlibs)
-		{
-			try
-			{
-				String cleanlib = extlib.replace("${arch}", is_64 ? "64" : "32");
-				File cleanlibf = new File(cleanlib);
-				Utils.log("Extracting " + cleanlibf.getName());
-				Utils.unzipNatives(cleanlibf, new File(natives));
-			} catch (IOException e)
-			{
-				System.err.println("Failed to extract native library:");
-				e.printStackTrace(System.err);
-				return -1;
-			}
-		}
-		Utils.log();
-		
 		// set the native libs path... the brute force way
 		try
 		{
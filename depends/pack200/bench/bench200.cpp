@@ -0,0 +1,1218 @@
+/*
+ * Benchmark and regression test for the xz + pack200 library unpack path.
+ *
+ * For every NAME.jar.pack.xz given on the command line, this:
+ *  - decodes the xz stream into memory, like ForgeXzDownload does
+ *    (single-call when the xz index has the size, multi-call otherwise)
+ *  - unpacks the pack200 stream into a jar
+ *  - runs both back to back, through a temporary file (end-to-end)
+ *  - compares the produced jar with NAME.jar
+ *
+ * NAME.jar is not produced by the unpacker: for the corpus, gen_corpus.py
+ * writes it from the same classes it packs, and for a real library it is the
+ * original jar. Pack200 doesn't keep the constant pool order or the zip
+ * layout, so classes are compared by what they resolve to (members, code,
+ * attributes), and everything else byte for byte.
+ *
+ * Each archive runs in a child process, so the peak memory printed is the
+ * one of unpacking that archive alone. Temporary files go into a private
+ * directory under TMPDIR (or --temp-dir).
+ *
+ * It prints MB/s (of produced output) for each stage, and exits with a
+ * failure if any jar doesn't match.
+ *
+ * This file is public domain.
+ */
+
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <zlib.h>
+
+#include "xz.h"
+#include "xz_mem.h"
+#include "unpack200.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+typedef std::chrono::steady_clock bench_clock;
+
+// the same buffer size ForgeXzDownload::decompressAndInstall uses in multi-call mode
+const size_t xz_buffer_size = 1 << 20;
+// and the same limit on what we allocate up front, based on what the xz index claims
+const uint64_t xz_single_call_limit = 512 * 1024 * 1024;
+
+// skip the index lookup, to compare against the multi-call decoder
+bool force_multi_call = false;
+
+struct stage_result
+{
+	double best = 0.0;
+	double total = 0.0;
+	int runs = 0;
+	void add(double seconds)
+	{
+		if (runs == 0 || seconds < best)
+			best = seconds;
+		total += seconds;
+		runs++;
+	}
+	double mean() const
+	{
+		return runs ? total / runs : 0.0;
+	}
+};
+
+bool read_file(const std::string &path, std::vector<uint8_t> &out)
+{
+	std::ifstream in(path.c_str(), std::ios::binary);
+	if (!in)
+		return false;
+	out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool write_file(const std::string &path, const std::vector<uint8_t> &data)
+{
+	std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write((const char *)data.data(), data.size());
+	return (bool)out;
+}
+
+bool append_to_vector(void *ctx, const uint8_t *data, size_t size)
+{
+	auto output = (std::vector<uint8_t> *)ctx;
+	output->insert(output->end(), data, data + size);
+	return true;
+}
+
+/*
+ * Decode a whole xz stream from memory, the same way ForgeXzDownload does:
+ * in a single call when the index tells us the size, otherwise through a
+ * large output buffer.
+ */
+bool xz_decode_to_memory(const std::vector<uint8_t> &input, std::vector<uint8_t> &output)
+{
+	uint64_t size = 0;
+	struct xz_mem_stats stats;
+	enum xz_ret ret = XZ_UNSUPPORTED_CHECK;
+	if (!force_multi_call && xz_mem_uncompressed_size(input.data(), input.size(), &size) &&
+		size <= xz_single_call_limit)
+	{
+		output.resize(size);
+		ret = xz_mem_decode_single(input.data(), input.size(), output.data(), output.size(),
+								   &stats);
+	}
+	if (ret == XZ_UNSUPPORTED_CHECK)
+	{
+		std::vector<uint8_t> buffer(xz_buffer_size);
+		output.clear();
+		ret = xz_mem_decode_multi(input.data(), input.size(), buffer.data(), buffer.size(),
+								  1 << 26, append_to_vector, &output, &stats);
+	}
+	if (ret != XZ_STREAM_END)
+		throw std::runtime_error(xz_mem_strerror(ret));
+	return stats.single_call;
+}
+
+void unpack_file(const std::string &pack_path, const std::string &jar_path)
+{
+	FILE *input = fopen(pack_path.c_str(), "rb");
+	if (!input)
+		throw std::runtime_error("Can't open " + pack_path);
+	FILE *output = fopen(jar_path.c_str(), "wb");
+	if (!output)
+	{
+		fclose(input);
+		throw std::runtime_error("Can't open " + jar_path);
+	}
+	// unpack_200 closes both files
+	unpack_200(input, output);
+}
+
+void end_to_end(const std::vector<uint8_t> &xz_data, const std::string &pack_path,
+				const std::string &jar_path)
+{
+	std::vector<uint8_t> pack_data;
+	xz_decode_to_memory(xz_data, pack_data);
+	FILE *pack_file = fopen(pack_path.c_str(), "w+b");
+	if (!pack_file)
+		throw std::runtime_error("Can't open " + pack_path);
+	if (fwrite(pack_data.data(), 1, pack_data.size(), pack_file) != pack_data.size())
+	{
+		fclose(pack_file);
+		throw std::runtime_error("Write error");
+	}
+	fflush(pack_file);
+	rewind(pack_file);
+	FILE *output = fopen(jar_path.c_str(), "wb");
+	if (!output)
+	{
+		fclose(pack_file);
+		throw std::runtime_error("Can't open " + jar_path);
+	}
+	unpack_200(pack_file, output);
+}
+
+double seconds_since(bench_clock::time_point start)
+{
+	return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+std::string throughput(size_t bytes, const stage_result &result)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	if (result.best <= 0.0)
+	{
+		out << "inf";
+	}
+	else
+	{
+		out << (bytes / result.best) / (1024.0 * 1024.0) << " MB/s best, "
+			<< (bytes / result.mean()) / (1024.0 * 1024.0) << " MB/s mean";
+	}
+	return out.str();
+}
+
+std::string strip_suffix(const std::string &str, const std::string &suffix)
+{
+	if (str.size() >= suffix.size() &&
+		str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0)
+	{
+		return str.substr(0, str.size() - suffix.size());
+	}
+	return str;
+}
+
+std::string base_name(const std::string &path)
+{
+	size_t pos = path.find_last_of("/\\");
+	return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+std::string join_path(const std::string &dir, const std::string &name)
+{
+#ifdef _WIN32
+	return dir + "\\" + name;
+#else
+	return dir + "/" + name;
+#endif
+}
+
+/*
+ * Reading jars. Just enough of the zip format for what the unpacker and
+ * common jar tools write: no zip64, no encryption, stored or deflated.
+ */
+struct reader
+{
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+
+	reader(const uint8_t *data, size_t size, size_t pos = 0) : data(data), size(size), pos(pos)
+	{
+	}
+	void need(size_t count)
+	{
+		if (pos > size || size - pos < count)
+			throw std::runtime_error("truncated data");
+	}
+	uint32_t u1()
+	{
+		need(1);
+		return data[pos++];
+	}
+	uint32_t u2be()
+	{
+		need(2);
+		uint32_t v = (data[pos] << 8) | data[pos + 1];
+		pos += 2;
+		return v;
+	}
+	uint32_t u4be()
+	{
+		need(4);
+		uint32_t v = ((uint32_t)data[pos] << 24) | (data[pos + 1] << 16) | (data[pos + 2] << 8) |
+					 data[pos + 3];
+		pos += 4;
+		return v;
+	}
+	uint32_t u2le()
+	{
+		need(2);
+		uint32_t v = data[pos] | (data[pos + 1] << 8);
+		pos += 2;
+		return v;
+	}
+	uint32_t u4le()
+	{
+		need(4);
+		uint32_t v = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) |
+					 ((uint32_t)data[pos + 3] << 24);
+		pos += 4;
+		return v;
+	}
+	std::string str(size_t count)
+	{
+		need(count);
+		std::string s((const char *)data + pos, count);
+		pos += count;
+		return s;
+	}
+	const uint8_t *skip(size_t count)
+	{
+		need(count);
+		const uint8_t *p = data + pos;
+		pos += count;
+		return p;
+	}
+};
+
+typedef std::map<std::string, std::vector<uint8_t>> jar_entries;
+
+void inflate_entry(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		throw std::runtime_error("inflateInit2 failed");
+	stream.next_in = (Bytef *)data;
+	stream.avail_in = (uInt)size;
+	int ret;
+	do
+	{
+		// the central directory has the size, so this is only ever one pass
+		stream.next_out = out.data() + stream.total_out;
+		stream.avail_out = (uInt)(out.size() - stream.total_out);
+		ret = inflate(&stream, Z_FINISH);
+	} while (ret == Z_OK && stream.avail_out);
+	inflateEnd(&stream);
+	if (ret != Z_STREAM_END || stream.total_out != out.size())
+		throw std::runtime_error("bad deflate data");
+}
+
+jar_entries read_jar(const std::vector<uint8_t> &jar)
+{
+	const size_t eocd_size = 22;
+	if (jar.size() < eocd_size)
+		throw std::runtime_error("not a zip file");
+	size_t eocd = jar.size() - eocd_size;
+	while (true)
+	{
+		reader r(jar.data(), jar.size(), eocd);
+		if (r.u4le() == 0x06054b50)
+			break;
+		if (eocd == 0 || jar.size() - eocd > eocd_size + 0xFFFF)
+			throw std::runtime_error("no end of central directory");
+		eocd--;
+	}
+	reader r(jar.data(), jar.size(), eocd + 10);
+	uint32_t count = r.u2le();
+	r.u4le(); // size of the central directory
+	r.pos = r.u4le();
+
+	jar_entries entries;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (r.u4le() != 0x02014b50)
+			throw std::runtime_error("bad central directory entry");
+		r.skip(6); // versions, flags
+		uint32_t method = r.u2le();
+		r.skip(4); // time, date
+		uint32_t crc = r.u4le();
+		uint32_t compressed = r.u4le();
+		uint32_t size = r.u4le();
+		uint32_t name_len = r.u2le();
+		uint32_t extra_len = r.u2le();
+		uint32_t comment_len = r.u2le();
+		r.skip(8); // disk, attributes
+		uint32_t offset = r.u4le();
+		std::string name = r.str(name_len);
+		r.skip(extra_len + comment_len);
+
+		reader local(jar.data(), jar.size(), offset);
+		if (local.u4le() != 0x04034b50)
+			throw std::runtime_error("bad local header for " + name);
+		local.skip(22);
+		uint32_t local_name_len = local.u2le();
+		uint32_t local_extra_len = local.u2le();
+		local.skip(local_name_len + local_extra_len);
+		const uint8_t *data = local.skip(compressed);
+
+		std::vector<uint8_t> &out = entries[name];
+		out.resize(size);
+		if (method == 0 && compressed == size)
+			std::copy(data, data + size, out.begin());
+		else if (method == 8)
+			inflate_entry(data, compressed, out);
+		else
+			throw std::runtime_error("unsupported compression for " + name);
+		if (crc32(0, out.data(), (uInt)out.size()) != crc)
+			throw std::runtime_error("bad crc for " + name);
+	}
+	return entries;
+}
+
+/*
+ * Class files, turned into text with every constant pool reference
+ * resolved. Two class files with the same members, code and attributes give
+ * the same text, whatever order their constant pools are in.
+ */
+class class_dump
+{
+public:
+	explicit class_dump(const std::vector<uint8_t> &data)
+		: r(data.data(), data.size()), m_cp(&m_own_cp)
+	{
+	}
+
+	std::vector<std::string> lines()
+	{
+		if (r.u4be() != 0xCAFEBABE)
+			throw std::runtime_error("not a class file");
+		uint32_t minor = r.u2be();
+		uint32_t major = r.u2be();
+		out("version " + num(major) + "." + num(minor));
+		read_constant_pool();
+		out("access " + hex(r.u2be()));
+		out("this " + constant(r.u2be()));
+		out("super " + constant(r.u2be()));
+		uint32_t interfaces = r.u2be();
+		for (uint32_t i = 0; i < interfaces; i++)
+			out("implements " + constant(r.u2be()));
+		for (int kind = 0; kind < 2; kind++)
+		{
+			uint32_t members = r.u2be();
+			for (uint32_t i = 0; i < members; i++)
+			{
+				uint32_t access = r.u2be();
+				std::string name = utf8(r.u2be());
+				std::string desc = utf8(r.u2be());
+				out(std::string(kind ? "method " : "field ") + name + " " + desc + " " +
+					hex(access));
+				read_attributes("  ");
+			}
+		}
+		read_attributes("");
+		if (r.pos != r.size)
+			throw std::runtime_error("trailing data after the class");
+		return m_lines;
+	}
+
+private:
+	struct cp_entry
+	{
+		uint32_t tag = 0;
+		uint32_t a = 0;
+		uint32_t b = 0;
+		uint64_t value = 0;
+		std::string text;
+	};
+
+	void read_constant_pool()
+	{
+		uint32_t count = r.u2be();
+		m_own_cp.assign(count, cp_entry());
+		for (uint32_t i = 1; i < count; i++)
+		{
+			cp_entry &e = m_own_cp[i];
+			e.tag = r.u1();
+			switch (e.tag)
+			{
+			case 1: // Utf8
+				e.text = r.str(r.u2be());
+				break;
+			case 3: // Integer
+			case 4: // Float
+				e.value = r.u4be();
+				break;
+			case 5: // Long
+			case 6: // Double
+				e.value = (uint64_t)r.u4be() << 32;
+				e.value |= r.u4be();
+				i++;
+				break;
+			case 7:  // Class
+			case 8:  // String
+			case 16: // MethodType
+				e.a = r.u2be();
+				break;
+			case 15: // MethodHandle
+				e.a = r.u1();
+				e.b = r.u2be();
+				break;
+			case 9:  // Fieldref
+			case 10: // Methodref
+			case 11: // InterfaceMethodref
+			case 12: // NameAndType
+			case 18: // InvokeDynamic
+				e.a = r.u2be();
+				e.b = r.u2be();
+				break;
+			default:
+				throw std::runtime_error("bad constant pool tag " + num(e.tag));
+			}
+		}
+	}
+
+	const cp_entry &entry(uint32_t index)
+	{
+		if (index == 0 || index >= m_cp->size() || (*m_cp)[index].tag == 0)
+			throw std::runtime_error("bad constant pool index " + num(index));
+		return (*m_cp)[index];
+	}
+
+	std::string utf8(uint32_t index)
+	{
+		const cp_entry &e = entry(index);
+		if (e.tag != 1)
+			throw std::runtime_error("not a Utf8 constant: " + num(index));
+		return e.text;
+	}
+
+	std::string constant(uint32_t index)
+	{
+		const cp_entry &e = entry(index);
+		switch (e.tag)
+		{
+		case 1:
+			return "Utf8 \"" + e.text + "\"";
+		case 3:
+			return "Integer " + num((int32_t)e.value);
+		case 4:
+			return "Float " + hex(e.value);
+		case 5:
+			return "Long " + num((int64_t)e.value);
+		case 6:
+			return "Double " + hex(e.value);
+		case 7:
+			return "Class " + utf8(e.a);
+		case 8:
+			return "String \"" + utf8(e.a) + "\"";
+		case 9:
+			return "Field " + utf8(entry(e.a).a) + "." + constant(e.b);
+		case 10:
+			return "Method " + utf8(entry(e.a).a) + "." + constant(e.b);
+		case 11:
+			return "IMethod " + utf8(entry(e.a).a) + "." + constant(e.b);
+		case 12:
+			return utf8(e.a) + ":" + utf8(e.b);
+		case 15:
+			return "MethodHandle " + num(e.a) + " " + constant(e.b);
+		case 16:
+			return "MethodType " + utf8(e.a);
+		case 18:
+			return "InvokeDynamic " + num(e.a) + " " + constant(e.b);
+		}
+		return "?";
+	}
+
+	void read_attributes(const std::string &indent)
+	{
+		// the unpacker writes attributes in its own order
+		std::vector<std::pair<std::string, std::vector<std::string>>> attributes;
+		uint32_t count = r.u2be();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			std::string name = utf8(r.u2be());
+			uint32_t length = r.u4be();
+			const uint8_t *data = r.skip(length);
+			class_dump inner(*this, data, length);
+			inner.attribute(name, indent + "  ");
+			if (inner.r.pos != length)
+				throw std::runtime_error("bad length of attribute " + name);
+			attributes.push_back(std::make_pair(name, inner.m_lines));
+		}
+		std::stable_sort(attributes.begin(), attributes.end());
+		for (auto &attribute : attributes)
+		{
+			out(indent + "attribute " + attribute.first);
+			m_lines.insert(m_lines.end(), attribute.second.begin(), attribute.second.end());
+		}
+	}
+
+	class_dump(const class_dump &outer, const uint8_t *data, size_t size)
+		: r(data, size), m_cp(outer.m_cp)
+	{
+	}
+
+	void attribute(const std::string &name, const std::string &indent)
+	{
+		if (name == "ConstantValue" || name == "SourceFile" || name == "Signature")
+		{
+			out(indent + constant(r.u2be()));
+		}
+		else if (name == "Exceptions")
+		{
+			uint32_t count = r.u2be();
+			for (uint32_t i = 0; i < count; i++)
+				out(indent + constant(r.u2be()));
+		}
+		else if (name == "InnerClasses")
+		{
+			uint32_t count = r.u2be();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				std::string line = optional(r.u2be());
+				line += " " + optional(r.u2be());
+				line += " " + optional(r.u2be());
+				out(indent + line + " " + hex(r.u2be()));
+			}
+		}
+		else if (name == "EnclosingMethod")
+		{
+			std::string line = constant(r.u2be());
+			out(indent + line + " " + optional(r.u2be()));
+		}
+		else if (name == "LineNumberTable")
+		{
+			uint32_t count = r.u2be();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t pc = r.u2be();
+				out(indent + num(pc) + " line " + num(r.u2be()));
+			}
+		}
+		else if (name == "LocalVariableTable" || name == "LocalVariableTypeTable")
+		{
+			uint32_t count = r.u2be();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				std::string line = num(r.u2be());
+				line += "+" + num(r.u2be());
+				line += " " + utf8(r.u2be());
+				line += " " + utf8(r.u2be());
+				out(indent + line + " slot " + num(r.u2be()));
+			}
+		}
+		else if (name == "Code")
+		{
+			code(indent);
+		}
+		else
+		{
+			// anything else compares as bytes, which only works if it has no
+			// constant pool references in it
+			std::ostringstream line;
+			line << std::hex << std::setfill('0');
+			while (r.pos < r.size)
+				line << std::setw(2) << r.u1();
+			out(indent + line.str());
+		}
+	}
+
+	enum operand
+	{
+		NONE,
+		U1,
+		S1,
+		S2,
+		LOCAL,
+		CP1,
+		CP2,
+		BRANCH2,
+		BRANCH4,
+		IINC,
+		INVOKEINTERFACE,
+		INVOKEDYNAMIC,
+		MULTIANEWARRAY,
+		TABLESWITCH,
+		LOOKUPSWITCH,
+		WIDE,
+		INVALID
+	};
+
+	static operand operand_of(uint32_t op)
+	{
+		if (op <= 15)
+			return NONE; // nop, constants
+		if (op == 16 || op == 188)
+			return op == 16 ? S1 : U1; // bipush, newarray
+		if (op == 17)
+			return S2; // sipush
+		if (op == 18)
+			return CP1; // ldc
+		if (op == 19 || op == 20)
+			return CP2; // ldc_w, ldc2_w
+		if ((op >= 21 && op <= 25) || (op >= 54 && op <= 58) || op == 169)
+			return LOCAL; // loads, stores, ret
+		if (op <= 131)
+			return NONE; // short loads and stores, arrays, stack, arithmetic
+		if (op == 132)
+			return IINC;
+		if (op <= 152)
+			return NONE; // conversions, comparisons
+		if (op <= 168 || op == 198 || op == 199)
+			return BRANCH2; // if*, goto, jsr, ifnull, ifnonnull
+		if (op == 170)
+			return TABLESWITCH;
+		if (op == 171)
+			return LOOKUPSWITCH;
+		if (op <= 177)
+			return NONE; // returns
+		if (op <= 184 || op == 187 || op == 189 || op == 192 || op == 193)
+			return CP2; // field and method refs, new, anewarray, checkcast, instanceof
+		if (op == 185)
+			return INVOKEINTERFACE;
+		if (op == 186)
+			return INVOKEDYNAMIC;
+		if (op == 190 || op == 191 || op == 194 || op == 195)
+			return NONE; // arraylength, athrow, monitors
+		if (op == 196)
+			return WIDE;
+		if (op == 197)
+			return MULTIANEWARRAY;
+		if (op == 200 || op == 201)
+			return BRANCH4; // goto_w, jsr_w
+		return INVALID;
+	}
+
+	void code(const std::string &indent)
+	{
+		uint32_t max_stack = r.u2be();
+		uint32_t max_locals = r.u2be();
+		out(indent + "stack " + num(max_stack) + " locals " + num(max_locals));
+		uint32_t length = r.u4be();
+		size_t start = r.pos;
+		r.need(length);
+		reader bytecode(r.data + start, length);
+		while (bytecode.pos < length)
+		{
+			uint32_t pc = bytecode.pos;
+			uint32_t op = bytecode.u1();
+			std::string line = indent + num(pc) + ": " + num(op);
+			bool wide = false;
+			operand kind = operand_of(op);
+			if (kind == WIDE)
+			{
+				wide = true;
+				op = bytecode.u1();
+				line += " " + num(op);
+				kind = operand_of(op);
+				if (kind != LOCAL && kind != IINC)
+					throw std::runtime_error("bad wide instruction at " + num(pc));
+			}
+			switch (kind)
+			{
+			case NONE:
+			case WIDE:
+				break;
+			case U1:
+				line += " " + num(bytecode.u1());
+				break;
+			case S1:
+				line += " " + num((int)(int8_t)bytecode.u1());
+				break;
+			case S2:
+				line += " " + num((int16_t)bytecode.u2be());
+				break;
+			case LOCAL:
+				line += " " + num(wide ? bytecode.u2be() : bytecode.u1());
+				break;
+			case IINC:
+				line += " " + num(wide ? bytecode.u2be() : bytecode.u1());
+				line += " " + num(wide ? (int)(int16_t)bytecode.u2be()
+									   : (int)(int8_t)bytecode.u1());
+				break;
+			case CP1:
+				line += " " + constant(bytecode.u1());
+				break;
+			case CP2:
+				line += " " + constant(bytecode.u2be());
+				break;
+			case BRANCH2:
+				line += " -> " + num(pc + (int16_t)bytecode.u2be());
+				break;
+			case BRANCH4:
+				line += " -> " + num(pc + (int32_t)bytecode.u4be());
+				break;
+			case INVOKEINTERFACE:
+				line += " " + constant(bytecode.u2be());
+				line += " " + num(bytecode.u1());
+				line += " " + num(bytecode.u1());
+				break;
+			case INVOKEDYNAMIC:
+				line += " " + constant(bytecode.u2be());
+				line += " " + num(bytecode.u2be());
+				break;
+			case MULTIANEWARRAY:
+				line += " " + constant(bytecode.u2be());
+				line += " " + num(bytecode.u1());
+				break;
+			case TABLESWITCH:
+			{
+				bytecode.skip(3 - pc % 4);
+				line += " default -> " + num(pc + (int32_t)bytecode.u4be());
+				int32_t low = bytecode.u4be();
+				int32_t high = bytecode.u4be();
+				if (high < low)
+					throw std::runtime_error("bad tableswitch at " + num(pc));
+				for (int64_t key = low; key <= high; key++)
+					line += " " + num(key) + " -> " + num(pc + (int32_t)bytecode.u4be());
+				break;
+			}
+			case LOOKUPSWITCH:
+			{
+				bytecode.skip(3 - pc % 4);
+				line += " default -> " + num(pc + (int32_t)bytecode.u4be());
+				uint32_t pairs = bytecode.u4be();
+				for (uint32_t i = 0; i < pairs; i++)
+				{
+					int32_t key = bytecode.u4be();
+					line += " " + num(key) + " -> " + num(pc + (int32_t)bytecode.u4be());
+				}
+				break;
+			}
+			case INVALID:
+				throw std::runtime_error("bad opcode " + num(op) + " at " + num(pc));
+			}
+			out(line);
+		}
+		r.pos = start + length;
+		uint32_t handlers = r.u2be();
+		for (uint32_t i = 0; i < handlers; i++)
+		{
+			std::string line = num(r.u2be());
+			line += ".." + num(r.u2be());
+			line += " -> " + num(r.u2be());
+			out(indent + "catch " + line + " " + optional(r.u2be()));
+		}
+		read_attributes(indent);
+	}
+
+	std::string optional(uint32_t index)
+	{
+		return index ? constant(index) : "-";
+	}
+
+	template <typename T> static std::string num(T value)
+	{
+		std::ostringstream out;
+		out << value;
+		return out.str();
+	}
+
+	static std::string hex(uint64_t value)
+	{
+		std::ostringstream out;
+		out << "0x" << std::hex << value;
+		return out.str();
+	}
+
+	void out(const std::string &line)
+	{
+		m_lines.push_back(line);
+	}
+
+	reader r;
+	std::vector<cp_entry> m_own_cp;
+	// attributes are read by their own class_dump, sharing the outer pool
+	const std::vector<cp_entry> *m_cp;
+	std::vector<std::string> m_lines;
+};
+
+bool is_class(const std::string &name)
+{
+	return strip_suffix(name, ".class") != name;
+}
+
+bool compare_entry(const std::string &name, const std::vector<uint8_t> &produced,
+				   const std::vector<uint8_t> &golden, std::string &difference)
+{
+	if (!is_class(name))
+	{
+		if (produced == golden)
+			return true;
+		size_t offset = std::mismatch(produced.begin(),
+									  produced.begin() + std::min(produced.size(), golden.size()),
+									  golden.begin()).first -
+						produced.begin();
+		difference = "differs at byte " + std::to_string(offset) + " (" +
+					 std::to_string(produced.size()) + " bytes produced, " +
+					 std::to_string(golden.size()) + " expected)";
+		return false;
+	}
+	std::vector<std::string> got, expected;
+	try
+	{
+		got = class_dump(produced).lines();
+	}
+	catch (std::runtime_error &e)
+	{
+		difference = std::string("produced class is broken: ") + e.what();
+		return false;
+	}
+	try
+	{
+		expected = class_dump(golden).lines();
+	}
+	catch (std::runtime_error &e)
+	{
+		difference = std::string("golden class is broken: ") + e.what();
+		return false;
+	}
+	if (got == expected)
+		return true;
+	size_t line = 0;
+	while (line < got.size() && line < expected.size() && got[line] == expected[line])
+		line++;
+	difference = "differs at line " + std::to_string(line + 1) + ": got '" +
+				 (line < got.size() ? got[line] : "<end>") + "', expected '" +
+				 (line < expected.size() ? expected[line] : "<end>") + "'";
+	return false;
+}
+
+bool check_golden(const std::string &name, const std::vector<uint8_t> &produced,
+				  const std::string &golden_path)
+{
+	std::vector<uint8_t> golden;
+	if (!read_file(golden_path, golden))
+	{
+		std::cerr << name << ": missing golden file " << golden_path << std::endl;
+		return false;
+	}
+	jar_entries got, expected;
+	try
+	{
+		got = read_jar(produced);
+		expected = read_jar(golden);
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cerr << name << ": can't read jar: " << e.what() << std::endl;
+		return false;
+	}
+
+	bool ok = true;
+	size_t classes = 0;
+	for (auto &entry : expected)
+	{
+		auto found = got.find(entry.first);
+		if (found == got.end())
+		{
+			std::cerr << name << ": " << entry.first << " is missing" << std::endl;
+			ok = false;
+			continue;
+		}
+		std::string difference;
+		if (!compare_entry(entry.first, found->second, entry.second, difference))
+		{
+			std::cerr << name << ": " << entry.first << " " << difference << std::endl;
+			ok = false;
+		}
+		if (is_class(entry.first))
+			classes++;
+	}
+	for (auto &entry : got)
+	{
+		if (!expected.count(entry.first))
+		{
+			std::cerr << name << ": unexpected " << entry.first << std::endl;
+			ok = false;
+		}
+	}
+	if (ok)
+	{
+		std::cout << "  output matches " << golden_path << " (" << expected.size()
+				  << " entries, " << classes << " classes)" << std::endl;
+	}
+	return ok;
+}
+
+bool run_archive(const std::string &path, int iterations, const std::string &temp_dir)
+{
+	const std::string name = strip_suffix(base_name(path), ".jar.pack.xz");
+	const std::string golden_path = strip_suffix(path, ".pack.xz");
+	const std::string pack_path = join_path(temp_dir, name + ".pack");
+	const std::string jar_path = join_path(temp_dir, name + ".jar");
+
+	std::vector<uint8_t> xz_data;
+	if (!read_file(path, xz_data))
+	{
+		std::cerr << name << ": can't read " << path << std::endl;
+		return false;
+	}
+
+	stage_result xz_stage, unpack_stage, e2e_stage;
+	bool single_call = false;
+	std::vector<uint8_t> pack_data;
+	std::vector<uint8_t> jar_data;
+	try
+	{
+		for (int i = 0; i < iterations; i++)
+		{
+			auto start = bench_clock::now();
+			single_call = xz_decode_to_memory(xz_data, pack_data);
+			xz_stage.add(seconds_since(start));
+		}
+		if (!write_file(pack_path, pack_data))
+			throw std::runtime_error("Can't write " + pack_path);
+		for (int i = 0; i < iterations; i++)
+		{
+			auto start = bench_clock::now();
+			unpack_file(pack_path, jar_path);
+			unpack_stage.add(seconds_since(start));
+		}
+		for (int i = 0; i < iterations; i++)
+		{
+			auto start = bench_clock::now();
+			end_to_end(xz_data, pack_path, jar_path);
+			e2e_stage.add(seconds_since(start));
+		}
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cerr << name << ": " << e.what() << std::endl;
+		std::remove(pack_path.c_str());
+		std::remove(jar_path.c_str());
+		return false;
+	}
+	bool ok = read_file(jar_path, jar_data);
+	std::remove(pack_path.c_str());
+	std::remove(jar_path.c_str());
+	if (!ok)
+	{
+		std::cerr << name << ": can't read back " << jar_path << std::endl;
+		return false;
+	}
+
+	std::cout << name << ": " << xz_data.size() << " bytes xz, " << pack_data.size()
+			  << " bytes pack200, " << jar_data.size() << " bytes jar" << std::endl;
+	std::cout << "  xz decode:      " << throughput(pack_data.size(), xz_stage)
+			  << (single_call ? " (single-call)" : " (multi-call)") << std::endl;
+	std::cout << "  pack200 unpack: " << throughput(jar_data.size(), unpack_stage) << std::endl;
+	std::cout << "  end-to-end:     " << throughput(jar_data.size(), e2e_stage) << std::endl;
+
+	return check_golden(name, jar_data, golden_path);
+}
+
+/*
+ * A private directory for the temporary files, removed when done.
+ */
+struct temp_dir
+{
+	std::string path;
+	bool owned = false;
+
+	explicit temp_dir(const std::string &requested)
+	{
+		if (!requested.empty())
+		{
+			path = requested;
+			return;
+		}
+#ifdef _WIN32
+		char base[MAX_PATH + 1];
+		DWORD len = GetTempPathA(sizeof(base), base);
+		if (len == 0 || len > MAX_PATH)
+			throw std::runtime_error("Can't find the temporary directory");
+		for (int attempt = 0; attempt < 100 && !owned; attempt++)
+		{
+			path = std::string(base) + "bench200-" + std::to_string(GetCurrentProcessId()) +
+				   "-" + std::to_string(attempt);
+			owned = CreateDirectoryA(path.c_str(), NULL) != 0;
+		}
+		if (!owned)
+			throw std::runtime_error("Can't create a temporary directory");
+#else
+		const char *base = getenv("TMPDIR");
+		std::string pattern = join_path(base && *base ? base : "/tmp", "bench200-XXXXXX");
+		std::vector<char> buffer(pattern.begin(), pattern.end());
+		buffer.push_back('\0');
+		if (!mkdtemp(buffer.data()))
+			throw std::runtime_error("Can't create a temporary directory in " + pattern);
+		path = buffer.data();
+		owned = true;
+#endif
+	}
+	~temp_dir()
+	{
+		if (!owned)
+			return;
+#ifdef _WIN32
+		RemoveDirectoryA(path.c_str());
+#else
+		rmdir(path.c_str());
+#endif
+	}
+};
+
+struct options
+{
+	int iterations = 5;
+	std::string temp_dir;
+	// run the archives right here, instead of a child process per archive
+	bool in_process = false;
+	std::vector<std::string> archives;
+};
+
+/*
+ * Runs one archive in a child process, and gets the peak memory it used.
+ * Windows can't fork, so there it's this program again with --in-process.
+ */
+bool run_child(const std::string &archive, const options &opts, const std::string &dir,
+			   uint64_t &peak)
+{
+	std::cout << std::flush;
+	std::cerr << std::flush;
+#ifdef _WIN32
+	char self[MAX_PATH + 1];
+	if (!GetModuleFileNameA(NULL, self, sizeof(self)))
+		return false;
+	std::string command = std::string("\"") + self + "\" --in-process --iterations " +
+						  std::to_string(opts.iterations) + " --temp-dir \"" + dir + "\"" +
+						  (force_multi_call ? " --multi-call" : "") + " \"" + archive + "\"";
+	std::vector<char> command_line(command.begin(), command.end());
+	command_line.push_back('\0');
+	STARTUPINFOA startup;
+	PROCESS_INFORMATION process;
+	memset(&startup, 0, sizeof(startup));
+	startup.cb = sizeof(startup);
+	if (!CreateProcessA(self, command_line.data(), NULL, NULL, FALSE, 0, NULL, NULL, &startup,
+						&process))
+	{
+		std::cerr << archive << ": can't start " << self << std::endl;
+		return false;
+	}
+	WaitForSingleObject(process.hProcess, INFINITE);
+	DWORD status = 1;
+	GetExitCodeProcess(process.hProcess, &status);
+	PROCESS_MEMORY_COUNTERS counters;
+	peak = 0;
+	if (GetProcessMemoryInfo(process.hProcess, &counters, sizeof(counters)))
+		peak = counters.PeakWorkingSetSize;
+	CloseHandle(process.hThread);
+	CloseHandle(process.hProcess);
+	return status == 0;
+#else
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		std::cerr << archive << ": can't fork" << std::endl;
+		return false;
+	}
+	if (pid == 0)
+	{
+		bool ok = run_archive(archive, opts.iterations, dir);
+		std::cout << std::flush;
+		std::cerr << std::flush;
+		_exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	int status = 0;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) != pid)
+		return false;
+#ifdef __APPLE__
+	peak = usage.ru_maxrss;
+#else
+	peak = (uint64_t)usage.ru_maxrss * 1024;
+#endif
+	if (WIFSIGNALED(status))
+		std::cerr << archive << ": killed by signal " << WTERMSIG(status) << std::endl;
+	return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+#endif
+}
+
+void usage(const char *self)
+{
+	std::cerr << "Benchmark and verify xz + pack200 unpacking." << std::endl
+			  << "Run like this:" << std::endl
+			  << "  " << self
+			  << " [--iterations N] [--multi-call] [--temp-dir DIR] NAME.jar.pack.xz..."
+			  << std::endl
+			  << "Output is compared with NAME.jar." << std::endl;
+}
+}
+
+int main(int argc, char **argv)
+{
+	options opts;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--multi-call")
+		{
+			force_multi_call = true;
+		}
+		else if (arg == "--in-process")
+		{
+			opts.in_process = true;
+		}
+		else if (arg == "--iterations" && i + 1 < argc)
+		{
+			opts.iterations = std::atoi(argv[++i]);
+		}
+		else if (arg == "--temp-dir" && i + 1 < argc)
+		{
+			opts.temp_dir = argv[++i];
+		}
+		else if (arg == "--help" || arg == "-h")
+		{
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else
+		{
+			opts.archives.push_back(arg);
+		}
+	}
+	if (opts.archives.empty() || opts.iterations < 1)
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	xz_crc32_init();
+	xz_crc64_init();
+
+	bool all_ok = true;
+	try
+	{
+		temp_dir dir(opts.temp_dir);
+		for (auto &archive : opts.archives)
+		{
+			if (opts.in_process)
+			{
+				if (!run_archive(archive, opts.iterations, dir.path))
+					all_ok = false;
+				continue;
+			}
+			uint64_t peak = 0;
+			if (!run_child(archive, opts, dir.path, peak))
+				all_ok = false;
+			std::cout << "  peak memory:    " << peak / 1024 << " KiB" << std::endl;
+		}
+	}
+	catch (std::runtime_error &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1288 @@
+#!/usr/bin/env python3
+#
+# Generates the .pack.xz corpus used by bench200, along with the jars the
+# archives must unpack to.
+#
+# There is no pack200 packer we can rely on at build time, so this builds the
+# classes itself, with fields, methods, bytecode, exception handlers, line
+# numbers and constant values, and then writes every class twice:
+#  - as a plain class file, into the golden NAME.jar (written with zipfile)
+#  - as pack200 bands, into NAME.jar.pack.xz
+#
+# The golden jar never goes through the unpacker, so bench200 compares the
+# unpacker's output against an independent encoding of the same classes.
+# Pack200 doesn't keep the constant pool order or the zip layout, so bench200
+# compares classes by what their constant pool references resolve to, and
+# resources byte for byte.
+#
+# The pack200 side uses the regular and the specialized bytecodes: self and
+# super field and method references (with and without the folded aload_0),
+# the <init> shortcuts for this, super and the last `new`, typed ldc, switch
+# case bands, wide locals and null class references for the current class.
+# Class stubs in the file list keep the jar order, like a real packer does.
+#
+# The archives are shaped after the libraries Forge ships as .pack.xz
+# (scala-library, forge universal, launchwrapper), so they exercise similar
+# constant pool sizes, name lengths and file size distributions.
+#
+# This file is public domain.
+
+import io
+import lzma
+import os
+import random
+import sys
+import zipfile
+
+JAVA_PACKAGE_MAGIC = b'\xCA\xFE\xD0\x0D'
+JAVA5_PACKAGE_MINOR_VERSION = 7
+JAVA5_PACKAGE_MAJOR_VERSION = 150
+AO_HAVE_CP_NUMBERS = 1 << 1
+AO_HAVE_ALL_CODE_FLAGS = 1 << 2
+AO_HAVE_FILE_HEADERS = 1 << 4
+AO_HAVE_FILE_OPTIONS = 1 << 7
+FO_DEFLATE_HINT = 1 << 0
+FO_IS_CLASS_STUB = 1 << 1
+ARCHIVE_MODTIME = 1402000000  # 2014-06-05, fixed so outputs are reproducible
+CLASS_MINVER = 0
+CLASS_MAJVER = 50
+
+ACC_PUBLIC = 0x0001
+ACC_PRIVATE = 0x0002
+ACC_STATIC = 0x0008
+ACC_FINAL = 0x0010
+ACC_SUPER = 0x0020
+ACC_INTERFACE = 0x0200
+ACC_ABSTRACT = 0x0400
+
+# attribute indexes, as flag bits of the owning class, field, method or code
+CLASS_ATTR_SourceFile = 17
+FIELD_ATTR_ConstantValue = 17
+METHOD_ATTR_Code = 17
+METHOD_ATTR_Exceptions = 18
+CODE_ATTR_LineNumberTable = 1
+
+# (B, H, S, D) of the codings the bands we write use
+BYTE1 = (1, 256, 0, 0)
+CHAR3 = (3, 128, 0, 0)
+UNSIGNED5 = (5, 64, 0, 0)
+DELTA5 = (5, 64, 1, 1)
+UDELTA5 = (5, 64, 0, 1)
+MDELTA5 = (5, 64, 2, 1)
+BCI5 = (5, 4, 0, 0)
+BRANCH5 = (5, 4, 2, 0)
+
+OBJECT = 'java/lang/Object'
+STRING = 'java/lang/String'
+
+
+# --- band coding ---------------------------------------------------------
+
+def sign_code(x, S):
+    """The unsigned code of x in a coding with S sign bits."""
+    if S == 0:
+        return x & 0xFFFFFFFF
+    if x < 0:
+        return ((~x) << S) | ((1 << S) - 1)
+    m = (1 << S) - 1
+    return ((x // m) << S) + x % m
+
+
+def to_int32(x):
+    return ((x + (1 << 31)) & 0xFFFFFFFF) - (1 << 31)
+
+
+def encode(values, coding, escape=True):
+    """Encode a band. Variable length bands lead with an escape that selects
+    the default coding, so the first value can't be mistaken for one."""
+    B, H, S, D = coding
+    out = bytearray()
+    if not values:
+        return out
+    if B == 1:
+        out.extend(v & 0xFF for v in values)
+        return out
+    L = 256 - H
+    coded = []
+    if escape:
+        coded.append(sign_code(-1, S) if S else L)
+    prev = 0
+    for v in values:
+        x = to_int32(v - prev) if D else v
+        prev = v
+        coded.append(sign_code(x, S))
+    for u in coded:
+        for i in range(B):
+            if i == B - 1 or u < L:
+                assert u < 256
+                out.append(u)
+                break
+            out.append(L + (u - L) % H)
+            u = (u - L) // H
+    return out
+
+
+def header(values):
+    return encode(values, UNSIGNED5, escape=False)
+
+
+# --- descriptors ---------------------------------------------------------
+
+def arg_slots(desc):
+    """Number of local variable slots the arguments of a method take."""
+    slots = 0
+    i = 1
+    while desc[i] != ')':
+        c = desc[i]
+        if c in 'JD':
+            slots += 2
+        else:
+            slots += 1
+        while desc[i] == '[':
+            i += 1
+        if desc[i] == 'L':
+            i = desc.index(';', i)
+        i += 1
+    return slots
+
+
+def signature_form(desc):
+    """Split a descriptor into its pack200 form and the classes it names."""
+    form = []
+    classes = []
+    i = 0
+    while i < len(desc):
+        c = desc[i]
+        form.append(c)
+        if c == 'L':
+            end = desc.index(';', i)
+            classes.append(desc[i + 1:end])
+            i = end
+            continue
+        i += 1
+    return ''.join(form), classes
+
+
+def source_file_for(name):
+    """The SourceFile the unpacker derives for a class without one."""
+    base = name[max(name.rfind('/'), name.rfind('.')) + 1:]
+    for i, c in enumerate(base):
+        if ord(c) <= ord('-'):
+            base = base[:i]
+            break
+    return base + '.java'
+
+
+# --- the class model -----------------------------------------------------
+
+# opcode, and how its operands are encoded
+OPCODES = {
+    'nop': 0, 'aconst_null': 1, 'iconst_m1': 2, 'iconst_0': 3, 'iconst_1': 4,
+    'iconst_2': 5, 'iconst_3': 6, 'iconst_4': 7, 'iconst_5': 8, 'lconst_0': 9,
+    'lconst_1': 10, 'bipush': 16, 'sipush': 17, 'ldc': 18, 'ldc2_w': 20,
+    'iload': 21, 'lload': 22, 'aload': 25, 'iload_1': 27, 'iload_2': 28,
+    'lload_1': 31, 'aload_0': 42, 'aload_1': 43, 'aload_2': 44, 'iaload': 46,
+    'aaload': 50, 'istore': 54, 'lstore': 55, 'astore': 58, 'istore_1': 60,
+    'istore_2': 61, 'astore_1': 76, 'astore_2': 77, 'iastore': 79, 'aastore': 83,
+    'pop': 87, 'dup': 89, 'iadd': 96, 'ladd': 97, 'isub': 100, 'imul': 104,
+    'irem': 112, 'ishl': 120, 'iand': 126, 'ixor': 130, 'iinc': 132, 'i2l': 133,
+    'l2i': 136, 'ifeq': 153, 'ifne': 154, 'iflt': 155, 'ifge': 156, 'ifgt': 157,
+    'ifle': 158, 'if_icmpeq': 159, 'if_icmpne': 160, 'if_icmplt': 161,
+    'if_icmpge': 162, 'if_icmpgt': 163, 'if_icmple': 164, 'if_acmpeq': 165,
+    'if_acmpne': 166, 'goto': 167, 'tableswitch': 170, 'lookupswitch': 171,
+    'ireturn': 172, 'lreturn': 173, 'areturn': 176, 'return': 177,
+    'getstatic': 178, 'putstatic': 179, 'getfield': 180, 'putfield': 181,
+    'invokevirtual': 182, 'invokespecial': 183, 'invokestatic': 184,
+    'invokeinterface': 185, 'new': 187, 'newarray': 188, 'anewarray': 189,
+    'arraylength': 190, 'athrow': 191, 'checkcast': 192, 'instanceof': 193,
+    'multianewarray': 197, 'ifnull': 198, 'ifnonnull': 199,
+}
+BRANCHES = set(['ifeq', 'ifne', 'iflt', 'ifge', 'ifgt', 'ifle', 'if_icmpeq', 'if_icmpne',
+                'if_icmplt', 'if_icmpge', 'if_icmpgt', 'if_icmple', 'if_acmpeq',
+                'if_acmpne', 'goto', 'ifnull', 'ifnonnull'])
+LOCALS = set(['iload', 'lload', 'aload', 'istore', 'lstore', 'astore'])
+MEMBERS = set(['getstatic', 'putstatic', 'getfield', 'putfield', 'invokevirtual',
+               'invokespecial', 'invokestatic', 'invokeinterface'])
+CLASS_OPS = set(['new', 'anewarray', 'checkcast', 'instanceof', 'multianewarray'])
+
+
+class Code(object):
+    def __init__(self, max_stack, max_locals):
+        self.max_stack = max_stack
+        self.max_locals = max_locals
+        self.insns = []     # (name, operands...), branch targets are label names
+        self.labels = {}    # label -> instruction index
+        self.handlers = []  # (start, end, catch, class or None), as labels
+        self.lines = []     # (label, line)
+
+    def label(self, name):
+        self.labels[name] = len(self.insns)
+        return self
+
+    def op(self, name, *args):
+        assert name in OPCODES, name
+        self.insns.append((name,) + args)
+        return self
+
+    def target(self, label):
+        return self.labels[label]
+
+
+class Member(object):
+    def __init__(self, flags, name, desc, code=None, constant=None, exceptions=()):
+        self.flags = flags
+        self.name = name
+        self.desc = desc
+        self.code = code
+        self.constant = constant  # ('Integer', v) or ('String', s)
+        self.exceptions = list(exceptions)
+
+
+class Class(object):
+    def __init__(self, name, super_name, flags=ACC_PUBLIC | ACC_SUPER, interfaces=(),
+                 source=None):
+        self.name = name
+        self.super_name = super_name
+        self.flags = flags
+        self.interfaces = list(interfaces)
+        self.fields = []
+        self.methods = []
+        self.source = source  # None means the derived .java name
+
+    def source_file(self):
+        return self.source if self.source is not None else source_file_for(self.name)
+
+
+def constants_of(insn):
+    """Constant pool references an instruction makes."""
+    name = insn[0]
+    if name in ('ldc', 'ldc2_w') or name in MEMBERS:
+        return [insn[1]]
+    if name in CLASS_OPS:
+        return [('Class', insn[1])]
+    return []
+
+
+# --- class files ---------------------------------------------------------
+
+class ConstantPool(object):
+    def __init__(self):
+        self.out = bytearray()
+        self.index = {}
+        self.count = 1
+
+    def add(self, key):
+        if key in self.index:
+            return self.index[key]
+        kind = key[0]
+        if kind == 'Utf8':
+            data = key[1].encode('ascii')
+            entry = b'\x01' + len(data).to_bytes(2, 'big') + data
+        elif kind == 'Integer':
+            entry = b'\x03' + (key[1] & 0xFFFFFFFF).to_bytes(4, 'big')
+        elif kind == 'Long':
+            entry = b'\x05' + (key[1] & 0xFFFFFFFFFFFFFFFF).to_bytes(8, 'big')
+        elif kind == 'Class':
+            entry = b'\x07' + self.add(('Utf8', key[1])).to_bytes(2, 'big')
+        elif kind == 'String':
+            entry = b'\x08' + self.add(('Utf8', key[1])).to_bytes(2, 'big')
+        elif kind in ('Field', 'Method', 'IMethod'):
+            tag = {'Field': 9, 'Method': 10, 'IMethod': 11}[kind]
+            owner = self.add(('Class', key[1]))
+            nat = self.add(('NameAndType', key[2], key[3]))
+            entry = bytes([tag]) + owner.to_bytes(2, 'big') + nat.to_bytes(2, 'big')
+        elif kind == 'NameAndType':
+            name = self.add(('Utf8', key[1]))
+            desc = self.add(('Utf8', key[2]))
+            entry = b'\x0c' + name.to_bytes(2, 'big') + desc.to_bytes(2, 'big')
+        else:
+            raise ValueError(key)
+        idx = self.count
+        self.index[key] = idx
+        self.out += entry
+        self.count += 2 if kind == 'Long' else 1
+        return idx
+
+    def utf8(self, s):
+        return self.add(('Utf8', s))
+
+
+def u2(v):
+    return (v & 0xFFFF).to_bytes(2, 'big')
+
+
+def u4(v):
+    return (v & 0xFFFFFFFF).to_bytes(4, 'big')
+
+
+def insn_size(insn, bci):
+    name = insn[0]
+    if name == 'tableswitch':
+        pad = 3 - bci % 4
+        return 1 + pad + 12 + 4 * len(insn[3])
+    if name == 'lookupswitch':
+        pad = 3 - bci % 4
+        return 1 + pad + 8 + 8 * len(insn[2])
+    if name in LOCALS:
+        return 4 if insn[1] > 255 else 2
+    if name == 'iinc':
+        return 6 if insn[1] > 255 or not -128 <= insn[2] <= 127 else 3
+    if name in BRANCHES or name in ('sipush', 'ldc2_w', 'getstatic', 'putstatic', 'getfield',
+                                    'putfield', 'invokevirtual', 'invokespecial',
+                                    'invokestatic', 'new', 'anewarray', 'checkcast',
+                                    'instanceof'):
+        return 3
+    if name in ('bipush', 'ldc', 'newarray'):
+        return 2
+    if name in ('invokeinterface', 'multianewarray'):
+        return 5 if name == 'invokeinterface' else 4
+    return 1
+
+
+def write_code(code, cp):
+    bcis = []
+    bci = 0
+    for insn in code.insns:
+        bcis.append(bci)
+        bci += insn_size(insn, bci)
+    bcis.append(bci)
+
+    def at(label):
+        return bcis[code.target(label)]
+
+    out = bytearray()
+    for i, insn in enumerate(code.insns):
+        name = insn[0]
+        op = OPCODES[name]
+        here = bcis[i]
+        if name in LOCALS and insn[1] > 255:
+            out += bytes([196, op]) + u2(insn[1])
+        elif name in LOCALS:
+            out += bytes([op, insn[1]])
+        elif name == 'iinc':
+            if insn_size(insn, here) == 6:
+                out += bytes([196, op]) + u2(insn[1]) + u2(insn[2])
+            else:
+                out += bytes([op, insn[1], insn[2] & 0xFF])
+        elif name in BRANCHES:
+            out += bytes([op]) + u2(at(insn[1]) - here)
+        elif name == 'tableswitch':
+            out += bytes([op]) + bytes(3 - here % 4)
+            out += u4(at(insn[1]) - here) + u4(insn[2]) + u4(insn[2] + len(insn[3]) - 1)
+            for label in insn[3]:
+                out += u4(at(label) - here)
+        elif name == 'lookupswitch':
+            out += bytes([op]) + bytes(3 - here % 4)
+            out += u4(at(insn[1]) - here) + u4(len(insn[2]))
+            for key, label in insn[2]:
+                out += u4(key) + u4(at(label) - here)
+        elif name == 'bipush' or name == 'newarray':
+            out += bytes([op, insn[1] & 0xFF])
+        elif name == 'sipush':
+            out += bytes([op]) + u2(insn[1])
+        elif name == 'ldc':
+            idx = cp.add(insn[1])
+            assert idx < 256
+            out += bytes([op, idx])
+        elif name == 'ldc2_w' or name in MEMBERS:
+            out += bytes([op]) + u2(cp.add(insn[1]))
+            if name == 'invokeinterface':
+                out += bytes([1 + arg_slots(insn[1][3]), 0])
+        elif name in CLASS_OPS:
+            out += bytes([op]) + u2(cp.add(('Class', insn[1])))
+            if name == 'multianewarray':
+                out += bytes([insn[2]])
+        else:
+            out += bytes([op])
+    assert len(out) == bci
+
+    body = u2(code.max_stack) + u2(code.max_locals) + u4(len(out)) + out
+    body += u2(len(code.handlers))
+    for start, end, catch, cls in code.handlers:
+        body += u2(at(start)) + u2(at(end)) + u2(at(catch))
+        body += u2(cp.add(('Class', cls)) if cls else 0)
+    if code.lines:
+        table = u2(len(code.lines))
+        for label, line in code.lines:
+            table += u2(at(label)) + u2(line)
+        body += u2(1) + u2(cp.utf8('LineNumberTable')) + u4(len(table)) + table
+    else:
+        body += u2(0)
+    return body
+
+
+def class_file(cls):
+    cp = ConstantPool()
+    # ldc takes a one byte index, so those go first, like the unpacker does it
+    for m in cls.methods:
+        if m.code:
+            for insn in m.code.insns:
+                if insn[0] == 'ldc':
+                    cp.add(insn[1])
+
+    def attribute(name, data):
+        return u2(cp.utf8(name)) + u4(len(data)) + data
+
+    body = u2(cls.flags) + u2(cp.add(('Class', cls.name)))
+    body += u2(cp.add(('Class', cls.super_name)))
+    body += u2(len(cls.interfaces))
+    for i in cls.interfaces:
+        body += u2(cp.add(('Class', i)))
+    body += u2(len(cls.fields))
+    for f in cls.fields:
+        body += u2(f.flags) + u2(cp.utf8(f.name)) + u2(cp.utf8(f.desc))
+        if f.constant:
+            body += u2(1) + attribute('ConstantValue', u2(cp.add(f.constant)))
+        else:
+            body += u2(0)
+    body += u2(len(cls.methods))
+    for m in cls.methods:
+        body += u2(m.flags) + u2(cp.utf8(m.name)) + u2(cp.utf8(m.desc))
+        attrs = []
+        if m.code:
+            attrs.append(attribute('Code', write_code(m.code, cp)))
+        if m.exceptions:
+            data = u2(len(m.exceptions))
+            for e in m.exceptions:
+                data += u2(cp.add(('Class', e)))
+            attrs.append(attribute('Exceptions', data))
+        body += u2(len(attrs)) + b''.join(attrs)
+    body += u2(1) + attribute('SourceFile', u2(cp.utf8(cls.source_file())))
+
+    head = b'\xCA\xFE\xBA\xBE' + u2(CLASS_MINVER) + u2(CLASS_MAJVER)
+    head += u2(cp.count) + cp.out
+    return bytes(head + body)
+
+
+def golden_jar(entries):
+    """entries: list of (name, bytes, deflate)"""
+    buf = io.BytesIO()
+    with zipfile.ZipFile(buf, 'w') as jar:
+        for name, data, deflate in entries:
+            info = zipfile.ZipInfo(name, (2014, 6, 5, 12, 0, 0))
+            info.compress_type = zipfile.ZIP_DEFLATED if deflate else zipfile.ZIP_STORED
+            info.external_attr = 0o644 << 16
+            jar.writestr(info, data)
+    return buf.getvalue()
+
+
+# --- pack200 -------------------------------------------------------------
+
+SELF_LINKER_OP = 202    # bc_bytecode_limit
+FIRST_LINKER_OP = 178   # getstatic
+NUM_LINKER_OPS = 7      # getstatic .. invokestatic
+INVOKEINIT_OP = SELF_LINKER_OP + 4 * NUM_LINKER_OPS
+CLDC = INVOKEINIT_OP + 3
+ILDC = CLDC + 1
+BC_END_MARKER = 255
+
+
+class Segment(object):
+    """Collects the global constant pool and the bands of one segment."""
+
+    def __init__(self):
+        self.utf8 = set([''])
+        self.ints = set()
+        self.longs = set()
+        self.strings = set()
+        self.classes = set()
+        self.sigs = set()
+        self.descrs = set()
+        self.fields = set()
+        self.methods = set()
+        self.imethods = set()
+
+    # collecting
+
+    def want_class(self, name):
+        self.classes.add(name)
+        self.utf8.add(name)
+
+    def want_sig(self, desc):
+        form, classes = signature_form(desc)
+        self.sigs.add(desc)
+        self.utf8.add(form)
+        for c in classes:
+            self.want_class(c)
+
+    def want_descr(self, name, desc):
+        self.descrs.add((name, desc))
+        self.utf8.add(name)
+        self.want_sig(desc)
+
+    def want(self, key):
+        kind = key[0]
+        if kind == 'Integer':
+            self.ints.add(key[1])
+        elif kind == 'Long':
+            self.longs.add(key[1])
+        elif kind == 'String':
+            self.strings.add(key[1])
+            self.utf8.add(key[1])
+        elif kind == 'Class':
+            self.want_class(key[1])
+        elif kind in ('Field', 'Method', 'IMethod'):
+            {'Field': self.fields, 'Method': self.methods, 'IMethod': self.imethods}[kind].add(
+                key[1:])
+            self.want_class(key[1])
+            self.want_descr(key[2], key[3])
+        else:
+            raise ValueError(key)
+
+    def collect(self, classes, files, extra_utf8):
+        for name, _, _ in files:
+            self.utf8.add(name)
+        self.utf8.update(extra_utf8)
+        for cls in classes:
+            self.want_class(cls.name)
+            self.want_class(cls.super_name)
+            for i in cls.interfaces:
+                self.want_class(i)
+            for f in cls.fields:
+                self.want_descr(f.name, f.desc)
+                if f.constant:
+                    self.want(f.constant)
+            for m in cls.methods:
+                self.want_descr(m.name, m.desc)
+                for e in m.exceptions:
+                    self.want_class(e)
+                if not m.code:
+                    continue
+                for insn in m.code.insns:
+                    for key in constants_of(insn):
+                        self.want(key)
+                for _, _, _, c in m.code.handlers:
+                    if c:
+                        self.want_class(c)
+
+    def freeze(self):
+        self.utf8_list = sorted(self.utf8)
+        assert self.utf8_list[0] == ''
+        self.utf8_ix = dict((s, i) for i, s in enumerate(self.utf8_list))
+        self.int_list = sorted(self.ints)
+        self.long_list = sorted(self.longs)
+        self.string_list = sorted(self.strings)
+        self.class_list = sorted(self.classes)
+        self.sig_list = sorted(self.sigs)
+        self.descr_list = sorted(self.descrs)
+        self.field_list = sorted(self.fields)
+        self.method_list = sorted(self.methods)
+        self.imethod_list = sorted(self.imethods)
+
+        def ix(items):
+            return dict((v, i) for i, v in enumerate(items))
+        self.int_ix = ix(self.int_list)
+        self.long_ix = ix(self.long_list)
+        self.string_ix = ix(self.string_list)
+        self.class_ix = ix(self.class_list)
+        self.sig_ix = ix(self.sig_list)
+        self.descr_ix = ix(self.descr_list)
+        self.field_ix = ix(self.field_list)
+        self.method_ix = ix(self.method_list)
+        self.imethod_ix = ix(self.imethod_list)
+
+    def cp_bands(self):
+        out = bytearray()
+        strings = self.utf8_list
+        prefixes = []
+        suffixes = []
+        chars = []
+        for i, s in enumerate(strings[1:], 1):
+            prev = strings[i - 1]
+            prefix = 0
+            if i >= 2:
+                while prefix < min(len(s), len(prev)) and s[prefix] == prev[prefix]:
+                    prefix += 1
+                prefixes.append(prefix)
+            suffixes.append(len(s) - prefix)
+            chars.extend(ord(c) for c in s[prefix:])
+        out += encode(prefixes, DELTA5)
+        out += encode(suffixes, UNSIGNED5)
+        out += encode(chars, CHAR3)
+        out += encode(self.int_list, UDELTA5)
+        out += encode([(v >> 32) & 0xFFFFFFFF for v in self.long_list], UDELTA5)
+        out += encode([to_int32(v) for v in self.long_list], DELTA5)
+        out += encode([self.utf8_ix[s] for s in self.string_list], UDELTA5)
+        out += encode([self.utf8_ix[c] for c in self.class_list], UDELTA5)
+        forms = [signature_form(s) for s in self.sig_list]
+        out += encode([self.utf8_ix[f] for f, _ in forms], DELTA5)
+        out += encode([self.class_ix[c] for _, cs in forms for c in cs], UDELTA5)
+        out += encode([self.utf8_ix[n] for n, _ in self.descr_list], DELTA5)
+        out += encode([self.sig_ix[d] for _, d in self.descr_list], UDELTA5)
+        for members in (self.field_list, self.method_list, self.imethod_list):
+            out += encode([self.class_ix[m[0]] for m in members], DELTA5)
+            out += encode([self.descr_ix[(m[1], m[2])] for m in members], UDELTA5)
+        return out
+
+    def cp_counts(self):
+        # Utf8, Integer, Float, Long, Double, String, Class, Signature,
+        # NameandType, Fieldref, Methodref, InterfaceMethodref
+        return [len(self.utf8_list), len(self.int_list), 0, len(self.long_list), 0,
+                len(self.string_list), len(self.class_list), len(self.sig_list),
+                len(self.descr_list), len(self.field_list), len(self.method_list),
+                len(self.imethod_list)]
+
+    # member references relative to a class, for the self and super linkers
+
+    def member_subindex(self, key):
+        kind, owner = key[0], key[1]
+        members = self.field_list if kind == 'Field' else self.method_list
+        same = [m for m in members if m[0] == owner]
+        return same.index(key[1:])
+
+    def init_subindex(self, key):
+        inits = [m for m in self.method_list if m[0] == key[1] and m[1] == '<init>']
+        return inits.index(key[1:])
+
+
+class Bands(object):
+    NAMES = ['bc_codes', 'bc_case_count', 'bc_case_value', 'bc_byte', 'bc_short',
+             'bc_local', 'bc_label', 'bc_intref', 'bc_floatref', 'bc_longref',
+             'bc_doubleref', 'bc_stringref', 'bc_classref', 'bc_fieldref', 'bc_methodref',
+             'bc_imethodref', 'bc_thisfield', 'bc_superfield', 'bc_thismethod',
+             'bc_supermethod', 'bc_initref']
+
+    def __init__(self):
+        for name in self.NAMES:
+            setattr(self, name, [])
+
+
+def pack_code(seg, cls, code, bands):
+    """Append the bytecodes of one method to the bc_* bands."""
+    insns = code.insns
+    new_class = None
+    i = 0
+    while i < len(insns):
+        insn = insns[i]
+        name = insn[0]
+        op = OPCODES[name]
+        bii = i
+
+        # aload_0 folds into a following self or super linker op
+        if name == 'aload_0' and i + 1 < len(insns) and insns[i + 1][0] in MEMBERS:
+            nxt = insns[i + 1]
+            owner = nxt[1][1]
+            init = nxt[0] == 'invokespecial' and nxt[1][2] == '<init>'
+            if nxt[0] != 'invokeinterface' and not init and owner in (cls.name,
+                                                                      cls.super_name):
+                link_op(seg, cls, nxt, bands, aload=True)
+                i += 2
+                continue
+
+        if name in MEMBERS:
+            key = insn[1]
+            if name == 'invokespecial' and key[2] == '<init>' and (
+                    key[1] in (cls.name, cls.super_name) or key[1] == new_class):
+                option = 0 if key[1] == cls.name else 1 if key[1] == cls.super_name else 2
+                bands.bc_codes.append(INVOKEINIT_OP + option)
+                bands.bc_initref.append(seg.init_subindex(key))
+            elif name != 'invokeinterface' and key[1] in (cls.name, cls.super_name):
+                link_op(seg, cls, insn, bands, aload=False)
+            else:
+                bands.bc_codes.append(op)
+                if key[0] == 'Field':
+                    bands.bc_fieldref.append(seg.field_ix[key[1:]])
+                elif key[0] == 'Method':
+                    bands.bc_methodref.append(seg.method_ix[key[1:]])
+                else:
+                    bands.bc_imethodref.append(seg.imethod_ix[key[1:]])
+        elif name == 'ldc':
+            key = insn[1]
+            if key[0] == 'String':
+                bands.bc_codes.append(op)
+                bands.bc_stringref.append(seg.string_ix[key[1]])
+            elif key[0] == 'Integer':
+                bands.bc_codes.append(ILDC)
+                bands.bc_intref.append(seg.int_ix[key[1]])
+            else:
+                bands.bc_codes.append(CLDC)
+                bands.bc_classref.append(seg.class_ix[key[1]] + 1)
+        elif name == 'ldc2_w':
+            bands.bc_codes.append(op)
+            bands.bc_longref.append(seg.long_ix[insn[1][1]])
+        elif name in CLASS_OPS:
+            bands.bc_codes.append(op)
+            # zero is a shorthand for the current class
+            ref = 0 if insn[1] == cls.name else seg.class_ix[insn[1]] + 1
+            bands.bc_classref.append(ref)
+            if name == 'new':
+                new_class = insn[1]
+            elif name == 'multianewarray':
+                bands.bc_byte.append(insn[2])
+        elif name in LOCALS:
+            if insn[1] > 255:
+                bands.bc_codes.append(196)
+            bands.bc_codes.append(op)
+            bands.bc_local.append(insn[1])
+        elif name == 'iinc':
+            wide = insn[1] > 255 or not -128 <= insn[2] <= 127
+            if wide:
+                bands.bc_codes.append(196)
+            bands.bc_codes.append(op)
+            bands.bc_local.append(insn[1])
+            # bc_short carries the raw 16 bits of the operand
+            (bands.bc_short if wide else bands.bc_byte).append(insn[2] & 0xFFFF)
+        elif name in BRANCHES:
+            bands.bc_codes.append(op)
+            bands.bc_label.append(code.target(insn[1]) - bii)
+        elif name == 'tableswitch':
+            bands.bc_codes.append(op)
+            bands.bc_case_count.append(len(insn[3]))
+            bands.bc_case_value.append(insn[2])
+            bands.bc_label.append(code.target(insn[1]) - bii)
+            bands.bc_label.extend(code.target(l) - bii for l in insn[3])
+        elif name == 'lookupswitch':
+            bands.bc_codes.append(op)
+            bands.bc_case_count.append(len(insn[2]))
+            bands.bc_label.append(code.target(insn[1]) - bii)
+            for key, label in insn[2]:
+                bands.bc_case_value.append(key)
+                bands.bc_label.append(code.target(label) - bii)
+        elif name in ('bipush', 'newarray'):
+            bands.bc_codes.append(op)
+            bands.bc_byte.append(insn[1])
+        elif name == 'sipush':
+            bands.bc_codes.append(op)
+            bands.bc_short.append(insn[1] & 0xFFFF)
+        else:
+            bands.bc_codes.append(op)
+        i += 1
+    bands.bc_codes.append(BC_END_MARKER)
+
+
+def link_op(seg, cls, insn, bands, aload):
+    key = insn[1]
+    idx = OPCODES[insn[0]] - FIRST_LINKER_OP
+    is_super = key[1] != cls.name
+    op = SELF_LINKER_OP + idx
+    if aload:
+        op += NUM_LINKER_OPS
+    if is_super:
+        op += 2 * NUM_LINKER_OPS
+    bands.bc_codes.append(op)
+    sub = seg.member_subindex(key)
+    if key[0] == 'Field':
+        (bands.bc_superfield if is_super else bands.bc_thisfield).append(sub)
+    else:
+        (bands.bc_supermethod if is_super else bands.bc_thismethod).append(sub)
+
+
+def code_header(m, code):
+    siglen = arg_slots(m.desc) + (0 if m.flags & ACC_STATIC else 1)
+    locals_ = code.max_locals - siglen
+    assert locals_ >= 0
+    stack = code.max_stack
+    handlers = len(code.handlers)
+    if handlers == 0 and stack < 12 and locals_ < 12:
+        return 1 + locals_ * 12 + stack, None
+    if handlers == 1 and stack < 8 and locals_ < 8:
+        return 1 + 12 * 12 + locals_ * 8 + stack, None
+    if handlers == 2 and stack < 7 and locals_ < 7:
+        return 1 + 12 * 12 + 8 * 8 + locals_ * 7 + stack, None
+    return 0, (stack, locals_, handlers)
+
+
+def pack_segment(files, classes, extra_utf8=()):
+    """files: list of (name, bytes or None for a class stub, deflate)"""
+    seg = Segment()
+    seg.collect(classes, files, extra_utf8)
+    seg.freeze()
+
+    class_bands = bytearray()
+    class_bands += encode([seg.class_ix[c.name] for c in classes], DELTA5)
+    class_bands += encode([seg.class_ix[c.super_name] for c in classes], DELTA5)
+    class_bands += encode([len(c.interfaces) for c in classes], DELTA5)
+    class_bands += encode([seg.class_ix[i] for c in classes for i in c.interfaces], DELTA5)
+    class_bands += encode([len(c.fields) for c in classes], DELTA5)
+    class_bands += encode([len(c.methods) for c in classes], DELTA5)
+
+    fields = [f for c in classes for f in c.fields]
+    class_bands += encode([seg.descr_ix[(f.name, f.desc)] for f in fields], DELTA5)
+    class_bands += encode([f.flags | ((1 << FIELD_ATTR_ConstantValue) if f.constant else 0)
+                           for f in fields], UNSIGNED5)
+    kq = []
+    for f in fields:
+        if f.constant:
+            kind, value = f.constant
+            kq.append(seg.int_ix[value] if kind == 'Integer' else seg.string_ix[value])
+    class_bands += encode(kq, UNSIGNED5)
+
+    methods = [(c, m) for c in classes for m in c.methods]
+    class_bands += encode([seg.descr_ix[(m.name, m.desc)] for _, m in methods], MDELTA5)
+    class_bands += encode([m.flags | ((1 << METHOD_ATTR_Code) if m.code else 0) |
+                           ((1 << METHOD_ATTR_Exceptions) if m.exceptions else 0)
+                           for _, m in methods], UNSIGNED5)
+    class_bands += encode([len(m.exceptions) for _, m in methods if m.exceptions], UNSIGNED5)
+    class_bands += encode([seg.class_ix[e] for _, m in methods for e in m.exceptions],
+                          UNSIGNED5)
+
+    class_bands += encode([c.flags | (1 << CLASS_ATTR_SourceFile) for c in classes],
+                          UNSIGNED5)
+    # null asks the unpacker to derive the usual Name.java
+    class_bands += encode([0 if c.source is None else seg.utf8_ix[c.source] + 1
+                           for c in classes], UNSIGNED5)
+
+    codes = [(c, m) for c, m in methods if m.code]
+    headers = [code_header(m, m.code) for _, m in codes]
+    class_bands += encode([h for h, _ in headers], BYTE1)
+    long_headers = [l for _, l in headers if l is not None]
+    class_bands += encode([l[0] for l in long_headers], UNSIGNED5)
+    class_bands += encode([l[1] for l in long_headers], UNSIGNED5)
+    class_bands += encode([l[2] for l in long_headers], UNSIGNED5)
+    starts, ends, catches, types = [], [], [], []
+    for _, m in codes:
+        for start, end, catch, cls in m.code.handlers:
+            s, e, k = m.code.target(start), m.code.target(end), m.code.target(catch)
+            starts.append(s)
+            ends.append(e - s)
+            catches.append(k - e)
+            types.append(seg.class_ix[cls] + 1 if cls else 0)
+    class_bands += encode(starts, BCI5)
+    class_bands += encode(ends, BRANCH5)
+    class_bands += encode(catches, BRANCH5)
+    class_bands += encode(types, UNSIGNED5)
+    # every code has flags, since AO_HAVE_ALL_CODE_FLAGS is set
+    class_bands += encode([(1 << CODE_ATTR_LineNumberTable) if m.code.lines else 0
+                           for _, m in codes], UNSIGNED5)
+    line_counts = [len(m.code.lines) for _, m in codes if m.code.lines]
+    class_bands += encode(line_counts, UNSIGNED5)
+    class_bands += encode([m.code.target(l) for _, m in codes for l, _ in m.code.lines], BCI5)
+    class_bands += encode([n for _, m in codes for _, n in m.code.lines], UNSIGNED5)
+
+    bands = Bands()
+    for c, m in codes:
+        pack_code(seg, c, m.code, bands)
+    code_bands = bytearray(encode(bands.bc_codes, BYTE1))
+    code_bands += encode(bands.bc_case_count, UNSIGNED5)
+    code_bands += encode(bands.bc_case_value, DELTA5)
+    code_bands += encode(bands.bc_byte, BYTE1)
+    code_bands += encode(bands.bc_short, DELTA5)
+    code_bands += encode(bands.bc_local, UNSIGNED5)
+    code_bands += encode(bands.bc_label, BRANCH5)
+    code_bands += encode(bands.bc_intref, DELTA5)
+    code_bands += encode(bands.bc_floatref, DELTA5)
+    code_bands += encode(bands.bc_longref, DELTA5)
+    code_bands += encode(bands.bc_doubleref, DELTA5)
+    code_bands += encode(bands.bc_stringref, DELTA5)
+    code_bands += encode(bands.bc_classref, UNSIGNED5)
+    code_bands += encode(bands.bc_fieldref, DELTA5)
+    code_bands += encode(bands.bc_methodref, UNSIGNED5)
+    code_bands += encode(bands.bc_imethodref, DELTA5)
+    code_bands += encode(bands.bc_thisfield, UNSIGNED5)
+    code_bands += encode(bands.bc_superfield, UNSIGNED5)
+    code_bands += encode(bands.bc_thismethod, UNSIGNED5)
+    code_bands += encode(bands.bc_supermethod, UNSIGNED5)
+    code_bands += encode(bands.bc_initref, UNSIGNED5)
+
+    file_bands = bytearray()
+    file_bands += encode([seg.utf8_ix[n] if data is not None else 0 for n, data, _ in files],
+                         UNSIGNED5)
+    file_bands += encode([len(data) if data is not None else 0 for _, data, _ in files],
+                         UNSIGNED5)
+    file_bands += encode([(FO_DEFLATE_HINT if deflate else 0) |
+                          (FO_IS_CLASS_STUB if data is None else 0)
+                          for _, data, deflate in files], UNSIGNED5)
+    for _, data, _ in files:
+        if data is not None:
+            file_bands += data
+
+    tail = bytearray()
+    tail += header([0, ARCHIVE_MODTIME, len(files)])  # next_count, modtime, file_count
+    tail += header(seg.cp_counts())
+    # ic_count, default class version, class_count
+    tail += header([0, CLASS_MINVER, CLASS_MAJVER, len(classes)])
+    tail += seg.cp_bands()
+    tail += class_bands
+    tail += code_bands
+    tail += file_bands
+
+    options = AO_HAVE_CP_NUMBERS | AO_HAVE_ALL_CODE_FLAGS | AO_HAVE_FILE_HEADERS | \
+        AO_HAVE_FILE_OPTIONS
+    head = bytearray(JAVA_PACKAGE_MAGIC)
+    head += header([JAVA5_PACKAGE_MINOR_VERSION, JAVA5_PACKAGE_MAJOR_VERSION, options])
+    head += header([0, len(tail)])  # archive_size_hi, archive_size_lo
+    return bytes(head + tail)
+
+
+# --- class bodies --------------------------------------------------------
+
+WORDS = ['the', 'item', 'block', 'tile', 'entity', 'render', 'forge', 'mod', 'event',
+         'handler', 'register', 'name', 'texture', 'world', 'player', 'scala', 'collection',
+         'immutable', 'mutable', 'function', 'apply', 'map', 'list', 'seq', 'iterator']
+
+PRINT_STREAM = 'java/io/PrintStream'
+SYSTEM_OUT = ('Field', 'java/lang/System', 'out', 'Ljava/io/PrintStream;')
+LIST_SIZE = ('IMethod', 'java/util/List', 'size', '()I')
+LIST_GET = ('IMethod', 'java/util/List', 'get', '(I)Ljava/lang/Object;')
+BUILDER = 'java/lang/StringBuilder'
+
+
+def text(rng, words, size):
+    out = []
+    n = 0
+    while n < size:
+        w = rng.choice(words)
+        out.append(w)
+        n += len(w) + 1
+    return (' '.join(out)[:size]).encode('ascii')
+
+
+def noise(rng, size):
+    return bytes(rng.getrandbits(8) for _ in range(size))
+
+
+def manifest(extra):
+    lines = ['Manifest-Version: 1.0'] + extra + ['', '']
+    return '\r\n'.join(lines).encode('ascii')
+
+
+class Shaper(object):
+    """Fills classes with members and bytecode, drawn from a seeded rng."""
+
+    def __init__(self, rng):
+        self.rng = rng
+        self.line = 10
+
+    def lines(self, code, *labels):
+        if self.rng.random() < 0.6:
+            for label in labels:
+                code.lines.append((label, self.line))
+                self.line += self.rng.randint(1, 4)
+
+    def constructor(self, cls, count_field, name_field, name):
+        code = Code(2, 1)
+        code.label('start')
+        code.op('aload_0').op('invokespecial', ('Method', cls.super_name, '<init>', '()V'))
+        code.label('fields')
+        code.op('aload_0').op('bipush', self.rng.randint(-100, 100))
+        code.op('putfield', ('Field', cls.name, count_field, 'I'))
+        code.op('aload_0').op('ldc', ('String', name))
+        code.op('putfield', ('Field', cls.name, name_field, 'Ljava/lang/String;'))
+        code.op('return')
+        self.lines(code, 'start', 'fields')
+        return Member(ACC_PUBLIC, '<init>', '()V', code)
+
+    def getter(self, cls, field, desc, ret):
+        code = Code(2 if desc == 'J' else 1, 1)
+        code.label('start')
+        code.op('aload_0').op('getfield', ('Field', cls.name, field, desc)).op(ret)
+        self.lines(code, 'start')
+        name = 'get' + field[0].upper() + field[1:]
+        return Member(ACC_PUBLIC, name, '()' + desc, code)
+
+    def counter(self, cls, count_field):
+        # for (int i = 0; i < n; i++) total += i * count; with a static field
+        code = Code(3, 3)
+        code.op('iconst_0').op('istore_2').op('iconst_0').op('istore', 3)
+        code.op('goto', 'cond')
+        code.label('body')
+        code.op('iload_2').op('iload', 3).op('aload_0')
+        code.op('getfield', ('Field', cls.name, count_field, 'I'))
+        code.op('imul').op('iadd').op('istore_2')
+        code.op('iinc', 3, self.rng.choice([1, 2, 3]))
+        code.label('cond')
+        code.op('iload', 3).op('iload_1').op('if_icmplt', 'body')
+        code.op('iload_2').op('ireturn')
+        code.max_locals = 4
+        self.lines(code, 'body', 'cond')
+        return Member(ACC_PUBLIC, 'sum', '(I)I', code)
+
+    def describe(self, cls):
+        rng = self.rng
+        code = Code(3, 2)
+        cases = rng.randint(3, 7)
+        labels = ['case%d' % i for i in range(cases)]
+        if rng.random() < 0.5:
+            low = rng.randint(-3, 10)
+            code.op('iload_1').op('tableswitch', 'default', low, labels)
+        else:
+            keys = sorted(rng.sample(range(-5000, 5000), cases))
+            code.op('iload_1').op('lookupswitch', 'default', list(zip(keys, labels)))
+        for label in labels:
+            code.label(label)
+            code.op('ldc', ('String', ' '.join(rng.choice(WORDS) for _ in range(3))))
+            code.op('areturn')
+        code.label('default')
+        code.op('new', 'java/lang/IllegalArgumentException').op('dup')
+        code.op('ldc', ('String', 'unknown ' + rng.choice(WORDS)))
+        code.op('invokespecial', ('Method', 'java/lang/IllegalArgumentException', '<init>',
+                                  '(Ljava/lang/String;)V'))
+        code.op('athrow')
+        return Member(ACC_PUBLIC, 'describe', '(I)Ljava/lang/String;', code)
+
+    def caller(self, cls, others):
+        # calls into the other classes of the archive, inside a try/catch
+        rng = self.rng
+        code = Code(4, 3)
+        code.label('try')
+        for other in rng.sample(others, min(len(others), rng.randint(1, 3))):
+            if other.flags & ACC_INTERFACE:
+                continue
+            code.op('new', other.name).op('dup')
+            code.op('invokespecial', ('Method', other.name, '<init>', '()V'))
+            code.op('bipush', rng.randint(1, 60))
+            code.op('invokevirtual', ('Method', other.name, 'sum', '(I)I')).op('pop')
+        code.op('aload_1').op('invokeinterface', LIST_SIZE).op('istore_2')
+        code.op('aload_1').op('iload_2').op('iconst_1').op('isub')
+        code.op('invokeinterface', LIST_GET)
+        code.op('dup').op('instanceof', STRING).op('ifeq', 'skip')
+        code.op('checkcast', STRING).op('astore_2')
+        code.op('getstatic', SYSTEM_OUT).op('aload_2')
+        code.op('invokevirtual', ('Method', PRINT_STREAM, 'println', '(Ljava/lang/String;)V'))
+        code.op('goto', 'done')
+        code.label('skip')
+        code.op('pop')
+        code.label('end')
+        code.op('goto', 'done')
+        code.label('catch')
+        code.op('astore_2').op('aload_2')
+        code.op('invokevirtual', ('Method', 'java/lang/Throwable', 'printStackTrace', '()V'))
+        code.label('done')
+        code.op('return')
+        code.handlers.append(('try', 'end', 'catch', 'java/lang/RuntimeException'))
+        if rng.random() < 0.4:
+            code.handlers.append(('try', 'end', 'catch', None))
+        self.lines(code, 'try', 'skip', 'catch', 'done')
+        exceptions = ['java/io/IOException'] if rng.random() < 0.5 else []
+        return Member(ACC_PUBLIC, 'run', '(Ljava/util/List;)V', code, exceptions=exceptions)
+
+    def arrays(self, cls):
+        rng = self.rng
+        code = Code(4, 3)
+        code.op('bipush', rng.randint(2, 100)).op('newarray', 10).op('astore_1')
+        code.op('aload_1').op('arraylength').op('anewarray', STRING).op('astore_2')
+        code.op('iconst_2').op('iconst_3').op('multianewarray', '[[I', 2).op('pop')
+        code.op('iconst_1').op('anewarray', cls.name).op('pop')
+        code.op('sipush', rng.randint(-30000, 30000)).op('ldc', ('Integer', rng.randint(
+            100000, 1 << 30))).op('iadd').op('i2l')
+        code.op('ldc2_w', ('Long', rng.randint(1 << 33, 1 << 60))).op('ladd')
+        if rng.random() < 0.3:
+            # something with more locals than a short code header can describe
+            code.op('lstore', 300).op('iinc', 300, rng.randint(200, 3000))
+            code.op('lload', 300)
+            code.max_locals = 302
+        code.op('lreturn')
+        return Member(ACC_PUBLIC | ACC_STATIC, 'arrays', '()J', code)
+
+    def to_string(self, cls):
+        code = Code(2, 1)
+        code.op('new', BUILDER).op('dup')
+        code.op('invokespecial', ('Method', BUILDER, '<init>', '()V'))
+        code.op('aload_0')
+        code.op('invokespecial', ('Method', cls.super_name, 'toString', '()Ljava/lang/String;'))
+        code.op('invokevirtual', ('Method', BUILDER, 'append',
+                                  '(Ljava/lang/String;)Ljava/lang/StringBuilder;'))
+        code.op('aload_0').op('invokevirtual', ('Method', cls.name, 'getName',
+                                                '()Ljava/lang/String;'))
+        code.op('invokevirtual', ('Method', BUILDER, 'append',
+                                  '(Ljava/lang/String;)Ljava/lang/StringBuilder;'))
+        code.op('invokevirtual', ('Method', BUILDER, 'toString', '()Ljava/lang/String;'))
+        code.op('areturn')
+        code.max_stack = 3
+        return Member(ACC_PUBLIC, 'toString', '()Ljava/lang/String;', code)
+
+    def static_init(self, cls, counter):
+        code = Code(2, 0)
+        code.op('getstatic', ('Field', cls.name, counter, 'I')).op('iconst_1').op('iadd')
+        code.op('putstatic', ('Field', cls.name, counter, 'I'))
+        code.op('return')
+        return Member(ACC_STATIC, '<clinit>', '()V', code)
+
+    def fill(self, cls, others):
+        rng = self.rng
+        short = cls.name[cls.name.rfind('/') + 1:]
+        cls.fields.append(Member(ACC_PRIVATE, 'count', 'I'))
+        cls.fields.append(Member(ACC_PRIVATE, 'name', 'Ljava/lang/String;'))
+        if rng.random() < 0.5:
+            cls.fields.append(Member(ACC_PUBLIC | ACC_STATIC | ACC_FINAL, 'ID', 'I',
+                                     constant=('Integer', rng.randint(1 << 20, 1 << 30))))
+        if rng.random() < 0.5:
+            cls.fields.append(Member(ACC_PUBLIC | ACC_STATIC | ACC_FINAL, 'KEY',
+                                     'Ljava/lang/String;',
+                                     constant=('String', short.lower() + '.key')))
+        cls.fields.append(Member(ACC_PRIVATE | ACC_STATIC, 'instances', 'I'))
+
+        cls.methods.append(self.constructor(cls, 'count', 'name', short))
+        cls.methods.append(self.getter(cls, 'name', 'Ljava/lang/String;', 'areturn'))
+        cls.methods.append(self.getter(cls, 'count', 'I', 'ireturn'))
+        cls.methods.append(self.counter(cls, 'count'))
+        if rng.random() < 0.7:
+            cls.methods.append(self.describe(cls))
+        if others and rng.random() < 0.6:
+            cls.methods.append(self.caller(cls, others))
+        if rng.random() < 0.5:
+            cls.methods.append(self.arrays(cls))
+        if rng.random() < 0.5:
+            cls.methods.append(self.to_string(cls))
+        cls.methods.append(self.static_init(cls, 'instances'))
+
+    def interface(self, name):
+        cls = Class(name, OBJECT, ACC_PUBLIC | ACC_INTERFACE | ACC_ABSTRACT)
+        for i in range(self.rng.randint(1, 4)):
+            cls.methods.append(Member(ACC_PUBLIC | ACC_ABSTRACT, '%s%d' % (
+                self.rng.choice(WORDS), i), '(Ljava/lang/Object;)V'))
+        return cls
+
+
+def build(rng, names, interfaces=(), sources=None):
+    """Turn class names into classes; '$' classes extend their outer class."""
+    shaper = Shaper(rng)
+    classes = []
+    by_name = {}
+    for name in names:
+        if name in interfaces:
+            cls = shaper.interface(name)
+        else:
+            outer = name[:name.index('$')] if '$' in name else None
+            super_name = outer if outer in by_name and not (
+                by_name[outer].flags & ACC_INTERFACE) else OBJECT
+            impl = [i for i in interfaces if rng.random() < 0.2]
+            cls = Class(name, super_name, interfaces=impl,
+                        source=sources(name) if sources else None)
+        classes.append(cls)
+        by_name[name] = cls
+    concrete = [c for c in classes if not c.flags & ACC_INTERFACE]
+    for cls in concrete:
+        shaper.fill(cls, [c for c in rng.sample(concrete, min(4, len(concrete)))
+                          if c is not cls])
+    return classes
+
+
+def launchwrapper(rng):
+    pkg = 'net/minecraft/launchwrapper/'
+    interfaces = [pkg + n for n in ['IClassTransformer', 'IClassNameTransformer', 'ITweaker']]
+    names = interfaces + [pkg + n for n in ['Launch', 'LaunchClassLoader', 'LogWrapper',
+                                            'VanillaTweaker', 'injector/VanillaTweakInjector',
+                                            'injector/AlphaVanillaTweakInjector',
+                                            'AlphaVanillaTweaker', 'IndevVanillaTweaker']]
+    names += [pkg + 'LaunchClassLoader$%d' % i for i in range(1, 4)]
+    classes = build(rng, names, interfaces)
+    files = [('META-INF/MANIFEST.MF', manifest(['Main-Class: net.minecraft.launchwrapper.Launch']),
+              True)]
+    files += [(None, c) for c in classes]
+    files += [('log4j2.xml', text(rng, WORDS, 1200), True),
+              ('LICENSE.txt', text(rng, WORDS, 1500), True)]
+    return files, classes
+
+
+def scala(rng):
+    pkgs = ['scala/', 'scala/collection/', 'scala/collection/immutable/',
+            'scala/collection/mutable/', 'scala/collection/generic/', 'scala/runtime/',
+            'scala/util/', 'scala/math/', 'scala/concurrent/', 'scala/reflect/']
+    bases = ['List', 'Vector', 'HashMap', 'TreeSet', 'Stream', 'Range', 'Option', 'Function',
+             'Tuple', 'Product', 'Ordering', 'Numeric', 'Builder', 'Iterator', 'Seq']
+    names = []
+    interfaces = []
+    for p in pkgs:
+        for b in bases:
+            for n in range(rng.randint(1, 3)):
+                base = '%s%s%d' % (p, b, n)
+                names.append(base)
+                if rng.random() < 0.3:
+                    interfaces.append(base + '$class')
+                    names.append(base + '$class')
+                for k in range(rng.randint(0, 3)):
+                    names.append('%s$$anonfun$%s$%d' % (base, rng.choice(WORDS), k + 1))
+
+    def source(name):
+        # scalac names the source, so the unpacker can't derive it
+        return source_file_for(name)[:-len('.java')] + '.scala'
+    classes = build(rng, names, interfaces, source)
+    files = [('META-INF/MANIFEST.MF', manifest(['Bundle-Name: Scala Standard Library']), True),
+             ('library.properties', text(rng, WORDS, 200), False)]
+    # scala ships a few pre-compiled signature blobs as resources
+    for i in range(40):
+        files.append(('scala/reflect/sig/Sig%d.bin' % i, noise(rng, rng.randint(200, 4000)),
+                      False))
+    # the first half of the classes keep their place in the jar through stubs,
+    # the rest are appended after the listed files
+    half = len(classes) // 2
+    files = files[:1] + [(None, c) for c in classes[:half]] + files[1:]
+    return files, classes
+
+
+def forge(rng):
+    pkgs = ['cpw/mods/fml/common/', 'cpw/mods/fml/common/event/', 'cpw/mods/fml/relauncher/',
+            'cpw/mods/fml/client/', 'net/minecraftforge/common/', 'net/minecraftforge/event/',
+            'net/minecraftforge/client/', 'net/minecraftforge/fluids/',
+            'net/minecraftforge/oredict/']
+    names = []
+    interfaces = []
+    for p in pkgs:
+        interfaces.append(p + 'I' + rng.choice(WORDS).capitalize() + 'Handler')
+        names.append(interfaces[-1])
+        for n in range(rng.randint(10, 30)):
+            name = '%s%s%s%d' % (p, rng.choice(WORDS).capitalize(),
+                                 rng.choice(WORDS).capitalize(), n)
+            names.append(name)
+            for k in range(rng.randint(0, 2)):
+                names.append('%s$%d' % (name, k + 1))
+    classes = build(rng, names, interfaces)
+    files = [('META-INF/MANIFEST.MF',
+              manifest(['FMLCorePlugin: cpw.mods.fml.relauncher.FMLCorePlugin',
+                        'TweakClass: cpw.mods.fml.common.launcher.FMLTweaker']), True)]
+    files += [(None, c) for c in classes]
+    files += [('fml_at.cfg', text(rng, WORDS, 9000), True),
+              ('forge_at.cfg', text(rng, WORDS, 6000), True),
+              ('deobfuscation_data-1.7.10.lzma', noise(rng, 120000), False),
+              ('binpatches.pack.lzma', noise(rng, 90000), False)]
+    for lang in ['en_US', 'de_DE', 'fr_FR', 'es_ES', 'ru_RU', 'zh_CN']:
+        files.append(('assets/forge/lang/%s.lang' % lang, text(rng, WORDS, 3000), True))
+    for i in range(30):
+        files.append(('assets/fml/textures/gui/icon%d.png' % i,
+                      noise(rng, rng.randint(300, 3000)), False))
+    return files, classes
+
+
+SHAPES = [
+    ('launchwrapper-1.12', launchwrapper),
+    ('scala-library-2.10.2', scala),
+    ('forge-1.7.10-universal', forge),
+]
+
+
+def write_archive(outdir, name, files, classes):
+    """files: list of (name, data, deflate) resources and (None, class) stubs"""
+    stubbed = [f[1] for f in files if f[0] is None]
+    # the unpacker hands out classes in order: first to the stubs, then to
+    # the classes that come after the file list
+    ordered = stubbed + [c for c in classes if c not in stubbed]
+
+    pack_files = []
+    jar = []
+    for entry in files:
+        if entry[0] is None:
+            pack_files.append(('', None, True))
+            jar.append((entry[1].name + '.class', class_file(entry[1]), True))
+        else:
+            pack_files.append(entry)
+            jar.append(entry)
+    for cls in ordered[len(stubbed):]:
+        jar.append((cls.name + '.class', class_file(cls), False))
+
+    sources = [c.source for c in ordered if c.source is not None]
+    pack = pack_segment(pack_files, ordered, sources)
+    xz = lzma.compress(pack, format=lzma.FORMAT_XZ, check=lzma.CHECK_CRC64)
+    path = os.path.join(outdir, name + '.jar.pack.xz')
+    with open(path, 'wb') as f:
+        f.write(xz)
+    golden = os.path.join(outdir, name + '.jar')
+    with open(golden, 'wb') as f:
+        f.write(golden_jar(jar))
+    methods = sum(len(c.methods) for c in classes)
+    print('%s: %d files, %d classes, %d methods, %d bytes packed, %d bytes xz' %
+          (path, len(jar), len(classes), methods, len(pack), len(xz)))
+
+
+def main():
+    outdir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), 'corpus')
+    if not os.path.isdir(outdir):
+        os.makedirs(outdir)
+    for name, shape in SHAPES:
+        rng = random.Random(name)
+        files, classes = shape(rng)
+        write_archive(outdir, name, files, classes)
+
+
+if __name__ == '__main__':
+    main()
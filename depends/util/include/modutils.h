@@ -53,6 +53,31 @@ private:
 	QList<Section> m_sections;
 
 	void parse();
+	/// negative, zero or positive like strcmp. missing sections count as 0.
+	int compare(const Version &other) const;
+};
+
+/**
+ * A version interval in maven notation, like "[1.6,1.7)", or a single version.
+ * Parsing the interval is the expensive part, so it's done once here and then checked
+ * against as many versions as needed.
+ */
+class LIBUTIL_EXPORT VersionInterval
+{
+public:
+	explicit VersionInterval(const QString &interval = QString());
+
+	bool contains(const Version &version) const;
+
+private:
+	QString m_string;
+	bool m_valid = false;
+	bool m_bottomInclusive = false;
+	bool m_topInclusive = false;
+	bool m_hasBottom = false;
+	bool m_hasTop = false;
+	Version m_bottom;
+	Version m_top;
 };
 
 LIBUTIL_EXPORT bool versionIsInInterval(const QString &version, const QString &interval);
@@ -12,63 +12,43 @@ Util::Version::Version(const QString &str) : m_string(str)
 
 bool Util::Version::operator<(const Version &other) const
 {
-	const int size = qMax(m_sections.size(), other.m_sections.size());
-	for (int i = 0; i < size; ++i)
-	{
-		const Section sec1 = (i >= m_sections.size()) ? Section("0", 0) : m_sections.at(i);
-		const Section sec2 =
-			(i >= other.m_sections.size()) ? Section("0", 0) : other.m_sections.at(i);
-		if (sec1 != sec2)
-		{
-			return sec1 < sec2;
-		}
-	}
-
-	return false;
+	return compare(other) < 0;
 }
 bool Util::Version::operator<=(const Util::Version &other) const
 {
-	return *this < other || *this == other;
+	return compare(other) <= 0;
 }
 bool Util::Version::operator>(const Version &other) const
 {
-	const int size = qMax(m_sections.size(), other.m_sections.size());
-	for (int i = 0; i < size; ++i)
-	{
-		const Section sec1 = (i >= m_sections.size()) ? Section("0", 0) : m_sections.at(i);
-		const Section sec2 =
-			(i >= other.m_sections.size()) ? Section("0", 0) : other.m_sections.at(i);
-		if (sec1 != sec2)
-		{
-			return sec1 > sec2;
-		}
-	}
-
-	return false;
+	return compare(other) > 0;
 }
 bool Util::Version::operator>=(const Version &other) const
 {
-	return *this > other || *this == other;
+	return compare(other) >= 0;
 }
 bool Util::Version::operator==(const Version &other) const
 {
+	return compare(other) == 0;
+}
+bool Util::Version::operator!=(const Version &other) const
+{
+	return compare(other) != 0;
+}
+
+int Util::Version::compare(const Version &other) const
+{
+	static const Section zero("0", 0);
 	const int size = qMax(m_sections.size(), other.m_sections.size());
 	for (int i = 0; i < size; ++i)
 	{
-		const Section sec1 = (i >= m_sections.size()) ? Section("0", 0) : m_sections.at(i);
-		const Section sec2 =
-			(i >= other.m_sections.size()) ? Section("0", 0) : other.m_sections.at(i);
+		const Section &sec1 = (i >= m_sections.size()) ? zero : m_sections.at(i);
+		const Section &sec2 = (i >= other.m_sections.size()) ? zero : other.m_sections.at(i);
 		if (sec1 != sec2)
 		{
-			return false;
+			return sec1 < sec2 ? -1 : 1;
 		}
 	}
-
-	return true;
-}
-bool Util::Version::operator!=(const Version &other) const
-{
-	return !operator==(other);
+	return 0;
 }
 
 void Util::Version::parse()
@@ -98,53 +78,74 @@ bool Util::versionIsInInterval(const QString &version, const QString &interval)
 }
 bool Util::versionIsInInterval(const Version &version, const QString &interval)
 {
-	if (interval.isEmpty() || version.toString() == interval)
+	return VersionInterval(interval).contains(version);
+}
+
+Util::VersionInterval::VersionInterval(const QString &interval) : m_string(interval)
+{
+	if (interval.isEmpty())
 	{
-		return true;
+		return;
 	}
 
 	// Interval notation is used
 	QRegularExpression exp(
 		"(?<start>[\\[\\]\\(\\)])(?<bottom>.*?)(,(?<top>.*?))?(?<end>[\\[\\]\\(\\)]),?");
 	QRegularExpressionMatch match = exp.match(interval);
-	if (match.hasMatch())
+	if (!match.hasMatch())
+	{
+		return;
+	}
+	m_valid = true;
+	const QChar start = match.captured("start").at(0);
+	const QChar end = match.captured("end").at(0);
+	const QString bottom = match.captured("bottom");
+	const QString top = match.captured("top");
+
+	// a bound with the bracket the wrong way around isn't checked
+	if (!bottom.isEmpty() && (start == '[' || start == '('))
+	{
+		m_hasBottom = true;
+		m_bottomInclusive = start == '[';
+		m_bottom = Version(bottom);
+	}
+	if (!top.isEmpty() && (end == ']' || end == ')'))
+	{
+		m_hasTop = true;
+		m_topInclusive = end == ']';
+		m_top = Version(top);
+	}
+}
+
+bool Util::VersionInterval::contains(const Version &version) const
+{
+	if (m_string.isEmpty() || version.toString() == m_string)
+	{
+		return true;
+	}
+	if (!m_valid)
 	{
-		const QChar start = match.captured("start").at(0);
-		const QChar end = match.captured("end").at(0);
-		const QString bottom = match.captured("bottom");
-		const QString top = match.captured("top");
+		return false;
+	}
 
-		// check if in range (bottom)
-		if (!bottom.isEmpty())
+	// check if in range (bottom)
+	if (m_hasBottom)
+	{
+		if (m_bottomInclusive ? !(version >= m_bottom) : !(version > m_bottom))
 		{
-			const auto bottomVersion = Util::Version(bottom);
-			if ((start == '[') && !(version >= bottomVersion))
-			{
-				return false;
-			}
-			else if ((start == '(') && !(version > bottomVersion))
-			{
-				return false;
-			}
+			return false;
 		}
+	}
 
-		// check if in range (top)
-		if (!top.isEmpty())
+	// check if in range (top)
+	if (m_hasTop)
+	{
+		if (m_topInclusive ? !(version <= m_top) : !(version < m_top))
 		{
-			const auto topVersion = Util::Version(top);
-			if ((end == ']') && !(version <= topVersion))
-			{
-				return false;
-			}
-			else if ((end == ')') && !(version < topVersion))
-			{
-				return false;
-			}
+			return false;
 		}
-
-		return true;
 	}
 
-	return false;
+	return true;
 }
 
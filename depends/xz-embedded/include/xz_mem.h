@@ -0,0 +1,118 @@
+/*
+ * Whole-buffer XZ decoding helpers
+ *
+ * These wrap xz_dec_run() for the common case of having the complete .xz
+ * file in memory. When the Index tells us how big the uncompressed data is,
+ * the stream can be decoded in single-call mode straight into the caller's
+ * buffer, which avoids allocating the LZMA2 dictionary and copying every
+ * byte from the dictionary to the output. Otherwise, the multi-call decoder
+ * is driven with a large caller-owned output buffer, so the consumer sees a
+ * few big chunks instead of many small ones.
+ *
+ * This file has been put into the public domain.
+ * You can do whatever you want with this file.
+ */
+
+#ifndef XZ_MEM_H
+#define XZ_MEM_H
+
+#include "xz.h"
+
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * struct xz_mem_stats - What a whole-buffer decode did
+ * @in_size:        Number of compressed bytes consumed
+ * @out_size:       Number of uncompressed bytes produced
+ * @single_call:    True if the stream was decoded in single-call mode
+ * @unsupported_check: True if the integrity check type isn't supported,
+ *                  so the data wasn't verified. Only happens in multi-call
+ *                  mode, and only if XZ_DEC_ANY_CHECK was defined.
+ *
+ * The helpers don't measure time; callers that report throughput time the
+ * call themselves and divide out_size by it.
+ */
+struct xz_mem_stats
+{
+	uint64_t in_size;
+	uint64_t out_size;
+	bool single_call;
+	bool unsupported_check;
+};
+
+/**
+ * xz_mem_uncompressed_size() - Read the uncompressed size from the Index
+ * @in:         The complete .xz file
+ * @in_size:    Size of the .xz file
+ * @size:       Set to the uncompressed size on success
+ *
+ * This only looks at the Stream Header, Stream Footer and Index, and doesn't
+ * decompress anything. It succeeds only for a file holding exactly one
+ * stream (optionally followed by Stream Padding) whose Index is intact;
+ * for anything else, the caller should fall back to multi-call decoding.
+ *
+ * xz_crc32_init() must have been called before this.
+ */
+XZ_EXTERN bool xz_mem_uncompressed_size(const uint8_t *in, size_t in_size, uint64_t *size);
+
+/**
+ * xz_mem_decode_single() - Decode a whole .xz file in single-call mode
+ * @in:         The complete .xz file
+ * @in_size:    Size of the .xz file
+ * @out:        Output buffer, owned by the caller
+ * @out_size:   Size of the output buffer. Must be at least the uncompressed
+ *              size, see xz_mem_uncompressed_size().
+ * @stats:      Filled in on success. May be NULL.
+ *
+ * Returns XZ_STREAM_END on success. XZ_UNSUPPORTED_CHECK means the stream
+ * can only be decoded in multi-call mode; nothing has been decoded then.
+ */
+XZ_EXTERN enum xz_ret xz_mem_decode_single(const uint8_t *in, size_t in_size, uint8_t *out,
+										   size_t out_size, struct xz_mem_stats *stats);
+
+/**
+ * xz_mem_flush_fn - Consumer of decoded data in multi-call mode
+ * @ctx:        The context pointer passed to xz_mem_decode_multi()
+ * @data:       Decoded data
+ * @size:       Number of bytes in data
+ *
+ * Return false to stop decoding, e.g. on a write error.
+ */
+typedef bool (*xz_mem_flush_fn)(void *ctx, const uint8_t *data, size_t size);
+
+/**
+ * xz_mem_decode_multi() - Decode a whole .xz file in multi-call mode
+ * @in:         The complete .xz file
+ * @in_size:    Size of the .xz file
+ * @buf:        Output buffer, owned by the caller. Bigger is better,
+ *              a few MiB make the per-flush overhead negligible.
+ * @buf_size:   Size of the output buffer
+ * @dict_max:   Maximum LZMA2 dictionary size, as for xz_dec_init()
+ * @flush:      Called every time the buffer fills up, and once at the end
+ * @ctx:        Passed to flush
+ * @stats:      Filled in on success. May be NULL.
+ *
+ * Returns XZ_STREAM_END on success. If @flush returns false, decoding stops
+ * and XZ_BUF_ERROR is returned.
+ */
+XZ_EXTERN enum xz_ret xz_mem_decode_multi(const uint8_t *in, size_t in_size, uint8_t *buf,
+										  size_t buf_size, uint32_t dict_max,
+										  xz_mem_flush_fn flush, void *ctx,
+										  struct xz_mem_stats *stats);
+
+/**
+ * xz_mem_strerror() - Describe a decoder return code
+ */
+XZ_EXTERN const char *xz_mem_strerror(enum xz_ret ret);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * Whole-buffer XZ decoding helpers
+ *
+ * This file has been put into the public domain.
+ * You can do whatever you want with this file.
+ */
+
+#include "xz_private.h"
+#include "xz_stream.h"
+#include "xz_mem.h"
+
+/* Decode a variable-length integer, returns false on a bad or truncated one */
+static bool mem_vli(const uint8_t *in, size_t in_size, size_t *pos, uint64_t *value)
+{
+	uint32_t i;
+	*value = 0;
+	for (i = 0; i < VLI_BYTES_MAX; ++i)
+	{
+		uint8_t byte;
+		if (*pos >= in_size)
+			return false;
+		byte = in[(*pos)++];
+		*value |= (uint64_t)(byte & 0x7F) << (i * 7);
+		if ((byte & 0x80) == 0)
+		{
+			/* Don't allow non-minimal encodings */
+			return byte != 0 || i == 0;
+		}
+	}
+	return false;
+}
+
+XZ_EXTERN bool xz_mem_uncompressed_size(const uint8_t *in, size_t in_size, uint64_t *size)
+{
+	const uint8_t *footer;
+	size_t index_size;
+	size_t index_pos;
+	size_t pos;
+	uint64_t records;
+	uint64_t blocks_size = 0;
+	uint64_t total = 0;
+
+	/* Strip Stream Padding, which comes in multiples of four null bytes */
+	while (in_size >= STREAM_HEADER_SIZE * 2 && get_le32(in + in_size - 4) == 0)
+		in_size -= 4;
+
+	if (in_size < STREAM_HEADER_SIZE * 2)
+		return false;
+
+	if (!memeq(in, HEADER_MAGIC, HEADER_MAGIC_SIZE))
+		return false;
+
+	footer = in + in_size - STREAM_HEADER_SIZE;
+	if (!memeq(footer + 10, FOOTER_MAGIC, FOOTER_MAGIC_SIZE))
+		return false;
+
+	if (xz_crc32(footer + 4, 6, 0) != get_le32(footer))
+		return false;
+
+	/* Stream Flags in the header and the footer have to agree */
+	if (!memeq(in + HEADER_MAGIC_SIZE, footer + 8, 2))
+		return false;
+
+	/* Backward Size is stored as (real size / 4) - 1 */
+	index_size = ((size_t)get_le32(footer + 4) + 1) * 4;
+	if (index_size > in_size - STREAM_HEADER_SIZE * 2)
+		return false;
+
+	index_pos = in_size - STREAM_HEADER_SIZE - index_size;
+	if (xz_crc32(in + index_pos, index_size - 4, 0) != get_le32(in + in_size - STREAM_HEADER_SIZE - 4))
+		return false;
+
+	/* Index Indicator */
+	pos = index_pos;
+	if (in[pos++] != 0x00)
+		return false;
+
+	if (!mem_vli(in, in_size, &pos, &records))
+		return false;
+
+	while (records-- > 0)
+	{
+		uint64_t unpadded;
+		uint64_t uncompressed;
+		if (!mem_vli(in, index_pos + index_size - 4, &pos, &unpadded))
+			return false;
+		if (!mem_vli(in, index_pos + index_size - 4, &pos, &uncompressed))
+			return false;
+		blocks_size += (unpadded + 3) & ~(uint64_t)3;
+		total += uncompressed;
+		if (total < uncompressed || total > VLI_MAX)
+			return false;
+	}
+
+	/* Index Padding */
+	while (pos & 3)
+	{
+		if (pos >= index_pos + index_size - 4 || in[pos++] != 0x00)
+			return false;
+	}
+	if (pos != index_pos + index_size - 4)
+		return false;
+
+	/* The Blocks have to fill the space between the Stream Header and the Index exactly */
+	if (blocks_size != index_pos - STREAM_HEADER_SIZE)
+		return false;
+
+	*size = total;
+	return true;
+}
+
+XZ_EXTERN enum xz_ret xz_mem_decode_single(const uint8_t *in, size_t in_size, uint8_t *out,
+										   size_t out_size, struct xz_mem_stats *stats)
+{
+	struct xz_buf b;
+	struct xz_dec *s;
+	enum xz_ret ret;
+
+	s = xz_dec_init(XZ_SINGLE, 0);
+	if (s == NULL)
+		return XZ_MEM_ERROR;
+
+	b.in = in;
+	b.in_pos = 0;
+	b.in_size = in_size;
+	b.out = out;
+	b.out_pos = 0;
+	b.out_size = out_size;
+
+	ret = xz_dec_run(s, &b);
+	xz_dec_end(s);
+
+	if (ret == XZ_STREAM_END && stats != NULL)
+	{
+		stats->in_size = b.in_pos;
+		stats->out_size = b.out_pos;
+		stats->single_call = true;
+		stats->unsupported_check = false;
+	}
+	return ret;
+}
+
+XZ_EXTERN enum xz_ret xz_mem_decode_multi(const uint8_t *in, size_t in_size, uint8_t *buf,
+										  size_t buf_size, uint32_t dict_max,
+										  xz_mem_flush_fn flush, void *ctx,
+										  struct xz_mem_stats *stats)
+{
+	struct xz_buf b;
+	struct xz_dec *s;
+	enum xz_ret ret;
+	uint64_t out_total = 0;
+	bool unsupported_check = false;
+
+	s = xz_dec_init(XZ_DYNALLOC, dict_max);
+	if (s == NULL)
+		return XZ_MEM_ERROR;
+
+	b.in = in;
+	b.in_pos = 0;
+	b.in_size = in_size;
+	b.out = buf;
+	b.out_pos = 0;
+	b.out_size = buf_size;
+
+	while (true)
+	{
+		ret = xz_dec_run(s, &b);
+
+		if (b.out_pos == b.out_size || (ret != XZ_OK && ret != XZ_UNSUPPORTED_CHECK))
+		{
+			if (b.out_pos > 0 && !flush(ctx, buf, b.out_pos))
+			{
+				ret = XZ_BUF_ERROR;
+				break;
+			}
+			out_total += b.out_pos;
+			b.out_pos = 0;
+		}
+
+		/* an unsupported check only means we can't verify the data */
+		if (ret == XZ_UNSUPPORTED_CHECK)
+			unsupported_check = true;
+		else if (ret != XZ_OK)
+			break;
+	}
+	xz_dec_end(s);
+
+	if (ret == XZ_STREAM_END && stats != NULL)
+	{
+		stats->in_size = b.in_pos;
+		stats->out_size = out_total;
+		stats->single_call = false;
+		stats->unsupported_check = unsupported_check;
+	}
+	return ret;
+}
+
+XZ_EXTERN const char *xz_mem_strerror(enum xz_ret ret)
+{
+	switch (ret)
+	{
+	case XZ_OK:
+	case XZ_STREAM_END:
+		return "Success";
+	case XZ_UNSUPPORTED_CHECK:
+		return "Unsupported check";
+	case XZ_MEM_ERROR:
+		return "Memory allocation failed";
+	case XZ_MEMLIMIT_ERROR:
+		return "Memory usage limit reached";
+	case XZ_FORMAT_ERROR:
+		return "Not a .xz file";
+	case XZ_OPTIONS_ERROR:
+		return "Unsupported options in the .xz headers";
+	case XZ_DATA_ERROR:
+	case XZ_BUF_ERROR:
+		return "File is corrupt";
+	default:
+		return "Bug!";
+	}
+}
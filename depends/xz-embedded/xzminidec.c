@@ -9,24 +9,63 @@
 
 /*
  * This is really limited: Not all filters from .xz format are supported,
- * only CRC32 is supported as the integrity check, and decoding of
- * concatenated .xz streams is not supported. Thus, you may want to look
- * at xzdec from XZ Utils if a few KiB bigger tool is not a problem.
+ * and decoding of concatenated .xz streams is not supported. Thus, you may
+ * want to look at xzdec from XZ Utils if a few KiB bigger tool is not a
+ * problem.
+ *
+ * The whole input is read into memory first. If the Index tells us the
+ * uncompressed size, the stream is decoded in a single call straight into
+ * the output buffer, otherwise in multi-call mode through a 1 MiB buffer.
  */
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "xz.h"
+#include "xz_mem.h"
+
+#define OUT_CHUNK_SIZE (1 << 20)
 
-static uint8_t in[BUFSIZ];
-static uint8_t out[BUFSIZ];
+static bool write_stdout(void *ctx, const uint8_t *data, size_t size)
+{
+	bool *write_failed = ctx;
+	*write_failed = fwrite(data, 1, size, stdout) != size;
+	return !*write_failed;
+}
+
+static uint8_t *read_stdin(size_t *size)
+{
+	size_t allocated = 1 << 16;
+	uint8_t *buf = malloc(allocated);
+	*size = 0;
+	while (buf != NULL)
+	{
+		size_t got = fread(buf + *size, 1, allocated - *size, stdin);
+		*size += got;
+		if (got == 0)
+			return ferror(stdin) ? (free(buf), NULL) : buf;
+		if (*size == allocated)
+		{
+			uint8_t *bigger = realloc(buf, allocated * 2);
+			if (bigger == NULL)
+				free(buf);
+			buf = bigger;
+			allocated *= 2;
+		}
+	}
+	return NULL;
+}
 
 int main(int argc, char **argv)
 {
-	struct xz_buf b;
-	struct xz_dec *s;
-	enum xz_ret ret;
+	uint8_t *in;
+	uint8_t *out = NULL;
+	size_t in_size;
+	uint64_t out_size;
+	enum xz_ret ret = XZ_UNSUPPORTED_CHECK;
+	struct xz_mem_stats stats;
+	bool write_failed = false;
 	const char *msg;
 
 	if (argc >= 2 && strcmp(argv[1], "--help") == 0)
@@ -42,103 +81,86 @@ int main(int argc, char **argv)
 	xz_crc64_init();
 #endif
 
-	/*
-	 * Support up to 64 MiB dictionary. The actually needed memory
-	 * is allocated once the headers have been parsed.
-	 */
-	s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-	if (s == NULL)
+	in = read_stdin(&in_size);
+	if (in == NULL)
 	{
-		msg = "Memory allocation failed\n";
+		msg = "Read error\n";
 		goto error;
 	}
 
-	b.in = in;
-	b.in_pos = 0;
-	b.in_size = 0;
-	b.out = out;
-	b.out_pos = 0;
-	b.out_size = BUFSIZ;
-
-	while (true)
+	if (xz_mem_uncompressed_size(in, in_size, &out_size) && out_size == (size_t)out_size)
 	{
-		if (b.in_pos == b.in_size)
-		{
-			b.in_size = fread(in, 1, sizeof(in), stdin);
-			b.in_pos = 0;
-		}
-
-		ret = xz_dec_run(s, &b);
-
-		if (b.out_pos == sizeof(out))
+		out = malloc(out_size ? (size_t)out_size : 1);
+		if (out != NULL)
 		{
-			if (fwrite(out, 1, b.out_pos, stdout) != b.out_pos)
+			ret = xz_mem_decode_single(in, in_size, out, (size_t)out_size, &stats);
+			if (ret == XZ_STREAM_END && !write_stdout(&write_failed, out, (size_t)stats.out_size))
 			{
 				msg = "Write error\n";
 				goto error;
 			}
-
-			b.out_pos = 0;
-		}
-
-		if (ret == XZ_OK)
-			continue;
-
-#ifdef XZ_DEC_ANY_CHECK
-		if (ret == XZ_UNSUPPORTED_CHECK)
-		{
-			fputs(argv[0], stderr);
-			fputs(": ", stderr);
-			fputs("Unsupported check; not verifying "
-				  "file integrity\n",
-				  stderr);
-			continue;
-		}
-#endif
-
-		if (fwrite(out, 1, b.out_pos, stdout) != b.out_pos || fclose(stdout))
-		{
-			msg = "Write error\n";
-			goto error;
 		}
+	}
 
-		switch (ret)
+	/*
+	 * Fall back to multi-call mode when the size is unknown, the buffer
+	 * can't be allocated or the check type needs it.
+	 * Support up to 64 MiB dictionary. The actually needed memory
+	 * is allocated once the headers have been parsed.
+	 */
+	if (ret == XZ_UNSUPPORTED_CHECK)
+	{
+		free(out);
+		out = malloc(OUT_CHUNK_SIZE);
+		if (out == NULL)
 		{
-		case XZ_STREAM_END:
-			xz_dec_end(s);
-			return 0;
-
-		case XZ_MEM_ERROR:
 			msg = "Memory allocation failed\n";
 			goto error;
+		}
+		ret = xz_mem_decode_multi(in, in_size, out, OUT_CHUNK_SIZE, 1 << 26, write_stdout,
+								  &write_failed, &stats);
+	}
 
-		case XZ_MEMLIMIT_ERROR:
-			msg = "Memory usage limit reached\n";
-			goto error;
-
-		case XZ_FORMAT_ERROR:
-			msg = "Not a .xz file\n";
-			goto error;
+#ifdef XZ_DEC_ANY_CHECK
+	if (ret == XZ_STREAM_END && stats.unsupported_check)
+	{
+		fputs(argv[0], stderr);
+		fputs(": ", stderr);
+		fputs("Unsupported check; not verifying "
+			  "file integrity\n",
+			  stderr);
+	}
+#endif
 
-		case XZ_OPTIONS_ERROR:
-			msg = "Unsupported options in the .xz headers\n";
-			goto error;
+	if (write_failed)
+	{
+		msg = "Write error\n";
+		goto error;
+	}
 
-		case XZ_DATA_ERROR:
-		case XZ_BUF_ERROR:
-			msg = "File is corrupt\n";
-			goto error;
+	if (ret != XZ_STREAM_END)
+	{
+		msg = xz_mem_strerror(ret);
+		goto error;
+	}
 
-		default:
-			msg = "Bug!\n";
-			goto error;
-		}
+	if (fclose(stdout))
+	{
+		msg = "Write error\n";
+		goto error;
 	}
 
+	free(in);
+	free(out);
+	return 0;
+
 error:
-	xz_dec_end(s);
+	free(in);
+	free(out);
 	fputs(argv[0], stderr);
 	fputs(": ", stderr);
 	fputs(msg, stderr);
+	if (msg[strlen(msg) - 1] != '\n')
+		fputs("\n", stderr);
 	return 1;
 }
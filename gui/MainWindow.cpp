@@ -36,6 +36,7 @@
 #include <QWidgetAction>
 #include <QProgressDialog>
 #include <QShortcut>
+#include <QFileDialog>
 
 #include "osutils.h"
 #include "userutils.h"
@@ -75,6 +76,8 @@
 #include "logic/InstanceList.h"
 #include "logic/minecraft/MinecraftVersionList.h"
 #include "logic/LwjglVersionList.h"
+#include "logic/forge/ForgeVersionList.h"
+#include "logic/liteloader/LiteLoaderVersionList.h"
 #include "logic/icons/IconList.h"
 #include "logic/java/JavaVersionList.h"
 
@@ -95,6 +98,11 @@
 #include "logic/InstanceFactory.h"
 #include "logic/MinecraftProcess.h"
 #include "logic/OneSixUpdate.h"
+#include "logic/BatchUpdate.h"
+#include "logic/InstanceCopyTask.h"
+#include "logic/InstanceExportTask.h"
+#include "logic/InstanceImportTask.h"
+#include "logic/Prefetcher.h"
 #include "logic/java/JavaUtils.h"
 #include "logic/NagUtils.h"
 #include "logic/SkinUtils.h"
@@ -219,7 +227,9 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
 	// model reset -> selection is invalid. All the instance pointers are wrong.
 	// FIXME: stop using POINTERS everywhere
-	connect(MMC->instances().get(), SIGNAL(dataIsInvalid()), SLOT(selectionBad()));
+	connect(MMC->instances().get(), SIGNAL(dataIsInvalid()), SLOT(instancesReloaded()));
+	// instances show up while they are loaded, select the last one as soon as it is there
+	connect(proxymodel, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(instancesAdded()));
 
 	m_statusLeft = new QLabel(tr("No instance selected"), this);
 	m_statusRight = new ServerStatus(this);
@@ -310,10 +320,18 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 			m_versionLoadTask = MMC->minecraftlist()->getLoadTask();
 			startTask(m_versionLoadTask);
 		}
-		if (!MMC->lwjgllist()->isLoaded())
+		// lists restored from the last run are checked against the servers, that's cheap
+		MMC->lwjgllist()->loadList();
+		if (MMC->forgelist()->isLoaded())
 		{
-			MMC->lwjgllist()->loadList();
+			startTask(MMC->forgelist()->getLoadTask());
 		}
+		if (MMC->liteloaderlist()->isLoaded())
+		{
+			startTask(MMC->liteloaderlist()->getLoadTask());
+		}
+		// fill the caches for the instances once things calm down
+		MMC->prefetcher()->schedule();
 
 		MMC->newsChecker()->reloadNews();
 		updateNewsLabel();
@@ -826,40 +844,74 @@ void MainWindow::on_actionCopyInstance_triggered()
 	QString instDirName = DirNameFromString(copyInstDlg.instName(), instancesDir);
 	QString instDir = PathCombine(instancesDir, instDirName);
 
-	auto &loader = InstanceFactory::get();
-
-	InstancePtr newInstance;
-	auto error = loader.copyInstance(newInstance, m_selectedInstance, instDir);
-
-	QString errorMsg = tr("Failed to create instance %1: ").arg(instDirName);
-	switch (error)
-	{
-	case InstanceFactory::NoCreateError:
-		newInstance->setName(copyInstDlg.instName());
-		newInstance->setIconKey(copyInstDlg.iconKey());
-		MMC->instances()->add(newInstance);
-		return;
-
-	case InstanceFactory::InstExists:
+	InstanceCopyTask copyTask(m_selectedInstance, instDir, copyInstDlg.shareFiles());
+	ProgressDialog tDialog(this);
+	tDialog.exec(&copyTask);
+	if (!copyTask.successful())
 	{
-		errorMsg += tr("An instance with the given directory name already exists.");
+		QString errorMsg = tr("Failed to create instance %1: %2")
+							   .arg(instDirName, copyTask.failReason());
 		CustomMessageBox::selectable(this, tr("Error"), errorMsg, QMessageBox::Warning)->show();
-		break;
+		return;
 	}
+	auto newInstance = copyTask.instance();
+	newInstance->setName(copyInstDlg.instName());
+	newInstance->setIconKey(copyInstDlg.iconKey());
+	MMC->instances()->add(newInstance);
+}
 
-	case InstanceFactory::CantCreateDir:
+void MainWindow::on_actionImportInstance_triggered()
+{
+	QString archivePath = QFileDialog::getOpenFileName(this, tr("Import Instance"), QString(),
+													   tr("Zip files (*.zip)"));
+	if (archivePath.isEmpty())
+		return;
+
+	QString instancesDir = MMC->settings()->get("InstanceDir").toString();
+	QString instDirName =
+		DirNameFromString(QFileInfo(archivePath).completeBaseName(), instancesDir);
+	QString instDir = PathCombine(instancesDir, instDirName);
+
+	InstanceImportTask importTask(archivePath, instDir);
+	ProgressDialog tDialog(this);
+	tDialog.exec(&importTask);
+	if (!importTask.successful())
 	{
-		errorMsg += tr("Failed to create the instance directory.");
+		QString errorMsg = tr("Failed to import %1: %2")
+							   .arg(QFileInfo(archivePath).fileName(), importTask.failReason());
 		CustomMessageBox::selectable(this, tr("Error"), errorMsg, QMessageBox::Warning)->show();
-		break;
+		return;
 	}
+	MMC->instances()->add(importTask.instance());
+}
 
-	default:
+void MainWindow::on_actionExportInstance_triggered()
+{
+	if (!m_selectedInstance)
+		return;
+
+	QString archivePath = QFileDialog::getSaveFileName(
+		this, tr("Export Instance"),
+		PathCombine(QDir::homePath(), m_selectedInstance->name() + ".zip"),
+		tr("Zip files (*.zip)"));
+	if (archivePath.isEmpty())
+		return;
+
+	auto skip = CustomMessageBox::selectable(
+					this, tr("Export Instance"),
+					tr("Leave out the files MultiMC can make again, like extracted natives? "
+					   "The archive gets smaller, but they have to be made again before the "
+					   "first launch."),
+					QMessageBox::Question, QMessageBox::Yes | QMessageBox::No)->exec();
+
+	InstanceExportTask exportTask(m_selectedInstance, archivePath, skip == QMessageBox::Yes);
+	ProgressDialog tDialog(this);
+	tDialog.exec(&exportTask);
+	if (!exportTask.successful())
 	{
-		errorMsg += tr("Unknown instance loader error %1").arg(error);
+		QString errorMsg = tr("Failed to export %1: %2")
+							   .arg(m_selectedInstance->name(), exportTask.failReason());
 		CustomMessageBox::selectable(this, tr("Error"), errorMsg, QMessageBox::Warning)->show();
-		break;
-	}
 	}
 }
 
@@ -934,6 +986,23 @@ void MainWindow::on_actionRefresh_triggered()
 	MMC->instances()->loadList();
 }
 
+void MainWindow::on_actionUpdateInstances_triggered()
+{
+	// the instances are loaded by the update as it gets to them
+	auto list = MMC->instances();
+	if (list->isLoading())
+		list->waitForLoaded();
+	QList<InstanceCatalog::Entry> entries;
+	for (int i = 0; i < list->count(); i++)
+	{
+		entries.append(list->entryAt(i));
+	}
+	BatchUpdate update(entries);
+	ProgressDialog tDialog(this);
+	connect(&update, SIGNAL(failed(QString)), SLOT(onGameUpdateError(QString)));
+	tDialog.exec(&update);
+}
+
 void MainWindow::on_actionViewCentralModsFolder_triggered()
 {
 	openDirInDefaultProgram(MMC->settings()->get("CentralModsDir").toString(), true);
@@ -1284,6 +1353,10 @@ void MainWindow::launchInstance(InstancePtr instance, AuthSessionPtr session,
 	Q_ASSERT_X(instance != NULL, "launchInstance", "instance is NULL");
 	Q_ASSERT_X(session.get() != nullptr, "launchInstance", "session is NULL");
 
+	// the launcher and the tools read the settings from the files
+	MMC->settings()->flush();
+	instance->settings().flush();
+
 	QString launchScript;
 
 	if (!instance->prepareForLaunch(session, launchScript))
@@ -1297,6 +1370,8 @@ void MainWindow::launchInstance(InstancePtr instance, AuthSessionPtr session,
 
 	console = new ConsoleWindow(proc);
 	connect(console, SIGNAL(isClosing()), this, SLOT(instanceEnded()));
+	// the game gets the bandwidth while it runs
+	MMC->prefetcher()->pause();
 
 	proc->setLogin(session);
 	proc->arm();
@@ -1432,8 +1507,26 @@ void MainWindow::selectionBad()
 	setSelectedInstanceById(MMC->settings()->get("SelectedInstance").toString());
 }
 
+void MainWindow::instancesReloaded()
+{
+	QString id = MMC->settings()->get("SelectedInstance").toString();
+	QModelIndex current = proxymodel->mapFromSource(MMC->instances()->getInstanceIndexById(id));
+	// selecting the current index again doesn't tell us anything, look at it directly
+	if (current.isValid() && current == view->selectionModel()->currentIndex())
+		instanceChanged(current, current);
+	else
+		selectionBad();
+}
+
+void MainWindow::instancesAdded()
+{
+	if (!m_selectedInstance)
+		setSelectedInstanceById(MMC->settings()->get("SelectedInstance").toString());
+}
+
 void MainWindow::instanceEnded()
 {
+	MMC->prefetcher()->resume();
 	this->show();
 }
 
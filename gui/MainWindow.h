@@ -64,6 +64,10 @@ slots:
 
 	void on_actionCopyInstance_triggered();
 
+	void on_actionImportInstance_triggered();
+
+	void on_actionExportInstance_triggered();
+
 	void on_actionChangeInstGroup_triggered();
 
 	void on_actionChangeInstIcon_triggered();
@@ -76,6 +80,8 @@ slots:
 
 	void on_actionRefresh_triggered();
 
+	void on_actionUpdateInstances_triggered();
+
 	void on_actionViewCentralModsFolder_triggered();
 
 	void on_actionCheckUpdate_triggered();
@@ -152,6 +158,10 @@ slots:
 
 	void selectionBad();
 
+	void instancesReloaded();
+
+	void instancesAdded();
+
 	void startTask(Task *task);
 
 	void updateAvailable(QString repo, QString versionName, int versionId);
@@ -65,6 +65,11 @@ QString CopyInstanceDialog::iconKey() const
 	return InstIconKey;
 }
 
+bool CopyInstanceDialog::shareFiles() const
+{
+	return ui->shareFilesCheckBox->isChecked();
+}
+
 void CopyInstanceDialog::on_iconButton_clicked()
 {
 	IconPickerDialog dlg(this);
@@ -38,6 +38,8 @@ public:
 
 	QString instName() const;
 	QString iconKey() const;
+	/// hardlink the mods and resource packs instead of copying them
+	bool shareFiles() const;
 
 private
 slots:
@@ -19,7 +19,9 @@
 #include <QKeyEvent>
 
 #include "logic/tasks/Task.h"
+#include "logic/Prefetcher.h"
 #include "gui/Platform.h"
+#include "MultiMC.h"
 
 ProgressDialog::ProgressDialog(QWidget *parent) : QDialog(parent), ui(new Ui::ProgressDialog)
 {
@@ -65,13 +67,18 @@ int ProgressDialog::exec(ProgressProvider *task)
 	connect(task, SIGNAL(status(QString)), SLOT(changeStatus(const QString &)));
 	connect(task, SIGNAL(progress(qint64, qint64)), SLOT(changeProgress(qint64, qint64)));
 
+	// whatever the user is waiting for comes before prefetching
+	auto prefetcher = MMC->prefetcher();
+	prefetcher->pause();
+
+	int result = QDialog::Accepted;
 	// if this didn't connect to an already running task, invoke start
 	if(!task->isRunning())
 		task->start();
 	if(task->isRunning())
-		return QDialog::exec();
-	else
-		return QDialog::Accepted;
+		result = QDialog::exec();
+	prefetcher->resume();
+	return result;
 }
 
 ProgressProvider *ProgressDialog::getTask()
@@ -39,6 +39,7 @@ public:
 	{
 		QString string;
 		bool exact = false;
+		Util::VersionInterval interval;
 	};
 
 	QHash<int, Filter> filters() const
@@ -50,6 +51,10 @@ public:
 		Filter f;
 		f.string = filter;
 		f.exact = exact;
+		if (!exact)
+		{
+			f.interval = Util::VersionInterval(filter);
+		}
 		m_filters[column] = f;
 		invalidateFilter();
 	}
@@ -59,32 +64,126 @@ public:
 		invalidateFilter();
 	}
 
+	/// show only rows containing 'search' in any column, ignoring case
+	void setSearch(const QString &search)
+	{
+		QString needle = search.trimmed().toLower();
+		if (needle == m_search)
+		{
+			return;
+		}
+		// typing more only ever removes rows, so the rows that didn't match before can be
+		// skipped without looking at them
+		m_narrowing = !m_search.isEmpty() && needle.contains(m_search);
+		m_previousSearch = m_search;
+		m_search = needle;
+		invalidateFilter();
+	}
+
+	void setSourceModel(QAbstractItemModel *model) override
+	{
+		m_rows.clear();
+		QSortFilterProxyModel::setSourceModel(model);
+		// the rows are found by the version they show, so this only drops versions
+		// that are gone or changed
+		connect(model, SIGNAL(modelReset()), SLOT(sourceReset()));
+		connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(sourceReset()));
+	}
+
 protected:
 	bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 	{
+		RowKeys &row = rowKeys(source_row);
 		for (auto it = m_filters.begin(); it != m_filters.end(); ++it)
 		{
-			const QString version =
-				sourceModel()->index(source_row, it.key()).data().toString();
-
+			const int column = it.key();
+			if (column >= row.text.size())
+			{
+				return false;
+			}
 			if (it.value().exact)
 			{
-				if (version != it.value().string)
+				if (row.text[column] != it.value().string)
 				{
 					return false;
 				}
 				continue;
 			}
 
-			if (!Util::versionIsInInterval(version, it.value().string))
+			if (!it.value().interval.contains(row.sortKeys[column]))
 			{
 				return false;
 			}
 		}
-		return true;
+		if (m_search.isEmpty())
+		{
+			return true;
+		}
+		if (row.search != m_search)
+		{
+			if (m_narrowing && row.search == m_previousSearch && !row.found)
+			{
+				row.search = m_search;
+			}
+			else
+			{
+				row.search = m_search;
+				row.found = row.haystack.contains(m_search);
+			}
+		}
+		return row.found;
+	}
+
+private
+slots:
+	void sourceReset()
+	{
+		m_rows.clear();
+		invalidateFilter();
+	}
+
+private:
+	/// everything the filters look at, taken from the source model once per version
+	struct RowKeys
+	{
+		BaseVersionPtr version;
+		QStringList text;
+		QList<Util::Version> sortKeys;
+		QString haystack;
+		// result of the last search for this row
+		QString search;
+		bool found = false;
+	};
+
+	RowKeys &rowKeys(int source_row) const
+	{
+		auto model = sourceModel();
+		auto version = model->index(source_row, 0)
+						   .data(BaseVersionList::VersionPointerRole)
+						   .value<BaseVersionPtr>();
+		auto iter = m_rows.find(version.get());
+		if (iter != m_rows.end())
+		{
+			return *iter;
+		}
+		RowKeys row;
+		// keeps the pointer used as the key from being reused for something else
+		row.version = version;
+		for (int column = 0; column < model->columnCount(); column++)
+		{
+			QString text = model->index(source_row, column).data().toString();
+			row.text.append(text);
+			row.sortKeys.append(Util::Version(text));
+			row.haystack += text.toLower() + '\n';
+		}
+		return *m_rows.insert(version.get(), row);
 	}
 
 	QHash<int, Filter> m_filters;
+	QString m_search;
+	QString m_previousSearch;
+	bool m_narrowing = false;
+	mutable QHash<BaseVersion *, RowKeys> m_rows;
 };
 
 VersionSelectDialog::VersionSelectDialog(BaseVersionList *vlist, QString title, QWidget *parent,
@@ -180,6 +279,11 @@ void VersionSelectDialog::on_refreshButton_clicked()
 	loadList();
 }
 
+void VersionSelectDialog::on_filterEdit_textChanged(const QString &text)
+{
+	m_proxyModel->setSearch(text);
+}
+
 void VersionSelectDialog::setExactFilter(int column, QString filter)
 {
 	m_proxyModel->setFilter(column, filter, true);
@@ -54,6 +54,7 @@ public:
 private
 slots:
 	void on_refreshButton_clicked();
+	void on_filterEdit_textChanged(const QString &text);
 
 private:
 	Ui::VersionSelectDialog *ui;
@@ -110,10 +110,10 @@ void drawProgressOverlay(QPainter *painter, const QStyleOptionViewItemV4 &option
 	painter->restore();
 }
 
-void drawBadges(QPainter *painter, const QStyleOptionViewItemV4 &option, BaseInstance *instance)
+void drawBadges(QPainter *painter, const QStyleOptionViewItemV4 &option,
+				const BaseInstance::InstanceFlags flags, const QString &name)
 {
 	QList<QString> pixmaps;
-	const BaseInstance::InstanceFlags flags = instance->flags();
 	if (flags & BaseInstance::VersionBrokenFlag)
 	{
 		pixmaps.append("broken");
@@ -124,21 +124,21 @@ void drawBadges(QPainter *painter, const QStyleOptionViewItemV4 &option, BaseIns
 	}
 
 	// begin easter eggs
-	if (instance->name().contains("btw", Qt::CaseInsensitive) ||
-		instance->name().contains("better then wolves", Qt::CaseInsensitive) ||
-		instance->name().contains("better than wolves", Qt::CaseInsensitive))
+	if (name.contains("btw", Qt::CaseInsensitive) ||
+		name.contains("better then wolves", Qt::CaseInsensitive) ||
+		name.contains("better than wolves", Qt::CaseInsensitive))
 	{
 		pixmaps.append("herobrine");
 	}
-	if (instance->name().contains("direwolf", Qt::CaseInsensitive))
+	if (name.contains("direwolf", Qt::CaseInsensitive))
 	{
 		pixmaps.append("enderman");
 	}
-	if (instance->name().contains("kitten", Qt::CaseInsensitive))
+	if (name.contains("kitten", Qt::CaseInsensitive))
 	{
 		pixmaps.append("kitten");
 	}
-	if (instance->name().contains("derp", Qt::CaseInsensitive))
+	if (name.contains("derp", Qt::CaseInsensitive))
 	{
 		pixmaps.append("derp");
 	}
@@ -318,11 +318,11 @@ void ListViewDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opti
 	}
 
 	// FIXME: this really has no business of being here. Make generic.
-	auto instance = (BaseInstance*)index.data(InstanceList::InstancePointerRole)
-			.value<void *>();
-	if (instance)
+	// the instances are not necessarily loaded, so this goes through the model
+	QVariant flags = index.data(InstanceList::InstanceFlagsRole);
+	if (flags.isValid())
 	{
-		drawBadges(painter, opt, instance);
+		drawBadges(painter, opt, BaseInstance::InstanceFlags(flags.toInt()), opt.text);
 	}
 
 	drawProgressOverlay(painter, opt, index.data(GroupViewRoles::ProgressValueRole).toInt(),
@@ -77,6 +77,11 @@ void MinecraftPage::applySettings()
 	// Minecraft version updates
 	s->set("AutoUpdateMinecraftVersions", ui->autoupdateMinecraft->isChecked());
 
+	// Background downloads
+	s->set("PrefetchEnabled", ui->prefetchCheckBox->isChecked());
+	s->set("PrefetchMaxSpeed", ui->prefetchSpeedSpinBox->value());
+	s->set("PrefetchMaxDownloads", ui->prefetchDownloadsSpinBox->value());
+
 	// Console
 	s->set("ShowConsole", ui->showConsoleCheck->isChecked());
 	s->set("AutoCloseConsole", ui->autoCloseConsoleCheck->isChecked());
@@ -92,7 +97,12 @@ void MinecraftPage::loadSettings()
 	auto s = MMC->settings();
 	// Minecraft version updates
 	ui->autoupdateMinecraft->setChecked(s->get("AutoUpdateMinecraftVersions").toBool());
-	
+
+	// Background downloads
+	ui->prefetchCheckBox->setChecked(s->get("PrefetchEnabled").toBool());
+	ui->prefetchSpeedSpinBox->setValue(s->get("PrefetchMaxSpeed").toInt());
+	ui->prefetchDownloadsSpinBox->setValue(s->get("PrefetchMaxDownloads").toInt());
+
 	// Console
 	ui->showConsoleCheck->setChecked(s->get("ShowConsole").toBool());
 	ui->autoCloseConsoleCheck->setChecked(s->get("AutoCloseConsole").toBool());
@@ -39,11 +39,13 @@ BaseInstance::BaseInstance(BaseInstancePrivate *d_in, const QString &rootDir,
 	d->m_settings = std::shared_ptr<SettingsObject>(settings_obj);
 	d->m_rootDir = rootDir;
 
-	settings().registerSetting("name", "Unnamed Instance");
-	settings().registerSetting("iconKey", "default");
+	d->m_name = TypedSetting<QString>(settings().registerSetting("name", "Unnamed Instance"));
+	d->m_iconKey = TypedSetting<QString>(settings().registerSetting("iconKey", "default"));
 	connect(MMC->icons().get(), SIGNAL(iconUpdated(QString)), SLOT(iconUpdated(QString)));
-	settings().registerSetting("notes", "");
-	settings().registerSetting("lastLaunchTime", 0);
+	d->m_notes = TypedSetting<QString>(settings().registerSetting("notes", ""));
+	d->m_lastLaunchTime = TypedSetting<qint64>(settings().registerSetting("lastLaunchTime", 0));
+	// registered by the instance factory
+	d->m_instanceType = TypedSetting<QString>(settings().getSetting("InstanceType"));
 
 	/*
 	 * custom base jar has no default. it is determined in code... see the accessor methods for
@@ -52,8 +54,9 @@ BaseInstance::BaseInstance(BaseInstancePrivate *d_in, const QString &rootDir,
 	 * for instances that DO NOT have the CustomBaseJar setting (legacy instances),
 	 * [.]minecraft/bin/mcbackup.jar is the default base jar
 	 */
-	settings().registerSetting("UseCustomBaseJar", true);
-	settings().registerSetting("CustomBaseJar", "");
+	d->m_useCustomBaseJar =
+		TypedSetting<bool>(settings().registerSetting("UseCustomBaseJar", true));
+	d->m_customBaseJar = TypedSetting<QString>(settings().registerSetting("CustomBaseJar", ""));
 
 	auto globalSettings = MMC->settings();
 
@@ -122,7 +125,7 @@ void BaseInstance::setRunning(bool running) const
 QString BaseInstance::instanceType() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("InstanceType").toString();
+	return d->m_instanceType.get();
 }
 
 QString BaseInstance::instanceRoot() const
@@ -206,7 +209,7 @@ bool BaseInstance::reload()
 QString BaseInstance::baseJar() const
 {
 	I_D(BaseInstance);
-	bool customJar = d->m_settings->get("UseCustomBaseJar").toBool();
+	bool customJar = d->m_useCustomBaseJar.get();
 	if (customJar)
 	{
 		return customBaseJar();
@@ -218,7 +221,7 @@ QString BaseInstance::baseJar() const
 QString BaseInstance::customBaseJar() const
 {
 	I_D(BaseInstance);
-	QString value = d->m_settings->get("CustomBaseJar").toString();
+	QString value = d->m_customBaseJar.get();
 	if (value.isNull() || value.isEmpty())
 	{
 		return defaultCustomBaseJar();
@@ -230,32 +233,32 @@ void BaseInstance::setCustomBaseJar(QString val)
 {
 	I_D(BaseInstance);
 	if (val.isNull() || val.isEmpty() || val == defaultCustomBaseJar())
-		d->m_settings->reset("CustomBaseJar");
+		d->m_customBaseJar.reset();
 	else
-		d->m_settings->set("CustomBaseJar", val);
+		d->m_customBaseJar.set(val);
 }
 
 void BaseInstance::setShouldUseCustomBaseJar(bool val)
 {
 	I_D(BaseInstance);
-	d->m_settings->set("UseCustomBaseJar", val);
+	d->m_useCustomBaseJar.set(val);
 }
 
 bool BaseInstance::shouldUseCustomBaseJar() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("UseCustomBaseJar").toBool();
+	return d->m_useCustomBaseJar.get();
 }
 
 qint64 BaseInstance::lastLaunch() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("lastLaunchTime").value<qint64>();
+	return d->m_lastLaunchTime.get();
 }
 void BaseInstance::setLastLaunch(qint64 val)
 {
 	I_D(BaseInstance);
-	d->m_settings->set("lastLaunchTime", val);
+	d->m_lastLaunchTime.set(val);
 	emit propertiesChanged(this);
 }
 
@@ -281,37 +284,37 @@ QString BaseInstance::group() const
 void BaseInstance::setNotes(QString val)
 {
 	I_D(BaseInstance);
-	d->m_settings->set("notes", val);
+	d->m_notes.set(val);
 }
 QString BaseInstance::notes() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("notes").toString();
+	return d->m_notes.get();
 }
 
 void BaseInstance::setIconKey(QString val)
 {
 	I_D(BaseInstance);
-	d->m_settings->set("iconKey", val);
+	d->m_iconKey.set(val);
 	emit propertiesChanged(this);
 }
 QString BaseInstance::iconKey() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("iconKey").toString();
+	return d->m_iconKey.get();
 }
 
 void BaseInstance::setName(QString val)
 {
 	I_D(BaseInstance);
-	d->m_settings->set("name", val);
+	d->m_name.set(val);
 	emit propertiesChanged(this);
 }
 
 QString BaseInstance::name() const
 {
 	I_D(BaseInstance);
-	return d->m_settings->get("name").toString();
+	return d->m_name.get();
 }
 
 QString BaseInstance::windowTitle() const
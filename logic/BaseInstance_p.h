@@ -19,6 +19,7 @@
 #include <QSet>
 
 #include "logic/settings/SettingsObject.h"
+#include "logic/settings/TypedSetting.h"
 
 #include "BaseInstance.h"
 
@@ -31,6 +32,14 @@ public:
 	QString m_rootDir;
 	QString m_group;
 	std::shared_ptr<SettingsObject> m_settings;
+	// the settings the instance list and the launch code read all the time
+	TypedSetting<QString> m_name;
+	TypedSetting<QString> m_iconKey;
+	TypedSetting<QString> m_notes;
+	TypedSetting<qint64> m_lastLaunchTime;
+	TypedSetting<QString> m_instanceType;
+	TypedSetting<bool> m_useCustomBaseJar;
+	TypedSetting<QString> m_customBaseJar;
 	BaseInstance::InstanceFlags m_flags;
 	bool m_isRunning = false;
 };
@@ -0,0 +1,424 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MultiMC.h"
+#include "BatchUpdate.h"
+
+#include <QDir>
+#include <QtConcurrentMap>
+
+#include "logic/OneSixUpdate.h"
+#include "logic/InstanceList.h"
+#include "logic/DownloadPlan.h"
+#include "logic/minecraft/MinecraftVersionList.h"
+#include "logic/minecraft/InstanceVersion.h"
+#include "logic/minecraft/NativesCache.h"
+#include "logger/QsLog.h"
+
+struct JarStripper
+{
+	typedef QString result_type;
+	/// returns the error, empty on success
+	QString operator()(const QPair<QString, QString> &strip)
+	{
+		QString error;
+		if (!OneSixUpdate::stripJar(strip.second, strip.first, error))
+			return error;
+		return QString();
+	}
+};
+
+struct InstanceFinisher
+{
+	typedef QString result_type;
+	/// returns the error, empty on success
+	QString operator()(const BatchUpdate::FinishJob &job)
+	{
+		QString error;
+		if (!NativesCache::perform(job.natives, error))
+			return BatchUpdate::tr("Failed to extract native libraries: %1").arg(error);
+		if (!OneSixUpdate::copyFmlLibs(job.fmlLibCopies, error))
+			return error;
+		return QString();
+	}
+};
+
+BatchUpdate::BatchUpdate(QList<InstanceCatalog::Entry> entries, QObject *parent)
+	: Task(parent), m_entries(entries)
+{
+	connect(&m_stripWatcher, SIGNAL(finished()), SLOT(stripFinished()));
+	connect(&m_finishWatcher, SIGNAL(finished()), SLOT(instancesFinished()));
+}
+
+void BatchUpdate::executeTask()
+{
+	// the catalog knows enough to get the Minecraft versions, the instances can wait
+	for (auto &entry : m_entries)
+	{
+		bool onesix = entry.instanceType == "OneSix" || entry.instanceType == "Nostalgia" ||
+					  entry.instanceType == "OneSixFTB";
+		if (!onesix)
+		{
+			m_legacy.append(entry);
+			continue;
+		}
+		Item item;
+		item.entry = entry;
+		m_items.append(item);
+
+		auto &added = m_items.last();
+		QString versionId = entry.intendedVersion;
+		auto target = std::dynamic_pointer_cast<MinecraftVersion>(
+			MMC->minecraftlist()->findVersion(versionId));
+		if (!target)
+		{
+			fail(added, tr("The specified Minecraft version is invalid. Choose a different one."));
+			continue;
+		}
+		// FTB instances provide their own version file
+		if (entry.instanceType == "OneSixFTB" || !target->needsUpdate())
+			continue;
+		if (!m_versionQueue.contains(versionId))
+			m_versionQueue.append(versionId);
+	}
+	versionUpdateNext();
+}
+
+void BatchUpdate::versionUpdateNext()
+{
+	m_versionUpdateTask.reset();
+	while (!m_versionQueue.isEmpty())
+	{
+		m_currentVersion = m_versionQueue.takeFirst();
+		m_versionUpdateTask = MMC->minecraftlist()->createUpdateTask(m_currentVersion);
+		if (!m_versionUpdateTask)
+			continue;
+		// queued, because the slots replace the task that emits the signal
+		connect(m_versionUpdateTask.get(), SIGNAL(succeeded()), SLOT(versionUpdateNext()),
+				Qt::QueuedConnection);
+		connect(m_versionUpdateTask.get(), SIGNAL(failed(QString)),
+				SLOT(versionUpdateFailed(QString)), Qt::QueuedConnection);
+		connect(m_versionUpdateTask.get(), SIGNAL(progress(qint64, qint64)),
+				SIGNAL(progress(qint64, qint64)));
+		setStatus(tr("Getting the version files for %1 from Mojang...").arg(m_currentVersion));
+		m_versionUpdateTask->start();
+		return;
+	}
+	librariesStart();
+}
+
+void BatchUpdate::versionUpdateFailed(QString reason)
+{
+	for (auto &item : m_items)
+	{
+		if (!item.failed && item.entry.intendedVersion == m_currentVersion)
+			fail(item, reason);
+	}
+	versionUpdateNext();
+}
+
+void BatchUpdate::librariesStart()
+{
+	setStatus(tr("Getting the library files from Mojang..."));
+	DownloadPlan &plan = m_librariesPlan;
+	for (int i = 0; i < m_items.size(); i++)
+	{
+		auto &item = m_items[i];
+		if (item.failed)
+			continue;
+		item.instance = std::dynamic_pointer_cast<OneSixInstance>(
+			MMC->instances()->getInstanceById(item.entry.id()));
+		if (!item.instance)
+		{
+			fail(item, tr("The instance couldn't be loaded."));
+			continue;
+		}
+		auto inst = item.instance.get();
+		QDir mcDir(inst->minecraftRoot());
+		if (!mcDir.exists() && !mcDir.mkpath("."))
+		{
+			fail(item, tr("Failed to create folder for minecraft binaries."));
+			continue;
+		}
+		// remember who needs what, so a failed download only fails those
+		plan.setOwner(i);
+		// nothing changed since the last update, the libraries are all there
+		item.launchPlanCurrent = inst->launchPlanIsCurrent();
+		if (item.launchPlanCurrent)
+		{
+			QLOG_INFO() << inst->name() << ": launch plan is current, skipping the libraries";
+		}
+		else
+		{
+			try
+			{
+				inst->reloadVersion();
+			}
+			catch (MMCError &e)
+			{
+				fail(item, e.cause());
+				continue;
+			}
+			catch (...)
+			{
+				fail(item,
+					 tr("Failed to load the version description file for reasons unknown."));
+				continue;
+			}
+			item.jarHashOnEntry = OneSixUpdate::versionJarHash(inst);
+			QString error;
+			if (!OneSixUpdate::planJarLibs(inst, plan, error))
+			{
+				fail(item, error);
+				continue;
+			}
+		}
+		if (inst->getFullVersion()->traits.contains("legacyFML"))
+		{
+			item.fmlLibs = OneSixUpdate::missingFmlLibs(inst);
+			OneSixUpdate::planFmlLibs(item.fmlLibs, plan);
+		}
+		OneSixUpdate::planAssetIndex(inst->getFullVersion()->assets, plan);
+	}
+	if (plan.isEmpty())
+	{
+		librariesFinished();
+		return;
+	}
+	m_librariesJob = plan.makeJob(tr("Libraries for %n instance(s)", "", m_items.size()));
+	connect(m_librariesJob.get(), SIGNAL(succeeded()), SLOT(librariesFinished()));
+	connect(m_librariesJob.get(), SIGNAL(failed()), SLOT(librariesFailed()));
+	connect(m_librariesJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	m_librariesJob->start();
+}
+
+void BatchUpdate::librariesFailed()
+{
+	QString failed_all = m_librariesJob->getFailedFiles().join("\n");
+	for (int i : m_librariesPlan.failedOwners())
+	{
+		if (!m_items[i].failed)
+			fail(m_items[i], tr("Failed to download the following files:\n%1").arg(failed_all));
+	}
+	// the others got everything they need
+	librariesFinished();
+}
+
+void BatchUpdate::librariesFinished()
+{
+	// the stripping only touches the jars, so it runs on worker threads. the paths come from
+	// the metacache, which has to be asked here.
+	for (auto &item : m_items)
+	{
+		if (item.failed || item.launchPlanCurrent)
+			continue;
+		QString jarPath, strippedJarPath;
+		if (!OneSixUpdate::needsStrippedJar(item.instance.get(), item.jarHashOnEntry, jarPath,
+											strippedJarPath))
+			continue;
+		item.strippedJarPath = strippedJarPath;
+		bool known = false;
+		for (auto &strip : m_strips)
+		{
+			known |= strip.first == strippedJarPath;
+		}
+		if (!known)
+			m_strips.append(qMakePair(strippedJarPath, jarPath));
+	}
+	if (m_strips.isEmpty())
+		m_stripDone = true;
+	else
+		m_stripWatcher.setFuture(QtConcurrent::mapped(m_strips, JarStripper()));
+
+	// meanwhile, the assets of all the instances
+	DownloadPlan &plan = m_assetsPlan;
+	for (int i = 0; i < m_items.size(); i++)
+	{
+		auto &item = m_items[i];
+		if (item.failed)
+			continue;
+		// the asset index that just came in may be a new one
+		if (item.launchPlanCurrent)
+			item.launchPlanCurrent = item.instance->launchPlanIsCurrent();
+		plan.setOwner(i);
+		QString error;
+		if (!OneSixUpdate::planAssets(item.instance->getFullVersion()->assets, plan, error))
+			fail(item, error);
+	}
+	if (plan.isEmpty())
+	{
+		assetsFinished();
+		return;
+	}
+	// legacy versions get a copy of the assets in the plan. we can't tell whose assets these
+	// are, so all the plans are made again.
+	for (auto &item : m_items)
+	{
+		item.launchPlanCurrent = false;
+	}
+	setStatus(tr("Getting the assets files from Mojang..."));
+	m_assetsJob = plan.makeJob(tr("Assets for %n instance(s)", "", m_items.size()));
+	connect(m_assetsJob.get(), SIGNAL(succeeded()), SLOT(assetsFinished()));
+	connect(m_assetsJob.get(), SIGNAL(failed()), SLOT(assetsFailed()));
+	connect(m_assetsJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	m_assetsJob->start();
+}
+
+void BatchUpdate::assetsFailed()
+{
+	for (int i : m_assetsPlan.failedOwners())
+	{
+		if (!m_items[i].failed)
+			fail(m_items[i], tr("Failed to download assets!"));
+	}
+	assetsFinished();
+}
+
+void BatchUpdate::assetsFinished()
+{
+	m_assetsDone = true;
+	if (m_stripDone)
+		finishInstances();
+	else
+		setStatus(tr("Creating stripped jars..."));
+}
+
+void BatchUpdate::stripFinished()
+{
+	auto results = m_stripWatcher.future().results();
+	for (int i = 0; i < results.size(); i++)
+	{
+		if (results[i].isEmpty())
+			continue;
+		for (auto &item : m_items)
+		{
+			if (!item.failed && item.strippedJarPath == m_strips[i].first)
+				fail(item, results[i]);
+		}
+	}
+	m_stripDone = true;
+	if (m_assetsDone)
+		finishInstances();
+}
+
+void BatchUpdate::finishInstances()
+{
+	// the paths come from the metacache, which has to be asked here. the natives and FML
+	// libraries are then put in place on worker threads, like the stripped jars.
+	setStatus(tr("Extracting native libraries..."));
+	for (int i = 0; i < m_items.size(); i++)
+	{
+		auto &item = m_items[i];
+		if (item.failed)
+			continue;
+		auto inst = item.instance.get();
+		FinishJob job;
+		job.item = i;
+		if (!item.launchPlanCurrent)
+		{
+			QString error;
+			job.natives = NativesCache::prepare(inst->getFullVersion()->getActiveNativeLibs(),
+												inst->librariesPath(), error);
+			if (job.natives.path.isEmpty())
+			{
+				fail(item, tr("Failed to extract native libraries: %1").arg(error));
+				continue;
+			}
+		}
+		job.fmlLibCopies = OneSixUpdate::fmlLibCopies(inst, item.fmlLibs);
+		m_finishJobs.append(job);
+	}
+	if (m_finishJobs.isEmpty())
+	{
+		legacyUpdateNext();
+		return;
+	}
+	m_finishWatcher.setFuture(QtConcurrent::mapped(m_finishJobs, InstanceFinisher()));
+}
+
+void BatchUpdate::instancesFinished()
+{
+	// the launch plans go through the metacache too
+	auto results = m_finishWatcher.future().results();
+	for (int i = 0; i < results.size(); i++)
+	{
+		auto &item = m_items[m_finishJobs[i].item];
+		if (!results[i].isEmpty())
+		{
+			fail(item, results[i]);
+			continue;
+		}
+		QString error;
+		if (!item.launchPlanCurrent &&
+			!item.instance->updateLaunchPlan(error, m_finishJobs[i].natives.path))
+			fail(item, tr("Failed to prepare the launch: %1").arg(error));
+	}
+	legacyUpdateNext();
+}
+
+void BatchUpdate::legacyUpdateNext()
+{
+	m_legacyUpdateTask.reset();
+	while (!m_legacy.isEmpty())
+	{
+		auto entry = m_legacy.takeFirst();
+		m_legacyName = entry.name;
+		auto instance = MMC->instances()->getInstanceById(entry.id());
+		if (!instance)
+		{
+			legacyUpdateFailed(tr("The instance couldn't be loaded."));
+			return;
+		}
+		m_legacyUpdateTask = instance->doUpdate();
+		if (!m_legacyUpdateTask)
+			continue;
+		connect(m_legacyUpdateTask.get(), SIGNAL(succeeded()), SLOT(legacyUpdateNext()),
+				Qt::QueuedConnection);
+		connect(m_legacyUpdateTask.get(), SIGNAL(failed(QString)),
+				SLOT(legacyUpdateFailed(QString)), Qt::QueuedConnection);
+		connect(m_legacyUpdateTask.get(), SIGNAL(progress(qint64, qint64)),
+				SIGNAL(progress(qint64, qint64)));
+		setStatus(tr("Updating %1...").arg(m_legacyName));
+		m_legacyUpdateTask->start();
+		return;
+	}
+	finish();
+}
+
+void BatchUpdate::legacyUpdateFailed(QString reason)
+{
+	QLOG_ERROR() << m_legacyName << "failed to update:" << reason;
+	m_failures.append(tr("%1: %2").arg(m_legacyName, reason));
+	legacyUpdateNext();
+}
+
+void BatchUpdate::fail(Item &item, const QString &error)
+{
+	QLOG_ERROR() << item.entry.name << "failed to update:" << error;
+	item.failed = true;
+	m_failures.append(tr("%1: %2").arg(item.entry.name, error));
+}
+
+void BatchUpdate::finish()
+{
+	if (m_failures.isEmpty())
+	{
+		emitSucceeded();
+		return;
+	}
+	emitFailed(tr("Some instances couldn't be updated:\n\n%1").arg(m_failures.join("\n\n")));
+}
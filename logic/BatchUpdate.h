@@ -0,0 +1,120 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QStringList>
+#include <QFutureWatcher>
+
+#include "logic/BaseInstance.h"
+#include "logic/InstanceCatalog.h"
+#include "logic/OneSixInstance.h"
+#include "logic/VersionFilterData.h"
+#include "logic/DownloadPlan.h"
+#include "logic/minecraft/NativesCache.h"
+#include "logic/net/NetJob.h"
+#include "logic/tasks/Task.h"
+
+/**
+ * Updates many instances at once.
+ *
+ * Everything the OneSix instances need is collected into shared download plans first, so a
+ * library or asset used by several instances is fetched only once, and each Minecraft version
+ * is updated only once no matter how many instances use it.
+ *
+ * The instances are given as catalog entries and each one is only loaded when the update gets
+ * to it.
+ *
+ * An instance that fails doesn't stop the others. The task fails at the end if any of them did.
+ */
+class BatchUpdate : public Task
+{
+	Q_OBJECT
+public:
+	explicit BatchUpdate(QList<InstanceCatalog::Entry> entries, QObject *parent = 0);
+	virtual void executeTask();
+
+private
+slots:
+	void versionUpdateNext();
+	void versionUpdateFailed(QString reason);
+
+	void librariesFinished();
+	void librariesFailed();
+
+	void assetsFinished();
+	void assetsFailed();
+	void stripFinished();
+	void instancesFinished();
+
+	void legacyUpdateNext();
+	void legacyUpdateFailed(QString reason);
+
+private:
+	struct Item
+	{
+		InstanceCatalog::Entry entry;
+		/// null until the libraries are planned
+		std::shared_ptr<OneSixInstance> instance;
+		QString jarHashOnEntry;
+		QList<FMLlib> fmlLibs;
+		/// set when the jar mods need a new stripped jar
+		QString strippedJarPath;
+		/// the launch plan from an earlier update can be used as it is
+		bool launchPlanCurrent = false;
+		bool failed = false;
+	};
+	/// the file work that's left for an instance at the end
+	struct FinishJob
+	{
+		/// index in m_items
+		int item = -1;
+		NativesCache::Extraction natives;
+		QList<QPair<QString, QString>> fmlLibCopies;
+	};
+	friend struct InstanceFinisher;
+
+	void fail(Item &item, const QString &error);
+	void librariesStart();
+	void finishInstances();
+	void finish();
+
+	QList<InstanceCatalog::Entry> m_entries;
+	QList<Item> m_items;
+	QList<InstanceCatalog::Entry> m_legacy;
+
+	QStringList m_versionQueue;
+	QString m_currentVersion;
+	std::shared_ptr<Task> m_versionUpdateTask;
+
+	DownloadPlan m_librariesPlan;
+	NetJobPtr m_librariesJob;
+	DownloadPlan m_assetsPlan;
+	NetJobPtr m_assetsJob;
+	bool m_assetsDone = false;
+
+	/// stripped jar path -> original jar path, in the order they are stripped
+	QList<QPair<QString, QString>> m_strips;
+	QFutureWatcher<QString> m_stripWatcher;
+	bool m_stripDone = false;
+
+	QList<FinishJob> m_finishJobs;
+	QFutureWatcher<QString> m_finishWatcher;
+
+	std::shared_ptr<Task> m_legacyUpdateTask;
+	QString m_legacyName;
+	QStringList m_failures;
+};
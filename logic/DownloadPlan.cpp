@@ -0,0 +1,90 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DownloadPlan.h"
+
+#include <QFileInfo>
+
+#include "logic/forge/ForgeMirrors.h"
+
+static const QString forgeMirrorList = "http://files.minecraftforge.net/mirror-brand.list";
+
+bool DownloadPlan::isNewTarget(const QString &target)
+{
+	if (m_owner != -1)
+		m_owners[target].insert(m_owner);
+	return !m_targets.contains(target);
+}
+
+bool DownloadPlan::addCacheDownload(const QUrl &url, MetaEntryPtr entry)
+{
+	QString target = entry->getFullPath();
+	if (!isNewTarget(target))
+		return false;
+	auto download = CacheDownload::make(url, entry);
+	m_targets.insert(target, download);
+	m_actions.append(download);
+	return true;
+}
+
+bool DownloadPlan::addForgeXzDownload(const QString &storage, MetaEntryPtr entry)
+{
+	QString target = entry->getFullPath();
+	if (!isNewTarget(target))
+		return false;
+	auto download = ForgeXzDownload::make(storage, entry);
+	m_targets.insert(target, download);
+	m_forgeLibs.append(download);
+	return true;
+}
+
+bool DownloadPlan::addMd5EtagDownload(const QUrl &url, const QString &target, qint64 size)
+{
+	QString absolute = QFileInfo(target).absoluteFilePath();
+	if (!isNewTarget(absolute))
+		return false;
+	auto download = MD5EtagDownload::make(url, target);
+	download->m_total_progress = size;
+	m_targets.insert(absolute, download);
+	m_actions.append(download);
+	return true;
+}
+
+QSet<int> DownloadPlan::failedOwners() const
+{
+	QSet<int> failed;
+	for (auto iter = m_targets.begin(); iter != m_targets.end(); iter++)
+	{
+		// forge libraries never start if the mirror list can't be had, so that counts too
+		if (iter.value()->m_status == Job_Finished)
+			continue;
+		failed.unite(m_owners.value(iter.key()));
+	}
+	return failed;
+}
+
+NetJobPtr DownloadPlan::makeJob(const QString &name)
+{
+	NetJobPtr job(new NetJob(name));
+	for (auto action : m_actions)
+	{
+		job->addNetAction(action);
+	}
+	if (!m_forgeLibs.isEmpty())
+	{
+		job->addNetAction(ForgeMirrors::make(m_forgeLibs, job, forgeMirrorList));
+	}
+	return job;
+}
@@ -0,0 +1,80 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QSet>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+
+#include "logic/net/NetJob.h"
+#include "logic/forge/ForgeXzDownload.h"
+
+/**
+ * Downloads collected from any number of instances, each file only once.
+ *
+ * Files are told apart by where they are saved, so two instances asking for the same
+ * library end up with a single download.
+ */
+class DownloadPlan
+{
+public:
+	/// returns false if the file was already in the plan
+	bool addCacheDownload(const QUrl &url, MetaEntryPtr entry);
+	/// a pack200/xz compressed forge library, fetched from the forge mirrors
+	bool addForgeXzDownload(const QString &storage, MetaEntryPtr entry);
+	bool addMd5EtagDownload(const QUrl &url, const QString &target, qint64 size);
+
+	/**
+	 * Downloads added from now on are needed by 'owner', whatever it is to the caller. A file
+	 * added by several owners is still downloaded once, but counts for all of them.
+	 */
+	void setOwner(int owner)
+	{
+		m_owner = owner;
+	}
+
+	/// after the job is done: the owners of the downloads that didn't finish
+	QSet<int> failedOwners() const;
+
+	bool isEmpty() const
+	{
+		return m_actions.isEmpty() && m_forgeLibs.isEmpty();
+	}
+
+	/// one job that downloads everything in the plan
+	NetJobPtr makeJob(const QString &name);
+
+	/// the downloads, to run them some other way. forge libraries need a job for the mirror list
+	/// and are not included.
+	QList<NetActionPtr> actions() const
+	{
+		return m_actions;
+	}
+
+private:
+	/// note the owner of 'target'. true if it isn't in the plan yet.
+	bool isNewTarget(const QString &target);
+
+	/// target file -> the download saving it
+	QHash<QString, NetActionPtr> m_targets;
+	/// target file -> its owners
+	QHash<QString, QSet<int>> m_owners;
+	int m_owner = -1;
+	QList<NetActionPtr> m_actions;
+	QList<ForgeXzDownloadPtr> m_forgeLibs;
+};
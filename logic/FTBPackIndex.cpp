@@ -0,0 +1,225 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FTBPackIndex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMap>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QXmlStreamReader>
+#include <QtConcurrentMap>
+
+#include "logger/QsLog.h"
+
+namespace
+{
+const quint32 indexMagic = 0x4d4d4650; // "MMFP"
+// bump this when the records change
+const quint32 indexFormat = 1;
+
+qint64 lastModified(const QFileInfo &info)
+{
+	return info.lastModified().toMSecsSinceEpoch();
+}
+
+QString mcVersionOf(const QXmlStreamAttributes &attrs)
+{
+	auto customVersions = attrs.value("customMCVersions");
+	if (customVersions.isNull())
+		return attrs.value("mcVersion").toString();
+
+	QMap<QString, QString> versionMatcher;
+	QString customVersionsStr = customVersions.toString();
+	QStringList list = customVersionsStr.split(';');
+	for (auto item : list)
+	{
+		auto segment = item.split('^');
+		if (segment.size() != 2)
+		{
+			QLOG_ERROR() << "FTB: Segment of size < 2 in " << customVersionsStr;
+			continue;
+		}
+		versionMatcher[segment[0]] = segment[1];
+	}
+	auto actualVersion = attrs.value("version").toString();
+	if (versionMatcher.contains(actualVersion))
+		return versionMatcher[actualVersion];
+	return attrs.value("mcVersion").toString();
+}
+
+/// read the FTB packs XML.
+FTBPackIndex::File parseFile(const QFileInfo &info)
+{
+	FTBPackIndex::File file;
+	file.path = info.absoluteFilePath();
+	file.size = info.size();
+	file.modified = lastModified(info);
+
+	QFile f(file.path);
+	QLOG_INFO() << "Discovering FTB instances -- " << file.path;
+	if (!f.open(QFile::ReadOnly))
+	{
+		// never current, so it is tried again next time
+		file.size = -1;
+		return file;
+	}
+	QXmlStreamReader reader(&f);
+	while (!reader.atEnd())
+	{
+		if (reader.readNext() != QXmlStreamReader::StartElement || reader.name() != "modpack")
+			continue;
+		QXmlStreamAttributes attrs = reader.attributes();
+		FTBRecord record;
+		record.dirName = attrs.value("dir").toString();
+		record.name = attrs.value("name").toString();
+		record.logo = attrs.value("logo").toString();
+		record.mcVersion = mcVersionOf(attrs);
+		record.description = attrs.value("description").toString();
+		file.packs.append(record);
+	}
+	return file;
+}
+}
+
+FTBPackIndex::Result FTBPackIndex::discover(const QString &launcherDataRoot,
+											const QString &ftbRoot, const Files &known)
+{
+	Result result;
+	QDir dir(launcherDataRoot);
+	QDir dataDir(ftbRoot);
+	if (!dataDir.exists())
+	{
+		QLOG_INFO() << "The FTB directory specified does not exist. Please check your settings";
+		return result;
+	}
+	else if (!dir.exists())
+	{
+		QLOG_INFO() << "The FTB launcher data directory specified does not exist. Please check "
+					   "your settings";
+		return result;
+	}
+	dir.cd("ModPacks");
+
+	// in name order, the first file to describe a pack wins
+	QList<QFileInfo> xmlFiles;
+	QList<QFileInfo> changed;
+	for (auto info : dir.entryInfoList(QDir::Readable | QDir::Files, QDir::Name))
+	{
+		if (!info.fileName().endsWith(".xml"))
+			continue;
+		xmlFiles.append(info);
+		auto iter = known.find(info.absoluteFilePath());
+		if (iter != known.end() && iter->size == info.size() &&
+			iter->modified == lastModified(info))
+		{
+			result.files.insert(iter->path, *iter);
+		}
+		else
+		{
+			changed.append(info);
+		}
+	}
+	for (auto file : QtConcurrent::blockingMapped<QList<File>>(changed, parseFile))
+	{
+		result.files.insert(file.path, file);
+	}
+	result.changed = !changed.isEmpty() || result.files.size() != known.size();
+
+	for (auto info : xmlFiles)
+	{
+		for (auto record : result.files[info.absoluteFilePath()].packs)
+		{
+			record.instanceDir = dataDir.absoluteFilePath(record.dirName);
+			record.templateDir = dir.absoluteFilePath(record.dirName);
+			QLOG_DEBUG() << dataDir.absolutePath() << record.instanceDir << record.dirName;
+			if (!QDir(record.instanceDir).exists())
+				continue;
+			if (!result.records.contains(record))
+				result.records.insert(record);
+		}
+	}
+	return result;
+}
+
+FTBPackIndex::Files FTBPackIndex::load(const QString &path)
+{
+	Files files;
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+		return files;
+
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 magic = 0, format = 0, count = 0;
+	in >> magic >> format >> count;
+	if (magic != indexMagic || format != indexFormat)
+		return files;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		File file;
+		quint32 packs = 0;
+		in >> file.path >> file.size >> file.modified >> packs;
+		for (quint32 j = 0; j < packs && in.status() == QDataStream::Ok; j++)
+		{
+			FTBRecord record;
+			in >> record.dirName >> record.name >> record.logo >> record.mcVersion >>
+				record.description;
+			file.packs.append(record);
+		}
+		files.insert(file.path, file);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "FTB pack index" << path << "is damaged, ignoring it";
+		files.clear();
+	}
+	return files;
+}
+
+void FTBPackIndex::save(const QString &path, const Files &files)
+{
+	QSaveFile output(path);
+	if (!output.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Could not open" << path << "for writing";
+		return;
+	}
+	QDataStream out(&output);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << indexMagic << indexFormat << quint32(files.size());
+	for (auto &file : files)
+	{
+		out << file.path << file.size << file.modified << quint32(file.packs.size());
+		for (auto &record : file.packs)
+		{
+			out << record.dirName << record.name << record.logo << record.mcVersion
+				<< record.description;
+		}
+	}
+	if (out.status() != QDataStream::Ok)
+	{
+		QLOG_ERROR() << "Failed to write the FTB pack index" << path;
+		output.cancelWriting();
+		return;
+	}
+	if (!output.commit())
+	{
+		QLOG_ERROR() << "Failed to store the FTB pack index" << path;
+	}
+}
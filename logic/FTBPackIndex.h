@@ -0,0 +1,82 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QSet>
+
+struct FTBRecord
+{
+	QString dirName;
+	QString name;
+	QString logo;
+	QString mcVersion;
+	QString description;
+	QString instanceDir;
+	QString templateDir;
+	bool operator ==(const FTBRecord other) const
+	{
+		return instanceDir == other.instanceDir;
+	}
+};
+
+inline uint qHash(FTBRecord record)
+{
+	return qHash(record.instanceDir);
+}
+
+/**
+ * The modpacks described by the xml files of the FTB launcher, stored in the instance folder as
+ * '.ftbpacks'.
+ *
+ * Each file is remembered with its size and modification time and only parsed again when those
+ * change. The files that did change are parsed on the thread pool.
+ */
+namespace FTBPackIndex
+{
+struct File
+{
+	QString path;
+	qint64 size = -1;
+	qint64 modified = 0;
+	/// the packs the file describes, without instanceDir and templateDir
+	QList<FTBRecord> packs;
+};
+/// by path
+typedef QHash<QString, File> Files;
+
+struct Result
+{
+	Files files;
+	QSet<FTBRecord> records;
+	/// true if 'files' differs from the known ones
+	bool changed = false;
+};
+
+/**
+ * find the packs installed in 'ftbRoot', going by the files in 'launcherDataRoot'.
+ * The files in 'known' are reused where they are still current. Runs on any thread.
+ */
+Result discover(const QString &launcherDataRoot, const QString &ftbRoot, const Files &known);
+
+/// the files stored in 'path'. empty if there are none or they can't be read.
+Files load(const QString &path);
+
+/// store 'files' in 'path'. Failures are logged and otherwise ignored.
+void save(const QString &path, const Files &files);
+}
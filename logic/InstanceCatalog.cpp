@@ -0,0 +1,164 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceCatalog.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <pathutils.h>
+
+#include "logic/BaseInstance.h"
+#include "logic/settings/INIFile.h"
+#include "logger/QsLog.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+const quint32 catalogMagic = 0x4d4d4943; // "MMIC"
+// bump this when the entries change
+const quint32 catalogFormat = 2;
+
+qint64 lastModified(const QFileInfo &info)
+{
+	return info.lastModified().toMSecsSinceEpoch();
+}
+
+quint64 fileId(const QFileInfo &info)
+{
+#ifdef Q_OS_UNIX
+	struct stat buf;
+	if (stat(QFile::encodeName(info.absoluteFilePath()).constData(), &buf) == 0)
+		return buf.st_ino;
+#endif
+	// there's nothing as cheap on Windows, renamed folders just lose their group there
+	return 0;
+}
+}
+
+bool InstanceCatalog::isKnownType(const QString &instanceType)
+{
+	// keep in sync with InstanceFactory::loadInstance
+	return instanceType == "OneSix" || instanceType == "Nostalgia" ||
+		   instanceType == "Legacy" || instanceType == "LegacyFTB" ||
+		   instanceType == "OneSixFTB";
+}
+
+InstanceCatalog::Entry InstanceCatalog::fromSettings(const QString &path, const INIFile &settings)
+{
+	// the defaults are the ones the instances register
+	Entry entry;
+	entry.path = path;
+	entry.name = settings.get("name", "Unnamed Instance").toString();
+	entry.iconKey = settings.get("iconKey", "default").toString();
+	entry.instanceType = settings.get("InstanceType", "Legacy").toString();
+	entry.intendedVersion = settings.get("IntendedVersion", "").toString();
+	if (entry.intendedVersion.isEmpty())
+		entry.intendedVersion = settings.get("IntendedJarVersion", "").toString();
+	entry.lastLaunch = settings.get("lastLaunchTime", 0).toLongLong();
+	return entry;
+}
+
+InstanceCatalog::Entry InstanceCatalog::fromInstance(BaseInstance *instance)
+{
+	Entry entry;
+	entry.path = instance->instanceRoot();
+	entry.name = instance->name();
+	entry.iconKey = instance->iconKey();
+	entry.instanceType = instance->instanceType();
+	entry.intendedVersion = instance->intendedVersionId();
+	entry.lastLaunch = instance->lastLaunch();
+	entry.flags = instance->flags();
+	stamp(entry);
+	return entry;
+}
+
+void InstanceCatalog::stamp(Entry &entry)
+{
+	stamp(entry, QFileInfo(PathCombine(entry.path, "instance.cfg")));
+}
+
+void InstanceCatalog::stamp(Entry &entry, const QFileInfo &cfg)
+{
+	entry.cfgSize = cfg.exists() ? cfg.size() : -1;
+	entry.cfgModified = lastModified(cfg);
+	entry.cfgFileId = fileId(cfg);
+}
+
+bool InstanceCatalog::isCurrent(const Entry &entry, const QFileInfo &cfg)
+{
+	return cfg.exists() && entry.cfgSize == cfg.size() &&
+		   entry.cfgModified == lastModified(cfg);
+}
+
+QList<InstanceCatalog::Entry> InstanceCatalog::load(const QString &path)
+{
+	QList<Entry> entries;
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+		return entries;
+
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 magic = 0, format = 0, count = 0;
+	in >> magic >> format >> count;
+	if (magic != catalogMagic || format != catalogFormat)
+		return entries;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		Entry entry;
+		in >> entry.path >> entry.cfgSize >> entry.cfgModified >> entry.cfgFileId >>
+			entry.name >> entry.iconKey >> entry.instanceType >> entry.intendedVersion >>
+			entry.lastLaunch >> entry.flags;
+		entries.append(entry);
+	}
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Instance catalog" << path << "is damaged, ignoring it";
+		entries.clear();
+	}
+	return entries;
+}
+
+void InstanceCatalog::save(const QString &path, const QList<Entry> &entries)
+{
+	QSaveFile output(path);
+	if (!output.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Could not open" << path << "for writing";
+		return;
+	}
+	QDataStream out(&output);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << catalogMagic << catalogFormat << quint32(entries.size());
+	for (auto &entry : entries)
+	{
+		out << entry.path << entry.cfgSize << entry.cfgModified << entry.cfgFileId << entry.name
+			<< entry.iconKey << entry.instanceType << entry.intendedVersion << entry.lastLaunch
+			<< entry.flags;
+	}
+	if (out.status() != QDataStream::Ok)
+	{
+		output.cancelWriting();
+	}
+	if (!output.commit())
+	{
+		QLOG_ERROR() << "Failed to store the instance catalog" << path;
+	}
+}
@@ -0,0 +1,81 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QFileInfo>
+
+class BaseInstance;
+class INIFile;
+
+/**
+ * What the instance list shows about each instance, stored in the instance folder as '.catalog'.
+ *
+ * This is enough to show the instances without loading them. Each entry remembers the size and
+ * modification time of the instance.cfg it was made from and is only used while those stay the
+ * same.
+ */
+namespace InstanceCatalog
+{
+struct Entry
+{
+	/// the instance folder, as the instance list found it
+	QString path;
+	qint64 cfgSize = -1;
+	qint64 cfgModified = 0;
+	/// inode of the instance.cfg, which stays the same when the folder is renamed. 0 if unknown.
+	quint64 cfgFileId = 0;
+
+	QString name;
+	QString iconKey;
+	QString instanceType;
+	QString intendedVersion;
+	qint64 lastLaunch = 0;
+	int flags = 0;
+
+	/// the id of the instance, its folder name
+	QString id() const
+	{
+		return QFileInfo(path).fileName();
+	}
+};
+
+/// true for the instance types the instance factory can load
+bool isKnownType(const QString &instanceType);
+
+/// make an entry from the contents of the instance.cfg in 'path'
+Entry fromSettings(const QString &path, const INIFile &settings);
+
+/// make an entry from a loaded instance
+Entry fromInstance(BaseInstance *instance);
+
+/// remember the current size and modification time of the entry's instance.cfg
+void stamp(Entry &entry);
+
+/// remember the size, modification time and file id of 'cfg' as those of the entry's
+/// instance.cfg
+void stamp(Entry &entry, const QFileInfo &cfg);
+
+/// true if the instance.cfg described by 'cfg' is the one the entry was made from
+bool isCurrent(const Entry &entry, const QFileInfo &cfg);
+
+/// the entries stored in 'path'. empty if there are none or they can't be read.
+QList<Entry> load(const QString &path);
+
+/// store 'entries' in 'path'. Failures are logged and otherwise ignored.
+void save(const QString &path, const QList<Entry> &entries);
+}
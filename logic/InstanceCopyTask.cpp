@@ -0,0 +1,340 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceCopyTask.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
+#include <pathutils.h>
+
+#include "logic/InstanceFactory.h"
+#include "logger/QsLog.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
+namespace
+{
+/// mods and resource packs are replaced when they change, never changed in place
+bool isImmutable(const QString &relative)
+{
+	static const QStringList folders = {"mods",		"coremods",		 "jarmods",
+										"instMods", "resourcepacks", "texturepacks"};
+	static const QStringList suffixes = {"jar", "zip", "litemod"};
+	if (!suffixes.contains(QFileInfo(relative).suffix(), Qt::CaseInsensitive))
+		return false;
+	auto parts = relative.split('/');
+	for (int i = 0; i < parts.size() - 1; i++)
+	{
+		if (folders.contains(parts[i]))
+			return true;
+	}
+	return false;
+}
+
+#ifdef Q_OS_LINUX
+enum KernelCopyResult
+{
+	Copied,
+	NotSupported,
+	CopyFailed
+};
+
+QString errnoString()
+{
+	return QString::fromLocal8Bit(strerror(errno));
+}
+
+/// share the blocks of the file, or let the kernel copy it without going through user space
+KernelCopyResult kernelCopy(const QString &from, const QString &to, QString &error)
+{
+	int in = open(QFile::encodeName(from).constData(), O_RDONLY | O_CLOEXEC);
+	if (in == -1)
+		return NotSupported;
+	struct stat info;
+	if (fstat(in, &info) == -1)
+	{
+		close(in);
+		return NotSupported;
+	}
+	int out = open(QFile::encodeName(to).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+				   info.st_mode & 0777);
+	if (out == -1)
+	{
+		error = errnoString();
+		close(in);
+		return CopyFailed;
+	}
+
+	KernelCopyResult result = Copied;
+	if (ioctl(out, FICLONE, in) == -1)
+	{
+#ifdef __NR_copy_file_range
+		off_t remaining = info.st_size;
+		while (remaining > 0)
+		{
+			ssize_t copied = syscall(__NR_copy_file_range, in, nullptr, out, nullptr,
+									 (size_t)remaining, 0);
+			if (copied > 0)
+			{
+				remaining -= copied;
+				continue;
+			}
+			// the file got shorter while copying it
+			if (copied == 0)
+				break;
+			// an old kernel, or across file systems. nothing was written yet.
+			if (remaining == info.st_size &&
+				(errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))
+			{
+				result = NotSupported;
+			}
+			else
+			{
+				error = errnoString();
+				result = CopyFailed;
+			}
+			break;
+		}
+#else
+		result = NotSupported;
+#endif
+	}
+	close(in);
+	if (close(out) == -1 && result == Copied)
+	{
+		error = errnoString();
+		result = CopyFailed;
+	}
+	if (result != Copied)
+		unlink(QFile::encodeName(to).constData());
+	return result;
+}
+#endif
+}
+
+InstanceCopyTask::InstanceCopyTask(InstancePtr source, const QString &instDir,
+								   bool linkImmutable, QObject *parent)
+	: Task(parent), m_source(source), m_instDir(instDir), m_linkImmutable(linkImmutable)
+{
+	connect(&m_scanWatcher, SIGNAL(finished()), SLOT(scanFinished()));
+	connect(&m_copyWatcher, SIGNAL(resultReadyAt(int)), SLOT(fileCopied(int)));
+	connect(&m_copyWatcher, SIGNAL(finished()), SLOT(copyFinished()));
+}
+
+void InstanceCopyTask::executeTask()
+{
+	setStatus(tr("Looking at the files of %1...").arg(m_source->name()));
+	// the copy is made from what is on disk
+	m_source->settings().flush();
+	m_scanWatcher.setFuture(QtConcurrent::run(&InstanceCopyTask::scan, m_source->instanceRoot(),
+											  m_instDir, m_linkImmutable));
+}
+
+void InstanceCopyTask::abort()
+{
+	m_aborted = true;
+	m_copyWatcher.cancel();
+}
+
+InstanceCopyTask::Scan InstanceCopyTask::scan(const QString &from, const QString &to,
+											  bool linkImmutable)
+{
+	Scan result;
+	QDir source(from);
+	if (!source.exists())
+	{
+		result.error = tr("The instance folder %1 doesn't exist.").arg(from);
+		return result;
+	}
+	if (QFileInfo(to).exists())
+	{
+		result.error = tr("An instance with the given directory name already exists.");
+		return result;
+	}
+	if (!QDir().mkpath(to))
+	{
+		result.error = tr("Failed to create the instance directory.");
+		return result;
+	}
+	result.created = true;
+
+	QDirIterator iter(from, QDir::AllEntries | QDir::Hidden | QDir::System |
+								QDir::NoDotAndDotDot,
+					  QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+	while (iter.hasNext())
+	{
+		iter.next();
+		auto info = iter.fileInfo();
+		QString relative = source.relativeFilePath(info.filePath());
+		QString target = PathCombine(to, relative);
+		if (info.isDir())
+		{
+			if (!QDir().mkpath(target))
+			{
+				result.error = tr("Failed to create the folder %1.").arg(target);
+				return result;
+			}
+			continue;
+		}
+		File file;
+		file.from = info.filePath();
+		file.to = target;
+		file.size = info.size();
+		file.link = linkImmutable && isImmutable(relative);
+		result.bytes += file.size;
+		result.files.append(file);
+	}
+	return result;
+}
+
+QString InstanceCopyTask::Copier::operator()(const File &file) const
+{
+#ifdef Q_OS_UNIX
+	if (file.link)
+	{
+		if (::link(QFile::encodeName(file.from).constData(),
+				   QFile::encodeName(file.to).constData()) == 0)
+			return QString();
+		// a different file system, or no hardlinks on it. it gets copied instead.
+	}
+#endif
+#ifdef Q_OS_LINUX
+	QString error;
+	switch (kernelCopy(file.from, file.to, error))
+	{
+	case Copied:
+		return QString();
+	case CopyFailed:
+		return QString("%1: %2").arg(file.from, error);
+	case NotSupported:
+		break;
+	}
+#endif
+	QFile source(file.from);
+	if (!source.copy(file.to))
+		return QString("%1: %2").arg(file.from, source.errorString());
+	return QString();
+}
+
+void InstanceCopyTask::scanFinished()
+{
+	auto result = m_scanWatcher.result();
+	m_created = result.created;
+	if (!result.error.isEmpty())
+	{
+		rollback(result.error);
+		return;
+	}
+	if (m_aborted)
+	{
+		rollback(tr("Copying was aborted."));
+		return;
+	}
+	m_files = result.files;
+	m_totalBytes = result.bytes;
+	m_copiedBytes = 0;
+	QLOG_INFO() << "Copying" << m_files.size() << "files," << m_totalBytes << "bytes, from"
+				<< m_source->instanceRoot() << "to" << m_instDir;
+	setStatus(tr("Copying %1 files...").arg(m_files.size()));
+	m_copyWatcher.setFuture(QtConcurrent::mapped(m_files, Copier()));
+}
+
+void InstanceCopyTask::fileCopied(int index)
+{
+	m_copiedBytes += m_files[index].size;
+	if (m_totalBytes > 0)
+		setProgress(m_copiedBytes * 100 / m_totalBytes);
+}
+
+void InstanceCopyTask::copyFinished()
+{
+	if (m_aborted)
+	{
+		rollback(tr("Copying was aborted."));
+		return;
+	}
+	QStringList errors;
+	auto future = m_copyWatcher.future();
+	for (int i = 0; i < future.resultCount(); i++)
+	{
+		if (!future.resultAt(i).isEmpty())
+			errors.append(future.resultAt(i));
+	}
+	if (!errors.isEmpty())
+	{
+		for (auto error : errors)
+			QLOG_ERROR() << "Failed to copy" << error;
+		rollback(tr("%1 files could not be copied, the first one was %2")
+					 .arg(errors.size())
+					 .arg(errors.first()));
+		return;
+	}
+
+	auto error = InstanceFactory::get().setUpCopy(m_instance, m_source, m_instDir);
+	switch (error)
+	{
+	case InstanceFactory::NoCreateError:
+		emitSucceeded();
+		return;
+	case InstanceFactory::CantCreateDir:
+		rollback(tr("Failed to create the instance directory."));
+		return;
+	default:
+		rollback(tr("Unknown instance loader error %1").arg(error));
+		return;
+	}
+}
+
+void InstanceCopyTask::rollback(const QString &reason)
+{
+	m_instance.reset();
+	if (m_created)
+	{
+		QLOG_INFO() << "Removing the incomplete copy" << m_instDir;
+		QDir(m_instDir).removeRecursively();
+	}
+	emitFailed(reason);
+}
+
+QString InstanceCopyTask::copyFiles(const QString &from, const QString &to, bool linkImmutable)
+{
+	auto result = scan(from, to, linkImmutable);
+	if (result.error.isEmpty())
+	{
+		auto errors = QtConcurrent::blockingMapped<QStringList>(result.files, Copier());
+		errors.removeAll(QString());
+		if (!errors.isEmpty())
+			result.error = errors.first();
+	}
+	if (!result.error.isEmpty() && result.created)
+		QDir(to).removeRecursively();
+	return result.error;
+}
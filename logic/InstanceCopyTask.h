@@ -0,0 +1,101 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QStringList>
+
+#include "logic/BaseInstance.h"
+#include "logic/tasks/Task.h"
+
+/**
+ * Copies an instance into a new folder and loads the copy.
+ *
+ * The files are copied on worker threads. Where the file system can do it, the copies share
+ * their blocks with the originals (reflinks), otherwise the kernel copies them. Optionally, the
+ * mods and resource packs, which are replaced rather than changed, are hardlinked instead.
+ *
+ * If any file can't be copied, the new folder is removed again.
+ */
+class InstanceCopyTask : public Task
+{
+	Q_OBJECT
+public:
+	explicit InstanceCopyTask(InstancePtr source, const QString &instDir, bool linkImmutable,
+							  QObject *parent = 0);
+
+	/// the new instance, once the task succeeded
+	InstancePtr instance() const
+	{
+		return m_instance;
+	}
+
+	/// copy the files from 'from' to the new folder 'to' right away. returns an error, if any
+	static QString copyFiles(const QString &from, const QString &to, bool linkImmutable);
+
+public
+slots:
+	virtual void abort();
+
+protected:
+	virtual void executeTask();
+
+private
+slots:
+	void scanFinished();
+	void fileCopied(int index);
+	void copyFinished();
+
+private:
+	struct File
+	{
+		QString from;
+		QString to;
+		qint64 size = 0;
+		/// hardlink it, if possible
+		bool link = false;
+	};
+	struct Scan
+	{
+		QList<File> files;
+		qint64 bytes = 0;
+		/// false if the target folder was there already, so it must not be removed
+		bool created = false;
+		QString error;
+	};
+	/// list the files to copy and create the folders for them
+	static Scan scan(const QString &from, const QString &to, bool linkImmutable);
+	struct Copier
+	{
+		typedef QString result_type;
+		/// copies one file. returns an error, if any
+		QString operator()(const File &file) const;
+	};
+	void rollback(const QString &reason);
+
+	InstancePtr m_source;
+	QString m_instDir;
+	bool m_linkImmutable;
+	InstancePtr m_instance;
+
+	QFutureWatcher<Scan> m_scanWatcher;
+	QFutureWatcher<QString> m_copyWatcher;
+	QList<File> m_files;
+	qint64 m_totalBytes = 0;
+	qint64 m_copiedBytes = 0;
+	bool m_created = false;
+	bool m_aborted = false;
+};
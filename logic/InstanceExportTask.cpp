@@ -0,0 +1,336 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceExportTask.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <quazip.h>
+#include <quazipfile.h>
+#include <zlib.h>
+#include <string.h>
+
+#include "logger/QsLog.h"
+
+// files bigger than this are compressed in pieces of this size, in parallel like the small ones
+static const qint64 maxPieceSize = 4 * 1024 * 1024;
+// how much memory the compression ahead of the writer may hold
+static const qint64 maxBytesInFlight = 256 * 1024 * 1024;
+static const qint64 copyChunkSize = 1024 * 1024;
+// minizip can't write zip64 archives, sizes and offsets have to fit into 32 bits
+static const qint64 maxZipSize = 0xFFFFFFFFLL;
+
+namespace
+{
+/// memory a piece holds from being compressed until it's written: the data and its deflate
+qint64 packCost(qint64 size, bool store)
+{
+	if (store)
+		return 0;
+	return 2 * size;
+}
+
+/// start a deflated entry whose data is put in as it is, like QuaZipFile does in raw mode
+bool openRawEntry(QuaZip &zip, const QString &name, const QString &path)
+{
+	QuaZipNewInfo info(name, path);
+	zip_fileinfo info_z;
+	memset(&info_z, 0, sizeof(info_z));
+	info_z.tmz_date.tm_year = info.dateTime.date().year();
+	info_z.tmz_date.tm_mon = info.dateTime.date().month() - 1;
+	info_z.tmz_date.tm_mday = info.dateTime.date().day();
+	info_z.tmz_date.tm_hour = info.dateTime.time().hour();
+	info_z.tmz_date.tm_min = info.dateTime.time().minute();
+	info_z.tmz_date.tm_sec = info.dateTime.time().second();
+	return zipOpenNewFileInZip3(zip.getZipFile(),
+								zip.getFileNameCodec()->fromUnicode(name).constData(), &info_z,
+								NULL, 0, NULL, 0, NULL, Z_DEFLATED, Z_DEFAULT_COMPRESSION, 1,
+								-MAX_WBITS, 8, Z_DEFAULT_STRATEGY, NULL, 0) == ZIP_OK;
+}
+
+bool isCompressed(const QString &name)
+{
+	static const QStringList suffixes = {"jar", "zip", "litemod", "png", "jpg", "ogg",
+										 "mp3", "gz",  "xz",	  "lzma"};
+	return suffixes.contains(QFileInfo(name).suffix(), Qt::CaseInsensitive);
+}
+}
+
+InstanceExportTask::InstanceExportTask(InstancePtr instance, const QString &archivePath,
+									   bool skipRegenerable, QObject *parent)
+	: Task(parent), m_instance(instance), m_root(instance->instanceRoot()),
+	  m_archivePath(archivePath), m_skipRegenerable(skipRegenerable)
+{
+	connect(&m_writeWatcher, SIGNAL(finished()), SLOT(writeFinished()));
+	m_progressTimer.setInterval(100);
+	connect(&m_progressTimer, SIGNAL(timeout()), SLOT(updateProgress()));
+}
+
+bool InstanceExportTask::isRegenerable(const QString &relativePath)
+{
+	// extracted natives, the runnable jar of legacy instances, which is rebuilt from the base jar
+	// and the jar mods, and the assets legacy instances get copied in
+	static const QStringList folders = {"natives", "bin/natives", "resources"};
+	static const QStringList files = {"bin/minecraft.jar"};
+	QString path = relativePath;
+	for (auto mcRoot : {"minecraft/", ".minecraft/"})
+	{
+		if (path.startsWith(mcRoot))
+		{
+			path = path.mid(QString(mcRoot).size());
+			if (files.contains(path))
+				return true;
+			break;
+		}
+	}
+	for (auto folder : folders)
+	{
+		if (path.startsWith(folder + "/"))
+			return true;
+	}
+	return false;
+}
+
+void InstanceExportTask::executeTask()
+{
+	setStatus(tr("Exporting %1...").arg(m_instance->name()));
+	// the archive is made from what is on disk
+	m_instance->settings().flush();
+	m_written.store(0);
+	m_total.store(0);
+	m_aborted.store(0);
+	m_progressTimer.start();
+	m_writeWatcher.setFuture(QtConcurrent::run(this, &InstanceExportTask::writeArchive));
+}
+
+void InstanceExportTask::abort()
+{
+	m_aborted.store(1);
+}
+
+void InstanceExportTask::updateProgress()
+{
+	int total = m_total.load();
+	if (total > 0)
+		setProgress(qint64(m_written.load()) * 100 / total);
+}
+
+void InstanceExportTask::writeFinished()
+{
+	m_progressTimer.stop();
+	QString error = m_writeWatcher.result();
+	if (!error.isEmpty())
+	{
+		QLOG_ERROR() << "Failed to export" << m_root << "to" << m_archivePath << ":" << error;
+		emitFailed(error);
+		return;
+	}
+	QLOG_INFO() << "Exported" << m_root << "to" << m_archivePath;
+	emitSucceeded();
+}
+
+InstanceExportTask::Packed InstanceExportTask::pack(const Entry &entry, const Piece &piece)
+{
+	Packed result;
+	if (entry.store)
+		return result;
+	QFile file(entry.path);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(piece.offset))
+	{
+		result.error = tr("Could not read %1: %2").arg(entry.path, file.errorString());
+		return result;
+	}
+	QByteArray input = file.read(piece.size);
+	if (input.size() != piece.size)
+	{
+		result.error = tr("Could not read %1: %2").arg(entry.path, file.errorString());
+		return result;
+	}
+
+	// the same raw deflate stream QuaZipFile would write. the pieces before the last one end
+	// byte aligned without a final block, so they can be put one after the other.
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+					 Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		result.error = tr("Could not compress %1").arg(entry.path);
+		return result;
+	}
+	// the bound is for finished streams, a flush adds an empty block of a few bytes
+	result.data.resize(deflateBound(&stream, input.size()) + 16);
+	stream.next_in = (Bytef *)input.data();
+	stream.avail_in = input.size();
+	stream.next_out = (Bytef *)result.data.data();
+	stream.avail_out = result.data.size();
+	int status = deflate(&stream, piece.last ? Z_FINISH : Z_SYNC_FLUSH);
+	result.data.resize(stream.total_out);
+	deflateEnd(&stream);
+	bool done = piece.last ? status == Z_STREAM_END
+						   : status == Z_OK && stream.avail_in == 0 && stream.avail_out != 0;
+	if (!done)
+	{
+		result.data.clear();
+		result.error = tr("Could not compress %1").arg(entry.path);
+		return result;
+	}
+	result.crc = crc32(crc32(0, Z_NULL, 0), (const Bytef *)input.constData(), input.size());
+	result.size = input.size();
+	result.packed = true;
+	return result;
+}
+
+QString InstanceExportTask::writeArchive()
+{
+	QList<Entry> entries;
+	QList<Piece> pieces;
+	qint64 total = 0;
+	QDir root(m_root);
+	QDirIterator iter(m_root, QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+					  QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		Entry entry;
+		entry.path = iter.next();
+		entry.name = root.relativeFilePath(entry.path);
+		if (m_skipRegenerable && isRegenerable(entry.name))
+			continue;
+		entry.size = iter.fileInfo().size();
+		entry.store = isCompressed(entry.name);
+		if (entry.size > maxZipSize)
+			return tr("%1 is bigger than 4 GiB, which zip files can't hold.").arg(entry.name);
+		total += entry.size;
+		if (total > maxZipSize)
+			return tr("The instance is bigger than 4 GiB, which zip files can't hold.");
+
+		// stored files are copied by the writer in one go
+		Piece piece;
+		piece.entry = entries.size();
+		do
+		{
+			piece.size = entry.store ? entry.size : qMin(maxPieceSize, entry.size - piece.offset);
+			piece.last = piece.offset + piece.size >= entry.size;
+			pieces.append(piece);
+			piece.offset += piece.size;
+		} while (!piece.last);
+		entries.append(entry);
+	}
+	m_total.store(int(total / 1024));
+
+	// written next to the target and moved over it at the end, so a failed export doesn't
+	// leave a broken archive behind
+	QString partPath = m_archivePath + ".part";
+	QuaZip zip(partPath);
+	if (!zip.open(QuaZip::mdCreate))
+		return tr("Could not create %1").arg(partPath);
+
+	// the compression runs ahead of the writing, as far as the memory it may use allows. the
+	// piece that is written next is always started, whatever it costs.
+	const int maxInFlight = QThread::idealThreadCount() * 2;
+	QList<QFuture<Packed>> window;
+	int next = 0;
+	qint64 bytesInFlight = 0;
+	qint64 written = 0;
+	quint32 crc = 0;
+	QString error;
+	for (int i = 0; i < pieces.size() && error.isEmpty(); i++)
+	{
+		while (next < pieces.size() && next - i < maxInFlight)
+		{
+			const Piece &piece = pieces[next];
+			const Entry &entry = entries[piece.entry];
+			qint64 cost = packCost(piece.size, entry.store);
+			if (next > i && bytesInFlight + cost > maxBytesInFlight)
+				break;
+			bytesInFlight += cost;
+			window.append(QtConcurrent::run(&InstanceExportTask::pack, entry, piece));
+			next++;
+		}
+		Packed packed = window.takeFirst().result();
+		if (m_aborted.load())
+		{
+			error = tr("Exporting was aborted.");
+			break;
+		}
+		if (!packed.error.isEmpty())
+		{
+			error = packed.error;
+			break;
+		}
+
+		const Piece &piece = pieces[i];
+		const Entry &entry = entries[piece.entry];
+		if (packed.packed)
+		{
+			if (piece.offset == 0 && !openRawEntry(zip, entry.name, entry.path))
+				error = tr("Could not add %1 to the archive").arg(entry.name);
+			else if (zipWriteInFileInZip(zip.getZipFile(), packed.data.constData(),
+										 packed.data.size()) != ZIP_OK)
+				error = tr("Could not add %1 to the archive").arg(entry.name);
+			crc = piece.offset == 0 ? packed.crc : crc32_combine(crc, packed.crc, packed.size);
+			if (error.isEmpty() && piece.last &&
+				zipCloseFileInZipRaw(zip.getZipFile(), entry.size, crc) != ZIP_OK)
+				error = tr("Could not add %1 to the archive").arg(entry.name);
+		}
+		else
+		{
+			QuaZipNewInfo info(entry.name, entry.path);
+			QuaZipFile out(&zip);
+			QFile in(entry.path);
+			if (!in.open(QIODevice::ReadOnly))
+			{
+				error = tr("Could not read %1: %2").arg(entry.path, in.errorString());
+			}
+			else if (!out.open(QIODevice::WriteOnly, info, NULL, 0, 0))
+			{
+				error = tr("Could not add %1 to the archive").arg(entry.name);
+			}
+			while (error.isEmpty() && !in.atEnd())
+			{
+				QByteArray chunk = in.read(copyChunkSize);
+				if (chunk.isEmpty() || out.write(chunk) != chunk.size())
+					error = tr("Could not add %1 to the archive").arg(entry.name);
+			}
+			if (out.isOpen())
+				out.close();
+			if (error.isEmpty() && out.getZipError() != UNZ_OK)
+				error = tr("Could not add %1 to the archive").arg(entry.name);
+		}
+		bytesInFlight -= packCost(piece.size, entry.store);
+		written += piece.size;
+		m_written.store(int(written / 1024));
+	}
+	// the ones still being compressed
+	for (auto &future : window)
+	{
+		future.waitForFinished();
+	}
+
+	zip.close();
+	if (error.isEmpty() && zip.getZipError() != UNZ_OK)
+		error = tr("Could not finish the archive %1").arg(partPath);
+	if (error.isEmpty())
+	{
+		QFile::remove(m_archivePath);
+		if (!QFile::rename(partPath, m_archivePath))
+			error = tr("Could not move the archive to %1").arg(m_archivePath);
+	}
+	if (!error.isEmpty())
+		QFile::remove(partPath);
+	return error;
+}
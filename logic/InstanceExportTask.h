@@ -0,0 +1,95 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QTimer>
+
+#include "logic/BaseInstance.h"
+#include "logic/tasks/Task.h"
+
+/**
+ * Packs an instance folder into a zip file.
+ *
+ * The entries are compressed on worker threads ahead of the one writing the archive, which only
+ * has to copy the compressed data. Big files are compressed in pieces. Files that are compressed
+ * already (jars, zips, images, sounds) are stored as they are. The files MultiMC makes again when needed, like extracted
+ * natives, can be left out.
+ */
+class InstanceExportTask : public Task
+{
+	Q_OBJECT
+public:
+	explicit InstanceExportTask(InstancePtr instance, const QString &archivePath,
+								bool skipRegenerable, QObject *parent = 0);
+
+	/// true for the files of an instance that are made again when needed
+	static bool isRegenerable(const QString &relativePath);
+
+public
+slots:
+	virtual void abort();
+
+protected:
+	virtual void executeTask();
+
+private
+slots:
+	void updateProgress();
+	void writeFinished();
+
+private:
+	struct Entry
+	{
+		QString name;
+		QString path;
+		qint64 size = 0;
+		bool store = false;
+	};
+	/// a part of an entry that is compressed on its own
+	struct Piece
+	{
+		int entry = 0;
+		qint64 offset = 0;
+		qint64 size = 0;
+		bool last = false;
+	};
+	struct Packed
+	{
+		/// raw deflate data of a piece, empty if the writer has to read the file itself
+		QByteArray data;
+		quint32 crc = 0;
+		qint64 size = 0;
+		bool packed = false;
+		QString error;
+	};
+	static Packed pack(const Entry &entry, const Piece &piece);
+	/// runs on a worker thread. returns an error, if any
+	QString writeArchive();
+
+	InstancePtr m_instance;
+	QString m_root;
+	QString m_archivePath;
+	bool m_skipRegenerable;
+
+	QFutureWatcher<QString> m_writeWatcher;
+	QTimer m_progressTimer;
+	/// updated by the worker thread, in KiB
+	QAtomicInt m_written;
+	QAtomicInt m_total;
+	QAtomicInt m_aborted;
+};
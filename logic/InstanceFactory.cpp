@@ -24,6 +24,7 @@
 #include "logger/QsLog.h"
 
 #include "logic/InstanceFactory.h"
+#include "logic/InstanceCopyTask.h"
 
 #include "logic/BaseInstance.h"
 #include "logic/LegacyInstance.h"
@@ -43,7 +44,16 @@ InstanceFactory::InstanceFactory() : QObject(NULL)
 InstanceFactory::InstLoadError InstanceFactory::loadInstance(InstancePtr &inst,
 															 const QString &instDir)
 {
-	auto m_settings = new INISettingsObject(PathCombine(instDir, "instance.cfg"));
+	INIFile settings;
+	settings.loadFile(PathCombine(instDir, "instance.cfg"));
+	return loadInstance(inst, instDir, settings);
+}
+
+InstanceFactory::InstLoadError InstanceFactory::loadInstance(InstancePtr &inst,
+															 const QString &instDir,
+															 const INIFile &settings)
+{
+	auto m_settings = new INISettingsObject(PathCombine(instDir, "instance.cfg"), settings);
 
 	m_settings->registerSetting("InstanceType", "Legacy");
 
@@ -135,14 +145,22 @@ InstanceFactory::InstCreateError InstanceFactory::copyInstance(InstancePtr &newI
 															   InstancePtr &oldInstance,
 															   const QString &instDir)
 {
-	QDir rootDir(instDir);
-
 	QLOG_DEBUG() << instDir.toUtf8();
-	if (!copyPath(oldInstance->instanceRoot(), instDir))
+	oldInstance->settings().flush();
+	QString error = InstanceCopyTask::copyFiles(oldInstance->instanceRoot(), instDir, false);
+	if (!error.isEmpty())
 	{
-		rootDir.removeRecursively();
+		QLOG_ERROR() << "Failed to copy" << oldInstance->instanceRoot() << ":" << error;
 		return InstanceFactory::CantCreateDir;
 	}
+	return setUpCopy(newInstance, oldInstance, instDir);
+}
+
+InstanceFactory::InstCreateError InstanceFactory::setUpCopy(InstancePtr &newInstance,
+															InstancePtr &oldInstance,
+															const QString &instDir)
+{
+	QDir rootDir(instDir);
 
 	INISettingsObject settings_obj(PathCombine(instDir, "instance.cfg"));
 	settings_obj.registerSetting("InstanceType", "Legacy");
@@ -152,6 +170,7 @@ InstanceFactory::InstCreateError InstanceFactory::copyInstance(InstancePtr &newI
 		settings_obj.set("InstanceType", "OneSix");
 	if (inst_type == "LegacyFTB")
 		settings_obj.set("InstanceType", "Legacy");
+	settings_obj.flush();
 
 	oldInstance->copy(instDir);
 
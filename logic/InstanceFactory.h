@@ -21,6 +21,7 @@
 
 #include "BaseVersion.h"
 #include "BaseInstance.h"
+#include "logic/settings/INIFile.h"
 
 struct BaseVersion;
 class BaseInstance;
@@ -89,6 +90,19 @@ public:
 	InstCreateError copyInstance(InstancePtr &newInstance, InstancePtr &oldInstance,
 								 const QString &instDir);
 
+	/*!
+	 * \brief Turns a copy of an instance's files into an instance
+	 *
+	 * This is the part of copyInstance that comes after copying the files, for when they are
+	 * copied some other way, like by InstanceCopyTask.
+	 * \param newInstance Pointer to store the created instance in.
+	 * \param oldInstance The instance that was copied
+	 * \param instDir The new instance's directory, with the copied files in it.
+	 * \return An InstCreateError error code.
+	 */
+	InstCreateError setUpCopy(InstancePtr &newInstance, InstancePtr &oldInstance,
+							  const QString &instDir);
+
 	/*!
 	 * \brief Loads an instance from the given directory.
 	 * Checks the instance's INI file to figure out what the instance's type is first.
@@ -99,6 +113,13 @@ public:
 	 */
 	InstLoadError loadInstance(InstancePtr &inst, const QString &instDir);
 
+	/*!
+	 * \brief Loads an instance from the given directory, with the contents of its INI file
+	 * already read.
+	 */
+	InstLoadError loadInstance(InstancePtr &inst, const QString &instDir,
+							   const INIFile &settings);
+
 private:
 	InstanceFactory();
 
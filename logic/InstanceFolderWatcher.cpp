@@ -0,0 +1,263 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceFolderWatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+#include <pathutils.h>
+
+#include "logger/QsLog.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// how long to collect changes before reporting them, in ms
+static const int coalesceDelay = 500;
+// how often to look for the instance folder after it is gone, in ms
+static const int rearmDelay = 5000;
+
+InstanceFolderWatcher::InstanceFolderWatcher(QObject *parent) : QObject(parent)
+{
+	m_flushTimer.setSingleShot(true);
+	m_flushTimer.setInterval(coalesceDelay);
+	connect(&m_flushTimer, SIGNAL(timeout()), SLOT(flush()));
+	m_rearmTimer.setInterval(rearmDelay);
+	connect(&m_rearmTimer, SIGNAL(timeout()), SLOT(rearmRoot()));
+
+#ifdef Q_OS_LINUX
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotify != -1)
+	{
+		m_notifier = new QSocketNotifier(m_inotify, QSocketNotifier::Read, this);
+		connect(m_notifier, SIGNAL(activated(int)), SLOT(inotifyReady()));
+		return;
+	}
+	QLOG_WARN() << "inotify is not available, watching the instance folder the slow way";
+#endif
+	m_watcher = new QFileSystemWatcher(this);
+	connect(m_watcher, SIGNAL(directoryChanged(QString)), SLOT(directoryChanged(QString)));
+}
+
+InstanceFolderWatcher::~InstanceFolderWatcher()
+{
+#ifdef Q_OS_LINUX
+	if (m_inotify != -1)
+	{
+		delete m_notifier;
+		close(m_inotify);
+	}
+#endif
+}
+
+void InstanceFolderWatcher::setRoot(const QString &root)
+{
+	m_changed.clear();
+	m_overflow = false;
+	m_flushTimer.stop();
+	m_rearmTimer.stop();
+	m_root = root;
+
+#ifdef Q_OS_LINUX
+	if (m_inotify != -1)
+	{
+		// events still queued for the old watches name descriptors that aren't known anymore
+		// and are skipped. descriptors are not reused right away.
+		if (m_rootWatch != -1)
+			inotify_rm_watch(m_inotify, m_rootWatch);
+		for (auto iter = m_folderWatches.begin(); iter != m_folderWatches.end(); iter++)
+			inotify_rm_watch(m_inotify, iter.key());
+		m_folderWatches.clear();
+		if (watchRoot())
+			QLOG_INFO() << "Started watching" << root;
+		else
+			QLOG_WARN() << "Failed to start watching" << root;
+		return;
+	}
+#endif
+	if (!m_watcher->directories().isEmpty())
+		m_watcher->removePaths(m_watcher->directories());
+	m_listing = listFolders();
+	if (m_watcher->addPath(root))
+		QLOG_INFO() << "Started watching" << root;
+	else
+		QLOG_WARN() << "Failed to start watching" << root;
+}
+
+bool InstanceFolderWatcher::watchRoot()
+{
+#ifdef Q_OS_LINUX
+	m_rootWatch = inotify_add_watch(m_inotify, QFile::encodeName(m_root).constData(),
+									IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+										IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	return m_rootWatch != -1;
+#else
+	return false;
+#endif
+}
+
+void InstanceFolderWatcher::rearmRoot()
+{
+	if (!watchRoot())
+		return;
+	QLOG_INFO() << "Watching" << m_root << "again";
+	m_rearmTimer.stop();
+	// anything could have been put there in the meantime
+	m_overflow = true;
+	if (!m_flushTimer.isActive())
+		m_flushTimer.start();
+}
+
+void InstanceFolderWatcher::watchFolder(const QString &name)
+{
+	QString path = PathCombine(m_root, name);
+#ifdef Q_OS_LINUX
+	if (m_inotify != -1)
+	{
+		int wd = inotify_add_watch(m_inotify, QFile::encodeName(path).constData(),
+								   IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR);
+		if (wd != -1)
+			m_folderWatches.insert(wd, name);
+		return;
+	}
+#endif
+	m_watcher->addPath(path);
+}
+
+void InstanceFolderWatcher::unwatchFolder(const QString &name)
+{
+#ifdef Q_OS_LINUX
+	if (m_inotify != -1)
+	{
+		int wd = m_folderWatches.key(name, -1);
+		if (wd != -1)
+		{
+			inotify_rm_watch(m_inotify, wd);
+			m_folderWatches.remove(wd);
+		}
+		return;
+	}
+#endif
+	QString path = PathCombine(m_root, name);
+	if (m_watcher->directories().contains(path))
+		m_watcher->removePath(path);
+}
+
+void InstanceFolderWatcher::inotifyReady()
+{
+#ifdef Q_OS_LINUX
+	alignas(inotify_event) char buffer[4096];
+	bool rootLost = false;
+	ssize_t length;
+	while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+	{
+		ssize_t offset = 0;
+		while (offset < length)
+		{
+			auto event = reinterpret_cast<const inotify_event *>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				m_overflow = true;
+				continue;
+			}
+			if (event->wd == m_rootWatch)
+			{
+				if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+				{
+					rootLost = true;
+					continue;
+				}
+				// the files in there are ours, instances are folders
+				if ((event->mask & IN_ISDIR) && event->len)
+					changed(QFile::decodeName(event->name));
+				continue;
+			}
+			auto iter = m_folderWatches.find(event->wd);
+			if (iter == m_folderWatches.end())
+				continue;
+			changed(*iter);
+			// the folder itself is gone
+			if (event->mask & IN_IGNORED)
+				m_folderWatches.erase(iter);
+		}
+	}
+	if (rootLost)
+	{
+		// the instance folder was removed or moved away. a moved one is still watched.
+		QLOG_WARN() << "The instance folder" << m_root << "is gone";
+		inotify_rm_watch(m_inotify, m_rootWatch);
+		m_rootWatch = -1;
+		m_overflow = true;
+		// the folder may be back already, otherwise look for it once in a while
+		if (watchRoot())
+			QLOG_INFO() << "Watching" << m_root << "again";
+		else
+			m_rearmTimer.start();
+	}
+	if (m_overflow && !m_flushTimer.isActive())
+		m_flushTimer.start();
+#endif
+}
+
+void InstanceFolderWatcher::directoryChanged(const QString &path)
+{
+	if (path != m_root)
+	{
+		changed(QFileInfo(path).fileName());
+		return;
+	}
+	// the folders that appeared or disappeared
+	auto listing = listFolders();
+	for (auto name : (listing - m_listing) + (m_listing - listing))
+	{
+		changed(name);
+	}
+	m_listing = listing;
+}
+
+void InstanceFolderWatcher::changed(const QString &name)
+{
+	m_changed.insert(name);
+	// not restarted, so a steady stream of changes still gets reported
+	if (!m_flushTimer.isActive())
+		m_flushTimer.start();
+}
+
+void InstanceFolderWatcher::flush()
+{
+	if (m_overflow)
+	{
+		m_overflow = false;
+		m_changed.clear();
+		emit foldersChanged(QStringList());
+		return;
+	}
+	if (m_changed.isEmpty())
+		return;
+	QStringList names = m_changed.toList();
+	m_changed.clear();
+	emit foldersChanged(names);
+}
+
+QSet<QString> InstanceFolderWatcher::listFolders() const
+{
+	return QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot).toSet();
+}
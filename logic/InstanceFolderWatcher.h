@@ -0,0 +1,81 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <QSet>
+#include <QHash>
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+
+/**
+ * Tells which folders in the instance folder were added, removed or renamed.
+ *
+ * On Linux this uses inotify, which names the folders. Elsewhere a QFileSystemWatcher is used
+ * and the folder is listed again to find out what changed. Changes are collected for a moment
+ * and reported together.
+ */
+class InstanceFolderWatcher : public QObject
+{
+	Q_OBJECT
+public:
+	explicit InstanceFolderWatcher(QObject *parent = 0);
+	virtual ~InstanceFolderWatcher();
+
+	/// watch 'root' instead of the folder watched before
+	void setRoot(const QString &root);
+
+	/// also report changes inside the folder 'name', for folders that aren't instances yet
+	void watchFolder(const QString &name);
+	void unwatchFolder(const QString &name);
+
+signals:
+	/// the folders that changed. empty if anything could have changed.
+	void foldersChanged(QStringList names);
+
+private
+slots:
+	void inotifyReady();
+	void directoryChanged(const QString &path);
+	void flush();
+	/// try to watch the instance folder again after it was gone
+	void rearmRoot();
+
+private:
+	bool watchRoot();
+	void changed(const QString &name);
+	QSet<QString> listFolders() const;
+
+	QString m_root;
+	QSet<QString> m_changed;
+	bool m_overflow = false;
+	QTimer m_flushTimer;
+	QTimer m_rearmTimer;
+
+	// inotify
+	int m_inotify = -1;
+	int m_rootWatch = -1;
+	QSocketNotifier *m_notifier = nullptr;
+	/// watch descriptor -> folder name
+	QHash<int, QString> m_folderWatches;
+
+	// fallback
+	QFileSystemWatcher *m_watcher = nullptr;
+	QSet<QString> m_listing;
+};
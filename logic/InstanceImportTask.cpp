@@ -0,0 +1,231 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InstanceImportTask.h"
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
+#include <quazip.h>
+#include <quazipfile.h>
+#include <pathutils.h>
+
+#include "logic/InstanceFactory.h"
+#include "logic/LegacyInstance.h"
+#include "logic/settings/INISettingsObject.h"
+#include "logger/QsLog.h"
+
+static const qint64 copyChunkSize = 1024 * 1024;
+
+namespace
+{
+/// false for entry names that would end up outside the instance folder
+bool isSafeName(const QString &name)
+{
+	if (name.isEmpty() || QDir::isAbsolutePath(name) || name.contains('\\') ||
+		name.contains(':'))
+		return false;
+	for (auto part : name.split('/'))
+	{
+		if (part == "..")
+			return false;
+	}
+	return true;
+}
+}
+
+InstanceImportTask::InstanceImportTask(const QString &archivePath, const QString &instDir,
+									   QObject *parent)
+	: Task(parent), m_archivePath(archivePath), m_instDir(instDir)
+{
+	connect(&m_checkWatcher, SIGNAL(finished()), SLOT(checkFinished()));
+	connect(&m_extractWatcher, SIGNAL(finished()), SLOT(extractFinished()));
+	m_progressTimer.setInterval(100);
+	connect(&m_progressTimer, SIGNAL(timeout()), SLOT(updateProgress()));
+}
+
+void InstanceImportTask::executeTask()
+{
+	setStatus(tr("Checking %1...").arg(QFileInfo(m_archivePath).fileName()));
+	m_extracted.store(0);
+	m_aborted.store(0);
+	m_checkWatcher.setFuture(QtConcurrent::run(this, &InstanceImportTask::checkArchive));
+}
+
+void InstanceImportTask::abort()
+{
+	m_aborted.store(1);
+}
+
+QString InstanceImportTask::checkArchive()
+{
+	QuaZip zip(m_archivePath);
+	if (!zip.open(QuaZip::mdUnzip))
+		return tr("%1 is not a zip file.").arg(m_archivePath);
+	bool hasSettings = false;
+	int entries = 0;
+	for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+	{
+		QString name = zip.getCurrentFileName();
+		if (!isSafeName(name))
+			return tr("The archive contains the invalid path %1.").arg(name);
+		if (name == "instance.cfg")
+			hasSettings = true;
+		entries++;
+	}
+	zip.close();
+	if (!hasSettings)
+		return tr("The archive doesn't contain an instance.");
+	m_entries = entries;
+
+	if (QFileInfo(m_instDir).exists())
+		return tr("An instance with the given directory name already exists.");
+	if (!QDir().mkpath(m_instDir))
+		return tr("Failed to create the instance directory.");
+	m_created = true;
+	return QString();
+}
+
+void InstanceImportTask::checkFinished()
+{
+	QString error = m_checkWatcher.result();
+	if (!error.isEmpty())
+	{
+		rollback(error);
+		return;
+	}
+	// every worker reads its own share of the entries through its own handle on the archive
+	int workers = qMax(1, qMin(QThread::idealThreadCount(), m_entries));
+	QList<int> shares;
+	for (int i = 0; i < workers; i++)
+	{
+		shares.append(i);
+	}
+	Extractor extractor;
+	extractor.archivePath = m_archivePath;
+	extractor.instDir = m_instDir;
+	extractor.workers = workers;
+	extractor.extracted = &m_extracted;
+	extractor.aborted = &m_aborted;
+
+	QLOG_INFO() << "Extracting" << m_entries << "files from" << m_archivePath << "to" << m_instDir
+				<< "with" << workers << "workers";
+	setStatus(tr("Extracting %1 files...").arg(m_entries));
+	m_progressTimer.start();
+	m_extractWatcher.setFuture(QtConcurrent::mapped(shares, extractor));
+}
+
+QString InstanceImportTask::Extractor::operator()(int worker) const
+{
+	QuaZip zip(archivePath);
+	if (!zip.open(QuaZip::mdUnzip))
+		return tr("Could not open %1").arg(archivePath);
+	int index = 0;
+	for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile(), index++)
+	{
+		if (index % workers != worker)
+			continue;
+		if (aborted->load())
+			return tr("Importing was aborted.");
+
+		QString name = zip.getCurrentFileName();
+		QString target = PathCombine(instDir, name);
+		if (name.endsWith('/'))
+		{
+			QDir().mkpath(target);
+			continue;
+		}
+		if (!QDir().mkpath(QFileInfo(target).path()))
+			return tr("Failed to create the folder for %1").arg(name);
+
+		QuaZipFile in(&zip);
+		QFile out(target);
+		if (!in.open(QIODevice::ReadOnly))
+			return tr("Could not read %1 from the archive").arg(name);
+		if (!out.open(QIODevice::WriteOnly))
+			return tr("Could not write %1: %2").arg(target, out.errorString());
+		while (!in.atEnd())
+		{
+			QByteArray chunk = in.read(copyChunkSize);
+			if (chunk.isEmpty() || out.write(chunk) != chunk.size())
+				return tr("Could not extract %1").arg(name);
+		}
+		// checks the CRC
+		in.close();
+		if (in.getZipError() != UNZ_OK)
+			return tr("%1 is damaged in the archive").arg(name);
+		extracted->fetchAndAddRelaxed(1);
+	}
+	return QString();
+}
+
+void InstanceImportTask::updateProgress()
+{
+	if (m_entries > 0)
+		setProgress(m_extracted.load() * 100 / m_entries);
+}
+
+void InstanceImportTask::extractFinished()
+{
+	m_progressTimer.stop();
+	auto future = m_extractWatcher.future();
+	for (int i = 0; i < future.resultCount(); i++)
+	{
+		if (!future.resultAt(i).isEmpty())
+		{
+			rollback(future.resultAt(i));
+			return;
+		}
+	}
+
+	// the copies of FTB instances are normal instances
+	{
+		INISettingsObject settings(PathCombine(m_instDir, "instance.cfg"));
+		settings.registerSetting("InstanceType", "Legacy");
+		QString type = settings.get("InstanceType").toString();
+		if (type == "OneSixFTB")
+			settings.set("InstanceType", "OneSix");
+		if (type == "LegacyFTB")
+			settings.set("InstanceType", "Legacy");
+	}
+
+	auto error = InstanceFactory::get().loadInstance(m_instance, m_instDir);
+	if (!m_instance || error != InstanceFactory::NoLoadError)
+	{
+		rollback(tr("The archive doesn't contain a valid instance."));
+		return;
+	}
+	// the runnable jar isn't exported, it is made again from the base jar and the jar mods
+	auto legacy = std::dynamic_pointer_cast<LegacyInstance>(m_instance);
+	if (legacy && !QFile::exists(legacy->runnableJar()))
+		legacy->setShouldRebuild(true);
+
+	QLOG_INFO() << "Imported" << m_archivePath << "as" << m_instDir;
+	emitSucceeded();
+}
+
+void InstanceImportTask::rollback(const QString &reason)
+{
+	m_instance.reset();
+	if (m_created)
+	{
+		QLOG_INFO() << "Removing the incomplete import" << m_instDir;
+		QDir(m_instDir).removeRecursively();
+	}
+	QLOG_ERROR() << "Failed to import" << m_archivePath << ":" << reason;
+	emitFailed(reason);
+}
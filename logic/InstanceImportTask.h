@@ -0,0 +1,87 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QTimer>
+
+#include "logic/BaseInstance.h"
+#include "logic/tasks/Task.h"
+
+/**
+ * Makes a new instance out of an archive made by InstanceExportTask.
+ *
+ * The archive is checked first: it needs an instance.cfg at the top and nothing in it may point
+ * outside the new instance folder. Then it is extracted by several worker threads at once, each
+ * with its own handle on the archive.
+ *
+ * If anything fails, the new folder is removed again.
+ */
+class InstanceImportTask : public Task
+{
+	Q_OBJECT
+public:
+	explicit InstanceImportTask(const QString &archivePath, const QString &instDir,
+								QObject *parent = 0);
+
+	/// the new instance, once the task succeeded
+	InstancePtr instance() const
+	{
+		return m_instance;
+	}
+
+public
+slots:
+	virtual void abort();
+
+protected:
+	virtual void executeTask();
+
+private
+slots:
+	void checkFinished();
+	void updateProgress();
+	void extractFinished();
+
+private:
+	/// runs on a worker thread. returns an error, if any
+	QString checkArchive();
+	struct Extractor
+	{
+		typedef QString result_type;
+		QString archivePath;
+		QString instDir;
+		int workers;
+		QAtomicInt *extracted;
+		QAtomicInt *aborted;
+		/// extracts every 'workers'th entry, starting at 'worker'. returns an error, if any
+		QString operator()(int worker) const;
+	};
+	void rollback(const QString &reason);
+
+	QString m_archivePath;
+	QString m_instDir;
+	InstancePtr m_instance;
+
+	QFutureWatcher<QString> m_checkWatcher;
+	QFutureWatcher<QString> m_extractWatcher;
+	QTimer m_progressTimer;
+	int m_entries = 0;
+	bool m_created = false;
+	QAtomicInt m_extracted;
+	QAtomicInt m_aborted;
+};
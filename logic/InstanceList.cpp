@@ -22,8 +22,9 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QXmlStreamReader>
 #include <QRegularExpression>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <pathutils.h>
 
 #include "MultiMC.h"
@@ -32,20 +33,40 @@
 #include "logic/minecraft/MinecraftVersionList.h"
 #include "logic/BaseInstance.h"
 #include "logic/InstanceFactory.h"
+#include "logic/InstanceFolderWatcher.h"
+#include "logic/settings/INIFile.h"
 #include "logger/QsLog.h"
 #include "gui/groupview/GroupView.h"
 
 const static int GROUP_FILE_FORMAT_VERSION = 1;
 
+// instances are added at most this many at a time, so the window stays responsive
+const static int LOAD_BATCH_SIZE = 32;
+// how long to wait for more instances before adding a batch, in ms
+const static int LOAD_BATCH_DELAY = 50;
+// how long group changes are collected before the group file is written, in ms
+const static int GROUP_SAVE_DELAY = 1000;
+
 InstanceList::InstanceList(const QString &instDir, QObject *parent)
 	: QAbstractListModel(parent), m_instDir(instDir)
 {
 	connect(MMC, &MultiMC::aboutToQuit, this, &InstanceList::saveGroupList);
+	connect(MMC, &MultiMC::aboutToQuit, this, &InstanceList::saveCatalog);
+	connect(&m_loadWatcher, SIGNAL(resultsReadyAt(int, int)), SLOT(descriptorsReady(int, int)));
+	connect(&m_loadWatcher, SIGNAL(finished()), SLOT(descriptorsFinished()));
+	m_batchTimer.setSingleShot(true);
+	connect(&m_batchTimer, SIGNAL(timeout()), SLOT(addLoadedBatch()));
+	m_groupSaveTimer.setSingleShot(true);
+	m_groupSaveTimer.setInterval(GROUP_SAVE_DELAY);
+	connect(&m_groupSaveTimer, SIGNAL(timeout()), SLOT(saveGroupList()));
 
 	if (!QDir::current().exists(m_instDir))
 	{
 		QDir::current().mkpath(m_instDir);
 	}
+	m_watcher = new InstanceFolderWatcher(this);
+	connect(m_watcher, SIGNAL(foldersChanged(QStringList)), SLOT(foldersChanged(QStringList)));
+	m_watcher->setRoot(m_instDir);
 }
 
 InstanceList::~InstanceList()
@@ -55,15 +76,15 @@ InstanceList::~InstanceList()
 int InstanceList::rowCount(const QModelIndex &parent) const
 {
 	Q_UNUSED(parent);
-	return m_instances.count();
+	return m_rows.count();
 }
 
 QModelIndex InstanceList::index(int row, int column, const QModelIndex &parent) const
 {
 	Q_UNUSED(parent);
-	if (row < 0 || row >= m_instances.size())
+	if (row < 0 || row >= m_rows.size())
 		return QModelIndex();
-	return createIndex(row, column, (void *)m_instances.at(row).get());
+	return createIndex(row, column);
 }
 
 QVariant InstanceList::data(const QModelIndex &index, int role) const
@@ -72,35 +93,43 @@ QVariant InstanceList::data(const QModelIndex &index, int role) const
 	{
 		return QVariant();
 	}
-	BaseInstance *pdata = static_cast<BaseInstance *>(index.internalPointer());
+	// the entries of loaded instances are kept up to date in propertiesChanged
+	const Row &row = m_rows.at(index.row());
 	switch (role)
 	{
 	case InstancePointerRole:
 	{
-		QVariant v = qVariantFromValue((void *)pdata);
+		QVariant v = qVariantFromValue((void *)row.instance.get());
 		return v;
 	}
 	case InstanceIDRole:
-    {
-        return pdata->id();
-    }
+	{
+		return row.entry.id();
+	}
+	case InstanceFlagsRole:
+	{
+		return row.entry.flags;
+	}
+	case LastLaunchRole:
+	{
+		return row.entry.lastLaunch;
+	}
 	case Qt::DisplayRole:
 	{
-		return pdata->name();
+		return row.entry.name;
 	}
 	case Qt::ToolTipRole:
 	{
-		return pdata->instanceRoot();
+		return row.entry.path;
 	}
 	case Qt::DecorationRole:
 	{
-		QString key = pdata->iconKey();
-		return MMC->icons()->getIcon(key);
+		return MMC->icons()->getIcon(row.entry.iconKey);
 	}
 	// for now.
 	case GroupViewRoles::GroupRole:
 	{
-		return pdata->group();
+		return rowGroup(row);
 	}
 	default:
 		break;
@@ -120,8 +149,13 @@ Qt::ItemFlags InstanceList::flags(const QModelIndex &index) const
 
 void InstanceList::groupChanged()
 {
-	// save the groups. save all of them.
-	saveGroupList();
+	// save the groups. save all of them, once the changes settle.
+	m_groupSaveTimer.start();
+}
+
+QString InstanceList::rowGroup(const Row &row) const
+{
+	return row.instance ? row.instance->group() : row.group;
 }
 
 QStringList InstanceList::getGroups()
@@ -131,6 +165,9 @@ QStringList InstanceList::getGroups()
 
 void InstanceList::saveGroupList()
 {
+	// the groups of the instances that aren't there yet would be lost
+	waitForLoaded();
+	m_groupSaveTimer.stop();
 	QString groupFileName = m_instDir + "/instgroups.json";
 	QFile groupFile(groupFileName);
 
@@ -143,10 +180,10 @@ void InstanceList::saveGroupList()
 	}
 	QTextStream out(&groupFile);
 	QMap<QString, QSet<QString>> groupMap;
-	for (auto instance : m_instances)
+	for (auto &row : m_rows)
 	{
-		QString id = instance->id();
-		QString group = instance->group();
+		QString id = row.entry.id();
+		QString group = rowGroup(row);
 		if (group.isEmpty())
 			continue;
 
@@ -283,100 +320,32 @@ void InstanceList::loadGroupList(QMap<QString, QString> &groupMap)
 	}
 }
 
-QSet<FTBRecord> InstanceList::discoverFTBInstances()
+void InstanceList::startFTBDiscovery()
 {
-	QSet<FTBRecord> records;
-	QDir dir = QDir(MMC->settings()->get("FTBLauncherDataRoot").toString());
-	QDir dataDir = QDir(MMC->settings()->get("FTBRoot").toString());
-	if (!dataDir.exists())
+	if (!m_ftbFilesLoaded)
 	{
-		QLOG_INFO() << "The FTB directory specified does not exist. Please check your settings";
-		return records;
+		m_ftbFiles = FTBPackIndex::load(PathCombine(m_instDir, ".ftbpacks"));
+		m_ftbFilesLoaded = true;
 	}
-	else if (!dir.exists())
-	{
-		QLOG_INFO() << "The FTB launcher data directory specified does not exist. Please check your settings";
-		return records;
-	}
-	dir.cd("ModPacks");
-	auto allFiles = dir.entryList(QDir::Readable | QDir::Files, QDir::Name);
-	for (auto filename : allFiles)
-	{
-		if (!filename.endsWith(".xml"))
-			continue;
-		auto fpath = dir.absoluteFilePath(filename);
-		QFile f(fpath);
-		QLOG_INFO() << "Discovering FTB instances -- " << fpath;
-		if (!f.open(QFile::ReadOnly))
-			continue;
+	m_ftbDiscovery = QtConcurrent::run(&FTBPackIndex::discover,
+									   MMC->settings()->get("FTBLauncherDataRoot").toString(),
+									   MMC->settings()->get("FTBRoot").toString(), m_ftbFiles);
+	m_ftbDiscovering = true;
+}
 
-		// read the FTB packs XML.
-		QXmlStreamReader reader(&f);
-		while (!reader.atEnd())
-		{
-			switch (reader.readNext())
-			{
-			case QXmlStreamReader::StartElement:
-			{
-				if (reader.name() == "modpack")
-				{
-					QXmlStreamAttributes attrs = reader.attributes();
-					FTBRecord record;
-					record.dirName = attrs.value("dir").toString();
-					record.instanceDir = dataDir.absoluteFilePath(record.dirName);
-					record.templateDir = dir.absoluteFilePath(record.dirName);
-					QDir test(record.instanceDir);
-					QLOG_DEBUG() << dataDir.absolutePath() << record.instanceDir << record.dirName;
-					if (!test.exists())
-						continue;
-					record.name = attrs.value("name").toString();
-					record.logo = attrs.value("logo").toString();
-					auto customVersions = attrs.value("customMCVersions");
-					if(!customVersions.isNull())
-					{
-						QMap<QString, QString> versionMatcher;
-						QString customVersionsStr = customVersions.toString();
-						QStringList list = customVersionsStr.split(';');
-						for(auto item: list)
-						{
-							auto segment = item.split('^');
-							if(segment.size() != 2)
-							{
-								QLOG_ERROR() << "FTB: Segment of size < 2 in " << customVersionsStr;
-								continue;
-							}
-							versionMatcher[segment[0]] = segment[1];
-						}
-						auto actualVersion = attrs.value("version").toString();
-						if(versionMatcher.contains(actualVersion))
-						{
-							record.mcVersion = versionMatcher[actualVersion];
-						}
-						else
-						{
-							record.mcVersion = attrs.value("mcVersion").toString();
-						}
-					}
-					else
-					{
-						record.mcVersion = attrs.value("mcVersion").toString();
-					}
-					record.description = attrs.value("description").toString();
-					records.insert(record);
-				}
-				break;
-			}
-			case QXmlStreamReader::EndElement:
-				break;
-			case QXmlStreamReader::Characters:
-				break;
-			default:
-				break;
-			}
-		}
-		f.close();
+QSet<FTBRecord> InstanceList::discoverFTBInstances()
+{
+	// loadList started it, so it is usually done by now
+	if (!m_ftbDiscovering)
+		startFTBDiscovery();
+	m_ftbDiscovering = false;
+	auto result = m_ftbDiscovery.result();
+	if (result.changed)
+	{
+		m_ftbFiles = result.files;
+		FTBPackIndex::save(PathCombine(m_instDir, ".ftbpacks"), m_ftbFiles);
 	}
-	return records;
+	return result.records;
 }
 
 void InstanceList::loadFTBInstances(QMap<QString, QString> &groupMap,
@@ -448,47 +417,444 @@ void InstanceList::loadFTBInstances(QMap<QString, QString> &groupMap,
 
 InstanceList::InstListError InstanceList::loadList()
 {
+	if (m_loading)
+	{
+		m_loadWatcher.cancel();
+		m_loadWatcher.waitForFinished();
+		m_batchTimer.stop();
+	}
+	saveCatalog();
+
+	if (MMC->settings()->get("TrackFTBInstances").toBool())
+		startFTBDiscovery();
+
 	// load the instance groups
-	QMap<QString, QString> groupMap;
-	loadGroupList(groupMap);
+	m_loadGroups.clear();
+	loadGroupList(m_loadGroups);
+
+	// the rows that are there already are checked against the folders and only the ones that
+	// changed are touched. the first time, the catalog provides them.
+	DescriptorReader reader;
+	QList<Row> rows;
+	if (m_rows.isEmpty())
+	{
+		for (auto &entry : InstanceCatalog::load(PathCombine(m_instDir, ".catalog")))
+		{
+			Row row;
+			row.entry = entry;
+			row.id = entry.id();
+			row.group = m_loadGroups.value(row.id);
+			reader.known.insert(entry.path, entry);
+			rows.append(row);
+		}
+	}
+	for (int i = 0; i < m_rows.size(); i++)
+	{
+		Row &row = m_rows[i];
+		if (row.external)
+			continue;
+		reader.known.insert(row.entry.path, row.entry);
+		// the group file may have been edited. loaded instances keep the group they have.
+		QString group = m_loadGroups.value(row.id);
+		if (!row.instance && row.group != group)
+		{
+			row.group = group;
+			emit dataChanged(index(i), index(i));
+		}
+	}
 
-	QList<InstancePtr> tempList;
+	QStringList dirs;
 	{
 		QDirIterator iter(m_instDir, QDir::Dirs | QDir::NoDot | QDir::NoDotDot | QDir::Readable,
 						  QDirIterator::FollowSymlinks);
 		while (iter.hasNext())
 		{
-			QString subDir = iter.next();
-			if (!QFileInfo(PathCombine(subDir, "instance.cfg")).exists())
-				continue;
-			QLOG_INFO() << "Loading MultiMC instance from " << subDir;
-			InstancePtr instPtr;
-			auto error = InstanceFactory::get().loadInstance(instPtr, subDir);
-			if(!continueProcessInstance(instPtr, error, subDir, groupMap))
-				continue;
-			tempList.append(instPtr);
+			dirs.append(iter.next());
+		}
+	}
+
+	appendRows(rows);
+
+	// the listing covers what changed before
+	m_changedFolders.clear();
+	m_pending.clear();
+	m_seen.clear();
+	m_found.clear();
+	m_catalogDirty = false;
+	m_loading = true;
+	m_workersDone = false;
+	QLOG_INFO() << "Loading instances from" << dirs.size() << "folders," << m_rows.size()
+				<< "known";
+	m_loadWatcher.setFuture(QtConcurrent::mapped(dirs, reader));
+	return NoError;
+}
+
+InstanceList::Descriptor InstanceList::DescriptorReader::operator()(const QString &dir) const
+{
+	Descriptor descriptor;
+	descriptor.path = dir;
+	QFileInfo cfg(PathCombine(dir, "instance.cfg"));
+	if (!cfg.exists())
+		return descriptor;
+	auto iter = known.find(dir);
+	if (iter != known.end() && InstanceCatalog::isCurrent(*iter, cfg))
+	{
+		descriptor.valid = true;
+		return descriptor;
+	}
+
+	INIFile settings;
+	settings.loadFile(cfg.filePath());
+	descriptor.entry = InstanceCatalog::fromSettings(dir, settings);
+	if (!InstanceCatalog::isKnownType(descriptor.entry.instanceType))
+	{
+		QLOG_ERROR() << "Failed to load instance" << cfg.dir().dirName() << ": unknown type"
+					 << descriptor.entry.instanceType;
+		return descriptor;
+	}
+	// the file as it was before reading it, so a change while reading isn't missed next time
+	InstanceCatalog::stamp(descriptor.entry, cfg);
+	descriptor.valid = true;
+	descriptor.changed = true;
+	return descriptor;
+}
+
+void InstanceList::descriptorsReady(int begin, int end)
+{
+	if (!m_loading)
+		return;
+	for (int i = begin; i < end; i++)
+	{
+		if (m_seen.contains(i))
+			continue;
+		m_seen.insert(i);
+		m_pending.append(i);
+	}
+	if (!m_batchTimer.isActive())
+		m_batchTimer.start(LOAD_BATCH_DELAY);
+}
+
+void InstanceList::descriptorsFinished()
+{
+	if (!m_loading)
+		return;
+	m_workersDone = true;
+	m_batchTimer.start(0);
+}
+
+void InstanceList::addLoadedBatch()
+{
+	if (!m_loading)
+		return;
+	addPending(LOAD_BATCH_SIZE);
+	if (!m_pending.isEmpty())
+	{
+		m_batchTimer.start(0);
+		return;
+	}
+	if (m_workersDone)
+		finishLoading();
+}
+
+void InstanceList::addPending(int limit)
+{
+	QList<Row> added;
+	int handled = 0;
+	while (!m_pending.isEmpty() && handled < limit)
+	{
+		if (applyDescriptor(m_loadWatcher.resultAt(m_pending.takeFirst()), added))
+			handled++;
+	}
+	appendRows(added);
+}
+
+bool InstanceList::applyDescriptor(const Descriptor &descriptor, QList<Row> &added)
+{
+	if (!descriptor.valid)
+		return false;
+	m_found.insert(descriptor.path);
+	if (!descriptor.changed)
+		return false;
+	m_catalogDirty = true;
+
+	int i = getPathIndex(descriptor.path);
+	if (i != -1)
+	{
+		Row &row = m_rows[i];
+		if (row.instance)
+		{
+			// a loaded instance knows better than the file
+			row.entry = InstanceCatalog::fromInstance(row.instance.get());
+			return true;
+		}
+		row.entry = descriptor.entry;
+		emit dataChanged(index(i), index(i));
+		return true;
+	}
+	QLOG_INFO() << "Found MultiMC instance" << descriptor.entry.name << "in" << descriptor.path;
+	Row row;
+	row.entry = descriptor.entry;
+	row.id = row.entry.id();
+	row.group = m_loadGroups.value(row.id);
+	added.append(row);
+	return true;
+}
+
+void InstanceList::foldersChanged(QStringList names)
+{
+	if (names.isEmpty())
+	{
+		QLOG_INFO() << "Lost track of the instance folder, checking all of it";
+		loadList();
+		return;
+	}
+	m_changedFolders += names;
+	// a load in progress may have read them already, they are looked at once it is done
+	if (!m_loading)
+		applyFolderChanges();
+}
+
+void InstanceList::applyFolderChanges()
+{
+	QStringList names = m_changedFolders;
+	m_changedFolders.clear();
+	names.removeDuplicates();
+
+	DescriptorReader reader;
+	QList<Row> removed;
+	QList<Descriptor> found;
+	for (auto name : names)
+	{
+		QString path = PathCombine(m_instDir, name);
+		int i = getPathIndex(path);
+		if (i != -1 && m_rows[i].external)
+			continue;
+		if (!QFileInfo(path).isDir())
+		{
+			m_watcher->unwatchFolder(name);
+			if (i != -1)
+			{
+				QLOG_INFO() << "Instance folder" << path << "is gone";
+				removed.append(m_rows[i]);
+				dropRows(i, i);
+			}
+			continue;
+		}
+		if (i != -1)
+			reader.known.insert(path, m_rows[i].entry);
+		// watched before reading, so an instance.cfg that shows up right after isn't missed
+		m_watcher->watchFolder(name);
+		auto descriptor = reader(path);
+		if (!descriptor.valid)
+		{
+			// probably still being filled, look again when something is put in there
+			continue;
 		}
+		m_watcher->unwatchFolder(name);
+		found.append(descriptor);
 	}
 
+	QList<Row> added;
+	for (auto &descriptor : found)
+	{
+		// a renamed folder still has the same instance.cfg file, it keeps its group. a copy has
+		// the same size and time, but is another file.
+		QString id = descriptor.entry.id();
+		quint64 fileId = descriptor.entry.cfgFileId;
+		if (descriptor.changed && fileId != 0 && !m_loadGroups.contains(id))
+		{
+			for (auto &old : removed)
+			{
+				if (old.entry.cfgFileId == fileId)
+				{
+					m_loadGroups.insert(id, rowGroup(old));
+					break;
+				}
+			}
+		}
+		applyDescriptor(descriptor, added);
+	}
+	appendRows(added);
+	if (!removed.isEmpty())
+		m_groupSaveTimer.start();
+	if (!removed.isEmpty() || !added.isEmpty())
+		saveCatalog();
+}
+
+void InstanceList::waitForLoaded()
+{
+	if (!m_loading)
+		return;
+	m_loadWatcher.waitForFinished();
+	// the signals for these may still be on their way
+	int results = m_loadWatcher.future().resultCount();
+	for (int i = 0; i < results; i++)
+	{
+		if (m_seen.contains(i))
+			continue;
+		m_seen.insert(i);
+		m_pending.append(i);
+	}
+	m_batchTimer.stop();
+	addPending(m_pending.size());
+	finishLoading();
+}
+
+void InstanceList::finishLoading()
+{
+	m_loading = false;
+	QList<InstancePtr> ftbInstances;
 	if (MMC->settings()->get("TrackFTBInstances").toBool())
 	{
-		loadFTBInstances(groupMap, tempList);
+		loadFTBInstances(m_loadGroups, ftbInstances);
 	}
-	beginResetModel();
-	m_instances.clear();
-	for(auto inst: tempList)
+	// if the setting was turned off while loading, the discovery started before is stale
+	m_ftbDiscovering = false;
+	m_ftbDiscovery = QFuture<FTBPackIndex::Result>();
+	QSet<QString> ftbPaths;
+	QList<Row> added;
+	for (auto inst : ftbInstances)
 	{
-		inst->setParent(this);
-		connect(inst.get(), SIGNAL(propertiesChanged(BaseInstance *)), this,
-				SLOT(propertiesChanged(BaseInstance *)));
-		connect(inst.get(), SIGNAL(groupChanged()), this, SLOT(groupChanged()));
-		connect(inst.get(), SIGNAL(nuked(BaseInstance *)), this,
-				SLOT(instanceNuked(BaseInstance *)));
-		m_instances.append(inst);
+		ftbPaths.insert(inst->instanceRoot());
+		if (getPathIndex(inst->instanceRoot()) != -1)
+			continue;
+		Row row = makeRow(inst);
+		row.external = true;
+		added.append(row);
 	}
-	endResetModel();
+
+	// loaded instances stay until they are nuked, unless their folder is gone
+	auto isGone = [&](const Row &row)
+	{
+		if (row.external)
+			return !ftbPaths.contains(row.entry.path);
+		if (m_found.contains(row.entry.path))
+			return false;
+		return !row.instance || !QFileInfo(row.entry.path).isDir();
+	};
+	for (int last = m_rows.size() - 1; last >= 0; last--)
+	{
+		if (!isGone(m_rows[last]))
+			continue;
+		int first = last;
+		while (first > 0 && isGone(m_rows[first - 1]))
+			first--;
+		dropRows(first, last);
+		last = first;
+	}
+	appendRows(added);
+
+	// the changes that came in while loading
+	if (!m_changedFolders.isEmpty())
+		applyFolderChanges();
+	saveCatalog();
+	QLOG_INFO() << "Loaded" << m_rows.size() << "instances";
 	emit dataIsInvalid();
-	return NoError;
+}
+
+void InstanceList::appendRows(const QList<Row> &rows)
+{
+	if (rows.isEmpty())
+		return;
+	beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + rows.size() - 1);
+	for (auto &row : rows)
+	{
+		// with duplicate ids, the first one wins
+		if (!m_idIndex.contains(row.id))
+			m_idIndex.insert(row.id, m_rows.size());
+		m_pathIndex.insert(row.entry.path, m_rows.size());
+		m_rows.append(row);
+	}
+	endInsertRows();
+}
+
+void InstanceList::dropRows(int first, int last)
+{
+	beginRemoveRows(QModelIndex(), first, last);
+	m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+	// the rows after them moved, the index has to be right before anyone hears about it
+	reindex();
+	m_catalogDirty = true;
+	endRemoveRows();
+}
+
+void InstanceList::reindex()
+{
+	m_idIndex.clear();
+	m_pathIndex.clear();
+	for (int i = m_rows.size() - 1; i >= 0; i--)
+	{
+		m_idIndex.insert(m_rows[i].id, i);
+		m_pathIndex.insert(m_rows[i].entry.path, i);
+	}
+}
+
+InstanceList::Row InstanceList::makeRow(InstancePtr inst) const
+{
+	connectInstance(inst);
+	Row row;
+	row.entry = InstanceCatalog::fromInstance(inst.get());
+	row.id = inst->id();
+	row.group = inst->group();
+	row.instance = inst;
+	return row;
+}
+
+void InstanceList::connectInstance(InstancePtr inst) const
+{
+	// instances are loaded from const accessors, that doesn't change what the list shows
+	auto self = const_cast<InstanceList *>(this);
+	inst->setParent(self);
+	connect(inst.get(), SIGNAL(propertiesChanged(BaseInstance *)), self,
+			SLOT(propertiesChanged(BaseInstance *)));
+	connect(inst.get(), SIGNAL(groupChanged()), self, SLOT(groupChanged()));
+	connect(inst.get(), SIGNAL(nuked(BaseInstance *)), self, SLOT(instanceNuked(BaseInstance *)));
+}
+
+InstancePtr InstanceList::at(int i) const
+{
+	return materialize(i);
+}
+
+InstancePtr InstanceList::materialize(int i) const
+{
+	Row &row = m_rows[i];
+	if (row.instance)
+		return row.instance;
+
+	InstancePtr inst;
+	auto error = InstanceFactory::get().loadInstance(inst, row.entry.path);
+	if (!inst || error != InstanceFactory::NoLoadError)
+	{
+		QLOG_ERROR() << "Failed to load instance" << row.entry.id() << ": error" << error;
+		return InstancePtr();
+	}
+	if (!row.group.isEmpty())
+		inst->setGroupInitial(row.group);
+	connectInstance(inst);
+	row.instance = inst;
+	QLOG_INFO() << "Loaded instance" << inst->name() << "from" << row.entry.path;
+
+	// loading can change the flags, and the file may have changed since the catalog was made
+	row.entry = InstanceCatalog::fromInstance(inst.get());
+	auto self = const_cast<InstanceList *>(this);
+	self->m_catalogDirty = true;
+	emit self->dataChanged(index(i), index(i));
+	return inst;
+}
+
+void InstanceList::saveCatalog()
+{
+	if (!m_catalogDirty)
+		return;
+	QList<InstanceCatalog::Entry> entries;
+	for (auto &row : m_rows)
+	{
+		if (!row.external)
+			entries.append(row.entry);
+	}
+	InstanceCatalog::save(PathCombine(m_instDir, ".catalog"), entries);
+	m_catalogDirty = false;
 }
 
 /// Clear all instances. Triggers notifications.
@@ -496,62 +862,61 @@ void InstanceList::clear()
 {
 	beginResetModel();
 	saveGroupList();
-	m_instances.clear();
+	m_rows.clear();
+	m_idIndex.clear();
+	m_pathIndex.clear();
 	endResetModel();
 	emit dataIsInvalid();
 }
 
 void InstanceList::on_InstFolderChanged(const Setting &setting, QVariant value)
 {
+	saveCatalog();
+	// nothing from the old folder carries over
+	clear();
 	m_instDir = value.toString();
+	m_watcher->setRoot(m_instDir);
 	loadList();
 }
 
 /// Add an instance. Triggers notifications, returns the new index
 int InstanceList::add(InstancePtr t)
 {
-	beginInsertRows(QModelIndex(), m_instances.size(), m_instances.size());
-	m_instances.append(t);
-	t->setParent(this);
-	connect(t.get(), SIGNAL(propertiesChanged(BaseInstance *)), this,
-			SLOT(propertiesChanged(BaseInstance *)));
-	connect(t.get(), SIGNAL(groupChanged()), this, SLOT(groupChanged()));
-	connect(t.get(), SIGNAL(nuked(BaseInstance *)), this, SLOT(instanceNuked(BaseInstance *)));
-	endInsertRows();
+	m_catalogDirty = true;
+	// the folder watcher may have been faster
+	int i = getPathIndex(t->instanceRoot());
+	if (i != -1)
+	{
+		m_rows[i] = makeRow(t);
+		emit dataChanged(index(i), index(i));
+		return i;
+	}
+	appendRows({makeRow(t)});
 	return count() - 1;
 }
 
 InstancePtr InstanceList::getInstanceById(QString instId) const
 {
-	if (m_instances.isEmpty())
-	{
-		return InstancePtr();
-	}
-
-	QListIterator<InstancePtr> iter(m_instances);
-	InstancePtr inst;
-	while (iter.hasNext())
-	{
-		inst = iter.next();
-		if (inst->id() == instId)
-			break;
-	}
-	if (inst->id() != instId)
+	int i = getIdIndex(instId);
+	if (i == -1)
 		return InstancePtr();
-	else
-		return iter.peekPrevious();
+	return materialize(i);
 }
 
 QModelIndex InstanceList::getInstanceIndexById(const QString &id) const
 {
-	return index(getInstIndex(getInstanceById(id).get()));
+	return index(getIdIndex(id));
 }
 
 int InstanceList::getInstIndex(BaseInstance *inst) const
 {
-	for (int i = 0; i < m_instances.count(); i++)
+	int i = getIdIndex(inst->id());
+	if (i != -1 && m_rows[i].instance.get() == inst)
+		return i;
+	// it shares its id with another instance
+	for (i = 0; i < m_rows.count(); i++)
 	{
-		if (inst == m_instances[i].get())
+		if (inst == m_rows[i].instance.get())
 		{
 			return i;
 		}
@@ -559,6 +924,16 @@ int InstanceList::getInstIndex(BaseInstance *inst) const
 	return -1;
 }
 
+int InstanceList::getIdIndex(const QString &id) const
+{
+	return m_idIndex.value(id, -1);
+}
+
+int InstanceList::getPathIndex(const QString &path) const
+{
+	return m_pathIndex.value(path, -1);
+}
+
 bool InstanceList::continueProcessInstance(InstancePtr instPtr, const int error,
 										   const QDir &dir, QMap<QString, QString> &groupMap)
 {
@@ -601,9 +976,7 @@ void InstanceList::instanceNuked(BaseInstance *inst)
 	int i = getInstIndex(inst);
 	if (i != -1)
 	{
-		beginRemoveRows(QModelIndex(), i, i);
-		m_instances.removeAt(i);
-		endRemoveRows();
+		dropRows(i, i);
 	}
 }
 
@@ -612,26 +985,29 @@ void InstanceList::propertiesChanged(BaseInstance *inst)
 	int i = getInstIndex(inst);
 	if (i != -1)
 	{
+		m_rows[i].entry = InstanceCatalog::fromInstance(inst);
+		m_catalogDirty = true;
 		emit dataChanged(index(i), index(i));
 	}
 }
 
-InstanceProxyModel::InstanceProxyModel(QObject *parent) : GroupedProxyModel(parent)
+InstanceProxyModel::InstanceProxyModel(QObject *parent)
+	: GroupedProxyModel(parent), m_sortMode(MMC->settings()->getSetting("InstSortMode"))
 {
 }
 
 bool InstanceProxyModel::subSortLessThan(const QModelIndex &left,
 										 const QModelIndex &right) const
 {
-	BaseInstance *pdataLeft = static_cast<BaseInstance *>(left.internalPointer());
-	BaseInstance *pdataRight = static_cast<BaseInstance *>(right.internalPointer());
-	QString sortMode = MMC->settings()->get("InstSortMode").toString();
+	// the instances may not be loaded, the model has what is needed
+	const QString &sortMode = m_sortMode.get();
 	if (sortMode == "LastLaunch")
 	{
-		return pdataLeft->lastLaunch() > pdataRight->lastLaunch();
+		return left.data(InstanceList::LastLaunchRole).toLongLong() >
+			   right.data(InstanceList::LastLaunchRole).toLongLong();
 	}
 	else
 	{
-		return QString::localeAwareCompare(pdataLeft->name(), pdataRight->name()) < 0;
+		return QString::localeAwareCompare(left.data().toString(), right.data().toString()) < 0;
 	}
 }
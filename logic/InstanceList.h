@@ -18,46 +18,36 @@
 #include <QObject>
 #include <QAbstractListModel>
 #include <QSet>
+#include <QHash>
+#include <QTimer>
+#include <QFutureWatcher>
 #include <gui/groupview/GroupedProxyModel.h>
 #include <QIcon>
 
 #include "logic/BaseInstance.h"
+#include "logic/InstanceCatalog.h"
+#include "logic/FTBPackIndex.h"
+#include "logic/settings/TypedSetting.h"
 
 class BaseInstance;
+class InstanceFolderWatcher;
 
 class QDir;
 
-struct FTBRecord
-{
-	QString dirName;
-	QString name;
-	QString logo;
-	QString mcVersion;
-	QString description;
-	QString instanceDir;
-	QString templateDir;
-	bool operator ==(const FTBRecord other) const
-	{
-		return instanceDir == other.instanceDir;
-	}
-};
-
-inline uint qHash(FTBRecord record)
-{
-	return qHash(record.instanceDir);
-}
-
 class InstanceList : public QAbstractListModel
 {
 	Q_OBJECT
 private:
 	void loadGroupList(QMap<QString, QString> &groupList);
+	/// look for the FTB packs on the thread pool, while the instances load
+	void startFTBDiscovery();
 	QSet<FTBRecord> discoverFTBInstances();
 	void loadFTBInstances(QMap<QString, QString> &groupMap, QList<InstancePtr> & tempList);
 
 private
 slots:
 	void saveGroupList();
+	void saveCatalog();
 
 public:
 	explicit InstanceList(const QString &instDir, QObject *parent = 0);
@@ -71,8 +61,10 @@ public:
 
 	enum AdditionalRoles
 	{
-		InstancePointerRole = 0x34B1CB48, ///< Return pointer to real instance
-		InstanceIDRole = 0x34B1CB49 ///< Return id if the instance
+		InstancePointerRole = 0x34B1CB48, ///< Return pointer to real instance, if it is loaded
+		InstanceIDRole = 0x34B1CB49, ///< Return id if the instance
+		InstanceFlagsRole = 0x34B1CB4A, ///< Return the instance flags
+		LastLaunchRole = 0x34B1CB4B ///< Return the last launch time
 	};
 	/*!
 	 * \brief Error codes returned by functions in the InstanceList class.
@@ -91,22 +83,30 @@ public:
 	}
 
 	/*!
-	 * \brief Get the instance at index
+	 * \brief Get the instance at index, loading it if it isn't loaded yet.
+	 * Returns null if it can't be loaded.
 	 */
-	InstancePtr at(int i) const
+	InstancePtr at(int i) const;
+
+	/// the instance at index if it is loaded already, null otherwise
+	InstancePtr loadedAt(int i) const
 	{
-		return m_instances.at(i);
+		return m_rows.at(i).instance;
+	}
+
+	/// what the list knows about the instance at index, without loading it
+	const InstanceCatalog::Entry &entryAt(int i) const
+	{
+		return m_rows.at(i).entry;
 	}
-	;
 
 	/*!
-	 * \brief Get the count of loaded instances
+	 * \brief Get the count of instances
 	 */
 	int count() const
 	{
-		return m_instances.count();
+		return m_rows.count();
 	}
-	;
 
 	/// Clear all instances. Triggers notifications.
 	void clear();
@@ -114,13 +114,22 @@ public:
 	/// Add an instance. Triggers notifications, returns the new index
 	int add(InstancePtr t);
 
-	/// Get an instance by ID
+	/// Get an instance by ID, loading it if it isn't loaded yet
 	InstancePtr getInstanceById(QString id) const;
 
 	QModelIndex getInstanceIndexById(const QString &id) const;
 
 	// FIXME: instead of iterating through all instances and forming a set, keep the set around
 	QStringList getGroups();
+
+	/// true while loadList is still adding instances
+	bool isLoading() const
+	{
+		return m_loading;
+	}
+
+	/// add all the instances loadList hasn't added yet, right now
+	void waitForLoaded();
 signals:
 	void dataIsInvalid();
 
@@ -130,6 +139,15 @@ slots:
 
 	/*!
 	 * \brief Loads the instance list. Triggers notifications.
+	 *
+	 * The instances from the catalog are shown right away. The instance settings that
+	 * changed since are read on worker threads and the rows are updated or added in batches
+	 * as they come in. dataIsInvalid() is emitted when all of them are there.
+	 *
+	 * Reloading does not reset the model, only the rows that changed are updated, added or
+	 * removed.
+	 *
+	 * The instances themselves are only loaded when something asks for them.
 	 */
 	InstListError loadList();
 
@@ -139,16 +157,97 @@ slots:
 	void instanceNuked(BaseInstance *inst);
 	void groupChanged();
 
+	void foldersChanged(QStringList names);
+
+	void descriptorsReady(int begin, int end);
+	void descriptorsFinished();
+	void addLoadedBatch();
+
 private:
+	struct Row
+	{
+		InstanceCatalog::Entry entry;
+		QString group;
+		/// the folder name, cached for the index
+		QString id;
+		/// null until something needs the instance itself
+		InstancePtr instance;
+		/// not in the instance folder (FTB), so not in the catalog either
+		bool external = false;
+	};
+	/// what a worker thread finds in an instance folder
+	struct Descriptor
+	{
+		QString path;
+		bool valid = false;
+		/// false if the catalog entry for the folder is still good
+		bool changed = false;
+		InstanceCatalog::Entry entry;
+	};
+	struct DescriptorReader
+	{
+		typedef Descriptor result_type;
+		/// the catalog entries by path
+		QHash<QString, InstanceCatalog::Entry> known;
+		Descriptor operator()(const QString &dir) const;
+	};
+	/// update or add rows for up to 'limit' of the pending descriptors
+	void addPending(int limit);
+	/// update the row of the descriptor or add one to 'added'. false if nothing changed
+	bool applyDescriptor(const Descriptor &descriptor, QList<Row> &added);
+	/// check the folders the watcher reported
+	void applyFolderChanges();
+	void finishLoading();
+	void appendRows(const QList<Row> &rows);
+	void dropRows(int first, int last);
+	/// rebuild m_idIndex and m_pathIndex after rows moved
+	void reindex();
+	Row makeRow(InstancePtr inst) const;
+	InstancePtr materialize(int i) const;
+	void connectInstance(InstancePtr inst) const;
+	QString rowGroup(const Row &row) const;
+
 	int getInstIndex(BaseInstance *inst) const;
+	int getIdIndex(const QString &id) const;
+	int getPathIndex(const QString &path) const;
 
 	bool continueProcessInstance(InstancePtr instPtr, const int error, const QDir &dir,
 								 QMap<QString, QString> &groupMap);
 
 protected:
 	QString m_instDir;
-	QList<InstancePtr> m_instances;
+	/// instances are loaded into these lazily, hence mutable
+	mutable QList<Row> m_rows;
+	/// instance id -> row
+	QHash<QString, int> m_idIndex;
+	/// instance folder -> row
+	QHash<QString, int> m_pathIndex;
 	QSet<QString> m_groups;
+	bool m_catalogDirty = false;
+
+	QFutureWatcher<Descriptor> m_loadWatcher;
+	/// collects the descriptors that come in into batches
+	QTimer m_batchTimer;
+	/// result indexes reported by the workers, but not added yet
+	QList<int> m_pending;
+	QSet<int> m_seen;
+	/// the folders the workers found instances in
+	QSet<QString> m_found;
+	QMap<QString, QString> m_loadGroups;
+	bool m_loading = false;
+	bool m_workersDone = false;
+
+	InstanceFolderWatcher *m_watcher;
+	/// folders the watcher reported that haven't been checked yet
+	QStringList m_changedFolders;
+	/// writes the group file once group changes settle
+	QTimer m_groupSaveTimer;
+
+	QFuture<FTBPackIndex::Result> m_ftbDiscovery;
+	bool m_ftbDiscovering = false;
+	/// the FTB launcher files parsed so far, read from the index the first time
+	FTBPackIndex::Files m_ftbFiles;
+	bool m_ftbFilesLoaded = false;
 };
 
 class InstanceProxyModel : public GroupedProxyModel
@@ -158,4 +257,8 @@ public:
 
 protected:
 	virtual bool subSortLessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+private:
+	/// read for every comparison
+	TypedSetting<QString> m_sortMode;
 };
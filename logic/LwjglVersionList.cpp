@@ -15,10 +15,13 @@
 
 #include "LwjglVersionList.h"
 #include "MultiMC.h"
+#include "logic/VersionListCache.h"
 
 #include <QtNetwork>
 #include <QtXml>
 #include <QRegExp>
+#include <QtConcurrentRun>
+#include <pathutils.h>
 
 #include "logger/QsLog.h"
 
@@ -27,6 +30,51 @@
 LWJGLVersionList::LWJGLVersionList(QObject *parent) : QAbstractListModel(parent)
 {
 	setLoading(false);
+	connect(&m_parseWatcher, SIGNAL(finished()), SLOT(listParsed()));
+	// the list from the last run is used until it's checked against the server
+	restoreList(VersionListCache::key({sourceEntry()}));
+}
+
+MetaEntryPtr LWJGLVersionList::sourceEntry()
+{
+	return MMC->metacache()->resolveEntry("lwjgl", "rss.xml");
+}
+
+QString LWJGLVersionList::storedListPath()
+{
+	return PathCombine(MMC->metacache()->getBasePath("lwjgl"), "versions.cache");
+}
+
+bool LWJGLVersionList::restoreList(const QString &key)
+{
+	if (key.isEmpty())
+		return false;
+	if (isLoaded() && key == m_cacheKey)
+		return true;
+	QStringList names, urls;
+	if (!VersionListCache::read(storedListPath(), key, [&](QDataStream &in)
+	{
+		in >> names >> urls;
+		return names.size() == urls.size();
+	}))
+	{
+		return false;
+	}
+	setVersions(names, urls);
+	m_cacheKey = key;
+	return true;
+}
+
+void LWJGLVersionList::setVersions(const QStringList &names, const QStringList &urls)
+{
+	QList<PtrLWJGLVersion> tempList;
+	for (int i = 0; i < names.size(); i++)
+	{
+		tempList.append(LWJGLVersion::Create(names[i], urls[i]));
+	}
+	beginResetModel();
+	m_vlist.swap(tempList);
+	endResetModel();
 }
 
 QVariant LWJGLVersionList::data(const QModelIndex &index, int role) const
@@ -82,12 +130,20 @@ void LWJGLVersionList::loadList()
 	Q_ASSERT_X(!m_loading, "loadList", "list is already loading (m_loading is true)");
 
 	setLoading(true);
-	auto worker = MMC->qnam();
-	QNetworkRequest req(QUrl(RSS_URL));
-	req.setRawHeader("Accept", "application/rss+xml, text/xml, */*");
-	req.setRawHeader("User-Agent", "MultiMC/5.0 (Uncached)");
-	reply = worker->get(req);
-	connect(reply, SIGNAL(finished()), SLOT(netRequestComplete()));
+	auto job = new NetJob("LWJGL version list");
+	m_listEntry = sourceEntry();
+
+	// verify by poking the server.
+	m_listEntry->stale = true;
+
+	m_listDownload = CacheDownload::make(QUrl(RSS_URL), m_listEntry);
+	m_listDownload->m_rawHeaders.append({"Accept", "application/rss+xml, text/xml, */*"});
+	m_listDownload->m_rawHeaders.append({"User-Agent", "MultiMC/5.0 (Uncached)"});
+	job->addNetAction(m_listDownload);
+	m_listJob.reset(job);
+	connect(m_listJob.get(), SIGNAL(succeeded()), SLOT(listDownloaded()));
+	connect(m_listJob.get(), SIGNAL(failed()), SLOT(listFailed()));
+	m_listJob->start();
 }
 
 inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
@@ -99,76 +155,111 @@ inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
 		return QDomElement();
 }
 
-void LWJGLVersionList::netRequestComplete()
+void LWJGLVersionList::listDownloaded()
 {
-	if (reply->error() == QNetworkReply::NoError)
+	// a 304 leaves the file alone, so the list made from it last time is still good
+	QString key = VersionListCache::key({m_listEntry});
+	if (restoreList(key))
 	{
-		QRegExp lwjglRegex("lwjgl-(([0-9]\\.?)+)\\.zip");
-		Q_ASSERT_X(lwjglRegex.isValid(), "load LWJGL list", "LWJGL regex is invalid");
+		QLOG_INFO() << "LWJGL list didn't change, using the stored list.";
+		m_listJob.reset();
+		finished();
+		setLoading(false);
+		return;
+	}
+	m_parseWatcher.setFuture(QtConcurrent::run(&LWJGLVersionList::parseList,
+											   m_listDownload->getTargetFilepath(),
+											   storedListPath(), key));
+}
 
-		QDomDocument doc;
+void LWJGLVersionList::listFailed()
+{
+	m_listJob.reset();
+	failed("Failed to load LWJGL list. Network error.");
+	setLoading(false);
+}
 
-		QString xmlErrorMsg;
-		int errorLine;
-		auto rawData = reply->readAll();
-		if (!doc.setContent(rawData, false, &xmlErrorMsg, &errorLine))
-		{
-			failed("Failed to load LWJGL list. XML error: " + xmlErrorMsg + " at line " +
-				   QString::number(errorLine));
-			setLoading(false);
-			return;
-		}
+void LWJGLVersionList::listParsed()
+{
+	m_listJob.reset();
+	auto result = m_parseWatcher.result();
+	if (!result.error.isEmpty())
+	{
+		failed(result.error);
+		setLoading(false);
+		return;
+	}
+	setVersions(result.names, result.urls);
+	m_cacheKey = VersionListCache::key({m_listEntry});
+
+	QLOG_INFO() << "Loaded LWJGL list.";
+	finished();
+	setLoading(false);
+}
+
+LWJGLVersionList::ParseResult LWJGLVersionList::parseList(QString listFile, QString storePath,
+														  QString key)
+{
+	ParseResult result;
+	QRegExp lwjglRegex("lwjgl-(([0-9]\\.?)+)\\.zip");
+	Q_ASSERT_X(lwjglRegex.isValid(), "load LWJGL list", "LWJGL regex is invalid");
+
+	QFile input(listFile);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		result.error = "Failed to open the LWJGL list.";
+		return result;
+	}
 
-		QDomNodeList items = doc.elementsByTagName("item");
+	QDomDocument doc;
 
-		QList<PtrLWJGLVersion> tempList;
+	QString xmlErrorMsg;
+	int errorLine;
+	if (!doc.setContent(&input, false, &xmlErrorMsg, &errorLine))
+	{
+		result.error = "Failed to load LWJGL list. XML error: " + xmlErrorMsg + " at line " +
+					   QString::number(errorLine);
+		return result;
+	}
+
+	QDomNodeList items = doc.elementsByTagName("item");
+
+	for (int i = 0; i < items.length(); i++)
+	{
+		Q_ASSERT_X(items.at(i).isElement(), "load LWJGL list",
+				   "XML element isn't an element... wat?");
 
-		for (int i = 0; i < items.length(); i++)
+		QDomElement linkElement = getDomElementByTagName(items.at(i).toElement(), "link");
+		if (linkElement.isNull())
 		{
-			Q_ASSERT_X(items.at(i).isElement(), "load LWJGL list",
-					   "XML element isn't an element... wat?");
+			QLOG_INFO() << "Link element" << i << "in RSS feed doesn't exist! Skipping.";
+			continue;
+		}
 
-			QDomElement linkElement = getDomElementByTagName(items.at(i).toElement(), "link");
-			if (linkElement.isNull())
-			{
-				QLOG_INFO() << "Link element" << i << "in RSS feed doesn't exist! Skipping.";
-				continue;
-			}
+		QString link = linkElement.text();
 
-			QString link = linkElement.text();
+		// Make sure it's a download link.
+		if (link.endsWith("/download") && link.contains(lwjglRegex))
+		{
+			QString name = link.mid(lwjglRegex.indexIn(link) + 6);
+			// Subtract 4 here to remove the .zip file extension.
+			name = name.left(lwjglRegex.matchedLength() - 10);
 
-			// Make sure it's a download link.
-			if (link.endsWith("/download") && link.contains(lwjglRegex))
+			QUrl url(link);
+			if (!url.isValid())
 			{
-				QString name = link.mid(lwjglRegex.indexIn(link) + 6);
-				// Subtract 4 here to remove the .zip file extension.
-				name = name.left(lwjglRegex.matchedLength() - 10);
-
-				QUrl url(link);
-				if (!url.isValid())
-				{
-					QLOG_WARN() << "LWJGL version URL isn't valid:" << link << "Skipping.";
-					continue;
-				}
-				QLOG_INFO() << "Discovered LWGL version" << name << "at" << link;
-				tempList.append(LWJGLVersion::Create(name, link));
+				QLOG_WARN() << "LWJGL version URL isn't valid:" << link << "Skipping.";
+				continue;
 			}
+			QLOG_INFO() << "Discovered LWGL version" << name << "at" << link;
+			result.names.append(name);
+			result.urls.append(link);
 		}
-
-		beginResetModel();
-		m_vlist.swap(tempList);
-		endResetModel();
-
-		QLOG_INFO() << "Loaded LWJGL list.";
-		finished();
-	}
-	else
-	{
-		failed("Failed to load LWJGL list. Network error: " + reply->errorString());
 	}
 
-	setLoading(false);
-	reply->deleteLater();
+	VersionListCache::write(storePath, key, [&](QDataStream &out)
+	{ out << result.names << result.urls; });
+	return result;
 }
 
 const PtrLWJGLVersion LWJGLVersionList::getVersion(const QString &versionName)
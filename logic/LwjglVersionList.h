@@ -19,9 +19,12 @@
 #include <QAbstractListModel>
 #include <QUrl>
 #include <QNetworkReply>
+#include <QFutureWatcher>
 
 #include <memory>
 
+#include "logic/net/NetJob.h"
+
 class LWJGLVersion;
 typedef std::shared_ptr<LWJGLVersion> PtrLWJGLVersion;
 
@@ -102,6 +105,18 @@ public:
 		return m_lastErrorMsg;
 	}
 
+	/**
+	 * Use the list stored by an earlier load, if it was made from the file 'key' stands for.
+	 */
+	bool restoreList(const QString &key);
+
+	struct ParseResult
+	{
+		QStringList names;
+		QStringList urls;
+		QString error;
+	};
+
 public
 slots:
 	/*!
@@ -129,8 +144,13 @@ signals:
 private:
 	QList<PtrLWJGLVersion> m_vlist;
 
-	QNetworkReply *m_netReply;
-	QNetworkReply *reply;
+	NetJobPtr m_listJob;
+	MetaEntryPtr m_listEntry;
+	CacheDownloadPtr m_listDownload;
+	QFutureWatcher<ParseResult> m_parseWatcher;
+
+	/// VersionListCache key of the file the current list was made from
+	QString m_cacheKey;
 
 	bool m_loading;
 	bool m_errored;
@@ -142,7 +162,17 @@ private:
 
 	void setLoading(bool loading);
 
+	void setVersions(const QStringList &names, const QStringList &urls);
+
+	static MetaEntryPtr sourceEntry();
+	static QString storedListPath();
+
+	/// runs on a worker thread. Parses the feed and stores the result under 'key'.
+	static ParseResult parseList(QString listFile, QString storePath, QString key);
+
 private
 slots:
-	virtual void netRequestComplete();
+	void listDownloaded();
+	void listFailed();
+	void listParsed();
 };
@@ -22,7 +22,9 @@
 #include <quazip.h>
 #include <quazipfile.h>
 
+#include "MultiMC.h"
 #include "Mod.h"
+#include "ModIndex.h"
 #include <pathutils.h>
 #include "logic/settings/INIFile.h"
 #include "logger/QsLog.h"
@@ -38,6 +40,7 @@ void Mod::repath(const QFileInfo &file)
 	QString name_base = file.fileName();
 
 	m_type = Mod::MOD_UNKNOWN;
+	m_coremod = false;
 
 	if (m_file.isDir())
 	{
@@ -84,32 +87,27 @@ void Mod::repath(const QFileInfo &file)
 
 		if (zip.setCurrentFile("mcmod.info"))
 		{
-			if (!file.open(QIODevice::ReadOnly))
+			if (file.open(QIODevice::ReadOnly))
 			{
-				zip.close();
-				return;
+				ReadMCModInfo(file.readAll());
+				file.close();
 			}
-
-			ReadMCModInfo(file.readAll());
-			file.close();
-			zip.close();
-			return;
 		}
 		else if (zip.setCurrentFile("forgeversion.properties"))
 		{
-			if (!file.open(QIODevice::ReadOnly))
+			if (file.open(QIODevice::ReadOnly))
 			{
-				zip.close();
-				return;
+				ReadForgeInfo(file.readAll());
+				file.close();
 			}
-
-			ReadForgeInfo(file.readAll());
-			file.close();
-			zip.close();
-			return;
 		}
-
 		zip.close();
+
+		// fill in what the info files didn't tell us from the mod's classes and manifest.
+		// jars that aren't indexed yet get this later, from the mod list.
+		ModIndexEntry entry;
+		if (MMC->modindex()->findCached(m_file, entry))
+			ReadIndexedInfo(entry);
 	}
 	else if (m_type == MOD_FOLDER)
 	{
@@ -223,6 +221,22 @@ void Mod::ReadMCModInfo(QByteArray contents)
 	}
 }
 
+void Mod::ReadIndexedInfo(const ModIndexEntry &entry)
+{
+	m_coremod = entry.isCoreMod();
+	m_dependencies = entry.dependencies;
+	if (m_mod_id.isEmpty())
+	{
+		m_mod_id = entry.modid;
+		if (!entry.name.isEmpty())
+			m_name = entry.name;
+	}
+	if (m_version.isEmpty())
+		m_version = entry.version;
+	if (m_mcversion.isEmpty())
+		m_mcversion = entry.mcversion;
+}
+
 void Mod::ReadForgeInfo(QByteArray contents)
 {
 	// Read the data
@@ -292,6 +306,8 @@ bool Mod::replace(Mod &with)
 		m_credits = with.m_credits;
 		m_homeurl = with.m_homeurl;
 		m_type = with.m_type;
+		m_coremod = with.m_coremod;
+		m_dependencies = with.m_dependencies;
 		m_file.refresh();
 	}
 	return success;
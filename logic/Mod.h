@@ -16,6 +16,8 @@
 #pragma once
 #include <QFileInfo>
 
+struct ModIndexEntry;
+
 class Mod
 {
 public:
@@ -87,6 +89,18 @@ public:
 		return m_enabled;
 	}
 
+	/// true if the manifest declares a core plugin or tweaker
+	bool coremod() const
+	{
+		return m_coremod;
+	}
+
+	/// the dependency string of the @Mod annotation, as found by the mod index
+	QString dependencies() const
+	{
+		return m_dependencies;
+	}
+
 	bool enable(bool value);
 
 	// delete all the files of this mod
@@ -96,6 +110,9 @@ public:
 	// change the mod's filesystem path (used by mod lists for *MAGIC* purposes)
 	void repath(const QFileInfo &file);
 
+	// fill in what mcmod.info didn't say from the mod index
+	void ReadIndexedInfo(const ModIndexEntry &entry);
+
 	// WEAK compare operator - used for replacing mods
 	bool operator==(const Mod &other) const;
 	bool strongCompare(const Mod &other) const;
@@ -125,6 +142,8 @@ protected:
 	QString m_description;
 	QString m_authors;
 	QString m_credits;
+	bool m_coremod = false;
+	QString m_dependencies;
 
 	ModType m_type;
 };
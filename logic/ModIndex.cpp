@@ -0,0 +1,347 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModIndex.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QSet>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtConcurrentMap>
+#include <quazip.h>
+#include <quazipfile.h>
+#include <javautils.h>
+
+#include "logger/QsLog.h"
+
+struct ModIndexScanner
+{
+	typedef ModIndex::ScanResult result_type;
+	ModIndex *index;
+	ModIndex::ScanResult operator()(const QFileInfo &file)
+	{
+		return index->scanFile(file);
+	}
+};
+
+namespace
+{
+bool isIndexable(const QFileInfo &file)
+{
+	if (!file.isFile())
+		return false;
+	QString name = file.fileName();
+	if (name.endsWith(".disabled"))
+		name.chop(9);
+	return name.endsWith(".jar") || name.endsWith(".zip");
+}
+
+qint64 lastChanged(const QFileInfo &file)
+{
+	return file.lastModified().toUTC().toMSecsSinceEpoch();
+}
+}
+
+ModIndex::ModIndex(QString path) : QObject()
+{
+	m_index_file = path;
+	saveBatchingTimer.setSingleShot(true);
+	saveBatchingTimer.setTimerType(Qt::VeryCoarseTimer);
+	connect(&saveBatchingTimer, SIGNAL(timeout()), SLOT(SaveNow()));
+}
+
+ModIndex::~ModIndex()
+{
+	saveBatchingTimer.stop();
+	SaveNow();
+}
+
+QFuture<ModIndex::ScanResult> ModIndex::scan(const QList<QFileInfo> &files)
+{
+	QList<QFileInfo> todo;
+	for (auto file : files)
+	{
+		ModIndexEntry unused;
+		if (isIndexable(file) && !findCached(file, unused))
+			todo.append(file);
+	}
+	ModIndexScanner scanner;
+	scanner.index = this;
+	return QtConcurrent::mapped(todo, scanner);
+}
+
+bool ModIndex::findCached(const QFileInfo &file, ModIndexEntry &entry)
+{
+	QMutexLocker locker(&m_mutex);
+	auto stamp = m_stamps.find(file.absoluteFilePath());
+	if (stamp == m_stamps.end())
+		return false;
+	if (stamp->size != file.size() || stamp->last_changed_timestamp != lastChanged(file))
+		return false;
+	auto found = m_entries.find(stamp->sha1);
+	if (found == m_entries.end())
+		return false;
+	entry = *found;
+	return true;
+}
+
+bool ModIndex::findEntry(const QString &sha1, ModIndexEntry &entry)
+{
+	QMutexLocker locker(&m_mutex);
+	auto found = m_entries.find(sha1);
+	if (found == m_entries.end())
+		return false;
+	entry = *found;
+	return true;
+}
+
+ModIndex::ScanResult ModIndex::scanFile(const QFileInfo &file)
+{
+	ScanResult result;
+	result.path = file.absoluteFilePath();
+	result.stamp.size = file.size();
+	result.stamp.last_changed_timestamp = lastChanged(file);
+
+	QFile input(result.path);
+	if (!input.open(QIODevice::ReadOnly))
+		return result;
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	if (!hash.addData(&input))
+		return result;
+	input.close();
+	result.stamp.sha1 = hash.result().toHex();
+
+	// the same jar may be in another instance already
+	if (!findEntry(result.stamp.sha1, result.entry))
+	{
+		result.entry = scanJar(result.path);
+		result.scanned = true;
+	}
+	return result;
+}
+
+void ModIndex::addResult(const ScanResult &result)
+{
+	if (result.stamp.sha1.isEmpty())
+		return;
+	QMutexLocker locker(&m_mutex);
+	m_stamps[result.path] = result.stamp;
+	if (result.scanned)
+		m_entries[result.stamp.sha1] = result.entry;
+	SaveEventually();
+}
+
+ModIndexEntry ModIndex::scanJar(const QString &path)
+{
+	ModIndexEntry entry;
+	QuaZip zip(path);
+	if (!zip.open(QuaZip::mdUnzip))
+		return entry;
+
+	QuaZipFile file(&zip);
+	bool foundMod = false;
+	for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+	{
+		QString name = zip.getCurrentFileName();
+		bool isManifest = name.compare("META-INF/MANIFEST.MF", Qt::CaseInsensitive) == 0;
+		// we're only after the first @Mod class, after that only the manifest is interesting
+		bool isClass = !foundMod && name.endsWith(".class");
+		if (!isManifest && !isClass)
+			continue;
+		if (!file.open(QIODevice::ReadOnly))
+			continue;
+		QByteArray contents = file.readAll();
+		file.close();
+
+		if (isManifest)
+		{
+			readManifest(contents, entry);
+			continue;
+		}
+		javautils::ModAnnotation annotation;
+		if (!javautils::GetModAnnotation(contents, annotation))
+			continue;
+		entry.modid = annotation.modid;
+		entry.name = annotation.name;
+		entry.version = annotation.version;
+		entry.dependencies = annotation.dependencies;
+		entry.mcversion = annotation.acceptedMinecraftVersions;
+		// @NetworkMod alone doesn't tell us anything, keep looking for the @Mod
+		foundMod = annotation.annotation == "Mod";
+	}
+	zip.close();
+	return entry;
+}
+
+void ModIndex::readManifest(const QByteArray &contents, ModIndexEntry &entry)
+{
+	// 'Name: value' lines. Long values continue on lines starting with a space.
+	QMap<QString, QString> attributes;
+	QString last;
+	for (auto line : QString::fromUtf8(contents).split('\n'))
+	{
+		if (line.endsWith('\r'))
+			line.chop(1);
+		if (line.startsWith(' ') && !last.isEmpty())
+		{
+			attributes[last] += line.mid(1);
+			continue;
+		}
+		int colon = line.indexOf(':');
+		if (colon <= 0)
+			continue;
+		last = line.left(colon).trimmed();
+		attributes[last] = line.mid(colon + 1).trimmed();
+	}
+	entry.corePlugin = attributes.value("FMLCorePlugin");
+	entry.tweakClass = attributes.value("TweakClass");
+	// FML only checks whether this one is there at all
+	entry.coreModContainsMod = attributes.contains("FMLCorePluginContainsFMLMod");
+}
+
+void ModIndex::Load()
+{
+	QFile index(m_index_file);
+	if (!index.open(QIODevice::ReadOnly))
+		return;
+
+	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
+	if (!json.isObject())
+		return;
+	auto root = json.object();
+	// check file version first
+	auto version_val = root.value("version");
+	if (!version_val.isString())
+		return;
+	if (version_val.toString() != "1")
+		return;
+
+	QMutexLocker locker(&m_mutex);
+	for (auto element : root.value("mods").toArray())
+	{
+		auto obj = element.toObject();
+		ModIndexEntry entry;
+		entry.modid = obj.value("modid").toString();
+		entry.name = obj.value("name").toString();
+		entry.version = obj.value("version").toString();
+		entry.dependencies = obj.value("dependencies").toString();
+		entry.mcversion = obj.value("mcversion").toString();
+		entry.corePlugin = obj.value("corePlugin").toString();
+		entry.tweakClass = obj.value("tweakClass").toString();
+		entry.coreModContainsMod = obj.value("coreModContainsMod").toBool();
+		m_entries[obj.value("sha1").toString()] = entry;
+	}
+	for (auto element : root.value("files").toArray())
+	{
+		auto obj = element.toObject();
+		FileStamp stamp;
+		stamp.size = obj.value("size").toDouble();
+		stamp.last_changed_timestamp = obj.value("last_changed_timestamp").toDouble();
+		stamp.sha1 = obj.value("sha1").toString();
+		m_stamps[obj.value("path").toString()] = stamp;
+	}
+	prune();
+}
+
+void ModIndex::prune()
+{
+	// forget the jars that were deleted since, and what was only known about them
+	QSet<QString> referenced;
+	for (auto iter = m_stamps.begin(); iter != m_stamps.end();)
+	{
+		if (!QFile::exists(iter.key()))
+		{
+			iter = m_stamps.erase(iter);
+			continue;
+		}
+		referenced.insert(iter->sha1);
+		iter++;
+	}
+	for (auto iter = m_entries.begin(); iter != m_entries.end();)
+	{
+		if (!referenced.contains(iter.key()))
+			iter = m_entries.erase(iter);
+		else
+			iter++;
+	}
+}
+
+void ModIndex::SaveEventually()
+{
+	// reset the save timer
+	saveBatchingTimer.stop();
+	saveBatchingTimer.start(30000);
+}
+
+void ModIndex::SaveNow()
+{
+	QSaveFile tfile(m_index_file);
+	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return;
+	QJsonObject toplevel;
+	toplevel.insert("version", QJsonValue(QString("1")));
+	QJsonArray modsArr;
+	QJsonArray filesArr;
+	{
+		QMutexLocker locker(&m_mutex);
+		for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+		{
+			const ModIndexEntry &entry = *iter;
+			QJsonObject entryObj;
+			entryObj.insert("sha1", iter.key());
+			if (!entry.modid.isEmpty())
+				entryObj.insert("modid", entry.modid);
+			if (!entry.name.isEmpty())
+				entryObj.insert("name", entry.name);
+			if (!entry.version.isEmpty())
+				entryObj.insert("version", entry.version);
+			if (!entry.dependencies.isEmpty())
+				entryObj.insert("dependencies", entry.dependencies);
+			if (!entry.mcversion.isEmpty())
+				entryObj.insert("mcversion", entry.mcversion);
+			if (!entry.corePlugin.isEmpty())
+				entryObj.insert("corePlugin", entry.corePlugin);
+			if (!entry.tweakClass.isEmpty())
+				entryObj.insert("tweakClass", entry.tweakClass);
+			if (entry.coreModContainsMod)
+				entryObj.insert("coreModContainsMod", true);
+			modsArr.append(entryObj);
+		}
+		for (auto iter = m_stamps.begin(); iter != m_stamps.end(); iter++)
+		{
+			QJsonObject stampObj;
+			stampObj.insert("path", iter.key());
+			stampObj.insert("size", double(iter->size));
+			stampObj.insert("last_changed_timestamp", double(iter->last_changed_timestamp));
+			stampObj.insert("sha1", iter->sha1);
+			filesArr.append(stampObj);
+		}
+	}
+	toplevel.insert("mods", modsArr);
+	toplevel.insert("files", filesArr);
+	QJsonDocument doc(toplevel);
+	QByteArray jsonData = doc.toJson();
+	qint64 result = tfile.write(jsonData);
+	if (result == -1)
+		return;
+	if (result != jsonData.size())
+		return;
+	tfile.commit();
+}
@@ -0,0 +1,116 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QList>
+#include <QMutex>
+#include <QFileInfo>
+#include <QTimer>
+#include <QFuture>
+
+/**
+ * What we could find out about a mod jar without running it, from the @Mod annotation of
+ * its mod class and from its manifest.
+ */
+struct ModIndexEntry
+{
+	QString modid;
+	QString name;
+	QString version;
+	QString dependencies;
+	QString mcversion;
+	/// FMLCorePlugin from the manifest
+	QString corePlugin;
+	/// TweakClass from the manifest
+	QString tweakClass;
+	/// FMLCorePluginContainsFMLMod from the manifest
+	bool coreModContainsMod = false;
+
+	bool isCoreMod() const
+	{
+		return !corePlugin.isEmpty() || !tweakClass.isEmpty();
+	}
+};
+
+/**
+ * Index of mod jars, shared by all instances.
+ *
+ * Scan results are stored by the SHA-1 of the jar, so the same jar in many instances is only
+ * scanned once. Hashing is skipped for files whose path, size and modification time haven't
+ * changed since the last time.
+ */
+class ModIndex : public QObject
+{
+	Q_OBJECT
+public:
+	struct FileStamp
+	{
+		qint64 size = 0;
+		qint64 last_changed_timestamp = 0;
+		QString sha1;
+	};
+	struct ScanResult
+	{
+		QString path;
+		FileStamp stamp;
+		bool scanned = false;
+		ModIndexEntry entry;
+	};
+
+	// supply path to the index file
+	ModIndex(QString path);
+	~ModIndex();
+
+	/**
+	 * Start scanning the jars that aren't indexed yet on the thread pool.
+	 * Hand the results to addResult once they arrive.
+	 */
+	QFuture<ScanResult> scan(const QList<QFileInfo> &files);
+
+	/// Store the result of a scan. Call from the thread the index lives in.
+	void addResult(const ScanResult &result);
+
+	/// Get the index entry for a jar if it's indexed and hasn't changed. Never scans.
+	bool findCached(const QFileInfo &file, ModIndexEntry &entry);
+
+	void Load();
+
+	// (re)start a timer that calls SaveNow later.
+	void SaveEventually();
+public
+slots:
+	void SaveNow();
+
+private:
+	friend struct ModIndexScanner;
+
+	/// Hash and (if the hash is unknown) scan a jar. Safe to call from any thread.
+	ScanResult scanFile(const QFileInfo &file);
+	bool findEntry(const QString &sha1, ModIndexEntry &entry);
+	/// drop the stamps of files that are gone and the entries nothing refers to. Lock first.
+	void prune();
+
+	static ModIndexEntry scanJar(const QString &path);
+	static void readManifest(const QByteArray &contents, ModIndexEntry &entry);
+
+	QMutex m_mutex;
+	QMap<QString, ModIndexEntry> m_entries;
+	QMap<QString, FileStamp> m_stamps;
+	QString m_index_file;
+	QTimer saveBatchingTimer;
+};
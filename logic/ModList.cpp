@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include "MultiMC.h"
 #include "ModList.h"
 #include "LegacyInstance.h"
 #include <pathutils.h>
@@ -35,6 +36,8 @@ ModList::ModList(const QString &dir, const QString &list_file)
 	is_watching = false;
 	connect(m_watcher, SIGNAL(directoryChanged(QString)), this,
 			SLOT(directoryChanged(QString)));
+	m_indexWatcher = new QFutureWatcher<ModIndex::ScanResult>(this);
+	connect(m_indexWatcher, SIGNAL(resultReadyAt(int)), SLOT(indexResultReady(int)));
 }
 
 void ModList::startWatching()
@@ -159,7 +162,9 @@ bool ModList::update()
 	}
 	beginResetModel();
 	mods.swap(orderedMods);
+	updateRows();
 	endResetModel();
+	indexMods();
 	if (orderOrStateChanged && !m_list_file.isEmpty())
 	{
 		QLOG_INFO() << "Mod list " << m_list_file << " changed!";
@@ -174,6 +179,39 @@ void ModList::directoryChanged(QString path)
 	update();
 }
 
+void ModList::indexMods()
+{
+	QList<QFileInfo> files;
+	for (auto &mod : mods)
+	{
+		if (mod.type() == Mod::MOD_ZIPFILE)
+			files.append(mod.filename());
+	}
+	// jars the previous scan didn't get to are picked up by this one
+	m_indexWatcher->cancel();
+	m_indexWatcher->setFuture(MMC->modindex()->scan(files));
+}
+
+void ModList::updateRows()
+{
+	m_rows.clear();
+	m_rows.reserve(mods.size());
+	for (int row = 0; row < mods.size(); row++)
+		m_rows.insert(mods[row].filename().absoluteFilePath(), row);
+}
+
+void ModList::indexResultReady(int index)
+{
+	auto result = m_indexWatcher->resultAt(index);
+	MMC->modindex()->addResult(result);
+	auto found = m_rows.find(result.path);
+	if (found == m_rows.end())
+		return;
+	int row = *found;
+	mods[row].ReadIndexedInfo(result.entry);
+	emit dataChanged(this->index(row), this->index(row, columnCount(QModelIndex()) - 1));
+}
+
 ModList::OrderList ModList::readListFile()
 {
 	OrderList itemList;
@@ -276,7 +314,9 @@ bool ModList::installMod(const QFileInfo &filename, int index)
 		m.repath(newpath);
 		beginInsertRows(QModelIndex(), index, index);
 		mods.insert(index, m);
+		updateRows();
 		endInsertRows();
+		indexMods();
 		saveListFile();
 		emit changed();
 		return true;
@@ -291,6 +331,7 @@ bool ModList::installMod(const QFileInfo &filename, int index)
 		m.repath(to);
 		beginInsertRows(QModelIndex(), index, index);
 		mods.insert(index, m);
+		updateRows();
 		endInsertRows();
 		saveListFile();
 		emit changed();
@@ -308,6 +349,7 @@ bool ModList::deleteMod(int index)
 	{
 		beginRemoveRows(QModelIndex(), index, index);
 		mods.removeAt(index);
+		updateRows();
 		endRemoveRows();
 		saveListFile();
 		emit changed();
@@ -325,6 +367,7 @@ bool ModList::deleteMods(int first, int last)
 	}
 	beginRemoveRows(QModelIndex(), first, last);
 	mods.erase(mods.begin() + first, mods.begin() + last + 1);
+	updateRows();
 	endRemoveRows();
 	saveListFile();
 	emit changed();
@@ -344,6 +387,7 @@ bool ModList::moveModTo(int from, int to)
 	int togap = to > from ? to + 1 : to;
 	beginMoveRows(QModelIndex(), from, from, QModelIndex(), togap);
 	mods.move(from, to);
+	updateRows();
 	endMoveRows();
 	saveListFile();
 	emit changed();
@@ -364,6 +408,7 @@ bool ModList::moveModsUp(int first, int last)
 
 	beginMoveRows(QModelIndex(), first, last, QModelIndex(), first - 1);
 	mods.move(first - 1, last);
+	updateRows();
 	endMoveRows();
 	saveListFile();
 	emit changed();
@@ -386,6 +431,7 @@ bool ModList::moveModsDown(int first, int last)
 
 	beginMoveRows(QModelIndex(), first, last, QModelIndex(), last + 2);
 	mods.move(last + 1, first);
+	updateRows();
 	endMoveRows();
 	saveListFile();
 	emit changed();
@@ -394,7 +440,7 @@ bool ModList::moveModsDown(int first, int last)
 
 int ModList::columnCount(const QModelIndex &parent) const
 {
-	return 3;
+	return 5;
 }
 
 QVariant ModList::data(const QModelIndex &index, int role) const
@@ -417,6 +463,10 @@ QVariant ModList::data(const QModelIndex &index, int role) const
 			return mods[row].name();
 		case VersionColumn:
 			return mods[row].version();
+		case CoreModColumn:
+			return mods[row].coremod() ? tr("Yes") : QString();
+		case DependenciesColumn:
+			return mods[row].dependencies();
 
 		default:
 			return QVariant();
@@ -450,6 +500,8 @@ bool ModList::setData(const QModelIndex &index, const QVariant &value, int role)
 		auto &mod = mods[index.row()];
 		if (mod.enable(!mod.enabled()))
 		{
+			// the file gets renamed
+			updateRows();
 			emit dataChanged(index, index);
 			return true;
 		}
@@ -470,6 +522,10 @@ QVariant ModList::headerData(int section, Qt::Orientation orientation, int role)
 			return tr("Name");
 		case VersionColumn:
 			return tr("Version");
+		case CoreModColumn:
+			return tr("Core mod");
+		case DependenciesColumn:
+			return tr("Dependencies");
 		default:
 			return QVariant();
 		}
@@ -483,6 +539,10 @@ QVariant ModList::headerData(int section, Qt::Orientation orientation, int role)
 			return tr("The name of the mod.");
 		case VersionColumn:
 			return tr("The version of the mod.");
+		case CoreModColumn:
+			return tr("Does the mod have a core plugin or tweaker?");
+		case DependenciesColumn:
+			return tr("The mods this mod wants loaded before or after it.");
 		default:
 			return QVariant();
 		}
@@ -581,6 +641,7 @@ bool ModList::dropMimeData(const QMimeData *data, Qt::DropAction action, int row
 			{
 				beginResetModel();
 				internalSort(mods);
+				updateRows();
 				endResetModel();
 			}
 		}
@@ -18,9 +18,12 @@
 #include <QList>
 #include <QString>
 #include <QDir>
+#include <QHash>
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 
 #include "logic/Mod.h"
+#include "logic/ModIndex.h"
 
 class LegacyInstance;
 class BaseInstance;
@@ -38,7 +41,9 @@ public:
 	{
 		ActiveColumn = 0,
 		NameColumn,
-		VersionColumn
+		VersionColumn,
+		CoreModColumn,
+		DependenciesColumn
 	};
 	ModList(const QString &dir, const QString &list_file = QString());
 
@@ -136,18 +141,26 @@ private:
 	typedef QList<OrderItem> OrderList;
 	OrderList readListFile();
 	bool saveListFile();
+	/// scan the jars the mod index doesn't know yet, without blocking
+	void indexMods();
+	/// rebuild m_rows after the mods were added, removed or moved around
+	void updateRows();
 private
 slots:
 	void directoryChanged(QString path);
+	void indexResultReady(int index);
 
 signals:
 	void changed();
 
 protected:
 	QFileSystemWatcher *m_watcher;
+	QFutureWatcher<ModIndex::ScanResult> *m_indexWatcher;
 	bool is_watching;
 	QDir m_dir;
 	QString m_list_file;
 	QString m_list_id;
 	QList<Mod> mods;
+	/// row of each mod by its absolute path
+	QHash<QString, int> m_rows;
 };
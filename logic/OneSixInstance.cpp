@@ -24,6 +24,8 @@
 #include "logic/OneSixInstance_p.h"
 #include "logic/OneSixUpdate.h"
 #include "logic/minecraft/InstanceVersion.h"
+#include "logic/minecraft/NativesCache.h"
+#include "logic/minecraft/VersionSnapshot.h"
 #include "minecraft/VersionBuildError.h"
 
 #include "logic/assets/AssetsUtils.h"
@@ -46,13 +48,24 @@ OneSixInstance::OneSixInstance(const QString &rootDir, SettingsObject *settings,
 	I_D(OneSixInstance);
 	d->m_settings->registerSetting("IntendedVersion", "");
 	d->version.reset(new InstanceVersion(this, this));
+	// any change to the version makes the launch plan outdated
+	connect(d->version.get(), SIGNAL(modelReset()), SLOT(invalidateLaunchPlan()));
+	connect(d->version.get(), SIGNAL(rowsInserted(QModelIndex, int, int)),
+			SLOT(invalidateLaunchPlan()));
+	connect(d->version.get(), SIGNAL(rowsRemoved(QModelIndex, int, int)),
+			SLOT(invalidateLaunchPlan()));
+	connect(d->version.get(), SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)),
+			SLOT(invalidateLaunchPlan()));
 }
 
 void OneSixInstance::init()
 {
+	I_D(OneSixInstance);
 	try
 	{
 		reloadVersion();
+		// the plan made by the last update, if the version hasn't changed since
+		d->launch_plan = LaunchPlan::load(launchPlanPath(), launchPlanKey());
 	}
 	catch (MMCError &e)
 	{
@@ -98,30 +111,6 @@ std::shared_ptr<Task> OneSixInstance::doUpdate()
 	return std::shared_ptr<Task>(new OneSixUpdate(this));
 }
 
-QString replaceTokensIn(QString text, QMap<QString, QString> with)
-{
-	QString result;
-	QRegExp token_regexp("\\$\\{(.+)\\}");
-	token_regexp.setMinimal(true);
-	QStringList list;
-	int tail = 0;
-	int head = 0;
-	while ((head = token_regexp.indexIn(text, head)) != -1)
-	{
-		result.append(text.mid(tail, head - tail));
-		QString key = token_regexp.cap(1);
-		auto iter = with.find(key);
-		if (iter != with.end())
-		{
-			result.append(*iter);
-		}
-		head += token_regexp.matchedLength();
-		tail = head;
-	}
-	result.append(text.mid(tail));
-	return result;
-}
-
 QDir OneSixInstance::reconstructAssets(std::shared_ptr<InstanceVersion> version)
 {
 	QDir assetsDir = QDir("assets/");
@@ -182,72 +171,25 @@ QDir OneSixInstance::reconstructAssets(std::shared_ptr<InstanceVersion> version)
 	return virtualRoot;
 }
 
-QStringList OneSixInstance::processMinecraftArgs(AuthSessionPtr session)
+LaunchPlanPtr OneSixInstance::compileLaunchPlan(QString &error, const QString &natives)
 {
 	I_D(OneSixInstance);
 	auto version = d->version;
-	QString args_pattern = version->minecraftArguments;
-	for (auto tweaker : version->tweakers)
-	{
-		args_pattern += " --tweakClass " + tweaker;
-	}
-
-	QMap<QString, QString> token_mapping;
-	// yggdrasil!
-	token_mapping["auth_username"] = session->username;
-	token_mapping["auth_session"] = session->session;
-	token_mapping["auth_access_token"] = session->access_token;
-	token_mapping["auth_player_name"] = session->player_name;
-	token_mapping["auth_uuid"] = session->uuid;
-
-	// these do nothing and are stupid.
-	token_mapping["profile_name"] = name();
-	token_mapping["version_name"] = version->id;
-
-	QString absRootDir = QDir(minecraftRoot()).absolutePath();
-	token_mapping["game_directory"] = absRootDir;
-	QString absAssetsDir = QDir("assets/").absolutePath();
-	token_mapping["game_assets"] = reconstructAssets(d->version).absolutePath();
-
-	token_mapping["user_properties"] = session->serializeUserProperties();
-	token_mapping["user_type"] = session->user_type;
-	// 1.7.3+ assets tokens
-	token_mapping["assets_root"] = absAssetsDir;
-	token_mapping["assets_index_name"] = version->assets;
-
-	QStringList parts = args_pattern.split(' ', QString::SkipEmptyParts);
-	for (int i = 0; i < parts.length(); i++)
-	{
-		parts[i] = replaceTokensIn(parts[i], token_mapping);
-	}
-	return parts;
-}
-
-bool OneSixInstance::prepareForLaunch(AuthSessionPtr session, QString &launchScript)
-{
-	I_D(OneSixInstance);
-
-	QIcon icon = MMC->icons()->getIcon(iconKey());
-	auto pixmap = icon.pixmap(128, 128);
-	pixmap.save(PathCombine(minecraftRoot(), "icon.png"), "PNG");
-
-	auto version = d->version;
-	if (!version)
-		return nullptr;
+	LaunchPlanPtr plan(new LaunchPlan());
 
 	// libraries and class path.
 	{
 		auto libs = version->getActiveNormalLibs();
 		for (auto lib : libs)
 		{
-			launchScript += "cp " + librariesPath().absoluteFilePath(lib->storagePath()) + "\n";
+			plan->addClassPath(librariesPath().absoluteFilePath(lib->storagePath()));
 		}
 		QString minecraftjarpath;
 		if (version->hasJarMods())
 		{
 			for (auto jarmod : version->jarMods)
 			{
-				launchScript += "cp " + jarmodsPath().absoluteFilePath(jarmod->name) + "\n";
+				plan->addClassPath(jarmodsPath().absoluteFilePath(jarmod->name));
 			}
 			minecraftjarpath = version->id + "/" + version->id + "-stripped.jar";
 		}
@@ -255,21 +197,158 @@ bool OneSixInstance::prepareForLaunch(AuthSessionPtr session, QString &launchScr
 		{
 			minecraftjarpath = version->id + "/" + version->id + ".jar";
 		}
-		launchScript += "cp " + versionsPath().absoluteFilePath(minecraftjarpath) + "\n";
+		plan->addClassPath(versionsPath().absoluteFilePath(minecraftjarpath));
 	}
-	if (!version->mainClass.isEmpty())
+	plan->mainClass = version->mainClass;
+	plan->appletClass = version->appletClass;
+
+	// generic minecraft params. everything that doesn't depend on the session or the
+	// instance name is filled in right away.
 	{
-		launchScript += "mainClass " + version->mainClass + "\n";
+		QString args_pattern = version->minecraftArguments;
+		for (auto tweaker : version->tweakers)
+		{
+			args_pattern += " --tweakClass " + tweaker;
+		}
+
+		QMap<QString, QString> token_mapping;
+		token_mapping["version_name"] = version->id;
+		token_mapping["game_directory"] = QDir(minecraftRoot()).absolutePath();
+		QString virtualAssetsDir = reconstructAssets(version).absolutePath();
+		token_mapping["game_assets"] = virtualAssetsDir;
+		// reconstruct the virtual assets again if someone deletes them
+		if (QDir(virtualAssetsDir).exists())
+			plan->addRequiredFolder(virtualAssetsDir);
+		// 1.7.3+ assets tokens
+		token_mapping["assets_root"] = QDir("assets/").absolutePath();
+		token_mapping["assets_index_name"] = version->assets;
+		plan->setArguments(args_pattern, token_mapping);
+		// a new asset index needs the virtual assets reconstructed
+		plan->addInput(QDir("assets/indexes/").absoluteFilePath(version->assets + ".json"));
 	}
-	if (!version->appletClass.isEmpty())
+
+	// native libraries (mostly LWJGL). normally already extracted by the update, which
+	// hands us the folder so the jars don't have to be hashed again.
 	{
-		launchScript += "appletClass " + version->appletClass + "\n";
+		plan->natives =
+			natives.isEmpty()
+				? NativesCache::extract(version->getActiveNativeLibs(), librariesPath(), error)
+				: natives;
+		if (plan->natives.isEmpty())
+			return nullptr;
+		// the folder is named after the jars, changed jars need another one
+		for (auto native : version->getActiveNativeLibs())
+		{
+			QString storage = native->storagePath();
+			if (storage.contains("${arch}"))
+			{
+				plan->addInput(librariesPath().absoluteFilePath(
+					QString(storage).replace("${arch}", "32")));
+				plan->addInput(librariesPath().absoluteFilePath(
+					QString(storage).replace("${arch}", "64")));
+			}
+			else
+			{
+				plan->addInput(librariesPath().absoluteFilePath(storage));
+			}
+		}
+		if (plan->natives.contains("${arch}"))
+		{
+			plan->addRequiredFolder(QString(plan->natives).replace("${arch}", "32"));
+			plan->addRequiredFolder(QString(plan->natives).replace("${arch}", "64"));
+		}
+		else
+		{
+			plan->addRequiredFolder(plan->natives);
+		}
 	}
 
-	// generic minecraft params
-	for (auto param : processMinecraftArgs(session))
+	// traits. including legacyLaunch and others ;)
+	plan->traits = version->traits.toList();
+	return plan;
+}
+
+bool OneSixInstance::updateLaunchPlan(QString &error, const QString &natives)
+{
+	I_D(OneSixInstance);
+	d->launch_plan = compileLaunchPlan(error, natives);
+	if (!d->launch_plan)
+		return false;
+	d->launch_plan->save(launchPlanPath(), launchPlanKey());
+	return true;
+}
+
+bool OneSixInstance::launchPlanIsCurrent()
+{
+	I_D(OneSixInstance);
+	if (!d->launch_plan || d->version->snapshotKey().isEmpty())
+		return false;
+	// somebody may have changed the version files since they were loaded
+	if (VersionSnapshot::key(this, externalPatches()) != d->version->snapshotKey())
+		return false;
+	return d->launch_plan->isUpToDate();
+}
+
+QString OneSixInstance::launchPlanPath() const
+{
+	return PathCombine(instanceRoot(), "launch.plan");
+}
+
+QString OneSixInstance::launchPlanKey() const
+{
+	I_D(const OneSixInstance);
+	QString versionKey = d->version->snapshotKey();
+	if (versionKey.isEmpty())
+		return QString();
+	// the plan has absolute paths in it, moving the instance or MultiMC makes it useless
+	return versionKey + "\n" + QDir(minecraftRoot()).absolutePath() + "\n" +
+		   QDir::currentPath();
+}
+
+void OneSixInstance::invalidateLaunchPlan()
+{
+	I_D(OneSixInstance);
+	d->launch_plan.reset();
+}
+
+bool OneSixInstance::prepareForLaunch(AuthSessionPtr session, QString &launchScript)
+{
+	I_D(OneSixInstance);
+
+	QIcon icon = MMC->icons()->getIcon(iconKey());
+	auto pixmap = icon.pixmap(128, 128);
+	pixmap.save(PathCombine(minecraftRoot(), "icon.png"), "PNG");
+
+	auto version = d->version;
+	if (!version)
+		return false;
+
+	if (!d->launch_plan || !d->launch_plan->isUpToDate())
+	{
+		QString error;
+		if (!updateLaunchPlan(error))
+		{
+			QLOG_ERROR() << "Can't launch" << name() << "-" << error;
+			return false;
+		}
+	}
+
+	// class path, main class, minecraft params, natives and traits
 	{
-		launchScript += "param " + param + "\n";
+		QMap<QString, QString> token_mapping;
+		// yggdrasil!
+		token_mapping["auth_username"] = session->username;
+		token_mapping["auth_session"] = session->session;
+		token_mapping["auth_access_token"] = session->access_token;
+		token_mapping["auth_player_name"] = session->player_name;
+		token_mapping["auth_uuid"] = session->uuid;
+		token_mapping["user_properties"] = session->serializeUserProperties();
+		token_mapping["user_type"] = session->user_type;
+
+		// these do nothing and are stupid.
+		token_mapping["profile_name"] = name();
+
+		launchScript += d->launch_plan->script(token_mapping);
 	}
 
 	// window size, title and state, legacy
@@ -291,28 +370,13 @@ bool OneSixInstance::prepareForLaunch(AuthSessionPtr session, QString &launchScr
 		launchScript += "sessionId " + session->session + "\n";
 	}
 
-	// native libraries (mostly LWJGL)
-	{
-		QDir natives_dir(PathCombine(instanceRoot(), "natives/"));
-		for (auto native : version->getActiveNativeLibs())
-		{
-			QFileInfo finfo(PathCombine("libraries", native->storagePath()));
-			launchScript += "ext " + finfo.absoluteFilePath() + "\n";
-		}
-		launchScript += "natives " + natives_dir.absolutePath() + "\n";
-	}
-
-	// traits. including legacyLaunch and others ;)
-	for (auto trait : version->traits)
-	{
-		launchScript += "traits " + trait + "\n";
-	}
 	launchScript += "launcher onesix\n";
 	return true;
 }
 
 void OneSixInstance::cleanupAfterRun()
 {
+	// natives live in the shared cache now, this only removes leftovers from older versions
 	QString target_dir = PathCombine(instanceRoot(), "natives/");
 	QDir dir(target_dir);
 	dir.removeRecursively();
@@ -414,6 +478,7 @@ QString OneSixInstance::currentVersionId() const
 void OneSixInstance::reloadVersion()
 {
 	I_D(OneSixInstance);
+	d->launch_plan.reset();
 
 	try
 	{
@@ -437,6 +502,7 @@ void OneSixInstance::reloadVersion()
 void OneSixInstance::clearVersion()
 {
 	I_D(OneSixInstance);
+	d->launch_plan.reset();
 	d->version->clear();
 	emit versionReloaded();
 }
@@ -18,6 +18,7 @@
 #include "BaseInstance.h"
 
 #include "logic/minecraft/InstanceVersion.h"
+#include "logic/minecraft/LaunchPlan.h"
 #include "logic/ModList.h"
 #include "gui/pages/BasePageProvider.h"
 
@@ -77,6 +78,18 @@ public:
 	
 	/// get the current full version info
 	std::shared_ptr<InstanceVersion> getFullVersion() const;
+
+	/**
+	 * work out everything the launch needs from the current version, ahead of time.
+	 * 'natives' is the natives folder if the caller has extracted them already.
+	 */
+	bool updateLaunchPlan(QString &error, const QString &natives = QString());
+
+	/**
+	 * true if the version files are the ones the loaded version was built from and the launch
+	 * plan made from it still matches the files on disk. The update has nothing to do then.
+	 */
+	bool launchPlanIsCurrent();
 	
 	/// is the current version original, or custom?
 	virtual bool versionIsCustom() override;
@@ -104,8 +117,14 @@ public:
 signals:
 	void versionReloaded();
 
+private
+slots:
+	void invalidateLaunchPlan();
+
 private:
-	QStringList processMinecraftArgs(AuthSessionPtr account);
+	LaunchPlanPtr compileLaunchPlan(QString &error, const QString &natives);
+	QString launchPlanPath() const;
+	QString launchPlanKey() const;
 	QDir reconstructAssets(std::shared_ptr<InstanceVersion> version);
 };
 
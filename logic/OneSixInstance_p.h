@@ -16,6 +16,7 @@
 #pragma once
 
 #include "logic/BaseInstance_p.h"
+#include "logic/minecraft/LaunchPlan.h"
 
 class ModList;
 class InstanceVersion;
@@ -30,4 +31,5 @@ public:
 	std::shared_ptr<ModList> core_mod_list;
 	std::shared_ptr<ModList> resource_pack_list;
 	std::shared_ptr<ModList> texture_pack_list;
+	LaunchPlanPtr launch_plan;
 };
@@ -29,10 +29,12 @@
 #include "logic/minecraft/MinecraftVersionList.h"
 #include "logic/minecraft/InstanceVersion.h"
 #include "logic/minecraft/OneSixLibrary.h"
+#include "logic/minecraft/NativesCache.h"
 #include "logic/OneSixInstance.h"
 #include "logic/forge/ForgeMirrors.h"
 #include "logic/net/URLConstants.h"
 #include "logic/assets/AssetsUtils.h"
+#include "logic/DownloadPlan.h"
 
 OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
 {
@@ -86,17 +88,9 @@ void OneSixUpdate::versionUpdateFailed(QString reason)
 void OneSixUpdate::assetIndexStart()
 {
 	setStatus(tr("Updating assets index..."));
-	OneSixInstance *inst = (OneSixInstance *)m_inst;
-	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
-	QString assetName = version->assets;
-	QUrl indexUrl = "http://" + URLConstants::AWS_DOWNLOAD_INDEXES + assetName + ".json";
-	QString localPath = assetName + ".json";
-	auto job = new NetJob(tr("Asset index for %1").arg(inst->name()));
-
-	auto metacache = MMC->metacache();
-	auto entry = metacache->resolveEntry("asset_indexes", localPath);
-	job->addNetAction(CacheDownload::make(indexUrl, entry));
-	jarlibDownloadJob.reset(job);
+	DownloadPlan plan;
+	planAssetIndex(m_inst->getFullVersion()->assets, plan);
+	jarlibDownloadJob = plan.makeJob(tr("Asset index for %1").arg(m_inst->name()));
 
 	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetIndexFinished()));
 	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetIndexFailed()));
@@ -108,39 +102,22 @@ void OneSixUpdate::assetIndexStart()
 
 void OneSixUpdate::assetIndexFinished()
 {
-	AssetsIndex index;
-
-	OneSixInstance *inst = (OneSixInstance *)m_inst;
-	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
-	QString assetName = version->assets;
-
-	QString asset_fname = "assets/indexes/" + assetName + ".json";
-	if (!AssetsUtils::loadAssetsIndexJson(asset_fname, &index))
-	{
-		emitFailed(tr("Failed to read the assets index!"));
-	}
-
-	QList<Md5EtagDownloadPtr> dls;
-	for (auto object : index.objects.values())
+	// the asset index that just came in may be a new one
+	if (launchPlanCurrent)
+		launchPlanCurrent = m_inst->launchPlanIsCurrent();
+	DownloadPlan plan;
+	QString error;
+	if (!planAssets(m_inst->getFullVersion()->assets, plan, error))
 	{
-		QString objectName = object.hash.left(2) + "/" + object.hash;
-		QFileInfo objectFile("assets/objects/" + objectName);
-		if ((!objectFile.isFile()) || (objectFile.size() != object.size))
-		{
-			auto objectDL = MD5EtagDownload::make(
-				QUrl("http://" + URLConstants::RESOURCE_BASE + objectName),
-				objectFile.filePath());
-			objectDL->m_total_progress = object.size;
-			dls.append(objectDL);
-		}
+		emitFailed(error);
+		return;
 	}
-	if (dls.size())
+	if (!plan.isEmpty())
 	{
+		// legacy versions get a copy of the assets in the plan, so it has to be made again
+		launchPlanCurrent = false;
 		setStatus(tr("Getting the assets files from Mojang..."));
-		auto job = new NetJob(tr("Assets for %1").arg(inst->name()));
-		for (auto dl : dls)
-			job->addNetAction(dl);
-		jarlibDownloadJob.reset(job);
+		jarlibDownloadJob = plan.makeJob(tr("Assets for %1").arg(m_inst->name()));
 		connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetsFinished()));
 		connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetsFailed()));
 		connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
@@ -158,6 +135,12 @@ void OneSixUpdate::assetIndexFailed()
 
 void OneSixUpdate::assetsFinished()
 {
+	QString error;
+	if (!launchPlanCurrent && !m_inst->updateLaunchPlan(error, nativesPath))
+	{
+		emitFailed(tr("Failed to prepare the launch: %1").arg(error));
+		return;
+	}
 	emitSucceeded();
 }
 
@@ -168,12 +151,29 @@ void OneSixUpdate::assetsFailed()
 
 void OneSixUpdate::jarlibStart()
 {
+	// nothing changed since the last update: the libraries, native jars, natives and stripped
+	// jar are all still there, and the version doesn't have to be loaded again. The asset
+	// index is checked again once it's downloaded.
+	if (m_inst->launchPlanIsCurrent())
+	{
+		QLOG_INFO() << m_inst->name() << ": launch plan is current, skipping the libraries";
+		launchPlanCurrent = true;
+		if (m_inst->getFullVersion()->traits.contains("legacyFML"))
+		{
+			fmllibsStart();
+		}
+		else
+		{
+			assetIndexStart();
+		}
+		return;
+	}
+
 	setStatus(tr("Getting the library files from Mojang..."));
 	QLOG_INFO() << m_inst->name() << ": downloading libraries";
-	OneSixInstance *inst = (OneSixInstance *)m_inst;
 	try
 	{
-		inst->reloadVersion();
+		m_inst->reloadVersion();
 	}
 	catch (MMCError &e)
 	{
@@ -186,38 +186,140 @@ void OneSixUpdate::jarlibStart()
 		return;
 	}
 
-	// Build a list of URLs that will need to be downloaded.
-	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
+	jarHashOnEntry = versionJarHash(m_inst);
+	DownloadPlan plan;
+	QString error;
+	if (!planJarLibs(m_inst, plan, error))
+	{
+		emitFailed(error);
+		return;
+	}
+	jarlibDownloadJob = plan.makeJob(tr("Libraries for instance %1").arg(m_inst->name()));
+
+	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(jarlibFinished()));
+	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(jarlibFailed()));
+	connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+
+	jarlibDownloadJob->start();
+}
+
+void OneSixUpdate::jarlibFinished()
+{
+	std::shared_ptr<InstanceVersion> version = m_inst->getFullVersion();
+	QString error;
+
+	// create stripped jar, if needed
+	QString jarPath, strippedJarPath;
+	if (needsStrippedJar(m_inst, jarHashOnEntry, jarPath, strippedJarPath))
+	{
+		setStatus(tr("Creating stripped jar..."));
+		if (!stripJar(jarPath, strippedJarPath, error))
+		{
+			emitFailed(error);
+			return;
+		}
+	}
+
+	// extract natives now, so launching doesn't have to
+	{
+		setStatus(tr("Extracting native libraries..."));
+		nativesPath =
+			NativesCache::extract(version->getActiveNativeLibs(), m_inst->librariesPath(), error);
+		if (nativesPath.isEmpty())
+		{
+			emitFailed(tr("Failed to extract native libraries: %1").arg(error));
+			return;
+		}
+	}
+
+	if (version->traits.contains("legacyFML"))
+	{
+		fmllibsStart();
+	}
+	else
+	{
+		assetIndexStart();
+	}
+}
+
+void OneSixUpdate::jarlibFailed()
+{
+	QStringList failed = jarlibDownloadJob->getFailedFiles();
+	QString failed_all = failed.join("\n");
+	emitFailed(
+		tr("Failed to download the following files:\n%1\n\nPlease try again.").arg(failed_all));
+}
+
+void OneSixUpdate::fmllibsStart()
+{
+	// determine if we need some libs for FML or forge
+	setStatus(tr("Checking for FML libraries..."));
+	fmlLibsToProcess = missingFmlLibs(m_inst);
+
+	// if everything is in place, there's nothing to do here...
+	if (fmlLibsToProcess.isEmpty())
+	{
+		assetIndexStart();
+		return;
+	}
+
+	// download missing libs to our place
+	setStatus(tr("Dowloading FML libraries..."));
+	DownloadPlan plan;
+	planFmlLibs(fmlLibsToProcess, plan);
+	legacyDownloadJob = plan.makeJob("FML libraries");
+	connect(legacyDownloadJob.get(), SIGNAL(succeeded()), SLOT(fmllibsFinished()));
+	connect(legacyDownloadJob.get(), SIGNAL(failed()), SLOT(fmllibsFailed()));
+	connect(legacyDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	legacyDownloadJob->start();
+}
+
+void OneSixUpdate::fmllibsFinished()
+{
+	legacyDownloadJob.reset();
+	setStatus(tr("Copying FML libraries into the instance..."));
+	QString error;
+	if (!installFmlLibs(m_inst, fmlLibsToProcess, error))
+	{
+		emitFailed(error);
+		return;
+	}
+	assetIndexStart();
+}
+
+void OneSixUpdate::fmllibsFailed()
+{
+	emitFailed("Game update failed: it was impossible to fetch the required FML libraries.");
+	return;
+}
+
+QString OneSixUpdate::versionJarHash(OneSixInstance *inst)
+{
+	QString version_id = inst->getFullVersion()->id;
+	QString localPath = version_id + "/" + version_id + ".jar";
+	return MMC->metacache()->resolveEntry("versions", localPath)->md5sum;
+}
+
+void OneSixUpdate::planVersionFiles(InstanceVersion *version, DownloadPlan &plan)
+{
+	auto metacache = MMC->metacache();
 	// minecraft.jar for this version
 	{
 		QString version_id = version->id;
 		QString localPath = version_id + "/" + version_id + ".jar";
 		QString urlstr = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + localPath;
-
-		auto job = new NetJob(tr("Libraries for instance %1").arg(inst->name()));
-
-		auto metacache = MMC->metacache();
-		auto entry = metacache->resolveEntry("versions", localPath);
-		job->addNetAction(CacheDownload::make(QUrl(urlstr), entry));
-		jarHashOnEntry = entry->md5sum;
-		jarlibDownloadJob.reset(job);
+		plan.addCacheDownload(QUrl(urlstr), metacache->resolveEntry("versions", localPath));
 	}
 
 	auto libs = version->getActiveNativeLibs();
 	libs.append(version->getActiveNormalLibs());
 
-	auto metacache = MMC->metacache();
-	QList<ForgeXzDownloadPtr> ForgeLibs;
-	QList<std::shared_ptr<OneSixLibrary>> brokenLocalLibs;
-
 	for (auto lib : libs)
 	{
 		if (lib->hint() == "local")
-		{
-			if (!lib->filesExist(m_inst->librariesPath()))
-				brokenLocalLibs.append(lib);
 			continue;
-		}
 
 		QString raw_storage = lib->storagePath();
 		QString raw_dl = lib->downloadUrl();
@@ -229,11 +331,11 @@ void OneSixUpdate::jarlibStart()
 			{
 				if (lib->hint() == "forge-pack-xz")
 				{
-					ForgeLibs.append(ForgeXzDownload::make(storage, entry));
+					plan.addForgeXzDownload(storage, entry);
 				}
 				else
 				{
-					jarlibDownloadJob->addNetAction(CacheDownload::make(dl, entry));
+					plan.addCacheDownload(dl, entry);
 				}
 			}
 		};
@@ -251,113 +353,85 @@ void OneSixUpdate::jarlibStart()
 			f(raw_storage, raw_dl);
 		}
 	}
-	if (!brokenLocalLibs.empty())
-	{
-		jarlibDownloadJob.reset();
-		QStringList failed;
-		for (auto brokenLib : brokenLocalLibs)
-		{
-			failed.append(brokenLib->files());
-		}
-		QString failed_all = failed.join("\n");
-		emitFailed(tr("Some libraries marked as 'local' are missing their jar "
-					  "files:\n%1\n\nYou'll have to correct this problem manually. If this is "
-					  "an externally tracked instance, make sure to run it at least once "
-					  "outside of MultiMC.").arg(failed_all));
-		return;
-	}
-	// TODO: think about how to propagate this from the original json file... or IF AT ALL
-	QString forgeMirrorList = "http://files.minecraftforge.net/mirror-brand.list";
-	if (!ForgeLibs.empty())
-	{
-		jarlibDownloadJob->addNetAction(
-			ForgeMirrors::make(ForgeLibs, jarlibDownloadJob, forgeMirrorList));
-	}
-
-	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(jarlibFinished()));
-	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(jarlibFailed()));
-	connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
-			SIGNAL(progress(qint64, qint64)));
-
-	jarlibDownloadJob->start();
 }
 
-void OneSixUpdate::jarlibFinished()
+bool OneSixUpdate::planJarLibs(OneSixInstance *inst, DownloadPlan &plan, QString &error)
 {
-	OneSixInstance *inst = (OneSixInstance *)m_inst;
 	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
+	planVersionFiles(version.get(), plan);
 
-	// create stripped jar, if needed
-	if (version->hasJarMods())
-	{
-		// FIXME: good candidate for moving elsewhere (jar location resolving/version caching).
-		QString version_id = version->id;
-		QString localPath = version_id + "/" + version_id + ".jar";
-		QString strippedPath = version_id + "/" + version_id + "-stripped.jar";
-		auto metacache = MMC->metacache();
-		auto entry = metacache->resolveEntry("versions", localPath);
-		auto entryStripped = metacache->resolveEntry("versions", strippedPath);
-
-		QString fullJarPath = entry->getFullPath();
-		QString fullStrippedJarPath = entryStripped->getFullPath();
-		QFileInfo finfo(fullStrippedJarPath);
-		if (entry->md5sum != jarHashOnEntry || !finfo.exists())
-		{
-			stripJar(fullJarPath, fullStrippedJarPath);
-		}
-	}
-	if (version->traits.contains("legacyFML"))
+	auto libs = version->getActiveNativeLibs();
+	libs.append(version->getActiveNormalLibs());
+
+	QStringList failed;
+	for (auto lib : libs)
 	{
-		fmllibsStart();
+		if (lib->hint() == "local" && !lib->filesExist(inst->librariesPath()))
+			failed.append(lib->files());
 	}
-	else
+	if (!failed.empty())
 	{
-		assetIndexStart();
+		QString failed_all = failed.join("\n");
+		error = tr("Some libraries marked as 'local' are missing their jar "
+				   "files:\n%1\n\nYou'll have to correct this problem manually. If this is "
+				   "an externally tracked instance, make sure to run it at least once "
+				   "outside of MultiMC.").arg(failed_all);
+		return false;
 	}
+	return true;
 }
 
-void OneSixUpdate::jarlibFailed()
+bool OneSixUpdate::needsStrippedJar(OneSixInstance *inst, const QString &jarHashOnEntry,
+									QString &jarPath, QString &strippedJarPath)
 {
-	QStringList failed = jarlibDownloadJob->getFailedFiles();
-	QString failed_all = failed.join("\n");
-	emitFailed(
-		tr("Failed to download the following files:\n%1\n\nPlease try again.").arg(failed_all));
+	std::shared_ptr<InstanceVersion> version = inst->getFullVersion();
+	if (!version->hasJarMods())
+	{
+		return false;
+	}
+	// FIXME: good candidate for moving elsewhere (jar location resolving/version caching).
+	QString version_id = version->id;
+	QString localPath = version_id + "/" + version_id + ".jar";
+	QString strippedPath = version_id + "/" + version_id + "-stripped.jar";
+	auto metacache = MMC->metacache();
+	auto entry = metacache->resolveEntry("versions", localPath);
+	auto entryStripped = metacache->resolveEntry("versions", strippedPath);
+
+	jarPath = entry->getFullPath();
+	strippedJarPath = entryStripped->getFullPath();
+	QFileInfo finfo(strippedJarPath);
+	return entry->md5sum != jarHashOnEntry || !finfo.exists();
 }
 
-void OneSixUpdate::stripJar(QString origPath, QString newPath)
+bool OneSixUpdate::stripJar(QString origPath, QString newPath, QString &error)
 {
 	QFileInfo runnableJar(newPath);
 	if (runnableJar.exists() && !QFile::remove(runnableJar.filePath()))
 	{
-		emitFailed("Failed to delete old minecraft.jar");
-		return;
+		error = "Failed to delete old minecraft.jar";
+		return false;
 	}
 
-	// TaskStep(); // STEP 1
-	setStatus(tr("Creating stripped jar: Opening minecraft.jar ..."));
-
 	QuaZip zipOut(runnableJar.filePath());
 	if (!zipOut.open(QuaZip::mdCreate))
 	{
 		QFile::remove(runnableJar.filePath());
-		emitFailed("Failed to open the minecraft.jar for stripping");
-		return;
+		error = "Failed to open the minecraft.jar for stripping";
+		return false;
 	}
 	// Modify the jar
-	setStatus(tr("Creating stripped jar: Adding files..."));
 	if (!MergeZipFiles(&zipOut, origPath))
 	{
 		zipOut.close();
 		QFile::remove(runnableJar.filePath());
-		emitFailed("Failed to add " + origPath + " to the jar.");
-		return;
+		error = "Failed to add " + origPath + " to the jar.";
+		return false;
 	}
+	return true;
 }
 
 bool OneSixUpdate::MergeZipFiles(QuaZip *into, QString from)
 {
-	setStatus(tr("Installing mods: Adding ") + from + " ...");
-
 	QuaZip modZip(from);
 	modZip.open(QuaZip::mdUnzip);
 
@@ -405,101 +479,110 @@ bool OneSixUpdate::MergeZipFiles(QuaZip *into, QString from)
 	return true;
 }
 
-void OneSixUpdate::fmllibsStart()
+QList<FMLlib> OneSixUpdate::missingFmlLibs(OneSixInstance *inst)
 {
-	// Get the mod list
-	OneSixInstance *inst = (OneSixInstance *)m_inst;
-	std::shared_ptr<InstanceVersion> fullversion = inst->getFullVersion();
-	bool forge_present = false;
-
+	QList<FMLlib> missing;
 	QString version = inst->intendedVersionId();
 	auto &fmlLibsMapping = g_VersionFilterData.fmlLibsMapping;
 	if (!fmlLibsMapping.contains(version))
 	{
-		assetIndexStart();
-		return;
+		return missing;
 	}
 
-	auto &libList = fmlLibsMapping[version];
-
-	// determine if we need some libs for FML or forge
-	setStatus(tr("Checking for FML libraries..."));
-	forge_present = (fullversion->versionPatch("net.minecraftforge") != nullptr);
-	// we don't...
-	if (!forge_present)
+	// we don't need any without forge...
+	if (inst->getFullVersion()->versionPatch("net.minecraftforge") == nullptr)
 	{
-		assetIndexStart();
-		return;
+		return missing;
 	}
 
 	// now check the lib folder inside the instance for files.
-	for (auto &lib : libList)
+	for (auto &lib : fmlLibsMapping[version])
 	{
 		QFileInfo libInfo(PathCombine(inst->libDir(), lib.filename));
 		if (libInfo.exists())
 			continue;
-		fmlLibsToProcess.append(lib);
-	}
-
-	// if everything is in place, there's nothing to do here...
-	if (fmlLibsToProcess.isEmpty())
-	{
-		assetIndexStart();
-		return;
+		missing.append(lib);
 	}
+	return missing;
+}
 
-	// download missing libs to our place
-	setStatus(tr("Dowloading FML libraries..."));
-	auto dljob = new NetJob("FML libraries");
+void OneSixUpdate::planFmlLibs(const QList<FMLlib> &libs, DownloadPlan &plan)
+{
 	auto metacache = MMC->metacache();
-	for (auto &lib : fmlLibsToProcess)
+	for (auto &lib : libs)
 	{
 		auto entry = metacache->resolveEntry("fmllibs", lib.filename);
 		QString urlString = lib.ours ? URLConstants::FMLLIBS_OUR_BASE_URL + lib.filename
 									 : URLConstants::FMLLIBS_FORGE_BASE_URL + lib.filename;
-		dljob->addNetAction(CacheDownload::make(QUrl(urlString), entry));
+		plan.addCacheDownload(QUrl(urlString), entry);
 	}
+}
 
-	connect(dljob, SIGNAL(succeeded()), SLOT(fmllibsFinished()));
-	connect(dljob, SIGNAL(failed()), SLOT(fmllibsFailed()));
-	connect(dljob, SIGNAL(progress(qint64, qint64)), SIGNAL(progress(qint64, qint64)));
-	legacyDownloadJob.reset(dljob);
-	legacyDownloadJob->start();
+bool OneSixUpdate::installFmlLibs(OneSixInstance *inst, const QList<FMLlib> &libs,
+								  QString &error)
+{
+	return copyFmlLibs(fmlLibCopies(inst, libs), error);
 }
 
-void OneSixUpdate::fmllibsFinished()
+QList<QPair<QString, QString>> OneSixUpdate::fmlLibCopies(OneSixInstance *inst,
+														  const QList<FMLlib> &libs)
 {
-	legacyDownloadJob.reset();
-	if (!fmlLibsToProcess.isEmpty())
+	QList<QPair<QString, QString>> copies;
+	auto metacache = MMC->metacache();
+	for (auto &lib : libs)
 	{
-		setStatus(tr("Copying FML libraries into the instance..."));
-		OneSixInstance *inst = (OneSixInstance *)m_inst;
-		auto metacache = MMC->metacache();
-		int index = 0;
-		for (auto &lib : fmlLibsToProcess)
+		auto entry = metacache->resolveEntry("fmllibs", lib.filename);
+		copies.append(qMakePair(entry->getFullPath(), PathCombine(inst->libDir(), lib.filename)));
+	}
+	return copies;
+}
+
+bool OneSixUpdate::copyFmlLibs(const QList<QPair<QString, QString>> &copies, QString &error)
+{
+	for (auto &copy : copies)
+	{
+		if (!ensureFilePathExists(copy.second))
 		{
-			progress(index, fmlLibsToProcess.size());
-			auto entry = metacache->resolveEntry("fmllibs", lib.filename);
-			auto path = PathCombine(inst->libDir(), lib.filename);
-			if (!ensureFilePathExists(path))
-			{
-				emitFailed(tr("Failed creating FML library folder inside the instance."));
-				return;
-			}
-			if (!QFile::copy(entry->getFullPath(), PathCombine(inst->libDir(), lib.filename)))
-			{
-				emitFailed(tr("Failed copying Forge/FML library: %1.").arg(lib.filename));
-				return;
-			}
-			index++;
+			error = tr("Failed creating FML library folder inside the instance.");
+			return false;
+		}
+		if (!QFile::copy(copy.first, copy.second))
+		{
+			error = tr("Failed copying Forge/FML library: %1.")
+						.arg(QFileInfo(copy.second).fileName());
+			return false;
 		}
-		progress(index, fmlLibsToProcess.size());
 	}
-	assetIndexStart();
+	return true;
 }
 
-void OneSixUpdate::fmllibsFailed()
+void OneSixUpdate::planAssetIndex(const QString &assetName, DownloadPlan &plan)
 {
-	emitFailed("Game update failed: it was impossible to fetch the required FML libraries.");
-	return;
+	QUrl indexUrl = "http://" + URLConstants::AWS_DOWNLOAD_INDEXES + assetName + ".json";
+	QString localPath = assetName + ".json";
+	plan.addCacheDownload(indexUrl, MMC->metacache()->resolveEntry("asset_indexes", localPath));
+}
+
+bool OneSixUpdate::planAssets(const QString &assetName, DownloadPlan &plan, QString &error)
+{
+	AssetsIndex index;
+
+	QString asset_fname = "assets/indexes/" + assetName + ".json";
+	if (!AssetsUtils::loadAssetsIndexJson(asset_fname, &index))
+	{
+		error = tr("Failed to read the assets index!");
+		return false;
+	}
+
+	for (auto object : index.objects.values())
+	{
+		QString objectName = object.hash.left(2) + "/" + object.hash;
+		QFileInfo objectFile("assets/objects/" + objectName);
+		if ((!objectFile.isFile()) || (objectFile.size() != object.size))
+		{
+			plan.addMd5EtagDownload(QUrl("http://" + URLConstants::RESOURCE_BASE + objectName),
+									objectFile.filePath(), object.size);
+		}
+	}
+	return true;
 }
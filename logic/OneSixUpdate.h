@@ -26,6 +26,8 @@
 
 class MinecraftVersion;
 class OneSixInstance;
+class InstanceVersion;
+class DownloadPlan;
 
 class OneSixUpdate : public Task
 {
@@ -34,6 +36,37 @@ public:
 	explicit OneSixUpdate(OneSixInstance *inst, QObject *parent = 0);
 	virtual void executeTask();
 
+	/*
+	 * The steps of the update, usable on their own. BatchUpdate uses them to update many
+	 * instances at once and Prefetcher to fill the caches ahead of time. The ones taking an
+	 * instance expect its version to be loaded.
+	 */
+
+	/// md5 of the version jar as it is before the update
+	static QString versionJarHash(OneSixInstance *inst);
+	/// add the version jar and the libraries that aren't there yet, except the local ones
+	static void planVersionFiles(InstanceVersion *version, DownloadPlan &plan);
+	/// planVersionFiles, and fails if a local library is missing
+	static bool planJarLibs(OneSixInstance *inst, DownloadPlan &plan, QString &error);
+	/// true if the stripped jar for jar mods has to be made (again)
+	static bool needsStrippedJar(OneSixInstance *inst, const QString &jarHashOnEntry,
+								 QString &jarPath, QString &strippedJarPath);
+	/// make a copy of the jar without META-INF. Doesn't touch anything but the two files.
+	static bool stripJar(QString origPath, QString newPath, QString &error);
+	/// the FML libraries an old forge needs and the instance doesn't have
+	static QList<FMLlib> missingFmlLibs(OneSixInstance *inst);
+	static void planFmlLibs(const QList<FMLlib> &libs, DownloadPlan &plan);
+	/// copy the downloaded FML libraries into the instance
+	static bool installFmlLibs(OneSixInstance *inst, const QList<FMLlib> &libs, QString &error);
+	/// where installFmlLibs copies the libraries from and to
+	static QList<QPair<QString, QString>> fmlLibCopies(OneSixInstance *inst,
+													   const QList<FMLlib> &libs);
+	/// the copying part of installFmlLibs. Doesn't touch anything but the files.
+	static bool copyFmlLibs(const QList<QPair<QString, QString>> &copies, QString &error);
+	static void planAssetIndex(const QString &assetName, DownloadPlan &plan);
+	/// add the asset objects that are missing. The asset index has to be there.
+	static bool planAssets(const QString &assetName, DownloadPlan &plan, QString &error);
+
 private
 slots:
 	void versionUpdateFailed(QString reason);
@@ -53,9 +86,9 @@ slots:
 	void assetsFinished();
 	void assetsFailed();
 
-	void stripJar(QString origPath, QString newPath);
-	bool MergeZipFiles(QuaZip *into, QString from);
 private:
+	static bool MergeZipFiles(QuaZip *into, QString from);
+
 	NetJobPtr jarlibDownloadJob;
 	NetJobPtr legacyDownloadJob;
 
@@ -67,4 +100,8 @@ private:
 	OneSixInstance *m_inst = nullptr;
 	QString jarHashOnEntry;
 	QList<FMLlib> fmlLibsToProcess;
+	/// the launch plan from an earlier update can be used as it is
+	bool launchPlanCurrent = false;
+	/// where the natives were extracted to, for the launch plan
+	QString nativesPath;
 };
@@ -0,0 +1,320 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MultiMC.h"
+#include "Prefetcher.h"
+
+#include "logic/InstanceList.h"
+#include "logic/OneSixInstance.h"
+#include "logic/OneSixUpdate.h"
+#include "logic/DownloadPlan.h"
+#include "logic/minecraft/MinecraftVersionList.h"
+#include "logic/minecraft/InstanceVersion.h"
+#include "logic/settings/SettingsObject.h"
+#include <MMCError.h>
+#include "logger/QsLog.h"
+
+// how long things have to be quiet before prefetching starts, in ms
+static const int idleDelay = 30000;
+
+static bool isOneSixType(const QString &instanceType)
+{
+	return instanceType == "OneSix" || instanceType == "Nostalgia" ||
+		   instanceType == "OneSixFTB";
+}
+
+Prefetcher::Prefetcher(QObject *parent) : QObject(parent)
+{
+	m_idleTimer.setSingleShot(true);
+	m_idleTimer.setInterval(idleDelay);
+	connect(&m_idleTimer, SIGNAL(timeout()), SLOT(run()));
+	m_nextTimer.setSingleShot(true);
+	connect(&m_nextTimer, SIGNAL(timeout()), SLOT(startDownloads()));
+	m_limiter = std::make_shared<RateLimiter>();
+
+	// new instances and version changes
+	auto instances = MMC->instances().get();
+	connect(instances, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(schedule()));
+	connect(instances, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(schedule()));
+	connect(instances, SIGNAL(modelReset()), SLOT(schedule()));
+	// new releases and snapshots
+	auto versions = MMC->minecraftlist().get();
+	connect(versions, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(schedule()));
+	connect(versions, SIGNAL(modelReset()), SLOT(schedule()));
+}
+
+Prefetcher::~Prefetcher()
+{
+	abortDownloads();
+}
+
+bool Prefetcher::isEnabled() const
+{
+	return MMC->settings()->get("PrefetchEnabled").toBool();
+}
+
+void Prefetcher::schedule()
+{
+	m_idleTimer.start();
+}
+
+void Prefetcher::pause()
+{
+	if (m_paused++ > 0)
+		return;
+	m_idleTimer.stop();
+	m_nextTimer.stop();
+	if (m_state == DownloadingFiles || m_state == DownloadingAssets)
+	{
+		QLOG_INFO() << "Prefetch: paused," << m_running.size() + m_queue.size()
+					<< "downloads dropped";
+		abortDownloads();
+		m_state = Idle;
+	}
+	// a running version update is small, it is left to finish
+}
+
+void Prefetcher::resume()
+{
+	if (m_paused > 0 && --m_paused == 0)
+		schedule();
+}
+
+void Prefetcher::run()
+{
+	if (m_paused || m_state != Idle || !isEnabled())
+		return;
+	auto list = MMC->minecraftlist();
+	if (!list->isLoaded())
+		return;
+
+	QStringList targets;
+	m_plainVersions.clear();
+	auto instances = MMC->instances();
+	for (int i = 0; i < instances->count(); i++)
+	{
+		auto instance = instances->loadedAt(i);
+		if (!instance)
+		{
+			// not worth loading the instance for, its Minecraft version will do
+			auto &entry = instances->entryAt(i);
+			if (isOneSixType(entry.instanceType) && !entry.intendedVersion.isEmpty())
+			{
+				targets.append(entry.intendedVersion);
+				m_plainVersions.append(entry.intendedVersion);
+			}
+			continue;
+		}
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance);
+		if (onesix && !onesix->providesVersionFile())
+			targets.append(onesix->intendedVersionId());
+	}
+	for (auto latest : {list->getLatestStable(), list->getLatestSnapshot()})
+	{
+		if (latest)
+		{
+			targets.append(latest->descriptor());
+			m_plainVersions.append(latest->descriptor());
+		}
+	}
+	targets.removeDuplicates();
+	m_plainVersions.removeDuplicates();
+
+	m_versionQueue.clear();
+	for (auto id : targets)
+	{
+		auto version = std::dynamic_pointer_cast<MinecraftVersion>(list->findVersion(id));
+		if (version && version->needsUpdate())
+			m_versionQueue.append(id);
+	}
+	m_state = UpdatingVersions;
+	versionUpdateNext();
+}
+
+void Prefetcher::versionUpdateNext()
+{
+	m_versionUpdateTask.reset();
+	if (m_paused)
+	{
+		m_state = Idle;
+		return;
+	}
+	while (!m_versionQueue.isEmpty())
+	{
+		QString id = m_versionQueue.takeFirst();
+		m_versionUpdateTask = MMC->minecraftlist()->createUpdateTask(id);
+		if (!m_versionUpdateTask)
+			continue;
+		// queued, because the next update replaces the task that emits the signal
+		connect(m_versionUpdateTask.get(), SIGNAL(succeeded()), SLOT(versionUpdateFinished()),
+				Qt::QueuedConnection);
+		connect(m_versionUpdateTask.get(), SIGNAL(failed(QString)),
+				SLOT(versionUpdateFinished()), Qt::QueuedConnection);
+		QLOG_INFO() << "Prefetch: updating version" << id;
+		m_versionUpdateTask->start();
+		return;
+	}
+	planFiles();
+}
+
+void Prefetcher::versionUpdateFinished()
+{
+	versionUpdateNext();
+}
+
+void Prefetcher::planFiles()
+{
+	DownloadPlan plan;
+	m_assetNames.clear();
+	auto addVersion = [&](InstanceVersion *version)
+	{
+		OneSixUpdate::planVersionFiles(version, plan);
+		OneSixUpdate::planAssetIndex(version->assets, plan);
+		if (!m_assetNames.contains(version->assets))
+			m_assetNames.append(version->assets);
+	};
+
+	auto instances = MMC->instances();
+	for (int i = 0; i < instances->count(); i++)
+	{
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instances->loadedAt(i));
+		if (!onesix)
+			continue;
+		auto version = onesix->getFullVersion();
+		if (version)
+			addVersion(version.get());
+	}
+	// the latest versions and the ones of instances that aren't loaded get a plain version
+	auto list = MMC->minecraftlist();
+	for (auto id : m_plainVersions)
+	{
+		auto minecraft = std::dynamic_pointer_cast<MinecraftVersion>(list->findVersion(id));
+		if (!minecraft || minecraft->usesLegacyLauncher())
+			continue;
+		InstanceVersion version(nullptr);
+		try
+		{
+			minecraft->applyTo(&version);
+		}
+		catch (MMCError &e)
+		{
+			QLOG_WARN() << "Prefetch: skipping" << minecraft->descriptor() << ":" << e.cause();
+			continue;
+		}
+		addVersion(&version);
+	}
+	m_state = DownloadingFiles;
+	startQueue(plan.actions());
+}
+
+void Prefetcher::planAssets()
+{
+	// needs the asset indexes from planFiles
+	DownloadPlan plan;
+	for (auto name : m_assetNames)
+	{
+		QString error;
+		if (!OneSixUpdate::planAssets(name, plan, error))
+			QLOG_WARN() << "Prefetch: assets" << name << ":" << error;
+	}
+	m_state = DownloadingAssets;
+	startQueue(plan.actions());
+}
+
+void Prefetcher::startQueue(const QList<NetActionPtr> &actions)
+{
+	m_queue = actions;
+	startDownloads();
+}
+
+void Prefetcher::startDownloads()
+{
+	// the ones that finished since the last time can go now
+	m_done.clear();
+	if (m_paused || (m_state != DownloadingFiles && m_state != DownloadingAssets))
+		return;
+	if (!isEnabled())
+	{
+		abortDownloads();
+		m_state = Idle;
+		return;
+	}
+
+	auto settings = MMC->settings();
+	int maxDownloads = qMax(1, settings->get("PrefetchMaxDownloads").toInt());
+	// the running downloads pick up a changed limit too
+	m_limiter->setRate(settings->get("PrefetchMaxSpeed").toLongLong() * 1024);
+	while (m_running.size() < maxDownloads && !m_queue.isEmpty())
+	{
+		NetActionPtr action = m_queue.takeFirst();
+		int index = m_nextIndex++;
+		action->m_index_within_job = index;
+		action->m_limiter = m_limiter;
+		m_running.insert(index, action);
+		connect(action.get(), SIGNAL(succeeded(int)), SLOT(downloadSucceeded(int)));
+		connect(action.get(), SIGNAL(failed(int)), SLOT(downloadFailed(int)));
+		action->start();
+	}
+	if (!m_running.isEmpty() || !m_queue.isEmpty())
+		return;
+
+	if (m_state == DownloadingFiles)
+	{
+		planAssets();
+		return;
+	}
+	QLOG_INFO() << "Prefetch: done," << m_downloaded << "files downloaded," << m_failed
+				<< "failed";
+	m_downloaded = 0;
+	m_failed = 0;
+	m_state = Idle;
+}
+
+void Prefetcher::downloadSucceeded(int index)
+{
+	m_downloaded++;
+	downloadFinished(index);
+}
+
+void Prefetcher::downloadFailed(int index)
+{
+	// the foreground update will try again and report it
+	m_failed++;
+	downloadFinished(index);
+}
+
+void Prefetcher::downloadFinished(int index)
+{
+	auto action = m_running.take(index);
+	if (!action)
+		return;
+	action->disconnect(this);
+	// it is still emitting the signal, so it can't be deleted yet
+	m_done.append(action);
+	m_nextTimer.start(0);
+}
+
+void Prefetcher::abortDownloads()
+{
+	for (auto &action : m_running)
+	{
+		action->disconnect(this);
+		if (action->m_reply)
+			action->m_reply->abort();
+		m_done.append(action);
+	}
+	m_running.clear();
+	m_queue.clear();
+}
@@ -0,0 +1,102 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QStringList>
+#include <QHash>
+#include <memory>
+
+#include "logic/net/NetAction.h"
+#include "logic/net/RateLimiter.h"
+#include "logic/tasks/Task.h"
+
+/**
+ * Fills the caches with what the instances will need to launch, while nothing else is going on.
+ *
+ * That is the version files, jars, libraries and assets of the Minecraft versions the OneSix
+ * instances use, plus the latest release and snapshot. Downloads run a few at a time and share
+ * a rate limit on the bytes they read, so together they stay below the configured speed.
+ *
+ * Anything in the foreground pauses it right away: the running downloads are dropped and
+ * everything is planned again once it's quiet.
+ */
+class Prefetcher : public QObject
+{
+	Q_OBJECT
+public:
+	explicit Prefetcher(QObject *parent = 0);
+	virtual ~Prefetcher();
+
+	/// something in the foreground started. every pause() needs a resume()
+	void pause();
+	void resume();
+
+public
+slots:
+	/// prefetch once things have been quiet for a while
+	void schedule();
+
+private
+slots:
+	void run();
+	void versionUpdateFinished();
+	void startDownloads();
+	void downloadSucceeded(int index);
+	void downloadFailed(int index);
+
+private:
+	enum State
+	{
+		Idle,
+		UpdatingVersions,
+		DownloadingFiles,
+		DownloadingAssets
+	};
+	bool isEnabled() const;
+	void versionUpdateNext();
+	void planFiles();
+	void planAssets();
+	void startQueue(const QList<NetActionPtr> &actions);
+	void downloadFinished(int index);
+	void abortDownloads();
+
+	State m_state = Idle;
+	int m_paused = 0;
+
+	/// waits for things to be quiet
+	QTimer m_idleTimer;
+	/// starts the next downloads once the finished ones are done emitting
+	QTimer m_nextTimer;
+	/// shared by all the running downloads
+	RateLimiterPtr m_limiter;
+
+	QStringList m_versionQueue;
+	std::shared_ptr<Task> m_versionUpdateTask;
+	/// versions prefetched without an instance: the latest ones and those of unloaded instances
+	QStringList m_plainVersions;
+	/// the asset indexes of the versions being prefetched
+	QStringList m_assetNames;
+
+	QList<NetActionPtr> m_queue;
+	QHash<int, NetActionPtr> m_running;
+	/// finished downloads, deleted once they are done emitting
+	QList<NetActionPtr> m_done;
+	int m_nextIndex = 0;
+	int m_downloaded = 0;
+	int m_failed = 0;
+};
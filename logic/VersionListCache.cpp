@@ -0,0 +1,101 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VersionListCache.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <pathutils.h>
+
+#include "logger/QsLog.h"
+
+namespace
+{
+const quint32 listMagic = 0x4d4d564c; // "MMVL"
+// bump this when the way any of the lists is stored changes
+const quint32 listFormat = 1;
+}
+
+QString VersionListCache::key(const QList<MetaEntryPtr> &sources)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(QByteArray::number(listFormat));
+	for (auto entry : sources)
+	{
+		// entries without a sum are not backed by a file
+		if (!entry || entry->md5sum.isEmpty())
+			return QString();
+		hash.addData(entry->path.toUtf8());
+		hash.addData(entry->md5sum.toLatin1());
+	}
+	return hash.result().toHex();
+}
+
+bool VersionListCache::read(const QString &path, const QString &key,
+							std::function<bool(QDataStream &)> reader)
+{
+	if (key.isEmpty())
+		return false;
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 magic = 0, format = 0;
+	QString storedKey;
+	in >> magic >> format >> storedKey;
+	if (magic != listMagic || format != listFormat || storedKey != key)
+		return false;
+	if (!reader(in) || in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Stored version list" << path << "is damaged, ignoring it";
+		return false;
+	}
+	return true;
+}
+
+void VersionListCache::write(const QString &path, const QString &key,
+							 std::function<void(QDataStream &)> writer)
+{
+	if (key.isEmpty())
+		return;
+	if (!ensureFilePathExists(path))
+	{
+		QLOG_ERROR() << "Could not create folder for" << path;
+		return;
+	}
+	QSaveFile output(path);
+	if (!output.open(QIODevice::WriteOnly))
+	{
+		QLOG_ERROR() << "Could not open" << path << "for writing";
+		return;
+	}
+	QDataStream out(&output);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << listMagic << listFormat << key;
+	writer(out);
+	if (out.status() != QDataStream::Ok)
+	{
+		output.cancelWriting();
+		QLOG_ERROR() << "Failed to store version list" << path;
+		return;
+	}
+	if (!output.commit())
+	{
+		QLOG_ERROR() << "Failed to store version list" << path;
+	}
+}
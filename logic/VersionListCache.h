@@ -0,0 +1,51 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QDataStream>
+#include <functional>
+
+#include "logic/net/HttpMetaCache.h"
+
+/**
+ * Parsed version lists, stored next to the files they were parsed from.
+ *
+ * The version lists are downloaded through the HttpMetaCache, so the server is only asked
+ * whether they changed. When they didn't, the stored list is used instead of parsing the
+ * downloaded files again.
+ */
+namespace VersionListCache
+{
+/**
+ * Hash of the downloaded files the list is made from.
+ * Empty when any of them isn't in the cache.
+ */
+QString key(const QList<MetaEntryPtr> &sources);
+
+/**
+ * Open the list stored at 'path' and hand it to 'reader', if it was stored under 'key'.
+ * Returns false when there is nothing usable there.
+ */
+bool read(const QString &path, const QString &key, std::function<bool(QDataStream &)> reader);
+
+/**
+ * Store a list under 'key'. Failures are logged and otherwise ignored.
+ * Safe to call from a worker thread.
+ */
+void write(const QString &path, const QString &key, std::function<void(QDataStream &)> writer);
+}
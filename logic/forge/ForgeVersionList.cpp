@@ -17,16 +17,99 @@
 #include "logic/forge/ForgeVersion.h"
 #include "logic/net/NetJob.h"
 #include "logic/net/URLConstants.h"
+#include "logic/VersionListCache.h"
 #include "MultiMC.h"
 
 #include <QtNetwork>
 #include <QtXml>
 #include <QRegExp>
+#include <QtConcurrentRun>
+#include <pathutils.h>
 
 #include "logger/QsLog.h"
 
+namespace
+{
+void writeVersions(QDataStream &out, const QList<BaseVersionPtr> &versions)
+{
+	out << quint32(versions.size());
+	for (auto base : versions)
+	{
+		auto version = std::dynamic_pointer_cast<ForgeVersion>(base);
+		out << qint32(version->type) << qint32(version->m_buildnr) << version->branch;
+		out << version->universal_url << version->changelog_url << version->installer_url;
+		out << version->jobbuildver << version->mcver << version->mcver_sane;
+		out << version->universal_filename << version->installer_filename;
+		out << version->is_recommended;
+	}
+}
+
+bool readVersions(QDataStream &in, QList<BaseVersionPtr> &versions)
+{
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		auto version = std::make_shared<ForgeVersion>();
+		qint32 type, buildnr;
+		in >> type >> buildnr >> version->branch;
+		in >> version->universal_url >> version->changelog_url >> version->installer_url;
+		in >> version->jobbuildver >> version->mcver >> version->mcver_sane;
+		in >> version->universal_filename >> version->installer_filename;
+		in >> version->is_recommended;
+		if (type != ForgeVersion::Legacy && type != ForgeVersion::Gradle)
+			return false;
+		version->type = type == ForgeVersion::Legacy ? ForgeVersion::Legacy : ForgeVersion::Gradle;
+		version->m_buildnr = buildnr;
+		versions.append(version);
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+bool readFile(const QString &filename, QByteArray &data)
+{
+	QFile listFile(filename);
+	if (!listFile.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	data = listFile.readAll();
+	return true;
+}
+}
+
 ForgeVersionList::ForgeVersionList(QObject *parent) : BaseVersionList(parent)
 {
+	// the list from the last run is shown until it's checked against the server
+	restoreList(VersionListCache::key(sourceEntries()));
+}
+
+QList<MetaEntryPtr> ForgeVersionList::sourceEntries()
+{
+	return {MMC->metacache()->resolveEntry("minecraftforge", "list.json"),
+			MMC->metacache()->resolveEntry("minecraftforge", "json")};
+}
+
+QString ForgeVersionList::storedListPath()
+{
+	return PathCombine(MMC->metacache()->getBasePath("minecraftforge"), "versions.cache");
+}
+
+bool ForgeVersionList::restoreList(const QString &key)
+{
+	if (key.isEmpty())
+		return false;
+	if (m_loaded && key == m_cacheKey)
+		return true;
+	QList<BaseVersionPtr> versions;
+	if (!VersionListCache::read(storedListPath(), key, [&](QDataStream &in)
+	{ return readVersions(in, versions); }))
+	{
+		return false;
+	}
+	updateListData(versions);
+	m_cacheKey = key;
+	return true;
 }
 
 Task *ForgeVersionList::getLoadTask()
@@ -155,6 +238,7 @@ void ForgeVersionList::sort()
 ForgeListLoadTask::ForgeListLoadTask(ForgeVersionList *vlist) : Task()
 {
 	m_list = vlist;
+	connect(&m_parseWatcher, SIGNAL(finished()), SLOT(listParsed()));
 }
 
 void ForgeListLoadTask::executeTask()
@@ -162,8 +246,9 @@ void ForgeListLoadTask::executeTask()
 	setStatus(tr("Fetching Forge version lists..."));
 	auto job = new NetJob("Version index");
 	// we do not care if the version is stale or not.
-	auto forgeListEntry = MMC->metacache()->resolveEntry("minecraftforge", "list.json");
-	auto gradleForgeListEntry = MMC->metacache()->resolveEntry("minecraftforge", "json");
+	m_entries = ForgeVersionList::sourceEntries();
+	auto forgeListEntry = m_entries[0];
+	auto gradleForgeListEntry = m_entries[1];
 
 	// verify by poking the server.
 	forgeListEntry->stale = true;
@@ -183,33 +268,21 @@ void ForgeListLoadTask::executeTask()
 	listJob->start();
 }
 
-bool ForgeListLoadTask::parseForgeList(QList<BaseVersionPtr> &out)
+bool ForgeListLoadTask::parseForgeList(const QByteArray &data, QList<BaseVersionPtr> &out,
+									   QString &error)
 {
-	QByteArray data;
-	{
-		auto dlJob = listDownload;
-		auto filename = std::dynamic_pointer_cast<CacheDownload>(dlJob)->getTargetFilepath();
-		QFile listFile(filename);
-		if (!listFile.open(QIODevice::ReadOnly))
-		{
-			return false;
-		}
-		data = listFile.readAll();
-		dlJob.reset();
-	}
-
 	QJsonParseError jsonError;
 	QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
 
 	if (jsonError.error != QJsonParseError::NoError)
 	{
-		emitFailed("Error parsing version list JSON:" + jsonError.errorString());
+		error = "Error parsing version list JSON:" + jsonError.errorString();
 		return false;
 	}
 
 	if (!jsonDoc.isObject())
 	{
-		emitFailed("Error parsing version list JSON: JSON root is not an object");
+		error = "Error parsing version list JSON: JSON root is not an object";
 		return false;
 	}
 
@@ -218,8 +291,7 @@ bool ForgeListLoadTask::parseForgeList(QList<BaseVersionPtr> &out)
 	// Now, get the array of versions.
 	if (!root.value("builds").isArray())
 	{
-		emitFailed(
-			"Error parsing version list JSON: version list object is missing 'builds' array");
+		error = "Error parsing version list JSON: version list object is missing 'builds' array";
 		return false;
 	}
 	QJsonArray builds = root.value("builds").toArray();
@@ -294,33 +366,21 @@ bool ForgeListLoadTask::parseForgeList(QList<BaseVersionPtr> &out)
 	return true;
 }
 
-bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
+bool ForgeListLoadTask::parseForgeGradleList(const QByteArray &data,
+											  QList<BaseVersionPtr> &out, QString &error)
 {
-	QByteArray data;
-	{
-		auto dlJob = gradleListDownload;
-		auto filename = std::dynamic_pointer_cast<CacheDownload>(dlJob)->getTargetFilepath();
-		QFile listFile(filename);
-		if (!listFile.open(QIODevice::ReadOnly))
-		{
-			return false;
-		}
-		data = listFile.readAll();
-		dlJob.reset();
-	}
-
 	QJsonParseError jsonError;
 	QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &jsonError);
 
 	if (jsonError.error != QJsonParseError::NoError)
 	{
-		emitFailed("Error parsing gradle version list JSON:" + jsonError.errorString());
+		error = "Error parsing gradle version list JSON:" + jsonError.errorString();
 		return false;
 	}
 
 	if (!jsonDoc.isObject())
 	{
-		emitFailed("Error parsing gradle version list JSON: JSON root is not an object");
+		error = "Error parsing gradle version list JSON: JSON root is not an object";
 		return false;
 	}
 
@@ -406,30 +466,67 @@ bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
 	return true;
 }
 
-void ForgeListLoadTask::listDownloaded()
+ForgeListLoadTask::ParseResult ForgeListLoadTask::parseLists(QString listFile,
+															QString gradleListFile,
+															QString storePath, QString key)
 {
-	QList<BaseVersionPtr> list;
-	bool ret = true;
-	if (!parseForgeList(list))
+	ParseResult result;
+	QByteArray data;
+	if (!readFile(listFile, data))
+	{
+		result.error = "Failed to open the Forge version list.";
+		return result;
+	}
+	if (!parseForgeList(data, result.versions, result.error))
+	{
+		return result;
+	}
+	if (!readFile(gradleListFile, data))
 	{
-		ret = false;
+		result.error = "Failed to open the gradle Forge version list.";
+		return result;
 	}
-	if (!parseForgeGradleList(list))
+	if (!parseForgeGradleList(data, result.versions, result.error))
 	{
-		ret = false;
+		return result;
 	}
+	std::sort(result.versions.begin(), result.versions.end(),
+			  [](const BaseVersionPtr & l, const BaseVersionPtr & r)
+	{ return (*l > *r); });
+
+	VersionListCache::write(storePath, key, [&](QDataStream &out)
+	{ writeVersions(out, result.versions); });
+	return result;
+}
 
-	if (!ret)
+void ForgeListLoadTask::listDownloaded()
+{
+	// a 304 leaves the files alone, so the list made from them last time is still good
+	QString key = VersionListCache::key(m_entries);
+	if (m_list->restoreList(key))
 	{
+		QLOG_INFO() << "Forge version lists didn't change, using the stored list.";
+		emitSucceeded();
 		return;
 	}
-	std::sort(list.begin(), list.end(), [](const BaseVersionPtr & l, const BaseVersionPtr & r)
-	{ return (*l > *r); });
 
-	m_list->updateListData(list);
+	setStatus(tr("Processing Forge version lists..."));
+	m_parseWatcher.setFuture(QtConcurrent::run(
+		&ForgeListLoadTask::parseLists, listDownload->getTargetFilepath(),
+		gradleListDownload->getTargetFilepath(), ForgeVersionList::storedListPath(), key));
+}
 
+void ForgeListLoadTask::listParsed()
+{
+	auto result = m_parseWatcher.result();
+	if (!result.error.isEmpty())
+	{
+		emitFailed(result.error);
+		return;
+	}
+	m_list->updateListData(result.versions);
+	m_list->m_cacheKey = VersionListCache::key(m_entries);
 	emitSucceeded();
-	return;
 }
 
 void ForgeListLoadTask::listFailed()
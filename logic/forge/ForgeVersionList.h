@@ -19,6 +19,7 @@
 #include <QAbstractListModel>
 #include <QUrl>
 #include <QNetworkReply>
+#include <QFutureWatcher>
 
 #include "logic/BaseVersionList.h"
 #include "logic/tasks/Task.h"
@@ -43,6 +44,11 @@ public:
 
 	ForgeVersionPtr findVersionByVersionNr(QString version);
 
+	/**
+	 * Use the list stored by an earlier load, if it was made from the files 'key' stands for.
+	 */
+	bool restoreList(const QString &key);
+
 	virtual QVariant data(const QModelIndex &index, int role) const;
 	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const;
 	virtual int columnCount(const QModelIndex &parent) const;
@@ -52,6 +58,13 @@ protected:
 
 	bool m_loaded = false;
 
+	/// VersionListCache key of the files the current list was made from
+	QString m_cacheKey;
+
+	/// the downloaded lists in the metacache, legacy one first
+	static QList<MetaEntryPtr> sourceEntries();
+	static QString storedListPath();
+
 protected
 slots:
 	virtual void updateListData(QList<BaseVersionPtr> versions);
@@ -62,6 +75,12 @@ class ForgeListLoadTask : public Task
 	Q_OBJECT
 
 public:
+	struct ParseResult
+	{
+		QList<BaseVersionPtr> versions;
+		QString error;
+	};
+
 	explicit ForgeListLoadTask(ForgeVersionList *vlist);
 
 	virtual void executeTask();
@@ -69,6 +88,7 @@ public:
 protected
 slots:
 	void listDownloaded();
+	void listParsed();
 	void listFailed();
 	void gradleListFailed();
 
@@ -76,10 +96,17 @@ protected:
 	NetJobPtr listJob;
 	ForgeVersionList *m_list;
 
+	QList<MetaEntryPtr> m_entries;
 	CacheDownloadPtr listDownload;
 	CacheDownloadPtr gradleListDownload;
+	QFutureWatcher<ParseResult> m_parseWatcher;
 
 private:
-	bool parseForgeList(QList<BaseVersionPtr> &out);
-	bool parseForgeGradleList(QList<BaseVersionPtr> &out);
+	/// runs on a worker thread. Parses both lists and stores the result under 'key'.
+	static ParseResult parseLists(QString listFile, QString gradleListFile, QString storePath,
+								  QString key);
+	static bool parseForgeList(const QByteArray &data, QList<BaseVersionPtr> &out,
+							   QString &error);
+	static bool parseForgeGradleList(const QByteArray &data, QList<BaseVersionPtr> &out,
+									 QString &error);
 };
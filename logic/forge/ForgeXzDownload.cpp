@@ -20,6 +20,7 @@
 #include <QCryptographicHash>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QDir>
 #include "logger/QsLog.h"
 
@@ -186,10 +187,20 @@ void ForgeXzDownload::downloadReadyRead()
 }
 
 #include "xz.h"
+#include "xz_mem.h"
 #include "unpack200.h"
 #include <stdexcept>
 
-const size_t buffer_size = 8196;
+// output buffer for multi-call decoding, used only when the xz index doesn't have the size
+const size_t xz_buffer_size = 1 << 20;
+// the most we're willing to allocate up front based on what the xz index claims
+const uint64_t xz_single_call_limit = 512 * 1024 * 1024;
+
+static bool writeXzChunk(void *ctx, const uint8_t *data, size_t size)
+{
+	auto file = static_cast<QFile *>(ctx);
+	return file->write((const char *)data, size) == (qint64)size;
+}
 
 void ForgeXzDownload::decompressAndInstall()
 {
@@ -199,114 +210,55 @@ void ForgeXzDownload::decompressAndInstall()
 	QTemporaryFile pack200_file("./dl_temp.XXXXXX");
 	pack200_file.open();
 
-	bool xz_success = false;
 	// first, de-xz
 	{
-		uint8_t in[buffer_size];
-		uint8_t out[buffer_size];
-		struct xz_buf b;
-		struct xz_dec *s;
-		enum xz_ret ret;
+		QElapsedTimer timer;
+		timer.start();
+		QByteArray xz_data = m_pack200_xz_file.readAll();
+		auto in = (const uint8_t *)xz_data.constData();
+		size_t in_size = xz_data.size();
 		xz_crc32_init();
 		xz_crc64_init();
-		s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-		if (s == nullptr)
-		{
-			xz_dec_end(s);
-			failAndTryNextMirror();
-			return;
-		}
-		b.in = in;
-		b.in_pos = 0;
-		b.in_size = 0;
-		b.out = out;
-		b.out_pos = 0;
-		b.out_size = buffer_size;
-		while (!xz_success)
-		{
-			if (b.in_pos == b.in_size)
-			{
-				b.in_size = m_pack200_xz_file.read((char *)in, sizeof(in));
-				b.in_pos = 0;
-			}
-
-			ret = xz_dec_run(s, &b);
-
-			if (b.out_pos == sizeof(out))
-			{
-				if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-				{
-					// msg = "Write error\n";
-					xz_dec_end(s);
-					failAndTryNextMirror();
-					return;
-				}
-
-				b.out_pos = 0;
-			}
-
-			if (ret == XZ_OK)
-				continue;
-
-			if (ret == XZ_UNSUPPORTED_CHECK)
-			{
-				// unsupported check. this is OK, but we should log this
-				continue;
-			}
-
-			if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-			{
-				// write error
-				pack200_file.close();
-				xz_dec_end(s);
-				return;
-			}
 
-			switch (ret)
+		struct xz_mem_stats stats;
+		enum xz_ret ret = XZ_UNSUPPORTED_CHECK;
+		uint64_t size = 0;
+		if (xz_mem_uncompressed_size(in, in_size, &size) && size <= xz_single_call_limit)
+		{
+			// we know how big it will be, so decode it all at once, straight into place
+			QByteArray pack200_data(size, Qt::Uninitialized);
+			ret = xz_mem_decode_single(in, in_size, (uint8_t *)pack200_data.data(), size, &stats);
+			if (ret == XZ_STREAM_END && pack200_file.write(pack200_data) != pack200_data.size())
 			{
-			case XZ_STREAM_END:
-				xz_dec_end(s);
-				xz_success = true;
-				break;
-
-			case XZ_MEM_ERROR:
-				QLOG_ERROR() << "Memory allocation failed\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_MEMLIMIT_ERROR:
-				QLOG_ERROR() << "Memory usage limit reached\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_FORMAT_ERROR:
-				QLOG_ERROR() << "Not a .xz file\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_OPTIONS_ERROR:
-				QLOG_ERROR() << "Unsupported options in the .xz headers\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_DATA_ERROR:
-			case XZ_BUF_ERROR:
-				QLOG_ERROR() << "File is corrupt\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			default:
-				QLOG_ERROR() << "Bug!\n";
-				xz_dec_end(s);
+				QLOG_ERROR() << "Error writing " << pack200_file.fileName();
 				failAndTryNextMirror();
 				return;
 			}
 		}
+		// no usable index, or a check type only the multi-call decoder can skip
+		if (ret == XZ_UNSUPPORTED_CHECK)
+		{
+			QByteArray buffer(xz_buffer_size, Qt::Uninitialized);
+			ret = xz_mem_decode_multi(in, in_size, (uint8_t *)buffer.data(), buffer.size(),
+									  1 << 26, writeXzChunk, &pack200_file, &stats);
+		}
+		if (ret != XZ_STREAM_END)
+		{
+			QLOG_ERROR() << "Error decompressing " << m_pack200_xz_file.fileName() << " : "
+						 << xz_mem_strerror(ret);
+			failAndTryNextMirror();
+			return;
+		}
+		if (stats.unsupported_check)
+		{
+			QLOG_WARN() << "Unsupported check in " << m_url.toString()
+						<< ", not verifying file integrity";
+		}
+		qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+		QLOG_INFO() << "Decompressed " << m_url.toString() << " : " << stats.out_size
+					<< " bytes in " << elapsed << " ms ("
+					<< QString::number(stats.out_size * 1000.0 / elapsed / (1024 * 1024), 'f', 1)
+					<< " MB/s, " << (stats.single_call ? "single-call" : "multi-call") << ")";
 	}
 	m_pack200_xz_file.remove();
 
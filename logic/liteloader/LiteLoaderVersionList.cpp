@@ -16,7 +16,9 @@
 #include "LiteLoaderVersionList.h"
 #include "MultiMC.h"
 #include "logic/net/URLConstants.h"
+#include "logic/VersionListCache.h"
 #include <MMCError.h>
+#include <pathutils.h>
 
 #include <QtXml>
 
@@ -29,9 +31,90 @@
 #include <QtAlgorithms>
 
 #include <QtNetwork>
+#include <QtConcurrentRun>
+
+namespace
+{
+void writeVersions(QDataStream &out, const QList<BaseVersionPtr> &versions)
+{
+	out << quint32(versions.size());
+	for (auto base : versions)
+	{
+		auto version = std::dynamic_pointer_cast<LiteLoaderVersion>(base);
+		out << version->version << version->file << version->mcVersion << version->md5;
+		out << qint32(version->timestamp) << version->isLatest << version->tweakClass;
+		out << version->defaultUrl << version->description << version->authors;
+		QJsonArray libraries;
+		for (auto lib : version->libraries)
+		{
+			libraries.append(lib->toJson());
+		}
+		out << QJsonDocument(libraries).toBinaryData();
+	}
+}
+
+bool readVersions(QDataStream &in, QList<BaseVersionPtr> &versions)
+{
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		LiteLoaderVersionPtr version(new LiteLoaderVersion());
+		qint32 timestamp;
+		QByteArray libraries;
+		in >> version->version >> version->file >> version->mcVersion >> version->md5;
+		in >> timestamp >> version->isLatest >> version->tweakClass;
+		in >> version->defaultUrl >> version->description >> version->authors;
+		in >> libraries;
+		version->timestamp = timestamp;
+		for (auto lib : QJsonDocument::fromBinaryData(libraries).array())
+		{
+			try
+			{
+				version->libraries.append(RawLibrary::fromJson(lib.toObject(), "versions.json"));
+			}
+			catch (MMCError &e)
+			{
+				return false;
+			}
+		}
+		versions.append(version);
+	}
+	return in.status() == QDataStream::Ok;
+}
+}
 
 LiteLoaderVersionList::LiteLoaderVersionList(QObject *parent) : BaseVersionList(parent)
 {
+	// the list from the last run is shown until it's checked against the server
+	restoreList(VersionListCache::key({sourceEntry()}));
+}
+
+MetaEntryPtr LiteLoaderVersionList::sourceEntry()
+{
+	return MMC->metacache()->resolveEntry("liteloader", "versions.json");
+}
+
+QString LiteLoaderVersionList::storedListPath()
+{
+	return PathCombine(MMC->metacache()->getBasePath("liteloader"), "versions.cache");
+}
+
+bool LiteLoaderVersionList::restoreList(const QString &key)
+{
+	if (key.isEmpty())
+		return false;
+	if (m_loaded && key == m_cacheKey)
+		return true;
+	QList<BaseVersionPtr> versions;
+	if (!VersionListCache::read(storedListPath(), key, [&](QDataStream &in)
+	{ return readVersions(in, versions); }))
+	{
+		return false;
+	}
+	updateListData(versions);
+	m_cacheKey = key;
+	return true;
 }
 
 Task *LiteLoaderVersionList::getLoadTask()
@@ -93,6 +176,7 @@ void LiteLoaderVersionList::updateListData(QList<BaseVersionPtr> versions)
 LLListLoadTask::LLListLoadTask(LiteLoaderVersionList *vlist)
 {
 	m_list = vlist;
+	connect(&m_parseWatcher, SIGNAL(finished()), SLOT(listParsed()));
 }
 
 LLListLoadTask::~LLListLoadTask()
@@ -104,13 +188,13 @@ void LLListLoadTask::executeTask()
 	setStatus(tr("Loading LiteLoader version list..."));
 	auto job = new NetJob("Version index");
 	// we do not care if the version is stale or not.
-	auto liteloaderEntry = MMC->metacache()->resolveEntry("liteloader", "versions.json");
+	listEntry = LiteLoaderVersionList::sourceEntry();
 
 	// verify by poking the server.
-	liteloaderEntry->stale = true;
+	listEntry->stale = true;
 
 	job->addNetAction(listDownload = CacheDownload::make(QUrl(URLConstants::LITELOADER_URL),
-														 liteloaderEntry));
+														 listEntry));
 
 	connect(listDownload.get(), SIGNAL(failed(int)), SLOT(listFailed()));
 
@@ -128,19 +212,47 @@ void LLListLoadTask::listFailed()
 
 void LLListLoadTask::listDownloaded()
 {
+	// a 304 leaves the file alone, so the list made from it last time is still good
+	QString key = VersionListCache::key({listEntry});
+	if (m_list->restoreList(key))
+	{
+		QLOG_INFO() << "LiteLoader version list didn't change, using the stored list.";
+		emitSucceeded();
+		return;
+	}
+
+	setStatus(tr("Processing LiteLoader version list..."));
+	m_parseWatcher.setFuture(QtConcurrent::run(&LLListLoadTask::parseList,
+											   listDownload->getTargetFilepath(),
+											   LiteLoaderVersionList::storedListPath(), key));
+}
+
+void LLListLoadTask::listParsed()
+{
+	auto result = m_parseWatcher.result();
+	if (!result.error.isEmpty())
+	{
+		emitFailed(result.error);
+		return;
+	}
+	m_list->updateListData(result.versions);
+	m_list->m_cacheKey = VersionListCache::key({listEntry});
+	emitSucceeded();
+}
+
+LLListLoadTask::ParseResult LLListLoadTask::parseList(QString listFile, QString storePath,
+													  QString key)
+{
+	ParseResult result;
 	QByteArray data;
 	{
-		auto dlJob = listDownload;
-		auto filename = std::dynamic_pointer_cast<CacheDownload>(dlJob)->getTargetFilepath();
-		QFile listFile(filename);
-		if (!listFile.open(QIODevice::ReadOnly))
+		QFile file(listFile);
+		if (!file.open(QIODevice::ReadOnly))
 		{
-			emitFailed("Failed to open the LiteLoader version list.");
-			return;
+			result.error = "Failed to open the LiteLoader version list.";
+			return result;
 		}
-		data = listFile.readAll();
-		listFile.close();
-		dlJob.reset();
+		data = file.readAll();
 	}
 
 	QJsonParseError jsonError;
@@ -148,14 +260,14 @@ void LLListLoadTask::listDownloaded()
 
 	if (jsonError.error != QJsonParseError::NoError)
 	{
-		emitFailed("Error parsing version list JSON:" + jsonError.errorString());
-		return;
+		result.error = "Error parsing version list JSON:" + jsonError.errorString();
+		return result;
 	}
 
 	if (!jsonDoc.isObject())
 	{
-		emitFailed("Error parsing version list JSON: jsonDoc is not an object");
-		return;
+		result.error = "Error parsing version list JSON: jsonDoc is not an object";
+		return result;
 	}
 
 	const QJsonObject root = jsonDoc.object();
@@ -163,8 +275,8 @@ void LLListLoadTask::listDownloaded()
 	// Now, get the array of versions.
 	if (!root.value("versions").isObject())
 	{
-		emitFailed("Error parsing version list JSON: missing 'versions' object");
-		return;
+		result.error = "Error parsing version list JSON: missing 'versions' object";
+		return result;
 	}
 
 	auto meta = root.value("meta").toObject();
@@ -173,7 +285,7 @@ void LLListLoadTask::listDownloaded()
 	QString authors = meta.value("authors").toString("Mumfrey");
 	auto versions = root.value("versions").toObject();
 
-	QList<BaseVersionPtr> tempList;
+	QList<BaseVersionPtr> &tempList = result.versions;
 	for (auto vIt = versions.begin(); vIt != versions.end(); ++vIt)
 	{
 		const QString mcVersion = vIt.key();
@@ -233,7 +345,7 @@ void LLListLoadTask::listDownloaded()
 		}
 		tempList.append(perMcVersionList);
 	}
-	m_list->updateListData(tempList);
-
-	emitSucceeded();
+	VersionListCache::write(storePath, key, [&](QDataStream &out)
+	{ writeVersions(out, tempList); });
+	return result;
 }
@@ -19,6 +19,7 @@
 
 #include <QString>
 #include <QStringList>
+#include <QFutureWatcher>
 #include "logic/BaseVersion.h"
 #include "logic/BaseVersionList.h"
 #include "logic/tasks/Task.h"
@@ -81,11 +82,22 @@ public:
 
 	virtual BaseVersionPtr getLatestStable() const;
 
+	/**
+	 * Use the list stored by an earlier load, if it was made from the file 'key' stands for.
+	 */
+	bool restoreList(const QString &key);
+
 protected:
 	QList<BaseVersionPtr> m_vlist;
 
 	bool m_loaded = false;
 
+	/// VersionListCache key of the file the current list was made from
+	QString m_cacheKey;
+
+	static MetaEntryPtr sourceEntry();
+	static QString storedListPath();
+
 protected
 slots:
 	virtual void updateListData(QList<BaseVersionPtr> versions);
@@ -96,6 +108,12 @@ class LLListLoadTask : public Task
 	Q_OBJECT
 
 public:
+	struct ParseResult
+	{
+		QList<BaseVersionPtr> versions;
+		QString error;
+	};
+
 	explicit LLListLoadTask(LiteLoaderVersionList *vlist);
 	~LLListLoadTask();
 
@@ -104,12 +122,19 @@ public:
 protected
 slots:
 	void listDownloaded();
+	void listParsed();
 	void listFailed();
 
 protected:
 	NetJobPtr listJob;
+	MetaEntryPtr listEntry;
 	CacheDownloadPtr listDownload;
 	LiteLoaderVersionList *m_list;
+	QFutureWatcher<ParseResult> m_parseWatcher;
+
+private:
+	/// runs on a worker thread. Parses the list and stores the result under 'key'.
+	static ParseResult parseList(QString listFile, QString storePath, QString key);
 };
 
 Q_DECLARE_METATYPE(LiteLoaderVersionPtr)
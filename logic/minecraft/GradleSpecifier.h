@@ -2,8 +2,15 @@
 
 #include <QString>
 #include <QStringList>
-#include "logic/DefaultVariable.h"
+#include <QHash>
+#include "StringTable.h"
 
+/**
+ * A gradle dependency specifier, like 'group:artifact:version:classifier@extension'.
+ *
+ * The parts are kept as StringTable handles, so specifiers are small and cheap to compare and
+ * hash, and reading a part needs neither a lock nor a copy.
+ */
 struct GradleSpecifier
 {
 	GradleSpecifier()
@@ -18,40 +25,55 @@ struct GradleSpecifier
 	{
 		/*
 		org.gradle.test.classifiers : service : 1.0 : jdk15 @ jar
-		DEBUG   0 "org.gradle.test.classifiers:service:1.0:jdk15@jar" 
-		DEBUG   1 "org.gradle.test.classifiers" 
-		DEBUG   2 "service" 
-		DEBUG   3 "1.0" 
-		DEBUG   4 ":jdk15" 
-		DEBUG   5 "jdk15" 
-		DEBUG   6 "@jar" 
-		DEBUG   7 "jar"
+		group                         artifact  version classifier extension
+		None of the parts can be empty or contain ':' or '@'.
 		*/
-		QRegExp matcher("([^:@]+):([^:@]+):([^:@]+)" "(:([^:@]+))?" "(@([^:@]+))?");
-		m_valid = matcher.exactMatch(value);
-		auto elements = matcher.capturedTexts();
-		m_groupId = elements[1];
-		m_artifactId = elements[2];
-		m_version = elements[3];
-		m_classifier = elements[5];
-		if(!elements[7].isEmpty())
+		*this = GradleSpecifier();
+		QString coordinates = value;
+		QString extension;
+		int at = value.indexOf('@');
+		if(at != -1)
 		{
-			m_extension = elements[7];
+			coordinates = value.left(at);
+			extension = value.mid(at + 1);
+			if(extension.isEmpty() || extension.contains('@') || extension.contains(':'))
+				return *this;
 		}
+		auto parts = coordinates.split(':');
+		if(parts.size() < 3 || parts.size() > 4)
+			return *this;
+		for(auto & part: parts)
+		{
+			if(part.isEmpty())
+				return *this;
+		}
+		m_groupId = StringTable::intern(parts[0]);
+		m_artifactId = StringTable::intern(parts[1]);
+		m_version = StringTable::intern(parts[2]);
+		if(parts.size() == 4)
+		{
+			m_classifier = StringTable::intern(parts[3]);
+		}
+		if(!extension.isEmpty())
+		{
+			m_extension = StringTable::intern(extension);
+			m_explicitExtension = true;
+		}
+		m_valid = true;
 		return *this;
 	}
 	operator QString() const
 	{
 		if(!m_valid)
 			return "INVALID";
-		QString retval = m_groupId + ":" + m_artifactId + ":" + m_version;
-		if(!m_classifier.isEmpty())
+		QString retval = groupId() + ":" + artifactId() + ":" + version();
+		if(m_classifier != StringTable::empty())
 		{
-			retval += ":" + m_classifier;
+			retval += ":" + classifier();
 		}
-		if(m_extension.isExplicit())
+		if(m_explicitExtension)
 		{
-			retval += "@" + m_extension;
+			retval += "@" + extension();
 		}
 		return retval;
 	}
@@ -59,51 +81,53 @@ struct GradleSpecifier
 	{
 		if(!m_valid)
 			return "INVALID";
-		QString path = m_groupId;
+		QString path = groupId();
 		path.replace('.', '/');
-		path += '/' + m_artifactId + '/' + m_version + '/' + m_artifactId + '-' + m_version;
-		if(!m_classifier.isEmpty())
+		const QString &artifact = artifactId();
+		const QString &ver = version();
+		path += '/' + artifact + '/' + ver + '/' + artifact + '-' + ver;
+		if(m_classifier != StringTable::empty())
 		{
-			path += "-" + m_classifier;
+			path += "-" + classifier();
 		}
-		path += "." + m_extension;
+		path += "." + extension();
 		return path;
 	}
 	inline bool valid() const
 	{
 		return m_valid;
 	}
-	inline QString version() const
+	inline const QString &version() const
 	{
-		return m_version;
+		return *m_version;
 	}
-	inline QString groupId() const
+	inline const QString &groupId() const
 	{
-		return m_groupId;
+		return *m_groupId;
 	}
-	inline QString artifactId() const
+	inline const QString &artifactId() const
 	{
-		return m_artifactId;
+		return *m_artifactId;
 	}
 	inline void setClassifier(const QString & classifier)
 	{
-		m_classifier = classifier;
+		m_classifier = StringTable::intern(classifier);
 	}
-	inline QString classifier() const
+	inline const QString &classifier() const
 	{
-		return m_classifier;
+		return *m_classifier;
 	}
-	inline QString extension() const
+	inline const QString &extension() const
 	{
-		return m_extension;
+		return *m_extension;
 	}
 	inline QString artifactPrefix() const
 	{
-		return m_groupId + ":" + m_artifactId;
+		return groupId() + ":" + artifactId();
 	}
 	bool matchName(const GradleSpecifier & other) const
 	{
-		return other.artifactId() == artifactId() && other.groupId() == groupId();
+		return other.m_artifactId == m_artifactId && other.m_groupId == m_groupId;
 	}
 	bool operator==(const GradleSpecifier & other) const
 	{
@@ -115,15 +139,32 @@ struct GradleSpecifier
 			return false;
 		if(m_classifier != other.m_classifier)
 			return false;
+		// 'jar' is the same handle whether it was given or not
 		if(m_extension != other.m_extension)
 			return false;
 		return true;
 	}
+	friend uint qHash(const GradleSpecifier & spec, uint seed = 0)
+	{
+		// the extension is left out, it's almost always 'jar'
+		uint hash = seed;
+		hash = hash * 31 + qHash(spec.m_groupId);
+		hash = hash * 31 + qHash(spec.m_artifactId);
+		hash = hash * 31 + qHash(spec.m_version);
+		hash = hash * 31 + qHash(spec.m_classifier);
+		return hash;
+	}
 private:
-	QString m_groupId;
-	QString m_artifactId;
-	QString m_version;
-	QString m_classifier;
-	DefaultVariable<QString> m_extension = DefaultVariable<QString>("jar");
+	static StringTable::Handle defaultExtension()
+	{
+		static StringTable::Handle jar = StringTable::intern("jar");
+		return jar;
+	}
+	StringTable::Handle m_groupId = StringTable::empty();
+	StringTable::Handle m_artifactId = StringTable::empty();
+	StringTable::Handle m_version = StringTable::empty();
+	StringTable::Handle m_classifier = StringTable::empty();
+	StringTable::Handle m_extension = defaultExtension();
+	bool m_explicitExtension = false;
 	bool m_valid = false;
 };
@@ -18,10 +18,12 @@
 #include <QUuid>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QSet>
 #include <pathutils.h>
 
 #include "logic/minecraft/InstanceVersion.h"
 #include "logic/minecraft/VersionBuilder.h"
+#include "logic/minecraft/VersionSnapshot.h"
 #include "logic/OneSixInstance.h"
 
 InstanceVersion::InstanceVersion(OneSixInstance *instance, QObject *parent)
@@ -33,14 +35,23 @@ InstanceVersion::InstanceVersion(OneSixInstance *instance, QObject *parent)
 void InstanceVersion::reload(const QStringList &external)
 {
 	m_externalPatches = external;
+	m_snapshotKey.clear();
 	beginResetModel();
-	VersionBuilder::build(this, m_instance, m_externalPatches);
-	reapply(true);
+	QString snapshotKey = VersionSnapshot::key(m_instance, m_externalPatches);
+	if (!VersionSnapshot::load(this, m_instance, snapshotKey))
+	{
+		VersionBuilder::build(this, m_instance, m_externalPatches);
+		reapply();
+		VersionSnapshot::save(this, m_instance, snapshotKey);
+	}
+	m_snapshotKey = snapshotKey;
 	endResetModel();
 }
 
 void InstanceVersion::clear()
 {
+	m_snapshotKey.clear();
+	m_layers.clear();
 	id.clear();
 	m_updateTimeString.clear();
 	m_updateTime = QDateTime();
@@ -91,7 +102,7 @@ bool InstanceVersion::remove(const int index)
 	beginRemoveRows(QModelIndex(), index, index);
 	VersionPatches.removeAt(index);
 	endRemoveRows();
-	reapply(true);
+	reapplyFrom(index);
 	saveCurrentOrder();
 	return true;
 }
@@ -171,14 +182,12 @@ bool InstanceVersion::isVanilla()
 
 bool InstanceVersion::revertToVanilla()
 {
-	beginResetModel();
 	// remove custom.json, if present
 	QString customPath = PathCombine(m_instance->instanceRoot(), "custom.json");
 	if(QFile::exists(customPath))
 	{
 		if(!QFile::remove(customPath))
 		{
-			endResetModel();
 			return false;
 		}
 	}
@@ -188,37 +197,40 @@ bool InstanceVersion::revertToVanilla()
 	{
 		if(!QFile::remove(versionPath))
 		{
-			endResetModel();
 			return false;
 		}
 	}
 	// remove patches, if present
-	auto it = VersionPatches.begin();
-	while (it != VersionPatches.end())
+	int firstRemoved = -1;
+	bool ok = true;
+	int i = 0;
+	while (i < VersionPatches.size())
 	{
-		if ((*it)->isMoveable())
+		auto patch = VersionPatches.at(i);
+		if (!patch->isMoveable())
 		{
-			if(!preremove(*it))
-			{
-				endResetModel();
-				saveCurrentOrder();
-				return false;
-			}
-			if(!QFile::remove((*it)->getPatchFilename()))
-			{
-				endResetModel();
-				saveCurrentOrder();
-				return false;
-			}
-			it = VersionPatches.erase(it);
+			i++;
+			continue;
+		}
+		if(!preremove(patch) || !QFile::remove(patch->getPatchFilename()))
+		{
+			ok = false;
+			break;
+		}
+		beginRemoveRows(QModelIndex(), i, i);
+		VersionPatches.removeAt(i);
+		endRemoveRows();
+		if (firstRemoved == -1)
+		{
+			firstRemoved = i;
 		}
-		else
-			it++;
 	}
-	reapply(true);
-	endResetModel();
+	if (firstRemoved != -1)
+	{
+		reapplyFrom(firstRemoved);
+	}
 	saveCurrentOrder();
-	return true;
+	return ok;
 }
 
 bool InstanceVersion::hasDeprecatedVersionFiles()
@@ -260,18 +272,17 @@ bool InstanceVersion::removeDeprecatedVersionFiles()
 QList<std::shared_ptr<OneSixLibrary> > InstanceVersion::getActiveNormalLibs()
 {
 	QList<std::shared_ptr<OneSixLibrary> > output;
+	QSet<GradleSpecifier> seen;
 	for (auto lib : libraries)
 	{
 		if (lib->isActive() && !lib->isNative())
 		{
-			for (auto other : output)
+			if (seen.contains(lib->rawName()))
 			{
-				if (other->rawName() == lib->rawName())
-				{
-					QLOG_WARN() << "Multiple libraries with name" << lib->rawName() << "in library list!";
-					continue;
-				}
+				QLOG_WARN() << "Multiple libraries with name" << lib->rawName() << "in library list!";
+				continue;
 			}
+			seen.insert(lib->rawName());
 			output.append(lib);
 		}
 	}
@@ -410,7 +421,7 @@ void InstanceVersion::move(const int index, const MoveDirection direction)
 	VersionPatches.swap(index, theirIndex);
 	endMoveRows();
 	saveCurrentOrder();
-	reapply();
+	reapplyFrom(qMin(index, theirIndex));
 }
 void InstanceVersion::resetOrder()
 {
@@ -418,16 +429,88 @@ void InstanceVersion::resetOrder()
 	reload(m_externalPatches);
 }
 
-void InstanceVersion::reapply(const bool alreadyReseting)
+void InstanceVersion::reapply()
 {
-	clear();
-	for(auto file: VersionPatches)
+	reapplyFrom(0);
+}
+
+void InstanceVersion::reapplyFrom(int index)
+{
+	// only the layers made from the same patches in the same order can be reused
+	int reusable = 0;
+	while (reusable < index && reusable < m_layers.size() &&
+		   m_layers[reusable].patch == VersionPatches[reusable])
 	{
+		reusable++;
+	}
+	m_layers.erase(m_layers.begin() + reusable, m_layers.end());
+
+	if (reusable)
+	{
+		restoreLayer(m_layers.last());
+	}
+	else
+	{
+		clear();
+	}
+	for (int i = reusable; i < VersionPatches.size(); i++)
+	{
+		auto file = VersionPatches[i];
 		file->applyTo(this);
+		Layer layer;
+		layer.patch = file;
+		saveLayer(layer);
+		m_layers.append(layer);
 	}
 	finalize();
 }
 
+void InstanceVersion::saveLayer(Layer &layer) const
+{
+	layer.id = id;
+	layer.m_releaseTimeString = m_releaseTimeString;
+	layer.m_releaseTime = m_releaseTime;
+	layer.m_updateTimeString = m_updateTimeString;
+	layer.m_updateTime = m_updateTime;
+	layer.type = type;
+	layer.assets = assets;
+	layer.processArguments = processArguments;
+	layer.vanillaProcessArguments = vanillaProcessArguments;
+	layer.minecraftArguments = minecraftArguments;
+	layer.vanillaMinecraftArguments = vanillaMinecraftArguments;
+	layer.minimumLauncherVersion = minimumLauncherVersion;
+	layer.tweakers = tweakers;
+	layer.mainClass = mainClass;
+	layer.appletClass = appletClass;
+	layer.libraries = libraries;
+	layer.vanillaLibraries = vanillaLibraries;
+	layer.traits = traits;
+	layer.jarMods = jarMods;
+}
+
+void InstanceVersion::restoreLayer(const Layer &layer)
+{
+	id = layer.id;
+	m_releaseTimeString = layer.m_releaseTimeString;
+	m_releaseTime = layer.m_releaseTime;
+	m_updateTimeString = layer.m_updateTimeString;
+	m_updateTime = layer.m_updateTime;
+	type = layer.type;
+	assets = layer.assets;
+	processArguments = layer.processArguments;
+	vanillaProcessArguments = layer.vanillaProcessArguments;
+	minecraftArguments = layer.minecraftArguments;
+	vanillaMinecraftArguments = layer.vanillaMinecraftArguments;
+	minimumLauncherVersion = layer.minimumLauncherVersion;
+	tweakers = layer.tweakers;
+	mainClass = layer.mainClass;
+	appletClass = layer.appletClass;
+	libraries = layer.libraries;
+	vanillaLibraries = layer.vanillaLibraries;
+	traits = layer.traits;
+	jarMods = layer.jarMods;
+}
+
 void InstanceVersion::finalize()
 {
 	// HACK: deny april fools. my head hurts enough already.
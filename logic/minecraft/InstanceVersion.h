@@ -42,6 +42,12 @@ public:
 	void reload(const QStringList &external = QStringList());
 	void clear();
 
+	/// VersionSnapshot key of the files the version was last loaded from, empty if it wasn't
+	QString snapshotKey() const
+	{
+		return m_snapshotKey;
+	}
+
 	bool canRemove(const int index) const;
 
 	QString versionFileId(const int index) const;
@@ -71,9 +77,13 @@ public:
 	void resetOrder();
 
 	// clears and reapplies all version files
-	void reapply(const bool alreadyReseting = false);
+	void reapply();
 	void finalize();
 
+private:
+	// reapplies the version files from 'index' on, on top of what the ones below it made
+	void reapplyFrom(int index);
+
 public
 slots:
 	bool remove(const int index);
@@ -177,7 +187,37 @@ public:
 	VersionPatchPtr versionPatch(int index);
 
 private:
+	/// everything the version files change, as it was after applying one of them
+	struct Layer
+	{
+		VersionPatchPtr patch;
+		QString id;
+		QString m_releaseTimeString;
+		QDateTime m_releaseTime;
+		QString m_updateTimeString;
+		QDateTime m_updateTime;
+		QString type;
+		QString assets;
+		QString processArguments;
+		QString vanillaProcessArguments;
+		QString minecraftArguments;
+		QString vanillaMinecraftArguments;
+		int minimumLauncherVersion;
+		QStringList tweakers;
+		QString mainClass;
+		QString appletClass;
+		QList<OneSixLibraryPtr> libraries;
+		QList<OneSixLibraryPtr> vanillaLibraries;
+		QSet<QString> traits;
+		QList<JarmodPtr> jarMods;
+	};
+	void saveLayer(Layer &layer) const;
+	void restoreLayer(const Layer &layer);
+
+	/// m_layers[i] is the state after applying VersionPatches[i], before finalize()
+	QList<Layer> m_layers;
 	QStringList m_externalPatches;
+	QString m_snapshotKey;
 	OneSixInstance *m_instance;
 	void saveCurrentOrder() const;
 	int getFreeOrderNumber();
@@ -0,0 +1,221 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LaunchPlan.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDataStream>
+
+#include "logger/QsLog.h"
+
+namespace
+{
+const quint32 planMagic = 0x4d4d434c; // "MMCL"
+// bump this when the stored data changes
+const quint32 planFormat = 2;
+
+qint64 lastModified(const QFileInfo &info)
+{
+	return info.lastModified().toMSecsSinceEpoch();
+}
+}
+
+void LaunchPlan::addClassPath(const QString &path)
+{
+	m_classpath.append(path);
+	addInput(path);
+}
+
+void LaunchPlan::addInput(const QString &path)
+{
+	QFileInfo info(path);
+	m_fingerprints.append({path, info.exists() ? info.size() : -1, lastModified(info)});
+}
+
+void LaunchPlan::addRequiredFolder(const QString &path)
+{
+	m_folders.append(path);
+}
+
+void LaunchPlan::setArguments(const QString &arguments, const QMap<QString, QString> &known)
+{
+	m_arguments.clear();
+	for (auto part : arguments.split(' ', QString::SkipEmptyParts))
+	{
+		Argument argument;
+		QString literal;
+		int tail = 0;
+		int head;
+		while ((head = part.indexOf("${", tail)) != -1)
+		{
+			int end = part.indexOf('}', head + 2);
+			if (end == -1)
+				break;
+			literal += part.mid(tail, head - tail);
+			QString token = part.mid(head + 2, end - head - 2);
+			tail = end + 1;
+			auto iter = known.find(token);
+			if (iter != known.end())
+			{
+				literal += *iter;
+				continue;
+			}
+			argument << literal << token;
+			literal.clear();
+		}
+		literal += part.mid(tail);
+		argument << literal;
+		m_arguments.append(argument);
+	}
+}
+
+bool LaunchPlan::isUpToDate() const
+{
+	for (auto &fingerprint : m_fingerprints)
+	{
+		QFileInfo info(fingerprint.path);
+		qint64 size = info.exists() ? info.size() : -1;
+		if (size != fingerprint.size || lastModified(info) != fingerprint.lastModified)
+			return false;
+	}
+	for (auto &folder : m_folders)
+	{
+		if (!QFileInfo(folder).isDir())
+			return false;
+	}
+	return true;
+}
+
+QString LaunchPlan::script(const QMap<QString, QString> &tokens) const
+{
+	QString launchScript;
+	for (auto &path : m_classpath)
+	{
+		launchScript += "cp " + path + "\n";
+	}
+	if (!mainClass.isEmpty())
+	{
+		launchScript += "mainClass " + mainClass + "\n";
+	}
+	if (!appletClass.isEmpty())
+	{
+		launchScript += "appletClass " + appletClass + "\n";
+	}
+	for (auto &argument : m_arguments)
+	{
+		QString param = argument.first();
+		for (int i = 1; i + 1 < argument.size(); i += 2)
+		{
+			// unknown tokens are dropped, like they always were
+			param += tokens.value(argument[i]);
+			param += argument[i + 1];
+		}
+		launchScript += "param " + param + "\n";
+	}
+	launchScript += "natives " + natives + "\n";
+	for (auto &trait : traits)
+	{
+		launchScript += "traits " + trait + "\n";
+	}
+	return launchScript;
+}
+
+void LaunchPlan::save(const QString &path, const QString &key) const
+{
+	QSaveFile output(path);
+	if (!output.open(QIODevice::WriteOnly))
+	{
+		QLOG_WARN() << "Couldn't write launch plan" << path << ":" << output.errorString();
+		return;
+	}
+	QDataStream out(&output);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << planMagic << planFormat << key;
+	out << mainClass << appletClass << natives << traits;
+	out << m_classpath << quint32(m_fingerprints.size());
+	for (auto &fingerprint : m_fingerprints)
+	{
+		out << fingerprint.path << fingerprint.size << fingerprint.lastModified;
+	}
+	out << m_folders << m_arguments;
+	if (out.status() != QDataStream::Ok)
+	{
+		output.cancelWriting();
+		QLOG_WARN() << "Couldn't write launch plan" << path;
+		return;
+	}
+	if (!output.commit())
+	{
+		QLOG_WARN() << "Couldn't write launch plan" << path;
+	}
+}
+
+LaunchPlanPtr LaunchPlan::load(const QString &path, const QString &key)
+{
+	if (key.isEmpty())
+		return nullptr;
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+		return nullptr;
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic = 0, format = 0;
+	QString storedKey;
+	in >> magic >> format >> storedKey;
+	if (magic != planMagic || format != planFormat || storedKey != key)
+		return nullptr;
+
+	LaunchPlanPtr plan(new LaunchPlan());
+	quint32 count = 0;
+	in >> plan->mainClass >> plan->appletClass >> plan->natives >> plan->traits;
+	in >> plan->m_classpath >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		Fingerprint fingerprint;
+		in >> fingerprint.path >> fingerprint.size >> fingerprint.lastModified;
+		plan->m_fingerprints.append(fingerprint);
+	}
+	in >> plan->m_folders >> plan->m_arguments;
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Launch plan" << path << "is damaged, ignoring it";
+		return nullptr;
+	}
+	return plan;
+}
+
+QString LaunchPlan::storedNatives(const QString &path)
+{
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+		return QString();
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic = 0, format = 0;
+	QString key, mainClass, appletClass, natives;
+	in >> magic >> format >> key;
+	// the start of the plan is the same in all formats so far
+	if (magic != planMagic || format < 1 || format > planFormat)
+		return QString();
+	in >> mainClass >> appletClass >> natives;
+	if (in.status() != QDataStream::Ok)
+		return QString();
+	return natives;
+}
@@ -0,0 +1,88 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <memory>
+
+class LaunchPlan;
+typedef std::shared_ptr<LaunchPlan> LaunchPlanPtr;
+
+/**
+ * Everything a OneSix launch needs that only depends on the instance version and the files
+ * on disk: class path, natives folder, main class, traits and the minecraft arguments with
+ * all the values known in advance already filled in.
+ *
+ * It is made once after the version is loaded or updated, and stored in the instance folder.
+ * Launching only checks the files are still the same and fills in the session tokens.
+ */
+class LaunchPlan
+{
+public:
+	/// add a file to the class path. Its size and modification time are remembered.
+	void addClassPath(const QString &path);
+
+	/// a file the plan was made from. Its size and modification time are remembered.
+	void addInput(const QString &path);
+
+	/// a folder that has to exist for the plan to stay valid
+	void addRequiredFolder(const QString &path);
+
+	/**
+	 * Split the arguments into parts and replace the tokens from 'known'.
+	 * Other tokens are left for script() to fill in.
+	 */
+	void setArguments(const QString &arguments, const QMap<QString, QString> &known);
+
+	/// true if the files the plan refers to haven't changed since it was made
+	bool isUpToDate() const;
+
+	/// the part of the launch script that comes from the plan, with 'tokens' filled in
+	QString script(const QMap<QString, QString> &tokens) const;
+
+	/// store the plan along with the key of what it was made from. Failures are only logged.
+	void save(const QString &path, const QString &key) const;
+
+	/// read a plan stored by save(). Returns nullptr unless it was stored with the same key.
+	static LaunchPlanPtr load(const QString &path, const QString &key);
+
+	/// the natives folder of a stored plan, whatever its key. Empty if there is no plan.
+	static QString storedNatives(const QString &path);
+
+public: /* data */
+	QString mainClass;
+	QString appletClass;
+	QString natives;
+	QStringList traits;
+
+private:
+	struct Fingerprint
+	{
+		QString path;
+		qint64 size;
+		qint64 lastModified;
+	};
+	/// literal text and token names, alternating. the first and last parts are literal.
+	typedef QStringList Argument;
+
+	QStringList m_classpath;
+	QList<Fingerprint> m_fingerprints;
+	QStringList m_folders;
+	QList<Argument> m_arguments;
+};
@@ -16,6 +16,9 @@
 #include <QtXml>
 #include "logic/MMCJson.h"
 #include <QtAlgorithms>
+#include <QtEndian>
+#include <cstring>
+#include <algorithm>
 #include <QtNetwork>
 
 #include "MultiMC.h"
@@ -29,7 +32,73 @@
 #include <logic/VersionFilterData.h>
 #include <pathutils.h>
 
-static const char * localVersionCache = "versions/versions.dat";
+/*
+ * The local version cache, versions/versions.cache. All numbers are little endian.
+ *
+ * header:  char[4] magic "MCVL", quint32 format, quint32 record count,
+ *          quint32 string pool size, string latest release, string latest snapshot
+ * records: record count times { string id, string type, string releaseTime, string time,
+ *          qint64 release time in ms since epoch }
+ * pool:    UTF-8 string data
+ *
+ * A 'string' is a quint32 offset into the pool followed by a quint32 length in bytes.
+ */
+static const char * localVersionCache = "versions/versions.cache";
+/// the binary json cache used before versions.cache. only read to migrate it.
+static const char * legacyVersionCache = "versions/versions.dat";
+
+namespace
+{
+const char cacheMagic[4] = {'M', 'C', 'V', 'L'};
+const quint32 cacheFormat = 1;
+const int stringRefSize = 8;
+const int headerSize = 4 + 3 * 4 + 2 * stringRefSize;
+const int recordSize = 4 * stringRefSize + 8;
+
+template <typename T> T readLE(const uchar *data)
+{
+	T value;
+	memcpy(&value, data, sizeof(T));
+	return qFromLittleEndian(value);
+}
+
+template <typename T> void appendLE(QByteArray &out, T value)
+{
+	value = qToLittleEndian(value);
+	out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+class StringPool
+{
+public:
+	void appendRef(QByteArray &out, const QString &str)
+	{
+		QByteArray utf8 = str.toUtf8();
+		auto iter = m_offsets.find(utf8);
+		quint32 offset;
+		if (iter != m_offsets.end())
+		{
+			offset = *iter;
+		}
+		else
+		{
+			offset = m_data.size();
+			m_data.append(utf8);
+			m_offsets.insert(utf8, offset);
+		}
+		appendLE<quint32>(out, offset);
+		appendLE<quint32>(out, utf8.size());
+	}
+	const QByteArray &data() const
+	{
+		return m_data;
+	}
+
+private:
+	QByteArray m_data;
+	QHash<QByteArray, quint32> m_offsets;
+};
+}
 
 class ListLoadError : public MMCError
 {
@@ -58,7 +127,7 @@ bool MinecraftVersionList::isLoaded()
 
 const BaseVersionPtr MinecraftVersionList::at(int i) const
 {
-	return m_vlist.at(i);
+	return materialize(i);
 }
 
 int MinecraftVersionList::count() const
@@ -66,35 +135,149 @@ int MinecraftVersionList::count() const
 	return m_vlist.count();
 }
 
-static bool cmpVersions(BaseVersionPtr first, BaseVersionPtr second)
+int MinecraftVersionList::indexOf(const QString &descriptor) const
+{
+	if (m_rowsStale)
+	{
+		m_rows.clear();
+		m_rows.reserve(m_vlist.size());
+		for (int i = 0; i < m_vlist.size(); i++)
+		{
+			m_rows.insert(m_vlist[i].descriptor, i);
+		}
+		m_rowsStale = false;
+	}
+	return m_rows.value(descriptor, -1);
+}
+
+BaseVersionPtr MinecraftVersionList::findVersion(const QString &descriptor)
+{
+	int i = indexOf(descriptor);
+	if (i == -1)
+		return BaseVersionPtr();
+	return materialize(i);
+}
+
+QString MinecraftVersionList::cacheString(const uchar *ref) const
 {
-	auto left = std::dynamic_pointer_cast<MinecraftVersion>(first);
-	auto right = std::dynamic_pointer_cast<MinecraftVersion>(second);
-	return left->m_releaseTime > right->m_releaseTime;
+	quint32 offset = readLE<quint32>(ref);
+	quint32 size = readLE<quint32>(ref + 4);
+	quint32 poolSize = readLE<quint32>(m_cacheData + 12);
+	if (offset > poolSize || size > poolSize - offset)
+		return QString();
+	const uchar *pool = m_cacheData + headerSize + readLE<quint32>(m_cacheData + 8) * recordSize;
+	return QString::fromUtf8(reinterpret_cast<const char *>(pool + offset), size);
+}
+
+BaseVersionPtr MinecraftVersionList::materialize(int i) const
+{
+	Entry &entry = m_vlist[i];
+	if (entry.version)
+		return entry.version;
+
+	const uchar *record = m_cacheData + headerSize + entry.cacheRecord * recordSize;
+	std::shared_ptr<MinecraftVersion> mcVersion(new MinecraftVersion());
+	mcVersion->m_name = mcVersion->m_descriptor = entry.descriptor;
+	mcVersion->m_type = cacheString(record + stringRefSize);
+	parse_timestamp(cacheString(record + 2 * stringRefSize), mcVersion->m_releaseTimeString,
+					mcVersion->m_releaseTime);
+	parse_timestamp(cacheString(record + 3 * stringRefSize), mcVersion->m_updateTimeString,
+					mcVersion->m_updateTime);
+	mcVersion->m_versionSource = Local;
+	mcVersion->download_url =
+		"http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + entry.descriptor + "/";
+	entry.version = mcVersion;
+	entry.cacheRecord = -1;
+	return entry.version;
 }
 
 void MinecraftVersionList::sortInternal()
 {
-	qSort(m_vlist.begin(), m_vlist.end(), cmpVersions);
+	m_rowsStale = true;
+	qSort(m_vlist.begin(), m_vlist.end(), [](const Entry &first, const Entry &second)
+	{
+		return first.releaseTime > second.releaseTime;
+	});
 }
 
 void MinecraftVersionList::loadCachedList()
 {
-	QFile localIndex(localVersionCache);
-	if (!localIndex.exists())
+	m_cacheFile.setFileName(localVersionCache);
+	if (!m_cacheFile.exists())
 	{
+		loadLegacyCachedList();
 		return;
 	}
-	if (!localIndex.open(QIODevice::ReadOnly))
+	if (!m_cacheFile.open(QIODevice::ReadOnly))
 	{
 		// FIXME: this is actually a very bad thing! How do we deal with this?
 		QLOG_ERROR() << "The minecraft version cache can't be read.";
 		return;
 	}
+	m_cacheSize = m_cacheFile.size();
+	m_cacheData = m_cacheFile.map(0, m_cacheSize);
+	if (!m_cacheData || !readCacheIndex())
+	{
+		// the cache has gone bad for some reason... flush it.
+		QLOG_ERROR() << "The minecraft version cache is corrupted. Flushing cache.";
+		m_cacheData = nullptr;
+		m_cacheFile.close();
+		m_cacheFile.remove();
+		return;
+	}
+	m_hasLocalIndex = true;
+}
+
+bool MinecraftVersionList::readCacheIndex()
+{
+	if (m_cacheSize < headerSize || memcmp(m_cacheData, cacheMagic, 4) != 0)
+		return false;
+	if (readLE<quint32>(m_cacheData + 4) != cacheFormat)
+		return false;
+	quint64 records = readLE<quint32>(m_cacheData + 8);
+	quint64 poolSize = readLE<quint32>(m_cacheData + 12);
+	if (headerSize + records * recordSize + poolSize != quint64(m_cacheSize))
+		return false;
+
+	m_latestReleaseID = cacheString(m_cacheData + 16);
+	m_latestSnapshotID = cacheString(m_cacheData + 16 + stringRefSize);
+	QList<Entry> entries;
+	for (quint64 i = 0; i < records; i++)
+	{
+		const uchar *record = m_cacheData + headerSize + i * recordSize;
+		Entry entry;
+		entry.descriptor = cacheString(record);
+		if (entry.descriptor.isEmpty())
+			return false;
+		entry.releaseTime = readLE<qint64>(record + 4 * stringRefSize);
+		entry.cacheRecord = i;
+		// builtin versions always win
+		if (indexOf(entry.descriptor) != -1)
+			continue;
+		entries.append(entry);
+	}
+	m_vlist.append(entries);
+	sortInternal();
+	QLOG_INFO() << "Loaded" << entries.size() << "versions from the local version cache.";
+	return true;
+}
+
+void MinecraftVersionList::loadLegacyCachedList()
+{
+	QFile localIndex(legacyVersionCache);
+	if (!localIndex.exists())
+	{
+		return;
+	}
+	if (!localIndex.open(QIODevice::ReadOnly))
+	{
+		QLOG_ERROR() << "The old minecraft version cache can't be read.";
+		return;
+	}
 	auto data = localIndex.readAll();
+	localIndex.close();
 	try
 	{
-		localIndex.close();
 		QJsonDocument jsonDoc = QJsonDocument::fromBinaryData(data);
 		if (jsonDoc.isNull())
 		{
@@ -104,12 +287,26 @@ void MinecraftVersionList::loadCachedList()
 	}
 	catch (MMCError &e)
 	{
-		// the cache has gone bad for some reason... flush it.
-		QLOG_ERROR() << "The minecraft version cache is corrupted. Flushing cache.";
+		QLOG_ERROR() << "The old minecraft version cache is corrupted.";
 		localIndex.remove();
 		return;
 	}
 	m_hasLocalIndex = true;
+	// move it over to the new format
+	saveCachedList();
+	localIndex.remove();
+}
+
+void MinecraftVersionList::releaseCache()
+{
+	if (!m_cacheData)
+		return;
+	for (int i = 0; i < m_vlist.size(); i++)
+	{
+		materialize(i);
+	}
+	m_cacheData = nullptr;
+	m_cacheFile.close();
 }
 
 void MinecraftVersionList::loadBuiltinList()
@@ -169,9 +366,13 @@ void MinecraftVersionList::loadBuiltinList()
 				mcVersion->m_traits.insert(MMCJson::ensureString(traitVal));
 			}
 		}
-		m_lookup[versionID] = mcVersion;
-		m_vlist.append(mcVersion);
+		Entry entry;
+		entry.descriptor = versionID;
+		entry.releaseTime = mcVersion->m_releaseTime.toMSecsSinceEpoch();
+		entry.version = mcVersion;
+		m_vlist.append(entry);
 	}
+	sortInternal();
 }
 
 void MinecraftVersionList::loadMojangList(QJsonDocument jsonDoc, VersionSource source)
@@ -305,38 +506,87 @@ void MinecraftVersionList::sort()
 
 BaseVersionPtr MinecraftVersionList::getLatestStable() const
 {
-	if(m_lookup.contains(m_latestReleaseID))
-		return m_lookup[m_latestReleaseID];
-	return BaseVersionPtr();
+	int i = indexOf(m_latestReleaseID);
+	if (i == -1)
+		return BaseVersionPtr();
+	return materialize(i);
+}
+
+BaseVersionPtr MinecraftVersionList::getLatestSnapshot() const
+{
+	int i = indexOf(m_latestSnapshotID);
+	if (i == -1)
+		return BaseVersionPtr();
+	return materialize(i);
 }
 
 void MinecraftVersionList::updateListData(QList<BaseVersionPtr> versions)
 {
-	beginResetModel();
+	// updateListData is called after Mojang list loads. those can be local or remote
+	// remote comes always after local. Only what changed is touched.
+	QList<Entry> newEntries;
+	QSet<QString> newDescriptors;
 	for (auto version : versions)
 	{
-		auto descr = version->descriptor();
-
-		if (!m_lookup.contains(descr))
+		auto added = std::dynamic_pointer_cast<MinecraftVersion>(version);
+		int idx = indexOf(added->descriptor());
+		if (idx == -1)
 		{
-			m_lookup[version->descriptor()] = version;
-			m_vlist.append(version);
+			if (newDescriptors.contains(added->descriptor()))
+				continue;
+			newDescriptors.insert(added->descriptor());
+			Entry entry;
+			entry.descriptor = added->descriptor();
+			entry.releaseTime = added->m_releaseTime.toMSecsSinceEpoch();
+			entry.version = added;
+			newEntries.append(entry);
 			continue;
 		}
-		auto orig = std::dynamic_pointer_cast<MinecraftVersion>(m_lookup[descr]);
-		auto added = std::dynamic_pointer_cast<MinecraftVersion>(version);
-		// updateListData is called after Mojang list loads. those can be local or remote
-		// remote comes always after local
 		// any other options are ignored
-		if (orig->m_versionSource != Local || added->m_versionSource != Remote)
+		if (added->m_versionSource != Remote)
+		{
+			continue;
+		}
+		const Entry &existing = m_vlist[idx];
+		if (!existing.version)
+		{
+			// still in the cache, so it's local. Same time means Mojang didn't change it.
+			const uchar *record = m_cacheData + headerSize + existing.cacheRecord * recordSize;
+			if (cacheString(record + 3 * stringRefSize) == added->m_updateTimeString)
+				continue;
+		}
+		auto orig = std::dynamic_pointer_cast<MinecraftVersion>(materialize(idx));
+		if (orig->m_versionSource != Local ||
+			orig->m_updateTimeString == added->m_updateTimeString)
 		{
 			continue;
 		}
 		// alright, it's an update. put it inside the original, for further processing.
 		orig->upstreamUpdate = added;
+		emit dataChanged(index(idx), index(idx));
+	}
+
+	// merge the new ones in, newest first like the list, so the list is walked only once
+	std::stable_sort(newEntries.begin(), newEntries.end(), [](const Entry &first,
+															  const Entry &second)
+	{
+		return first.releaseTime > second.releaseTime;
+	});
+	int row = 0;
+	for (auto &entry : newEntries)
+	{
+		while (row < m_vlist.size() && m_vlist[row].releaseTime >= entry.releaseTime)
+			row++;
+		beginInsertRows(QModelIndex(), row, row);
+		m_vlist.insert(row, entry);
+		// the rows after it moved, so the lookup is rebuilt the next time it's used
+		if (row == m_vlist.size() - 1)
+			m_rows.insert(entry.descriptor, row);
+		else
+			m_rowsStale = true;
+		endInsertRows();
+		row++;
 	}
-	sortInternal();
-	endResetModel();
 }
 
 inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
@@ -503,73 +753,56 @@ void MinecraftVersionList::saveCachedList()
 	// FIXME: throw.
 	if (!ensureFilePathExists(localVersionCache))
 		return;
-	QSaveFile tfile(localVersionCache);
-	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
-		return;
-	QJsonObject toplevel;
-	QJsonArray entriesArr;
-	for (auto version : m_vlist)
+	// the file is about to be replaced, stop using it
+	releaseCache();
+
+	QByteArray records;
+	StringPool pool;
+	quint32 count = 0;
+	for (auto &entry : m_vlist)
 	{
-		auto mcversion = std::dynamic_pointer_cast<MinecraftVersion>(version);
+		auto mcversion = std::dynamic_pointer_cast<MinecraftVersion>(entry.version);
 		// do not save the remote versions.
 		if (mcversion->m_versionSource != Local)
 			continue;
-		QJsonObject entryObj;
-
-		entryObj.insert("id", mcversion->descriptor());
-		entryObj.insert("time", mcversion->m_updateTimeString);
-		entryObj.insert("releaseTime", mcversion->m_releaseTimeString);
-		entryObj.insert("type", mcversion->m_type);
-		entriesArr.append(entryObj);
-	}
-	toplevel.insert("versions", entriesArr);
-	
-	{
-		bool someLatest = false;
-		QJsonObject latestObj;
-		if(!m_latestReleaseID.isNull())
-		{
-			latestObj.insert("release", m_latestReleaseID);
-			someLatest = true;
-		}
-		if(!m_latestSnapshotID.isNull())
-		{
-			latestObj.insert("snapshot", m_latestSnapshotID);
-			someLatest = true;
-		}
-		if(someLatest)
-		{
-			toplevel.insert("latest", latestObj);
-		}
+		pool.appendRef(records, mcversion->descriptor());
+		pool.appendRef(records, mcversion->m_type);
+		pool.appendRef(records, mcversion->m_releaseTimeString);
+		pool.appendRef(records, mcversion->m_updateTimeString);
+		appendLE<qint64>(records, entry.releaseTime);
+		count++;
 	}
-	
-	QJsonDocument doc(toplevel);
-	QByteArray jsonData = doc.toBinaryData();
-	qint64 result = tfile.write(jsonData);
-	if (result == -1)
+
+	QByteArray header(cacheMagic, 4);
+	appendLE<quint32>(header, cacheFormat);
+	appendLE<quint32>(header, count);
+	QByteArray latest;
+	pool.appendRef(latest, m_latestReleaseID);
+	pool.appendRef(latest, m_latestSnapshotID);
+	appendLE<quint32>(header, pool.data().size());
+	header.append(latest);
+
+	QSaveFile tfile(localVersionCache);
+	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
 		return;
-	if (result != jsonData.size())
+	if (tfile.write(header) != header.size() || tfile.write(records) != records.size() ||
+		tfile.write(pool.data()) != pool.data().size())
+	{
+		tfile.cancelWriting();
 		return;
+	}
 	tfile.commit();
 }
 
 void MinecraftVersionList::finalizeUpdate(QString version)
 {
-	int idx = -1;
-	for (int i = 0; i < m_vlist.size(); i++)
-	{
-		if (version == m_vlist[i]->descriptor())
-		{
-			idx = i;
-			break;
-		}
-	}
+	int idx = indexOf(version);
 	if (idx == -1)
 	{
 		return;
 	}
 
-	auto updatedVersion = std::dynamic_pointer_cast<MinecraftVersion>(m_vlist[idx]);
+	auto updatedVersion = std::dynamic_pointer_cast<MinecraftVersion>(materialize(idx));
 
 	// reject any updates to builtin versions.
 	if (updatedVersion->m_versionSource == Builtin)
@@ -580,8 +813,7 @@ void MinecraftVersionList::finalizeUpdate(QString version)
 	{
 		auto updatedWith = updatedVersion->upstreamUpdate;
 		updatedWith->m_versionSource = Local;
-		m_vlist[idx] = updatedWith;
-		m_lookup[version] = updatedWith;
+		m_vlist[idx].version = updatedWith;
 	}
 	else
 	{
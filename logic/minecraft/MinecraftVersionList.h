@@ -18,6 +18,7 @@
 #include <QObject>
 #include <QList>
 #include <QSet>
+#include <QFile>
 
 #include "logic/BaseVersionList.h"
 #include "logic/tasks/Task.h"
@@ -36,6 +37,9 @@ private:
 	void loadBuiltinList();
 	void loadMojangList(QJsonDocument jsonDoc, VersionSource source);
 	void loadCachedList();
+	bool readCacheIndex();
+	void loadLegacyCachedList();
+	void releaseCache();
 	void saveCachedList();
 	void finalizeUpdate(QString version);
 public:
@@ -52,11 +56,37 @@ public:
 	virtual int count() const;
 	virtual void sort();
 
+	virtual BaseVersionPtr findVersion(const QString &descriptor) override;
 	virtual BaseVersionPtr getLatestStable() const;
+	BaseVersionPtr getLatestSnapshot() const;
 
 protected:
-	QList<BaseVersionPtr> m_vlist;
-	QMap<QString, BaseVersionPtr> m_lookup;
+	/**
+	 * A row of the list. Versions from the local cache only get a MinecraftVersion object
+	 * when something asks for them, until then they are just a record in the mapped file.
+	 */
+	struct Entry
+	{
+		QString descriptor;
+		/// release time in ms since epoch, for sorting without creating the version
+		qint64 releaseTime = 0;
+		/// index of the record in the version cache, or -1
+		int cacheRecord = -1;
+		BaseVersionPtr version;
+	};
+	int indexOf(const QString &descriptor) const;
+	BaseVersionPtr materialize(int i) const;
+	QString cacheString(const uchar *ref) const;
+
+	mutable QList<Entry> m_vlist;
+	/// descriptor -> row in m_vlist. when rows move, it is rebuilt by the next indexOf
+	mutable QHash<QString, int> m_rows;
+	mutable bool m_rowsStale = false;
+
+	/// the mapped version cache. see MinecraftVersionList.cpp for the layout
+	QFile m_cacheFile;
+	const uchar *m_cacheData = nullptr;
+	qint64 m_cacheSize = 0;
 
 	bool m_loaded = false;
 	bool m_hasLocalIndex = false;
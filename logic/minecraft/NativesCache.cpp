@@ -0,0 +1,320 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MultiMC.h"
+#include "NativesCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+#include <quazip.h>
+#include <quazipfile.h>
+#include <JlCompress.h>
+#include <pathutils.h>
+
+#include "logic/minecraft/OneSixLibrary.h"
+#include "logic/minecraft/LaunchPlan.h"
+#include "logic/net/HttpMetaCache.h"
+#include "logger/QsLog.h"
+
+namespace
+{
+// bump this when the way natives are extracted changes, so old folders aren't reused
+const QString cacheFormat = "1";
+const QString archToken = "${arch}";
+// folders younger than this are left alone by collectGarbage, an update may be using them
+const qint64 garbageGraceSecs = 24 * 60 * 60;
+
+QDir nativesRoot()
+{
+	return QDir::current().absoluteFilePath("natives");
+}
+
+/// the architectures a native library has to be extracted for. empty string means 'any'.
+QStringList architectures(const QList<std::shared_ptr<OneSixLibrary>> &natives)
+{
+	for (auto native : natives)
+	{
+		if (native->storagePath().contains(archToken))
+			return {"32", "64"};
+	}
+	return {""};
+}
+
+QString cookedStoragePath(std::shared_ptr<OneSixLibrary> native, const QString &arch)
+{
+	QString storage = native->storagePath();
+	if (!arch.isEmpty())
+		storage.replace(archToken, arch);
+	return storage;
+}
+
+/// MD5 of a native jar. Takes it from the metacache when the jar was downloaded by us.
+QString contentHash(const QString &storage, const QDir &libraries)
+{
+	auto entry = MMC->metacache()->resolveEntry("libraries", storage);
+	if (!entry->stale && !entry->md5sum.isEmpty())
+		return entry->md5sum;
+
+	QFile input(libraries.absoluteFilePath(storage));
+	if (!input.open(QIODevice::ReadOnly))
+		return QString();
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	if (!hash.addData(&input))
+		return QString();
+	return hash.result().toHex();
+}
+
+/// Name of the cache folder for the set, or an empty string if some jar is missing.
+QString cacheKey(const QList<std::shared_ptr<OneSixLibrary>> &natives, const QDir &libraries,
+				 QString &error)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(QString("format %1\n").arg(cacheFormat).toUtf8());
+	hash.addData(QString("platform %1\n").arg(OpSys_toString(currentSystem)).toUtf8());
+	for (auto native : natives)
+	{
+		QStringList arches = native->storagePath().contains(archToken)
+								 ? QStringList({"32", "64"})
+								 : QStringList({""});
+		for (auto arch : arches)
+		{
+			QString storage = cookedStoragePath(native, arch);
+			QString md5 = contentHash(storage, libraries);
+			if (md5.isEmpty())
+			{
+				error = QObject::tr("Native library %1 is missing.").arg(storage);
+				return QString();
+			}
+			hash.addData(QString("jar %1 %2\n").arg(storage, md5).toUtf8());
+		}
+		for (auto exclude : native->extract_excludes)
+		{
+			hash.addData(QString("exclude %1\n").arg(exclude).toUtf8());
+		}
+	}
+	return hash.result().toHex();
+}
+
+bool isExcluded(const QString &name, const QStringList &excludes)
+{
+	for (auto exclude : excludes)
+	{
+		if (name.startsWith(exclude))
+			return true;
+	}
+	return false;
+}
+
+/// LWJGL on OSX looks for either .dylib or .jnilib, so we always provide both.
+void linkOSXVariant(const QDir &target, const QString &name)
+{
+	QString other;
+	if (name.endsWith(".dylib"))
+		other = name.left(name.size() - 6) + ".jnilib";
+	else if (name.endsWith(".jnilib"))
+		other = name.left(name.size() - 7) + ".dylib";
+	else
+		return;
+
+	QString linkPath = target.absoluteFilePath(other);
+	if (QFileInfo(linkPath).exists())
+		return;
+	// relative, so it survives moving the folder into place
+	QFile::link(QFileInfo(name).fileName(), linkPath);
+}
+
+bool unzipNatives(const QString &jar, const QDir &target, const QStringList &excludes,
+				  QString &error)
+{
+	QuaZip zip(jar);
+	if (!zip.open(QuaZip::mdUnzip))
+	{
+		error = QObject::tr("Native library %1 is not a valid archive.").arg(jar);
+		return false;
+	}
+
+	QString targetRoot = target.absolutePath() + "/";
+	QStringList extracted;
+	QuaZipFile file(&zip);
+	for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+	{
+		QString name = zip.getCurrentFileName();
+		if (name.endsWith('/') || isExcluded(name, excludes))
+			continue;
+
+		QString targetPath = QDir::cleanPath(target.absoluteFilePath(name));
+		if (!targetPath.startsWith(targetRoot))
+		{
+			QLOG_WARN() << "Skipping" << name << "from" << jar << "- it points outside the natives folder";
+			continue;
+		}
+		if (!ensureFilePathExists(targetPath))
+		{
+			error = QObject::tr("Failed to create folder for %1.").arg(targetPath);
+			return false;
+		}
+		QFile output(targetPath);
+		if (!file.open(QIODevice::ReadOnly) || !output.open(QIODevice::WriteOnly))
+		{
+			file.close();
+			error = QObject::tr("Failed to extract %1 from %2.").arg(name, jar);
+			return false;
+		}
+		bool copied = JlCompress::copyData(file, output);
+		file.close();
+		output.close();
+		if (!copied)
+		{
+			error = QObject::tr("Failed to extract %1 from %2.").arg(name, jar);
+			return false;
+		}
+		extracted.append(name);
+	}
+	zip.close();
+
+	for (auto name : extracted)
+	{
+		linkOSXVariant(target, name);
+	}
+	return true;
+}
+
+bool extractFolder(const QString &folder, const QList<NativesCache::Jar> &jars, QString &error)
+{
+	if (QDir(folder).exists())
+		return true;
+
+	if (!ensureFolderPathExists(nativesRoot().absolutePath()))
+	{
+		error = QObject::tr("Failed to create the natives folder.");
+		return false;
+	}
+
+	// extract next to the final location, so the rename below is cheap and all-or-nothing
+	QTemporaryDir staging(folder + "-XXXXXX");
+	if (!staging.isValid())
+	{
+		error = QObject::tr("Failed to create a temporary folder for natives.");
+		return false;
+	}
+
+	for (auto &jar : jars)
+	{
+		QLOG_INFO() << "Extracting" << jar.path;
+		if (!unzipNatives(jar.path, QDir(staging.path()), jar.excludes, error))
+			return false;
+	}
+
+	if (!QDir().rename(staging.path(), folder))
+	{
+		// another update could have beaten us to it. that's fine, it has the same content.
+		if (QDir(folder).exists())
+			return true;
+		error = QObject::tr("Failed to move extracted natives to %1.").arg(folder);
+		return false;
+	}
+	staging.setAutoRemove(false);
+	return true;
+}
+}
+
+NativesCache::Extraction
+NativesCache::prepare(const QList<std::shared_ptr<OneSixLibrary>> &natives, const QDir &libraries,
+					  QString &error)
+{
+	Extraction extraction;
+	QString key = cacheKey(natives, libraries, error);
+	if (key.isEmpty())
+		return extraction;
+
+	QString base = nativesRoot().absoluteFilePath(key);
+	QStringList arches = architectures(natives);
+	for (auto arch : arches)
+	{
+		QString folder = arch.isEmpty() ? base : base + "-" + arch;
+		if (QDir(folder).exists())
+			continue;
+		QList<Jar> jars;
+		for (auto native : natives)
+		{
+			// applyExcludes isn't carried over to OneSixLibrary, the excludes are all we have
+			jars.append({libraries.absoluteFilePath(cookedStoragePath(native, arch)),
+						 native->extract_excludes});
+		}
+		extraction.folders.append(qMakePair(folder, jars));
+	}
+	extraction.path = arches.first().isEmpty() ? base : base + "-" + archToken;
+	return extraction;
+}
+
+bool NativesCache::perform(const Extraction &extraction, QString &error)
+{
+	for (auto &folder : extraction.folders)
+	{
+		if (!extractFolder(folder.first, folder.second, error))
+			return false;
+	}
+	return true;
+}
+
+QString NativesCache::extract(const QList<std::shared_ptr<OneSixLibrary>> &natives,
+							  const QDir &libraries, QString &error)
+{
+	auto extraction = prepare(natives, libraries, error);
+	if (extraction.path.isEmpty() || !perform(extraction, error))
+		return QString();
+	return extraction.path;
+}
+
+void NativesCache::collectGarbage(const QString &instancesDir)
+{
+	QDir root = nativesRoot();
+	if (!root.exists())
+		return;
+
+	// the folders the stored launch plans point at
+	QSet<QString> used;
+	QDir instances(instancesDir);
+	for (auto instance : instances.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		QString plan = PathCombine(instances.absoluteFilePath(instance), "launch.plan");
+		QString natives = LaunchPlan::storedNatives(plan);
+		if (natives.isEmpty())
+			continue;
+		if (natives.contains(archToken))
+		{
+			used.insert(QFileInfo(QString(natives).replace(archToken, "32")).fileName());
+			used.insert(QFileInfo(QString(natives).replace(archToken, "64")).fileName());
+		}
+		else
+		{
+			used.insert(QFileInfo(natives).fileName());
+		}
+	}
+
+	QDateTime cutoff = QDateTime::currentDateTime().addSecs(-garbageGraceSecs);
+	for (auto info : root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		if (used.contains(info.fileName()) || info.lastModified() > cutoff)
+			continue;
+		QLOG_INFO() << "Removing unused natives folder" << info.fileName();
+		if (!QDir(info.absoluteFilePath()).removeRecursively())
+			QLOG_WARN() << "Couldn't remove" << info.absoluteFilePath();
+	}
+}
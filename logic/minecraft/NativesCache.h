@@ -0,0 +1,79 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include <QDir>
+#include <memory>
+
+class OneSixLibrary;
+
+/**
+ * Extracted native libraries, shared by all instances.
+ *
+ * Every set of native jars gets its own folder inside 'natives/', named after a hash of the
+ * platform, the jar contents and the extract rules. A folder is only ever created complete
+ * (extracted elsewhere and renamed into place), so if it's there, it's ready to use.
+ *
+ * Native jars with '${arch}' in their path get one folder per architecture. The path given to
+ * the launcher then contains '${arch}' too, because only the launched JVM knows which one it is.
+ */
+namespace NativesCache
+{
+struct Jar
+{
+	QString path;
+	QStringList excludes;
+};
+
+/// What extract() does, worked out ahead of time by prepare().
+struct Extraction
+{
+	/// the natives folder, like extract() returns it
+	QString path;
+	/// the folders that aren't there yet and the jars that go into each of them
+	QList<QPair<QString, QList<Jar>>> folders;
+};
+
+/**
+ * Extract the native libraries, unless that has been done already.
+ *
+ * Returns the absolute path of the natives folder (with '${arch}' in it, if the natives are
+ * architecture specific), or an empty string and an explanation in 'error' on failure.
+ */
+QString extract(const QList<std::shared_ptr<OneSixLibrary>> &natives, const QDir &libraries,
+				QString &error);
+
+/**
+ * The part of extract() that asks the metacache, so it has to run on the main thread.
+ * The path is empty on failure.
+ */
+Extraction prepare(const QList<std::shared_ptr<OneSixLibrary>> &natives,
+				   const QDir &libraries, QString &error);
+
+/// The rest of extract(). Only touches files, so it can run on any thread.
+bool perform(const Extraction &extraction, QString &error);
+
+/**
+ * Remove the folders no launch plan of the instances in 'instancesDir' uses anymore.
+ * Recently made folders are kept, so it doesn't pull them from under a running update.
+ * Only touches files, so it can run on any thread.
+ */
+void collectGarbage(const QString &instancesDir);
+}
@@ -45,6 +45,10 @@ public:
 	}
 	virtual ~Rule() {};
 	virtual QJsonObject toJson() = 0;
+	RuleAction result() const
+	{
+		return m_result;
+	}
 	RuleAction apply(const RawLibrary *parent)
 	{
 		if (applies(parent))
@@ -74,6 +78,14 @@ protected:
 
 public:
 	virtual QJsonObject toJson();
+	OpSys system() const
+	{
+		return m_system;
+	}
+	QString versionRegexp() const
+	{
+		return m_version_regexp;
+	}
 	static std::shared_ptr<OsRule> create(RuleAction result, OpSys system,
 										  QString version_regexp)
 	{
@@ -2,6 +2,7 @@
 using namespace MMCJson;
 
 #include "RawLibrary.h"
+#include "StringTable.h"
 
 RawLibraryPtr RawLibrary::fromJson(const QJsonObject &libObj, const QString &filename)
 {
@@ -13,7 +14,8 @@ RawLibraryPtr RawLibrary::fromJson(const QJsonObject &libObj, const QString &fil
 	}
 	out->m_name = libObj.value("name").toString();
 
-	auto readString = [libObj, filename](const QString & key, QString & variable) -> bool
+	auto readString = [libObj, filename](const QString & key, QString & variable,
+										 bool repetitive) -> bool
 	{
 		if (!libObj.contains(key))
 			return false;
@@ -25,14 +27,19 @@ RawLibraryPtr RawLibrary::fromJson(const QJsonObject &libObj, const QString &fil
 			return false;
 		}
 
-		variable = val.toString();
+		// the same few base URLs and hints are used by almost every library
+		if (repetitive)
+			variable = StringTable::shared(val.toString());
+		else
+			variable = val.toString();
 		return true;
 	};
 
-	readString("url", out->m_base_url);
-	readString("MMC-hint", out->m_hint);
-	readString("MMC-absulute_url", out->m_absolute_url);
-	readString("MMC-absoluteUrl", out->m_absolute_url);
+	readString("url", out->m_base_url, true);
+	readString("MMC-hint", out->m_hint, true);
+	// these are different for every library, interning them would only grow the table
+	readString("MMC-absulute_url", out->m_absolute_url, false);
+	readString("MMC-absoluteUrl", out->m_absolute_url, false);
 	if (libObj.contains("extract"))
 	{
 		out->applyExcludes = true;
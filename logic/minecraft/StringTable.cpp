@@ -0,0 +1,71 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StringTable.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace
+{
+struct Table
+{
+	QReadWriteLock lock;
+	/// the values are allocated once and never freed, handles point at them
+	QHash<QString, const QString *> handles;
+	const QString emptyString;
+};
+
+Table &table()
+{
+	static Table instance;
+	return instance;
+}
+}
+
+StringTable::Handle StringTable::empty()
+{
+	return &table().emptyString;
+}
+
+StringTable::Handle StringTable::intern(const QString &value)
+{
+	auto &t = table();
+	if (value.isEmpty())
+		return &t.emptyString;
+	{
+		QReadLocker locker(&t.lock);
+		auto found = t.handles.constFind(value);
+		if (found != t.handles.constEnd())
+			return *found;
+	}
+	QWriteLocker locker(&t.lock);
+	// someone else could have added it between the locks
+	auto found = t.handles.constFind(value);
+	if (found != t.handles.constEnd())
+		return *found;
+	auto handle = new QString(value);
+	t.handles.insert(value, handle);
+	return handle;
+}
+
+QString StringTable::shared(const QString &value)
+{
+	if (value.isEmpty())
+		return value;
+	return *intern(value);
+}
@@ -0,0 +1,45 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+
+/**
+ * Process-wide table of interned strings.
+ *
+ * Library coordinates, URLs and hints repeat across every version file of every instance.
+ * Interning them means every distinct string is stored once, and interned strings can be
+ * compared and hashed by their handle.
+ *
+ * A handle points at the table's copy of the string. That copy never changes or goes away,
+ * so reading through a handle needs no locking. Only interning takes a lock.
+ *
+ * Entries are never removed, so only use this for strings from a small, repetitive set.
+ * Safe to use from any thread.
+ */
+namespace StringTable
+{
+typedef const QString *Handle;
+
+/// handle of the empty string
+Handle empty();
+
+/// Get the handle of a string, adding it to the table if needed.
+Handle intern(const QString &value);
+
+/// Get the table's copy of a string. It shares its data with all the other copies.
+QString shared(const QString &value);
+}
@@ -31,6 +31,7 @@
 #include "logic/minecraft/OneSixRule.h"
 #include "logic/minecraft/VersionPatch.h"
 #include "logic/minecraft/VersionFile.h"
+#include "logic/minecraft/VersionFileCache.h"
 #include "VersionBuildError.h"
 #include "MinecraftVersionList.h"
 
@@ -252,16 +253,25 @@ VersionFilePtr VersionBuilder::parseJsonFile(const QFileInfo &fileInfo, const bo
 		throw JSONValidationError(QObject::tr("Unable to open the version file %1: %2.")
 									  .arg(fileInfo.fileName(), file.errorString()));
 	}
-	QJsonParseError error;
-	QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
-	if (error.error != QJsonParseError::NoError)
+	auto mode = VersionFileCache::Json;
+	if (isFTB)
+		mode = VersionFileCache::JsonFTB;
+	else if (requireOrder)
+		mode = VersionFileCache::JsonRequireOrder;
+	QByteArray data = file.readAll();
+	return VersionFileCache::get(data, mode, file.fileName(), [&]()
 	{
-		throw JSONValidationError(
-			QObject::tr("Unable to process the version file %1: %2 at %3.")
-				.arg(fileInfo.fileName(), error.errorString())
-				.arg(error.offset));
-	}
-	return VersionFile::fromJson(doc, file.fileName(), requireOrder, isFTB);
+		QJsonParseError error;
+		QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+		if (error.error != QJsonParseError::NoError)
+		{
+			throw JSONValidationError(
+				QObject::tr("Unable to process the version file %1: %2 at %3.")
+					.arg(fileInfo.fileName(), error.errorString())
+					.arg(error.offset));
+		}
+		return VersionFile::fromJson(doc, file.fileName(), requireOrder, isFTB);
+	});
 }
 
 VersionFilePtr VersionBuilder::parseBinaryJsonFile(const QFileInfo &fileInfo)
@@ -272,15 +282,19 @@ VersionFilePtr VersionBuilder::parseBinaryJsonFile(const QFileInfo &fileInfo)
 		throw JSONValidationError(QObject::tr("Unable to open the version file %1: %2.")
 									  .arg(fileInfo.fileName(), file.errorString()));
 	}
-	QJsonDocument doc = QJsonDocument::fromBinaryData(file.readAll());
+	QByteArray data = file.readAll();
 	file.close();
-	if (doc.isNull())
+	return VersionFileCache::get(data, VersionFileCache::BinaryJson, file.fileName(), [&]()
 	{
-		file.remove();
-		throw JSONValidationError(
-			QObject::tr("Unable to process the version file %1.").arg(fileInfo.fileName()));
-	}
-	return VersionFile::fromJson(doc, file.fileName(), false, false);
+		QJsonDocument doc = QJsonDocument::fromBinaryData(data);
+		if (doc.isNull())
+		{
+			file.remove();
+			throw JSONValidationError(
+				QObject::tr("Unable to process the version file %1.").arg(fileInfo.fileName()));
+		}
+		return VersionFile::fromJson(doc, file.fileName(), false, false);
+	});
 }
 
 static const int currentOrderFileVersion = 1;
@@ -383,7 +383,9 @@ void VersionFile::applyTo(InstanceVersion *version)
 			int index = findLibraryByName(version->libraries, addedLibrary->rawName());
 			if (index >= 0)
 			{
-				auto existingLibrary = version->libraries[index];
+				// the library may be shared with the layers below this one, change a copy
+				auto existingLibrary = std::make_shared<OneSixLibrary>(*version->libraries[index]);
+				version->libraries.replace(index, existingLibrary);
 				if (!addedLibrary->m_base_url.isNull())
 				{
 					existingLibrary->setBaseUrl(addedLibrary->m_base_url);
@@ -0,0 +1,64 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VersionFileCache.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+
+namespace
+{
+// the cost of an entry is the size of the file it came from. This is plenty for hundreds of
+// distinct versions and keeps edited files from piling up forever.
+const int maxCacheCost = 32 * 1024 * 1024;
+
+QMutex cacheMutex;
+QCache<QByteArray, VersionFile> cache(maxCacheCost);
+
+QByteArray cacheKey(const QByteArray &data, VersionFileCache::ParseMode mode)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(data);
+	return hash.result() + char(mode);
+}
+}
+
+VersionFilePtr VersionFileCache::get(const QByteArray &data, ParseMode mode,
+									 const QString &filename,
+									 std::function<VersionFilePtr()> parse)
+{
+	QByteArray key = cacheKey(data, mode);
+	{
+		QMutexLocker locker(&cacheMutex);
+		VersionFile *cached = cache.object(key);
+		if (cached)
+		{
+			auto copy = std::make_shared<VersionFile>(*cached);
+			copy->filename = filename;
+			return copy;
+		}
+	}
+
+	// parse outside the lock. if two threads race here, both results are equal anyway.
+	VersionFilePtr parsed = parse();
+	{
+		QMutexLocker locker(&cacheMutex);
+		cache.insert(key, new VersionFile(*parsed), qMax(data.size(), 1));
+	}
+	parsed->filename = filename;
+	return parsed;
+}
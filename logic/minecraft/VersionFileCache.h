@@ -0,0 +1,58 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+#include "VersionFile.h"
+
+/**
+ * Parsed version files, shared by all instances and keyed by the content of the file.
+ *
+ * Many instances use the same Minecraft, Forge or LiteLoader json files. Those are parsed once,
+ * and every instance gets its own shallow copy of the parsed file. The copy shares the strings,
+ * lists and libraries of the cached one (Qt containers are copy-on-write), so an instance can
+ * still change things like the order, name or filename of its patch without affecting others.
+ * The libraries themselves are never modified after parsing - applying a patch creates new
+ * OneSixLibrary objects.
+ *
+ * Safe to use from any thread.
+ */
+namespace VersionFileCache
+{
+/// how the file was parsed - the same content parsed differently is a different entry
+enum ParseMode
+{
+	Json,
+	JsonRequireOrder,
+	JsonFTB,
+	BinaryJson,
+	/// a patch as stored in a version snapshot
+	Snapshot,
+	/// the built libraries of a version snapshot, as the addLibs of an otherwise empty file
+	SnapshotLibraries
+};
+
+/**
+ * Get a private copy of the version file with 'data' as its content, calling 'parse' to
+ * create it if it isn't cached yet. Exceptions thrown by 'parse' are passed on.
+ *
+ * 'filename' is set on the copy, as it is different for each instance.
+ */
+VersionFilePtr get(const QByteArray &data, ParseMode mode, const QString &filename,
+				   std::function<VersionFilePtr()> parse);
+}
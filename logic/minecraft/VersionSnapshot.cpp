@@ -0,0 +1,450 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MultiMC.h"
+#include "BuildConfig.h"
+#include "VersionSnapshot.h"
+
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <pathutils.h>
+
+#include "logic/minecraft/InstanceVersion.h"
+#include "logic/minecraft/MinecraftVersion.h"
+#include "logic/minecraft/MinecraftVersionList.h"
+#include "logic/minecraft/VersionFile.h"
+#include "logic/minecraft/VersionFileCache.h"
+#include "logic/minecraft/VersionBuildError.h"
+#include "logic/minecraft/OneSixRule.h"
+#include "logic/OneSixInstance.h"
+#include "logger/QsLog.h"
+
+namespace
+{
+// bump this when anything about the stored data or the way versions are built changes
+const quint32 snapshotMagic = 0x4d4d4356; // "MMCV"
+const quint32 snapshotFormat = 3;
+
+enum PatchKind
+{
+	Patch_File,
+	Patch_Minecraft
+};
+
+QString snapshotPath(OneSixInstance *instance)
+{
+	return PathCombine(instance->instanceRoot(), "version.snapshot");
+}
+
+void hashFile(QCryptographicHash &hash, const QString &path)
+{
+	QFile input(path);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		hash.addData(QString("missing %1\n").arg(path).toUtf8());
+		return;
+	}
+	hash.addData(QString("file %1 %2\n").arg(path).arg(input.size()).toUtf8());
+	hash.addData(input.readAll());
+}
+
+std::shared_ptr<MinecraftVersion> findMinecraftVersion(OneSixInstance *instance)
+{
+	auto version = MMC->minecraftlist()->findVersion(instance->intendedVersionId());
+	return std::dynamic_pointer_cast<MinecraftVersion>(version);
+}
+
+enum RuleKind
+{
+	Rule_Implicit,
+	Rule_Os
+};
+
+void writeRules(QDataStream &out, const QList<std::shared_ptr<Rule>> &rules)
+{
+	out << quint32(rules.size());
+	for (auto rule : rules)
+	{
+		auto osRule = std::dynamic_pointer_cast<OsRule>(rule);
+		out << qint32(osRule ? Rule_Os : Rule_Implicit) << qint32(rule->result());
+		if (osRule)
+		{
+			out << qint32(osRule->system()) << osRule->versionRegexp();
+		}
+	}
+}
+
+QList<std::shared_ptr<Rule>> readRules(QDataStream &in)
+{
+	QList<std::shared_ptr<Rule>> rules;
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		qint32 kind, action;
+		in >> kind >> action;
+		if (kind == Rule_Os)
+		{
+			qint32 system;
+			QString versionRegexp;
+			in >> system >> versionRegexp;
+			rules.append(OsRule::create(RuleAction(action), OpSys(system), versionRegexp));
+		}
+		else
+		{
+			rules.append(ImplicitRule::create(RuleAction(action)));
+		}
+	}
+	return rules;
+}
+
+void writeLibrary(QDataStream &out, const RawLibraryPtr &lib)
+{
+	out << QString(lib->rawName()) << lib->m_base_url << lib->m_absolute_url << lib->m_hint;
+	out << lib->applyExcludes << lib->extract_excludes;
+	out << quint32(lib->m_native_classifiers.size());
+	for (auto iter = lib->m_native_classifiers.begin(); iter != lib->m_native_classifiers.end();
+		 iter++)
+	{
+		out << qint32(iter.key()) << iter.value();
+	}
+	out << lib->applyRules;
+	writeRules(out, lib->m_rules);
+	out << qint32(lib->insertType) << lib->insertData << qint32(lib->dependType);
+}
+
+void readLibrary(QDataStream &in, RawLibrary &lib)
+{
+	QString name;
+	in >> name >> lib.m_base_url >> lib.m_absolute_url >> lib.m_hint;
+	lib.setRawName(name);
+	in >> lib.applyExcludes >> lib.extract_excludes;
+	quint32 natives = 0;
+	in >> natives;
+	for (quint32 i = 0; i < natives && in.status() == QDataStream::Ok; i++)
+	{
+		qint32 system;
+		QString classifier;
+		in >> system >> classifier;
+		lib.m_native_classifiers[OpSys(system)] = classifier;
+	}
+	in >> lib.applyRules;
+	lib.m_rules = readRules(in);
+	qint32 insertType, dependType;
+	in >> insertType >> lib.insertData >> dependType;
+	lib.insertType = RawLibrary::InsertType(insertType);
+	lib.dependType = RawLibrary::DependType(dependType);
+}
+
+template <typename T> void writeLibraries(QDataStream &out, const QList<T> &libs)
+{
+	out << quint32(libs.size());
+	for (auto lib : libs)
+	{
+		writeLibrary(out, lib);
+	}
+}
+
+QList<RawLibraryPtr> readRawLibraries(QDataStream &in)
+{
+	QList<RawLibraryPtr> libs;
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		auto lib = std::make_shared<RawLibrary>();
+		readLibrary(in, *lib);
+		libs.append(lib);
+	}
+	return libs;
+}
+
+void writeJarMods(QDataStream &out, const QList<JarmodPtr> &jarMods)
+{
+	out << quint32(jarMods.size());
+	for (auto jarMod : jarMods)
+	{
+		out << jarMod->name << jarMod->baseurl << jarMod->hint << jarMod->absoluteUrl;
+	}
+}
+
+QList<JarmodPtr> readJarMods(QDataStream &in)
+{
+	QList<JarmodPtr> jarMods;
+	quint32 count = 0;
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+	{
+		auto jarMod = std::make_shared<Jarmod>();
+		in >> jarMod->name >> jarMod->baseurl >> jarMod->hint >> jarMod->absoluteUrl;
+		jarMods.append(jarMod);
+	}
+	return jarMods;
+}
+
+QByteArray versionFileData(const VersionFilePtr &file)
+{
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_0);
+	// no filename or order, so the same patch in different instances is the same data
+	out << file->isVanilla << file->name << file->fileId << file->version
+		<< file->mcVersion << file->id << file->mainClass << file->appletClass
+		<< file->overwriteMinecraftArguments << file->addMinecraftArguments
+		<< file->removeMinecraftArguments << file->processArguments << file->type
+		<< file->m_releaseTimeString << file->m_releaseTime << file->m_updateTimeString
+		<< file->m_updateTime << file->assets << qint32(file->minimumLauncherVersion)
+		<< file->shouldOverwriteTweakers << file->overwriteTweakers << file->addTweakers
+		<< file->removeTweakers << file->shouldOverwriteLibs;
+	writeLibraries(out, file->overwriteLibs);
+	writeLibraries(out, file->addLibs);
+	out << file->removeLibs << file->traits;
+	writeJarMods(out, file->jarMods);
+	return data;
+}
+
+VersionFilePtr parseVersionFile(const QByteArray &data)
+{
+	QDataStream in(data);
+	in.setVersion(QDataStream::Qt_5_0);
+	auto file = std::make_shared<VersionFile>();
+	qint32 minimumLauncherVersion;
+	in >> file->isVanilla >> file->name >> file->fileId >> file->version >>
+		file->mcVersion >> file->id >> file->mainClass >> file->appletClass >>
+		file->overwriteMinecraftArguments >> file->addMinecraftArguments >>
+		file->removeMinecraftArguments >> file->processArguments >> file->type >>
+		file->m_releaseTimeString >> file->m_releaseTime >> file->m_updateTimeString >>
+		file->m_updateTime >> file->assets >> minimumLauncherVersion >>
+		file->shouldOverwriteTweakers >> file->overwriteTweakers >> file->addTweakers >>
+		file->removeTweakers >> file->shouldOverwriteLibs;
+	file->minimumLauncherVersion = minimumLauncherVersion;
+	file->overwriteLibs = readRawLibraries(in);
+	file->addLibs = readRawLibraries(in);
+	in >> file->removeLibs >> file->traits;
+	file->jarMods = readJarMods(in);
+	if (in.status() != QDataStream::Ok)
+		throw VersionBuildError(QObject::tr("Damaged version snapshot."));
+	return file;
+}
+
+/// the patch from the snapshot, shared with every other instance that has the same one
+VersionFilePtr readVersionFile(QDataStream &in)
+{
+	QString filename;
+	QByteArray data;
+	in >> filename >> data;
+	return VersionFileCache::get(data, VersionFileCache::Snapshot, filename, [&]()
+	{ return parseVersionFile(data); });
+}
+
+QByteArray librariesData(const QList<OneSixLibraryPtr> &libs)
+{
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_0);
+	writeLibraries(out, libs);
+	return data;
+}
+
+/**
+ * The built libraries from the snapshot. Like the libraries of the patches, they are shared
+ * with every other instance that has the same ones. Applying patches never changes a library
+ * in place, so that's safe.
+ */
+QList<OneSixLibraryPtr> readLibraries(QDataStream &in)
+{
+	QByteArray data;
+	in >> data;
+	auto file = VersionFileCache::get(data, VersionFileCache::SnapshotLibraries, QString(), [&]()
+	{
+		QDataStream libsIn(data);
+		libsIn.setVersion(QDataStream::Qt_5_0);
+		auto file = std::make_shared<VersionFile>();
+		quint32 count = 0;
+		libsIn >> count;
+		for (quint32 i = 0; i < count && libsIn.status() == QDataStream::Ok; i++)
+		{
+			auto lib = std::make_shared<OneSixLibrary>(QString());
+			readLibrary(libsIn, *lib);
+			file->addLibs.append(lib);
+		}
+		if (libsIn.status() != QDataStream::Ok)
+			throw VersionBuildError(QObject::tr("Damaged version snapshot."));
+		return file;
+	});
+	QList<OneSixLibraryPtr> libs;
+	for (auto lib : file->addLibs)
+	{
+		libs.append(std::static_pointer_cast<OneSixLibrary>(lib));
+	}
+	return libs;
+}
+}
+
+QString VersionSnapshot::key(OneSixInstance *instance, const QStringList &external)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(QString("format %1\n").arg(snapshotFormat).toUtf8());
+	// the builtin LWJGL patch and the rules for applying patches come with MultiMC
+	hash.addData(QString("build %1\n").arg(BuildConfig.GIT_COMMIT).toUtf8());
+	hash.addData(QString("intended %1\n").arg(instance->intendedVersionId()).toUtf8());
+	for (auto patch : external)
+	{
+		hashFile(hash, patch);
+	}
+
+	QDir root(instance->instanceRoot());
+	hashFile(hash, root.absoluteFilePath("custom.json"));
+	hashFile(hash, root.absoluteFilePath("version.json"));
+	hashFile(hash, root.absoluteFilePath("order.json"));
+	QDir patches(root.absoluteFilePath("patches/"));
+	for (auto info : patches.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Name))
+	{
+		hashFile(hash, info.absoluteFilePath());
+	}
+
+	auto minecraft = findMinecraftVersion(instance);
+	if (minecraft)
+	{
+		hash.addData(QString("minecraft %1\n").arg(int(minecraft->m_versionSource)).toUtf8());
+		if (minecraft->m_versionSource == Local)
+		{
+			hashFile(hash, QString("versions/%1/%1.dat").arg(minecraft->descriptor()));
+		}
+	}
+	return hash.result().toHex();
+}
+
+bool VersionSnapshot::load(InstanceVersion *version, OneSixInstance *instance,
+						   const QString &key)
+{
+	QFile input(snapshotPath(instance));
+	if (!input.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&input);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic = 0, format = 0;
+	QString storedKey;
+	in >> magic >> format >> storedKey;
+	if (magic != snapshotMagic || format != snapshotFormat || storedKey != key)
+		return false;
+
+	QList<VersionPatchPtr> patches;
+	version->clear();
+	try
+	{
+		quint32 count = 0;
+		in >> count;
+		for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++)
+		{
+			qint32 kind, order;
+			in >> kind >> order;
+			if (kind == Patch_Minecraft)
+			{
+				auto minecraft = findMinecraftVersion(instance);
+				if (!minecraft)
+					return false;
+				minecraft->setOrder(order);
+				patches.append(minecraft);
+			}
+			else
+			{
+				auto file = readVersionFile(in);
+				file->setOrder(order);
+				patches.append(file);
+			}
+		}
+
+		qint32 minimumLauncherVersion;
+		in >> version->id >> version->m_releaseTimeString >> version->m_releaseTime >>
+			version->m_updateTimeString >> version->m_updateTime >> version->type >>
+			version->assets >> version->processArguments >> version->vanillaProcessArguments >>
+			version->minecraftArguments >> version->vanillaMinecraftArguments >>
+			minimumLauncherVersion >> version->tweakers >> version->mainClass >>
+			version->appletClass >> version->traits;
+		version->minimumLauncherVersion = minimumLauncherVersion;
+		version->libraries = readLibraries(in);
+		version->vanillaLibraries = readLibraries(in);
+		version->jarMods = readJarMods(in);
+	}
+	catch (VersionBuildError &)
+	{
+		in.setStatus(QDataStream::ReadCorruptData);
+	}
+
+	if (in.status() != QDataStream::Ok)
+	{
+		QLOG_WARN() << "Version snapshot of" << instance->id() << "is damaged, rebuilding.";
+		version->clear();
+		return false;
+	}
+	version->VersionPatches = patches;
+	version->finalize();
+	return true;
+}
+
+void VersionSnapshot::save(InstanceVersion *version, OneSixInstance *instance,
+						   const QString &key)
+{
+	QSaveFile output(snapshotPath(instance));
+	if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		QLOG_WARN() << "Couldn't write version snapshot" << output.fileName() << ":"
+					<< output.errorString();
+		return;
+	}
+	QDataStream out(&output);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << snapshotMagic << snapshotFormat << key;
+
+	out << quint32(version->VersionPatches.size());
+	for (auto patch : version->VersionPatches)
+	{
+		auto file = std::dynamic_pointer_cast<VersionFile>(patch);
+		if (file)
+		{
+			out << qint32(Patch_File) << qint32(patch->getOrder());
+			out << file->filename << versionFileData(file);
+		}
+		else if (std::dynamic_pointer_cast<MinecraftVersion>(patch))
+		{
+			// these live in the version list, only remember that it was there
+			out << qint32(Patch_Minecraft) << qint32(patch->getOrder());
+		}
+		else
+		{
+			output.cancelWriting();
+			return;
+		}
+	}
+
+	out << version->id << version->m_releaseTimeString << version->m_releaseTime
+		<< version->m_updateTimeString << version->m_updateTime << version->type
+		<< version->assets << version->processArguments << version->vanillaProcessArguments
+		<< version->minecraftArguments << version->vanillaMinecraftArguments
+		<< qint32(version->minimumLauncherVersion) << version->tweakers << version->mainClass
+		<< version->appletClass << version->traits;
+	out << librariesData(version->libraries) << librariesData(version->vanillaLibraries);
+	writeJarMods(out, version->jarMods);
+
+	if (out.status() != QDataStream::Ok || !output.commit())
+	{
+		QLOG_WARN() << "Couldn't write version snapshot" << output.fileName();
+	}
+}
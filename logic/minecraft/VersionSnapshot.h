@@ -0,0 +1,49 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+class InstanceVersion;
+class OneSixInstance;
+
+/**
+ * Binary snapshots of fully built instance versions.
+ *
+ * Building a version means reading and parsing all the json files of an instance and applying
+ * them on top of each other. The result only depends on the content of those files, their order
+ * and the Minecraft version they are applied to, so it is stored in the instance folder along
+ * with a hash of all that, and reused for as long as the hash stays the same.
+ */
+namespace VersionSnapshot
+{
+/**
+ * Hash everything that goes into building the version of the instance.
+ */
+QString key(OneSixInstance *instance, const QStringList &external);
+
+/**
+ * Restore the version from the snapshot, if there is one for 'key'.
+ * Returns false when the version has to be built the usual way.
+ */
+bool load(InstanceVersion *version, OneSixInstance *instance, const QString &key);
+
+/**
+ * Store the built version under 'key'. Failures are logged and otherwise ignored.
+ */
+void save(InstanceVersion *version, OneSixInstance *instance, const QString &key);
+}
@@ -73,11 +73,16 @@ void CacheDownload::start()
 	}
 
 	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Cached)");
+	for (auto &header : m_rawHeaders)
+	{
+		request.setRawHeader(header.first, header.second);
+	}
 
 	auto worker = MMC->qnam();
 	QNetworkReply *rep = worker->get(request);
 
 	m_reply = std::shared_ptr<QNetworkReply>(rep);
+	applyLimiter(rep);
 	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
 			SLOT(downloadProgress(qint64, qint64)));
 	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
@@ -125,6 +130,12 @@ void CacheDownload::downloadFinished()
 		}
 	}
 
+	// the rate limit may have left some of it unread
+	if (m_status != Job_Failed && m_reply->bytesAvailable())
+	{
+		writeData(m_reply->readAll());
+	}
+
 	// if the download succeeded
 	if (m_status == Job_Failed)
 	{
@@ -180,14 +191,25 @@ void CacheDownload::downloadFinished()
 
 void CacheDownload::downloadReadyRead()
 {
-	QByteArray ba = m_reply->readAll();
+	// also called by the rate limit, possibly after the reply is done
+	if (!m_reply || m_status == Job_Failed)
+		return;
+	// aborting finishes the reply, which reports the failure
+	if (!writeData(readLimited()))
+		m_reply->abort();
+}
+
+bool CacheDownload::writeData(const QByteArray &ba)
+{
+	if (ba.isEmpty())
+		return true;
 	md5sum.addData(ba);
 	if (m_output_file->write(ba) != ba.size())
 	{
 		QLOG_ERROR() << "Failed writing into " + m_target_path;
 		m_status = Job_Failed;
-		m_reply->abort();
-		emit failed(m_index_within_job);
+		return false;
 	}
 	wroteAnyData = true;
+	return true;
 }
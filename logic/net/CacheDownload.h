@@ -19,6 +19,8 @@
 #include "HttpMetaCache.h"
 #include <QCryptographicHash>
 #include <QSaveFile>
+#include <QList>
+#include <QPair>
 
 typedef std::shared_ptr<class CacheDownload> CacheDownloadPtr;
 class CacheDownload : public NetAction
@@ -35,8 +37,13 @@ private:
 
 	bool wroteAnyData = false;
 
+	/// false if it couldn't be written. Marks the download as failed then.
+	bool writeData(const QByteArray &ba);
+
 public:
 	bool m_followRedirects = false;
+	/// sent with the request, after (and instead of) the default ones
+	QList<QPair<QByteArray, QByteArray>> m_rawHeaders;
 
 	explicit CacheDownload(QUrl url, MetaEntryPtr entry);
 	static CacheDownloadPtr make(QUrl url, MetaEntryPtr entry)
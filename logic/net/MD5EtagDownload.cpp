@@ -88,6 +88,7 @@ void MD5EtagDownload::start()
 	QNetworkReply *rep = worker->get(request);
 
 	m_reply = std::shared_ptr<QNetworkReply>(rep);
+	applyLimiter(rep);
 	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
 			SLOT(downloadProgress(qint64, qint64)));
 	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
@@ -115,6 +116,9 @@ void MD5EtagDownload::downloadFinished()
 	// if the download succeeded
 	if (m_status != Job_Failed)
 	{
+		// the rate limit may have left some of it unread
+		if (m_reply->bytesAvailable())
+			m_output_file.write(m_reply->readAll());
 		// nothing went wrong...
 		m_status = Job_Finished;
 		m_output_file.close();
@@ -140,6 +144,9 @@ void MD5EtagDownload::downloadFinished()
 
 void MD5EtagDownload::downloadReadyRead()
 {
+	// also called by the rate limit, possibly after the reply is done
+	if (!m_reply)
+		return;
 	if (!m_output_file.isOpen())
 	{
 		if (!m_output_file.open(QIODevice::WriteOnly))
@@ -152,5 +159,5 @@ void MD5EtagDownload::downloadReadyRead()
 			return;
 		}
 	}
-	m_output_file.write(m_reply->readAll());
+	m_output_file.write(readLimited());
 }
@@ -19,6 +19,9 @@
 #include <QUrl>
 #include <memory>
 #include <QNetworkReply>
+#include <QTimer>
+
+#include "RateLimiter.h"
 
 enum JobStatus
 {
@@ -73,6 +76,29 @@ public:
 	/// number of failures up to this point
 	int m_failures = 0;
 
+	/// limits how fast the reply is read, shared with other downloads. null for no limit.
+	RateLimiterPtr m_limiter;
+
+protected:
+	/// call on a new reply, so it doesn't keep reading from the network while we wait
+	void applyLimiter(QNetworkReply *reply)
+	{
+		if (m_limiter)
+			reply->setReadBufferSize(RateLimiter::bufferSize);
+	}
+
+	/// read as much as the limiter allows, and come back for the rest later
+	QByteArray readLimited()
+	{
+		if (!m_limiter)
+			return m_reply->readAll();
+		qint64 available = m_reply->bytesAvailable();
+		qint64 allowed = m_limiter->take(available);
+		if (allowed < available)
+			QTimer::singleShot(m_limiter->waitTime(), this, SLOT(downloadReadyRead()));
+		return m_reply->read(allowed);
+	}
+
 signals:
 	void started(int index);
 	void progress(int index, qint64 current, qint64 total);
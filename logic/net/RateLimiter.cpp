@@ -0,0 +1,67 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RateLimiter.h"
+
+#include <QtGlobal>
+
+const qint64 RateLimiter::bufferSize;
+
+RateLimiter::RateLimiter()
+{
+	m_clock.start();
+}
+
+void RateLimiter::setRate(qint64 rate)
+{
+	if (rate == m_rate)
+		return;
+	refill();
+	m_rate = rate;
+	m_tokens = qMin(m_tokens, capacity());
+}
+
+qint64 RateLimiter::capacity() const
+{
+	// a quarter of a second worth, but at least one buffer, so nobody waits forever
+	return qMax(m_rate / 4, bufferSize);
+}
+
+void RateLimiter::refill()
+{
+	qint64 elapsed = m_clock.restart();
+	if (m_rate <= 0)
+		return;
+	m_tokens = qMin(m_tokens + elapsed * m_rate / 1000, capacity());
+}
+
+qint64 RateLimiter::take(qint64 wanted)
+{
+	if (m_rate <= 0)
+		return wanted;
+	refill();
+	qint64 taken = qMin(wanted, m_tokens);
+	m_tokens -= taken;
+	return taken;
+}
+
+int RateLimiter::waitTime() const
+{
+	if (m_rate <= 0)
+		return 0;
+	// until a full buffer can be read, or at least 10ms to not spin
+	qint64 missing = qMax(bufferSize - m_tokens, qint64(0));
+	return qMax(int(missing * 1000 / m_rate), 10);
+}
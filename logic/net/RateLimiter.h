@@ -0,0 +1,55 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <memory>
+
+class RateLimiter;
+typedef std::shared_ptr<RateLimiter> RateLimiterPtr;
+
+/**
+ * A token bucket for the bytes read by a group of downloads.
+ *
+ * The downloads sharing one only read as many bytes from their replies as it hands out. Their
+ * read buffers are kept small, so Qt stops reading from the network while they wait and the
+ * server has to slow down.
+ */
+class RateLimiter
+{
+public:
+	/// how much a limited reply buffers before it stops reading from the network
+	static const qint64 bufferSize = 16 * 1024;
+
+	RateLimiter();
+
+	/// bytes per second, 0 or less for no limit
+	void setRate(qint64 rate);
+
+	/// take up to 'wanted' bytes from the bucket and return how many were taken
+	qint64 take(qint64 wanted);
+
+	/// ms until it's worth asking for more
+	int waitTime() const;
+
+private:
+	void refill();
+	qint64 capacity() const;
+
+	qint64 m_rate = 0;
+	qint64 m_tokens = 0;
+	QElapsedTimer m_clock;
+};
@@ -16,76 +16,121 @@
 #include "logic/settings/INIFile.h"
 
 #include <QFile>
-#include <QTextStream>
-#include <QStringList>
+#include <QSaveFile>
+#include <string.h>
 
 INIFile::INIFile()
 {
 }
 
+namespace
+{
+bool isAsciiSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// decodes [begin, end) without the whitespace around it
+QString decodeTrimmed(const char *begin, const char *end)
+{
+	while (begin < end && isAsciiSpace(*begin))
+		begin++;
+	while (end > begin && isAsciiSpace(end[-1]))
+		end--;
+	QString result = QString::fromUtf8(begin, end - begin);
+	// the rare non-ASCII whitespace
+	if (!result.isEmpty() && (result.at(0).isSpace() || result.at(result.size() - 1).isSpace()))
+		return result.trimmed();
+	return result;
+}
+}
+
 QString INIFile::unescape(QString orig)
 {
+	int first = orig.indexOf('\\');
+	if (first == -1)
+		return orig;
+
+	const QChar *data = orig.constData();
+	const int size = orig.size();
 	QString out;
-	QChar prev = 0;
-	for(auto c: orig)
+	out.reserve(size);
+	out.append(data, first);
+	for (int i = first; i < size; i++)
 	{
-		if(prev == '\\')
+		QChar c = data[i];
+		if (c == '\\')
 		{
-			if(c == 'n')
-				out += '\n';
+			// a backslash at the end is dropped
+			if (++i == size)
+				break;
+			c = data[i];
+			if (c == 'n')
+				c = '\n';
 			else if (c == 't')
-				out += '\t';
-			else
-				out += c;
-			prev = 0;
-		}
-		else
-		{
-			if(c == '\\')
-			{
-				prev = c;
-				continue;
-			}
-			out += c;
-			prev = 0;
+				c = '\t';
 		}
+		out.append(c);
 	}
 	return out;
 }
 
 QString INIFile::escape(QString orig)
 {
+	const QChar *data = orig.constData();
+	const int size = orig.size();
+	int first = 0;
+	while (first < size && data[first] != '\n' && data[first] != '\t' && data[first] != '\\')
+		first++;
+	if (first == size)
+		return orig;
+
 	QString out;
-	for(auto c: orig)
+	out.reserve(size + 16);
+	out.append(data, first);
+	for (int i = first; i < size; i++)
 	{
-		if(c == '\n')
-			out += "\\n";
+		QChar c = data[i];
+		if (c == '\n')
+			out.append(QLatin1String("\\n"));
 		else if (c == '\t')
-			out += "\\t";
-		else if(c == '\\')
-			out += "\\\\";
+			out.append(QLatin1String("\\t"));
+		else if (c == '\\')
+			out.append(QLatin1String("\\\\"));
 		else
-			out += c;
+			out.append(c);
 	}
 	return out;
 }
 
-bool INIFile::saveFile(QString fileName)
+QByteArray INIFile::serialize() const
 {
-	// TODO Handle errors.
-	QFile file(fileName);
-	file.open(QIODevice::WriteOnly);
-	QTextStream out(&file);
-	out.setCodec("UTF-8");
-
-	for (Iterator iter = begin(); iter != end(); iter++)
+	QByteArray out;
+	// a guess that fits the usual instance.cfg without growing
+	out.reserve(size() * 48);
+	for (ConstIterator iter = begin(); iter != end(); iter++)
 	{
-		QString value = iter.value().toString();
-		value = escape(value);
-		out << iter.key() << "=" << value << "\n";
+		out.append(iter.key().toUtf8());
+		out.append('=');
+		out.append(escape(iter.value().toString()).toUtf8());
+		out.append('\n');
 	}
+	return out;
+}
 
-	return true;
+bool INIFile::saveFile(QString fileName)
+{
+	// written to a temporary file and moved over the old one, so it is never left half written
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	QByteArray contents = serialize();
+	if (file.write(contents) != contents.size())
+	{
+		file.cancelWriting();
+		return false;
+	}
+	return file.commit();
 }
 
 bool INIFile::loadFile(QString fileName)
@@ -99,26 +144,33 @@ bool INIFile::loadFile(QString fileName)
 }
 bool INIFile::loadFile(QByteArray file)
 {
-	QTextStream in(file);
-	in.setCodec("UTF-8");
-
-	QStringList lines = in.readAll().split('\n');
-	for (int i = 0; i < lines.count(); i++)
+	const char *data = file.constData();
+	const char *const fileEnd = data + file.size();
+	// a UTF-8 byte order mark
+	if (file.startsWith("\xEF\xBB\xBF"))
+		data += 3;
+
+	// '\n', '#' and '=' never appear inside of a multi-byte UTF-8 sequence, so the lines can be
+	// split up before decoding them
+	while (data < fileEnd)
 	{
-		QString &lineRaw = lines[i];
-		// Ignore comments.
-		QString line = lineRaw.left(lineRaw.indexOf('#')).trimmed();
-
-		int eqPos = line.indexOf('=');
-		if (eqPos == -1)
-			continue;
-		QString key = line.left(eqPos).trimmed();
-		QString valueStr = line.right(line.length() - eqPos - 1).trimmed();
+		const char *lineEnd = (const char *)memchr(data, '\n', fileEnd - data);
+		if (!lineEnd)
+			lineEnd = fileEnd;
 
-		valueStr = unescape(valueStr);
+		// Ignore comments.
+		const char *end = (const char *)memchr(data, '#', lineEnd - data);
+		if (!end)
+			end = lineEnd;
 
-		QVariant value(valueStr);
-		this->operator[](key) = value;
+		const char *eq = (const char *)memchr(data, '=', end - data);
+		if (eq)
+		{
+			QString key = decodeTrimmed(data, eq);
+			QString value = unescape(decodeTrimmed(eq + 1, end));
+			insert(key, QVariant(value));
+		}
+		data = lineEnd + 1;
 	}
 
 	return true;
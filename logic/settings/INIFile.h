@@ -28,6 +28,8 @@ public:
 	bool loadFile(QByteArray file);
 	bool loadFile(QString fileName);
 	bool saveFile(QString fileName);
+	/// the contents of the file saveFile writes
+	QByteArray serialize() const;
 
 	QVariant get(QString key, QVariant def) const;
 	void set(QString key, QVariant val);
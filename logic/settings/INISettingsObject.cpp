@@ -16,23 +16,129 @@
 #include "INISettingsObject.h"
 #include "Setting.h"
 
+#include <QtConcurrentRun>
+
+#include "logger/QsLog.h"
+
+const static int WRITE_DELAY = 500;
+
+QSet<INISettingsObject *> INISettingsObject::s_pending;
+
 INISettingsObject::INISettingsObject(const QString &path, QObject *parent)
 	: SettingsObject(parent)
 {
 	m_filePath = path;
 	m_ini.loadFile(path);
+	m_writeTimer.setSingleShot(true);
+	m_writeTimer.setInterval(WRITE_DELAY);
+	connect(&m_writeTimer, SIGNAL(timeout()), SLOT(startWrite()));
+	connect(&m_writeWatcher, SIGNAL(finished()), SLOT(writeFinished()));
+}
+
+INISettingsObject::INISettingsObject(const QString &path, const INIFile &contents,
+									 QObject *parent)
+	: SettingsObject(parent), m_ini(contents)
+{
+	m_filePath = path;
+	m_writeTimer.setSingleShot(true);
+	m_writeTimer.setInterval(WRITE_DELAY);
+	connect(&m_writeTimer, SIGNAL(timeout()), SLOT(startWrite()));
+	connect(&m_writeWatcher, SIGNAL(finished()), SLOT(writeFinished()));
+}
+
+INISettingsObject::~INISettingsObject()
+{
+	flush();
+	s_pending.remove(this);
 }
 
 void INISettingsObject::setFilePath(const QString &filePath)
 {
+	// the pending changes belong to the old file
+	flush();
 	m_filePath = filePath;
 }
 
 bool INISettingsObject::reload()
 {
+	flush();
 	return m_ini.loadFile(m_filePath) && SettingsObject::reload();
 }
 
+void INISettingsObject::markDirty()
+{
+	m_dirty = true;
+	s_pending.insert(this);
+	// every change pushes the write back a bit, up to when the changes stop coming
+	m_writeTimer.start();
+}
+
+bool INISettingsObject::writeFile(QString path, INIFile contents)
+{
+	return contents.saveFile(path);
+}
+
+void INISettingsObject::startWrite()
+{
+	// writeFinished starts the next one
+	if (m_writing || !m_dirty)
+		return;
+	m_dirty = false;
+	m_writing = true;
+	m_writeWatcher.setFuture(QtConcurrent::run(&INISettingsObject::writeFile, m_filePath, m_ini));
+}
+
+void INISettingsObject::writeFinished()
+{
+	// flush() already took care of it
+	if (!m_writing)
+		return;
+	m_writing = false;
+	if (!m_writeWatcher.result())
+	{
+		// tried again when flushing, not in a loop
+		QLOG_ERROR() << "Failed to write the settings file" << m_filePath;
+		m_dirty = true;
+		return;
+	}
+	if (m_dirty)
+		m_writeTimer.start();
+	else
+		s_pending.remove(this);
+}
+
+bool INISettingsObject::flush()
+{
+	m_writeTimer.stop();
+	if (m_writing)
+	{
+		m_writeWatcher.waitForFinished();
+		m_writing = false;
+		if (!m_writeWatcher.result())
+			m_dirty = true;
+	}
+	if (m_dirty)
+	{
+		if (!m_ini.saveFile(m_filePath))
+		{
+			QLOG_ERROR() << "Failed to write the settings file" << m_filePath;
+			return false;
+		}
+		m_dirty = false;
+	}
+	s_pending.remove(this);
+	return true;
+}
+
+void INISettingsObject::flushAll()
+{
+	// flush() takes them out of the set
+	for (auto settings : s_pending.values())
+	{
+		settings->flush();
+	}
+}
+
 void INISettingsObject::changeSetting(const Setting &setting, QVariant value)
 {
 	if (contains(setting.id()))
@@ -51,7 +157,7 @@ void INISettingsObject::changeSetting(const Setting &setting, QVariant value)
 			for(auto iter: setting.configKeys())
 				m_ini.remove(iter);
 		}
-		m_ini.saveFile(m_filePath);
+		markDirty();
 	}
 }
 
@@ -62,7 +168,7 @@ void INISettingsObject::resetSetting(const Setting &setting)
 	{
 		for(auto iter: setting.configKeys())
 			m_ini.remove(iter);
-		m_ini.saveFile(m_filePath);
+		markDirty();
 	}
 }
 
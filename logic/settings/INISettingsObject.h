@@ -16,6 +16,9 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QSet>
 
 #include "logic/settings/INIFile.h"
 
@@ -23,12 +26,18 @@
 
 /*!
  * \brief A settings object that stores its settings in an INIFile.
+ *
+ * Changes aren't written right away. The file is marked dirty and written a moment after the
+ * last change, on a worker thread, so applying many settings at once writes it only once.
  */
 class INISettingsObject : public SettingsObject
 {
 	Q_OBJECT
 public:
 	explicit INISettingsObject(const QString &path, QObject *parent = 0);
+	/// use 'contents', already read from 'path' (on another thread, for example)
+	INISettingsObject(const QString &path, const INIFile &contents, QObject *parent = 0);
+	virtual ~INISettingsObject();
 
 	/*!
 	 * \brief Gets the path to the INI file.
@@ -47,15 +56,38 @@ public:
 
 	bool reload() override;
 
+	bool flush() override;
+
+	/// writes the pending changes of all the settings files. used when shutting down.
+	static void flushAll();
+
 protected
 slots:
 	virtual void changeSetting(const Setting &setting, QVariant value);
 	virtual void resetSetting(const Setting &setting);
 
+private
+slots:
+	void startWrite();
+	void writeFinished();
+
 protected:
 	virtual QVariant retrieveValue(const Setting &setting);
 
 	INIFile m_ini;
 
 	QString m_filePath;
+
+private:
+	void markDirty();
+	static bool writeFile(QString path, INIFile contents);
+
+	QTimer m_writeTimer;
+	QFutureWatcher<bool> m_writeWatcher;
+	/// changed since the last write was started
+	bool m_dirty = false;
+	bool m_writing = false;
+
+	/// the ones with changes that aren't written yet
+	static QSet<INISettingsObject *> s_pending;
 };
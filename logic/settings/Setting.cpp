@@ -23,18 +23,23 @@ Setting::Setting(QStringList synonyms, QVariant defVal)
 
 QVariant Setting::get() const
 {
+	if (m_cached)
+		return m_cache;
 	SettingsObject *sbase = m_storage;
 	if (!sbase)
 	{
-		return defValue();
+		m_cache = defValue();
 	}
 	else
 	{
 		QVariant test = sbase->retrieveValue(*this);
 		if (!test.isValid())
-			return defValue();
-		return test;
+			m_cache = defValue();
+		else
+			m_cache = test;
 	}
+	m_cached = true;
+	return m_cache;
 }
 
 QVariant Setting::defValue() const
@@ -44,10 +49,20 @@ QVariant Setting::defValue() const
 
 void Setting::set(QVariant value)
 {
+	// the storage is updated by the first slot connected, the others read the new value
+	invalidate();
 	emit SettingChanged(*this, value);
 }
 
 void Setting::reset()
 {
+	invalidate();
 	emit settingReset(*this);
 }
+
+void Setting::invalidate()
+{
+	m_cached = false;
+	m_cache = QVariant();
+	m_generation++;
+}
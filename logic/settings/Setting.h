@@ -78,6 +78,15 @@ public:
 	 */
 	virtual QVariant defValue() const;
 
+	/*!
+	 * \brief Counts the changes of this setting's value.
+	 * TypedSetting compares it to know when its converted value is out of date.
+	 */
+	int generation() const
+	{
+		return m_generation;
+	}
+
 signals:
 	/*!
 	 * \brief Signal emitted when this Setting object's value changes.
@@ -109,9 +118,20 @@ slots:
 	 */
 	virtual void reset();
 
+	/*!
+	 * \brief Forgets the cached value.
+	 * Called when the value may have changed without going through set() or reset().
+	 */
+	void invalidate();
+
 protected:
 	friend class SettingsObject;
 	SettingsObject * m_storage;
 	QStringList m_synonyms;
 	QVariant m_defVal;
+
+	/// what get() returned last, until the value changes
+	mutable QVariant m_cache;
+	mutable bool m_cached = false;
+	int m_generation = 0;
 };
@@ -105,6 +105,10 @@ bool SettingsObject::contains(const QString &id)
 
 bool SettingsObject::reload()
 {
+	for (auto setting : m_settings.values())
+	{
+		setting->invalidate();
+	}
 	for (auto setting : m_settings.values())
 	{
 		setting->set(setting->get());
@@ -117,6 +117,15 @@ public:
 	 */
 	virtual bool reload();
 
+	/*!
+	 * \brief Writes out any changes that are still waiting to be saved, and waits for it.
+	 * \return True if everything is saved
+	 */
+	virtual bool flush()
+	{
+		return true;
+	}
+
 signals:
 	/*!
 	 * \brief Signal emitted when one of this SettingsObject object's settings changes.
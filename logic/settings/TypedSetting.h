@@ -0,0 +1,85 @@
+/* Copyright 2013-2014 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "logic/settings/Setting.h"
+
+/*!
+ * \brief A handle on a registered setting, for the places that read it often.
+ *
+ * The setting is looked up once, when the handle is made. The value is converted to T once
+ * after every change of the setting, so reading it is a comparison and a copy.
+ *
+ * \code
+ * TypedSetting<int> maxMem(settings.getSetting("MaxMemAlloc"));
+ * int value = maxMem.get();
+ * \endcode
+ */
+template <typename T> class TypedSetting
+{
+public:
+	TypedSetting()
+	{
+	}
+	explicit TypedSetting(std::shared_ptr<Setting> setting) : m_setting(setting)
+	{
+	}
+
+	/// false if the setting wasn't registered
+	bool isValid() const
+	{
+		return m_setting != nullptr;
+	}
+
+	std::shared_ptr<Setting> setting() const
+	{
+		return m_setting;
+	}
+
+	const T &get() const
+	{
+		if (!m_setting)
+			return m_value;
+		int generation = m_setting->generation();
+		if (!m_converted || generation != m_generation)
+		{
+			m_value = m_setting->get().template value<T>();
+			m_generation = generation;
+			m_converted = true;
+		}
+		return m_value;
+	}
+
+	void set(const T &value)
+	{
+		if (m_setting)
+			m_setting->set(QVariant::fromValue(value));
+	}
+
+	void reset()
+	{
+		if (m_setting)
+			m_setting->reset();
+	}
+
+private:
+	std::shared_ptr<Setting> m_setting;
+	mutable T m_value = T();
+	mutable int m_generation = 0;
+	mutable bool m_converted = false;
+};
@@ -0,0 +1,190 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <quazip.h>
+#include <quazipfile.h>
+#include "TestUtil.h"
+
+#include <javautils.h>
+#include "depends/classparser/src/classfile.h"
+
+/// writes the big-endian structures of a class file
+class ClassWriter
+{
+public:
+	ClassWriter &u1(quint8 value)
+	{
+		data.append(char(value));
+		return *this;
+	}
+	ClassWriter &u2(quint16 value)
+	{
+		return u1(value >> 8).u1(value & 0xFF);
+	}
+	ClassWriter &u4(quint32 value)
+	{
+		return u2(value >> 16).u2(value & 0xFFFF);
+	}
+	ClassWriter &utf8(const QByteArray &str)
+	{
+		u1(1).u2(str.size());
+		data.append(str);
+		return *this;
+	}
+	QByteArray data;
+};
+
+/**
+ * A class file with a version string in the constant pool and an @Mod(modid = "testmod")
+ * annotation. The parameters break it in different ways.
+ */
+QByteArray makeClass(quint16 attributeName = 6, quint32 attributeLength = 0,
+					 quint8 elementTag = 's', quint16 elementIndex = 9)
+{
+	ClassWriter w;
+	w.u4(0xCAFEBABE).u2(0).u2(50);
+	w.u2(10);
+	w.utf8("Minecraft Minecraft 1.7.10");	// 1
+	w.utf8("net/minecraft/client/Minecraft"); // 2
+	w.u1(7).u2(2);							  // 3
+	w.utf8("java/lang/Object");				  // 4
+	w.u1(7).u2(4);							  // 5
+	w.utf8("RuntimeVisibleAnnotations");	  // 6
+	w.utf8("Lcpw/mods/fml/common/Mod;");	  // 7
+	w.utf8("modid");						  // 8
+	w.utf8("testmod");						  // 9
+	// access flags, this class, super class, no interfaces, fields or methods
+	w.u2(0x21).u2(3).u2(5).u2(0).u2(0).u2(0);
+
+	ClassWriter annotations;
+	annotations.u2(1).u2(7).u2(1).u2(8).u1(elementTag).u2(elementIndex);
+	w.u2(1).u2(attributeName);
+	w.u4(attributeLength ? attributeLength : annotations.data.size());
+	w.data.append(annotations.data);
+	return w.data;
+}
+
+/// parse all of it, including the annotations
+void parseClass(const QByteArray &data)
+{
+	java::classfile parsed(data.constData(), data.size());
+	parsed.visible_class_annotations();
+}
+
+/// true if 'parse' rejects its input the way the parser is supposed to
+template <typename F> bool rejects(F parse)
+{
+	try
+	{
+		parse();
+	}
+	catch (java::classfile_exception &)
+	{
+		return true;
+	}
+	return false;
+}
+
+class ClassParserTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_Valid()
+	{
+		QByteArray data = makeClass();
+		java::classfile parsed(data.constData(), data.size());
+		QCOMPARE(parsed.constants.size(), std::size_t(10));
+		QCOMPARE(parsed.visible_class_annotations().size(), std::size_t(1));
+
+		javautils::ModAnnotation mod;
+		QVERIFY(javautils::GetModAnnotation(data, mod));
+		QCOMPARE(mod.annotation, QString("Mod"));
+		QCOMPARE(mod.modid, QString("testmod"));
+	}
+
+	void test_Truncated()
+	{
+		QByteArray data = makeClass();
+		for (int size = 0; size < data.size(); size++)
+		{
+			QVERIFY(rejects([&] { parseClass(data.left(size)); }));
+		}
+	}
+
+	void test_ConstantIndexes()
+	{
+		QByteArray data = makeClass();
+		java::classfile parsed(data.constData(), data.size());
+		QVERIFY(rejects([&] { parsed.constants.type(0); }));
+		QVERIFY(rejects([&] { parsed.constants.type(10); }));
+		QVERIFY(rejects([&] { parsed.constants.utf8(0xFFFF); }));
+		QVERIFY(rejects([&] { parsed.constants[10]; }));
+		// not a UTF-8 constant
+		QVERIFY(rejects([&] { parsed.constants.utf8(3); }));
+
+		// an attribute name past the end of the pool
+		QVERIFY(rejects([&] { parseClass(makeClass(200)); }));
+
+		// an annotation value past the end of the pool
+		javautils::ModAnnotation mod;
+		QVERIFY(!javautils::GetModAnnotation(makeClass(6, 0, 's', 0xFFFF), mod));
+	}
+
+	void test_Lengths()
+	{
+		// a UTF-8 constant longer than the file
+		ClassWriter w;
+		w.u4(0xCAFEBABE).u2(0).u2(50).u2(2).u1(1).u2(0xFFFF);
+		w.data.append("short");
+		QVERIFY(rejects([&] { parseClass(w.data); }));
+
+		// more constants than the file has
+		ClassWriter count;
+		count.u4(0xCAFEBABE).u2(0).u2(50).u2(0xFFFF).utf8("only one");
+		QVERIFY(rejects([&] { parseClass(count.data); }));
+
+		// an empty constant pool
+		ClassWriter empty;
+		empty.u4(0xCAFEBABE).u2(0).u2(50).u2(0);
+		QVERIFY(rejects([&] { parseClass(empty.data); }));
+
+		// an attribute that is skipped, but is longer than the file
+		QVERIFY(rejects([&] { parseClass(makeClass(8, 0xFFFFFFF0)); }));
+	}
+
+	void test_MalformedAnnotation()
+	{
+		// an element value of an unknown type
+		QVERIFY(rejects([&] { parseClass(makeClass(6, 0, 'x')); }));
+		// an array that claims more values than there are
+		QVERIFY(rejects([&] { parseClass(makeClass(6, 0, '[', 0xFFFF)); }));
+
+		javautils::ModAnnotation mod;
+		QVERIFY(!javautils::GetModAnnotation(makeClass(6, 0, 'x'), mod));
+	}
+
+	void test_MinecraftJarVersion()
+	{
+		QTemporaryDir dir;
+		QString jarPath = QDir(dir.path()).absoluteFilePath("minecraft.jar");
+		{
+			QuaZip zip(jarPath);
+			QVERIFY(zip.open(QuaZip::mdCreate));
+			QuaZipFile file(&zip);
+			QVERIFY(file.open(QIODevice::WriteOnly,
+							  QuaZipNewInfo("net/minecraft/client/Minecraft.class")));
+			file.write(makeClass());
+			file.close();
+			zip.close();
+		}
+		QCOMPARE(javautils::GetMinecraftJarVersion(jarPath), QString("1.7.10"));
+
+		// not a jar
+		QCOMPARE(javautils::GetMinecraftJarVersion(QDir(dir.path()).absoluteFilePath("none")),
+				 QString(MCVer_Unknown));
+	}
+};
+
+QTEST_GUILESS_MAIN_MULTIMC(ClassParserTest)
+
+#include "tst_classparser.moc"
@@ -53,6 +53,23 @@ slots:
 		
 		QCOMPARE(converted, expected);
 	}
+	void test_Equality()
+	{
+		GradleSpecifier plain("net.minecraft:launchwrapper:1.5");
+		GradleSpecifier explicitJar("net.minecraft:launchwrapper:1.5@jar");
+		GradleSpecifier newer("net.minecraft:launchwrapper:1.6");
+
+		QVERIFY(plain == explicitJar);
+		QCOMPARE(qHash(plain), qHash(explicitJar));
+		QVERIFY(!(plain == newer));
+		QVERIFY(plain.matchName(newer));
+		QVERIFY(!plain.matchName(GradleSpecifier("net.minecraft:minecraft:1.5")));
+
+		GradleSpecifier classified = plain;
+		classified.setClassifier("natives-linux");
+		QVERIFY(!(plain == classified));
+		QCOMPARE(QString(classified), QString("net.minecraft:launchwrapper:1.5:natives-linux"));
+	}
 	void test_Negative_data()
 	{
 		QTest::addColumn<QString>("input");
@@ -1,8 +1,36 @@
 #include <QTest>
+#include <QTemporaryDir>
 #include "TestUtil.h"
 
 #include "logic/settings/INIFile.h"
 
+// what an instance.cfg usually looks like
+INIFile instanceSettings()
+{
+	INIFile ini;
+	ini.set("InstanceType", "OneSix");
+	ini.set("IntendedVersion", "1.7.10");
+	ini.set("name", "Some Instance");
+	ini.set("iconKey", "default");
+	ini.set("notes", "Lorem ipsum\ndolor sit amet.\n\tconsectetur");
+	ini.set("lastLaunchTime", 1234567890123LL);
+	ini.set("OverrideJava", true);
+	ini.set("JavaPath", "/usr/lib/jvm/java-7-openjdk/bin/java");
+	ini.set("JvmArgs", "-XX:+UseConcMarkSweepGC -XX:+CMSIncrementalMode");
+	ini.set("OverrideMemory", true);
+	ini.set("MinMemAlloc", 512);
+	ini.set("MaxMemAlloc", 2048);
+	ini.set("PermGen", 128);
+	ini.set("OverrideWindow", false);
+	ini.set("LaunchMaximized", false);
+	ini.set("MinecraftWinWidth", 854);
+	ini.set("MinecraftWinHeight", 480);
+	ini.set("OverrideConsole", false);
+	ini.set("ShowConsole", true);
+	ini.set("AutoCloseConsole", true);
+	return ini;
+}
+
 class IniFileTest : public QObject
 {
 	Q_OBJECT
@@ -36,6 +64,64 @@ slots:
 		
 		QCOMPARE(back, through);
 	}
+
+	void test_Parse()
+	{
+		QByteArray contents = "\xEF\xBB\xBFname=Some Instance\r\n"
+							  "# a comment\n"
+							  "  iconKey =  default  # after the value\n"
+							  "notes=first\\nsecond\\tthird\\\\\n"
+							  "no value here\n"
+							  "empty=\n"
+							  "unicode=\xC3\xA4\xC3\xB6\xC3\xBC";
+		INIFile ini;
+		QVERIFY(ini.loadFile(contents));
+		QCOMPARE(ini.size(), 5);
+		QCOMPARE(ini.get("name", QVariant()).toString(), QString("Some Instance"));
+		QCOMPARE(ini.get("iconKey", QVariant()).toString(), QString("default"));
+		QCOMPARE(ini.get("notes", QVariant()).toString(), QString("first\nsecond\tthird\\"));
+		QCOMPARE(ini.get("empty", QVariant()).toString(), QString());
+		QCOMPARE(ini.get("unicode", QVariant()).toString(),
+				 QString::fromUtf8("\xC3\xA4\xC3\xB6\xC3\xBC"));
+	}
+
+	void test_SaveLoad()
+	{
+		INIFile ini;
+		ini.set("name", "Some Instance");
+		ini.set("notes", "Lorem\n\tipsum\\dolor");
+		ini.set("lastLaunchTime", 1234567890123LL);
+
+		QTemporaryDir dir;
+		QString path = QDir(dir.path()).absoluteFilePath("instance.cfg");
+		QVERIFY(ini.saveFile(path));
+
+		INIFile back;
+		QVERIFY(back.loadFile(path));
+		QCOMPARE(back.size(), ini.size());
+		QCOMPARE(back.get("name", QVariant()).toString(), QString("Some Instance"));
+		QCOMPARE(back.get("notes", QVariant()).toString(), QString("Lorem\n\tipsum\\dolor"));
+		QCOMPARE(back.get("lastLaunchTime", QVariant()).toLongLong(), 1234567890123LL);
+	}
+
+	void benchmark_Parse()
+	{
+		QByteArray contents = instanceSettings().serialize();
+		QBENCHMARK
+		{
+			INIFile ini;
+			ini.loadFile(contents);
+		}
+	}
+
+	void benchmark_Serialize()
+	{
+		INIFile ini = instanceSettings();
+		QBENCHMARK
+		{
+			ini.serialize();
+		}
+	}
 };
 
 QTEST_GUILESS_MAIN_MULTIMC(IniFileTest)
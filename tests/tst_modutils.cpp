@@ -98,6 +98,53 @@ private slots:
 		QCOMPARE(Util::versionIsInInterval(version, interval), result);
 	}
 
+	void test_VersionInterval_data()
+	{
+		QTest::addColumn<QString>("version");
+		QTest::addColumn<QString>("interval");
+		QTest::addColumn<bool>("result");
+
+		QTest::newRow("inclusive bottom, on it") << "1.2" << "[1.2,1.3]" << true;
+		QTest::newRow("inclusive top, on it") << "1.3" << "[1.2,1.3]" << true;
+		QTest::newRow("inclusive, implicit zero") << "1.2.0" << "[1.2,1.3]" << true;
+		QTest::newRow("exclusive bottom, on it") << "1.2" << "(1.2,1.3)" << false;
+		QTest::newRow("exclusive top, on it") << "1.3" << "(1.2,1.3)" << false;
+		QTest::newRow("exclusive, between") << "1.2.5" << "(1.2,1.3)" << true;
+		QTest::newRow("exclusive, below") << "1.1.9" << "(1.2,1.3)" << false;
+		QTest::newRow("exclusive, above") << "1.3.1" << "(1.2,1.3)" << false;
+
+		QTest::newRow("open top, far above") << "42.0" << "[1.2,)" << true;
+		QTest::newRow("open top, below") << "1.1" << "[1.2,)" << false;
+		QTest::newRow("open bottom, far below") << "0.1" << "(,1.3]" << true;
+		QTest::newRow("open bottom, above") << "1.4" << "(,1.3]" << false;
+		QTest::newRow("open both ends") << "1.2.3" << "(,)" << true;
+
+		// brackets the wrong way around don't bound anything
+		QTest::newRow("reversed brackets, below") << "1.0" << "]1.2,1.3[" << true;
+		QTest::newRow("reversed brackets, above") << "2.0" << "]1.2,1.3[" << true;
+		QTest::newRow("reversed bottom bracket") << "1.0" << "]1.2,1.3]" << true;
+		QTest::newRow("reversed bottom bracket, top still checked") << "1.4" << "]1.2,1.3]"
+																	 << false;
+
+		QTest::newRow("empty") << "1.2.3" << "" << true;
+		QTest::newRow("invalid") << "1.2.3" << "not an interval" << false;
+		QTest::newRow("invalid, exact match") << "not an interval" << "not an interval" << true;
+		QTest::newRow("exact match") << "1.2.3" << "1.2.3" << true;
+		// without brackets it's a plain string comparison
+		QTest::newRow("exact match, implicit zero") << "1.2.0" << "1.2" << false;
+	}
+	void test_VersionInterval()
+	{
+		QFETCH(QString, version);
+		QFETCH(QString, interval);
+		QFETCH(bool, result);
+
+		const Util::VersionInterval parsed(interval);
+		QCOMPARE(parsed.contains(Util::Version(version)), result);
+		// parsed once, checked many times
+		QCOMPARE(parsed.contains(Util::Version(version)), result);
+	}
+
 	void test_versionCompareLessThan_data()
 	{
 		setupVersions();
@@ -146,6 +193,26 @@ private slots:
 
 		QCOMPARE(v1 == v2, equal);
 	}
+	void test_versionCompareSymmetric_data()
+	{
+		setupVersions();
+	}
+	void test_versionCompareSymmetric()
+	{
+		QFETCH(QString, first);
+		QFETCH(QString, second);
+
+		const auto v1 = Util::Version(first);
+		const auto v2 = Util::Version(second);
+
+		QCOMPARE(v1 < v2, v2 > v1);
+		QCOMPARE(v1 > v2, v2 < v1);
+		QCOMPARE(v1 <= v2, v2 >= v1);
+		QCOMPARE(v1 == v2, v2 == v1);
+		QCOMPARE(v1 != v2, v2 != v1);
+		// exactly one of them
+		QCOMPARE(int(v1 < v2) + int(v1 == v2) + int(v1 > v2), 1);
+	}
 };
 
 QTEST_GUILESS_MAIN(ModUtilsTest)